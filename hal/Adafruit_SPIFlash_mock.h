@@ -4,11 +4,35 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <array>
+#include <cstring>
+#include <memory>
+
 #define FAKE_MEMORY_SIZE_BYTES 16777216 // 16MB
 #define SFLASH_SECTOR_SIZE 4096
 #define SFLASH_BLOCK_SIZE 65536
 #define SFLASH_PAGE_SIZE 256
 
+// Latencies charged to the mock's virtual clock. Defaults are typical W25Q128
+// datasheet figures with the bus at 8 MHz (1 us per byte).
+struct FakeFlashTiming {
+    uint32_t command_ns = 5000;        // Opcode, address and chip-select overhead per call
+    uint32_t transferPerByte_ns = 1000;
+    uint32_t pageProgram_us = 700;     // Per page touched by a write
+    uint32_t sectorErase_us = 45000;
+    uint32_t chipErase_us = 40000000;
+};
+
+/**
+ * Sparse NOR flash mock. Sectors are allocated on first write and released on
+ * erase; unallocated sectors read as erased (0xFF), so a fresh mock is a blank
+ * chip. Like real NOR flash, writes can only clear bits: the stored byte is
+ * the AND of the old and new values, and attempts to set a bit are counted in
+ * getNorViolations().
+ *
+ * Every call is charged to a virtual clock instead of sleeping, so tests can
+ * measure how long code would block on the real chip with getElapsed_us().
+ */
 class Adafruit_SPIFlash {
     public:
 
@@ -23,49 +47,135 @@ class Adafruit_SPIFlash {
     }
 
     bool writeBuffer(uint32_t address, const uint8_t* buffer, size_t length) {
-        // Write to fake memory
-        for (size_t i = 0; i < length; i++) {
-            fakeMemory[address + i] = buffer[i];
-        }
-        // if out of bounds, return false
-        if (address + length > FAKE_MEMORY_SIZE_BYTES) {
+        if (!inBounds(address, length)) {
             return false;
         }
-
+        chargeTransfer(length);
+        if (length == 0U) {
+            return true;
+        }
+        for (size_t done = 0; done < length;) {
+            const uint32_t offset = static_cast<uint32_t>((address + done) % SFLASH_SECTOR_SIZE);
+            const size_t chunk = chunkLength(offset, length - done);
+            uint8_t* sector = touchSector(static_cast<uint32_t>((address + done) / SFLASH_SECTOR_SIZE));
+            for (size_t i = 0; i < chunk; i++) {
+                const uint8_t old = sector[offset + i];
+                const uint8_t value = buffer[done + i];
+                if ((value & static_cast<uint8_t>(~old)) != 0U) {
+                    norViolations_++;
+                }
+                sector[offset + i] = static_cast<uint8_t>(old & value);
+            }
+            done += chunk;
+        }
+        const uint32_t firstPage = address / SFLASH_PAGE_SIZE;
+        const uint32_t lastPage = static_cast<uint32_t>((address + length - 1U) / SFLASH_PAGE_SIZE);
+        pagePrograms_ += lastPage - firstPage + 1U;
+        elapsed_ns_ += static_cast<uint64_t>(lastPage - firstPage + 1U) * timing_.pageProgram_us * 1000U;
         return true;
     }
 
     bool readBuffer(uint32_t address, uint8_t* buffer, size_t length) {
-        // Read from fake memory
-        for (size_t i = 0; i < length; i++) {
-            buffer[i] = fakeMemory[address + i];
-        }
-
-        // if out of bounds, return false
-        if (address + length > FAKE_MEMORY_SIZE_BYTES) {
+        if (!inBounds(address, length)) {
             return false;
         }
-
+        chargeTransfer(length);
+        for (size_t done = 0; done < length;) {
+            const uint32_t offset = static_cast<uint32_t>((address + done) % SFLASH_SECTOR_SIZE);
+            const size_t chunk = chunkLength(offset, length - done);
+            const auto& sector = sectors_[(address + done) / SFLASH_SECTOR_SIZE];
+            if (sector) {
+                std::memcpy(buffer + done, sector->data() + offset, chunk);
+            } else {
+                std::memset(buffer + done, 0xFF, chunk);
+            }
+            done += chunk;
+        }
         return true;
     }
 
     bool eraseSector(uint32_t sectorNumber) {
-        // Erase the sector in fake memory
-        for (size_t i = 0; i < 4096; i++) {
-            fakeMemory[sectorNumber * 4096 + i] = 0xFF;
+        if (sectorNumber >= kSectorCount) {
+            return false;
         }
+        sectors_[sectorNumber].reset();
+        sectorErases_++;
+        elapsed_ns_ += timing_.command_ns + static_cast<uint64_t>(timing_.sectorErase_us) * 1000U;
         return true;
     }
 
     bool eraseChip() {
-        // Erase the entire chip in fake memory
-        for (size_t i = 0; i < FAKE_MEMORY_SIZE_BYTES; i++) {
-            fakeMemory[i] = 0xFF;
+        for (auto& sector : sectors_) {
+            sector.reset();
         }
+        elapsed_ns_ += timing_.command_ns + static_cast<uint64_t>(timing_.chipErase_us) * 1000U;
         return true;
     }
 
-    uint8_t fakeMemory[FAKE_MEMORY_SIZE_BYTES];
+    // Test access to the raw contents, bypassing NOR semantics and timing. The
+    // pointer is valid up to the end of the 4 KB sector holding `address`.
+    uint8_t* memoryAt(uint32_t address) {
+        return touchSector(address / SFLASH_SECTOR_SIZE) + address % SFLASH_SECTOR_SIZE;
+    }
+
+    void setTiming(const FakeFlashTiming& timing) { timing_ = timing; }
+
+    // Virtual time spent in flash calls since construction or resetStats()
+    uint64_t getElapsed_us() const { return elapsed_ns_ / 1000U; }
+    uint32_t getPagePrograms() const { return pagePrograms_; }
+    uint32_t getSectorErases() const { return sectorErases_; }
+    uint32_t getNorViolations() const { return norViolations_; }
+
+    // Allocated sectors, i.e. host memory in use divided by 4 KB
+    uint32_t getTouchedSectors() const {
+        uint32_t count = 0;
+        for (const auto& sector : sectors_) {
+            count += sector ? 1U : 0U;
+        }
+        return count;
+    }
+
+    void resetStats() {
+        elapsed_ns_ = 0;
+        pagePrograms_ = 0;
+        sectorErases_ = 0;
+        norViolations_ = 0;
+    }
+
+    private:
+
+    static constexpr uint32_t kSectorCount = FAKE_MEMORY_SIZE_BYTES / SFLASH_SECTOR_SIZE;
+    using Sector = std::array<uint8_t, SFLASH_SECTOR_SIZE>;
+
+    static bool inBounds(uint32_t address, size_t length) {
+        return length <= FAKE_MEMORY_SIZE_BYTES && address <= FAKE_MEMORY_SIZE_BYTES - length;
+    }
+
+    // Bytes from `offset` to the end of its sector, capped at `remaining`
+    static size_t chunkLength(uint32_t offset, size_t remaining) {
+        const size_t toSectorEnd = SFLASH_SECTOR_SIZE - offset;
+        return remaining < toSectorEnd ? remaining : toSectorEnd;
+    }
+
+    uint8_t* touchSector(uint32_t sectorNumber) {
+        std::unique_ptr<Sector>& sector = sectors_[sectorNumber];
+        if (!sector) {
+            sector.reset(new Sector());
+            sector->fill(0xFF);
+        }
+        return sector->data();
+    }
+
+    void chargeTransfer(size_t length) {
+        elapsed_ns_ += timing_.command_ns + static_cast<uint64_t>(length) * timing_.transferPerByte_ns;
+    }
+
+    std::array<std::unique_ptr<Sector>, kSectorCount> sectors_;
+    FakeFlashTiming timing_;
+    uint64_t elapsed_ns_ = 0;
+    uint32_t pagePrograms_ = 0;
+    uint32_t sectorErases_ = 0;
+    uint32_t norViolations_ = 0;
 };
 
-#endif // ADAFRUIT_SPIFLASH_MOCK_H
\ No newline at end of file
+#endif // ADAFRUIT_SPIFLASH_MOCK_H
@@ -71,6 +71,16 @@ inline unsigned long millis() {
     return static_cast<unsigned long>(elapsed_ms);
 }
 
+// micros mock, same time base as millis
+inline unsigned long micros() {
+    const auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - program_start).count();
+    if (elapsed_us < 0) {
+        return 0UL;
+    }
+    return static_cast<unsigned long>(elapsed_us);
+}
+
 inline void delay(unsigned long ms) { // NOLINT
     // Wait using the real time clock
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
@@ -19,6 +19,8 @@ public:
     std::vector<std::string> printCalls;
     std::vector<std::string> printlnCalls;
     std::vector<std::string> printfCalls;
+    std::vector<uint8_t> writtenBytes;
+    size_t writeCalls = 0;
 
     template<typename T>
     void print(const T& message) {
@@ -52,11 +54,17 @@ public:
         printCalls.clear();
         printlnCalls.clear();
         printfCalls.clear();
+        writtenBytes.clear();
+        writeCalls = 0;
     }
 
     // write
     size_t write(uint8_t) { return 0; }
-    size_t write(const uint8_t* /*buffer*/, size_t size) { return size; }
+    size_t write(const uint8_t* buffer, size_t size) {
+        writtenBytes.insert(writtenBytes.end(), buffer, buffer + size);
+        writeCalls++;
+        return size;
+    }
 };
 
 inline MockSerial& serial_global_instance() {
@@ -1,10 +1,14 @@
 #ifndef SPI_MOCK_H
 #define SPI_MOCK_H
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
 
 /* ──────────────────────────────
    Simple Arduino‑style helpers
@@ -71,29 +75,96 @@ extern SPIClass SPI;           // declared; you can define in a test .cpp
 /* ──────────────────────────────
    SdFat / File mocks
    ──────────────────────────────*/
+/* Contents of every file written through the mocks, by path; clear between tests */
+inline std::map<std::string, std::vector<uint8_t>>& mockSdFiles() {
+    static std::map<std::string, std::vector<uint8_t>> files;
+    return files;
+}
+
+/* Virtual card time and write pattern, summed over all files; reset between tests */
+struct MockSdStats {
+    uint64_t elapsed_us = 0;
+    uint32_t writes = 0;
+    uint32_t unalignedWrites = 0;   // Offset or length not a whole number of 512-byte sectors
+    uint32_t syncs = 0;
+    uint32_t preAllocations = 0;
+    size_t   largestWrite_bytes = 0;
+};
+inline MockSdStats& mockSdStats() {
+    static MockSdStats stats;
+    return stats;
+}
+
+/* Typical SDHC latencies at 40 MHz SPI */
+constexpr uint32_t kMockSdCommand_us = 100;          // Per write call
+constexpr uint32_t kMockSdSector_us = 25;            // Per 512-byte sector (~20 MB/s)
+constexpr uint32_t kMockSdReadModifyWrite_us = 400;  // Partial sector: read it back first
+constexpr uint32_t kMockSdSync_us = 3000;            // Directory and FAT update
+constexpr uint32_t kMockSdPreAllocate_us = 15000;    // Cluster chain search
+constexpr uint32_t kMockSdOpen_us = 2000;
+
 struct File32 {
-    bool   open(const char*, int)          { return true; }
-    void   close()                         {}
-    bool   exists(const char*)             { return false; }
+    bool   open(const char* path, int)     {
+        contents_ = &mockSdFiles()[path];
+        position_ = 0;
+        mockSdStats().elapsed_us += kMockSdOpen_us;
+        return true;
+    }
+    void   close()                         { contents_ = nullptr; }
+    bool   exists(const char* path)        { return mockSdFiles().count(path) != 0U; }
 
     /* Arduino‑style file API */
-    int    write(const void*, size_t n)    { return static_cast<int>(n); }
-    void   sync()                          {}
+    int    write(const void* data, size_t n) {
+        MockSdStats& stats = mockSdStats();
+        stats.writes++;
+        stats.largestWrite_bytes = n > stats.largestWrite_bytes ? n : stats.largestWrite_bytes;
+        stats.elapsed_us += kMockSdCommand_us + kMockSdSector_us * ((n + 511U) / 512U);
+        if (position_ % 512U != 0U || n % 512U != 0U) {
+            stats.unalignedWrites++;
+            stats.elapsed_us += kMockSdReadModifyWrite_us;
+        }
+        if (contents_ != nullptr) {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            if (contents_->size() < position_ + n) {
+                contents_->resize(position_ + n);
+            }
+            std::copy(bytes, bytes + n, contents_->begin() + static_cast<std::ptrdiff_t>(position_));
+        }
+        position_ += n;
+        return static_cast<int>(n);
+    }
+    void   sync()                          { mockSdStats().syncs++; mockSdStats().elapsed_us += kMockSdSync_us; }
+    bool   seekSet(uint64_t position)      { position_ = static_cast<size_t>(position); return true; }
+    bool   truncate(uint64_t length)       {
+        if (contents_ != nullptr && contents_->size() > length) {
+            contents_->resize(static_cast<size_t>(length));
+        }
+        return true;
+    }
+    uint64_t curPosition() const           { return position_; }
 
     template<typename T> void print  (const T&) {}
     template<typename T> void println(const T&) {}
 
-    bool   preAllocate(uint32_t)           { return true; }
+    bool   preAllocate(uint64_t)           {
+        mockSdStats().preAllocations++;
+        mockSdStats().elapsed_us += kMockSdPreAllocate_us;
+        return true;
+    }
 
     /* truthiness test:  if(file) … */
     explicit operator bool() const         { return true; }
+
+    std::vector<uint8_t>* contents_ = nullptr;
+    size_t position_ = 0;
 };
 using SdFile_t = File32;
 
 struct SdFat {
     bool begin(uint8_t, int)               { return true; }
-    bool exists(const char*)               { return false; }
-    SdFile_t open(const char*, int)        { return SdFile_t(); }
+    bool exists(const char* path)          { return mockSdFiles().count(path) != 0U; }
+    SdFile_t open(const char* path, int mode) { SdFile_t file; file.open(path, mode); return file; }
+    bool remove(const char* path)          { return mockSdFiles().erase(path) != 0U; }
 };
 
 /* file‑open flags + helper macro */
@@ -0,0 +1,183 @@
+#ifndef BINARY_LOG_FORMAT_H
+#define BINARY_LOG_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/FlashDecoder.h"
+
+// Binary log format written by DataSaverBigSD in BigSDLogFormat::kBinary mode.
+// Shared with host tools, so it must not depend on ArduinoHAL.h.
+//
+// The file is a sequence of 512-byte blocks, one SD sector each:
+//   Header blocks   BinaryLogHeader_t, then the channel table and the flight
+//                   state table, zero padded to a whole number of blocks
+//   Data blocks     BinaryBlockHeader_t, then records, zero padded
+// Tables are a count byte followed by (value u8, length u8, name) entries.
+//
+// A record is name(u8) delta(u8) value(f32): delta is the milliseconds since
+// the previous record in the block (the first record counts from the block's
+// firstTimestamp_ms). A delta of kBinaryDeltaEscape is followed by the full
+// u32 timestamp, for gaps of 255 ms or more and for time going backwards.
+//
+// Since version 2 a record named kBinaryVectorRecord holds several values:
+// kBinaryVectorRecord(u8) delta(u8) [timestamp(u32)] label(u8) count(u8)
+// count x value(f32); value i belongs to channel label + i.
+//
+// Data block i starts at byte (headerBlocks + i) * 512 and carries its first
+// timestamp, so the fixed stride doubles as a seek index: binary search the
+// block headers (see BinaryLogDecoder::findBlock()).
+
+constexpr std::size_t kBinaryBlockSize_bytes = 512;
+constexpr std::array<char, 8> kBinaryLogMagic = {{'C', 'U', 'R', 'E', 'L', 'O', 'G', '1'}};
+constexpr uint16_t kBinaryLogVersion = 2;
+constexpr uint16_t kBinaryBlockMagic = 0xB10C;
+constexpr uint8_t kBinaryDeltaEscape = 0xFF;
+constexpr uint8_t kBinaryVectorRecord = 0xFE;  // Reserved channel name marking a vector record
+
+#pragma pack(push, 1)
+// NOLINTBEGIN(cppcoreguidelines-pro-type-member-init, hicpp-member-init)
+struct BinaryLogHeader_t {
+    std::array<char, 8> magic;
+    uint16_t version;
+    uint16_t blockSize_bytes;
+    uint16_t headerBlocks;     // Header blocks before the first data block
+};
+
+struct BinaryBlockHeader_t {
+    uint16_t magic;              // kBinaryBlockMagic
+    uint16_t recordCount;
+    uint32_t sequence;           // Data block index, from 0
+    uint32_t firstTimestamp_ms;
+    uint16_t payloadLength_bytes;
+    uint16_t crc16;              // CRC-16/CCITT of the header up to here and the payload
+};
+// NOLINTEND(cppcoreguidelines-pro-type-member-init, hicpp-member-init)
+#pragma pack(pop)
+
+constexpr std::size_t kBinaryBlockPayload_bytes = kBinaryBlockSize_bytes - sizeof(BinaryBlockHeader_t);
+constexpr std::size_t kBinaryRecordSize_bytes = 6;
+constexpr std::size_t kBinaryEscapedRecordSize_bytes = kBinaryRecordSize_bytes + 4;
+
+// Room for the channel and state tables with their current names
+constexpr std::size_t kBinaryLogHeaderCapacity_bytes = 2 * kBinaryBlockSize_bytes;
+
+/**
+ * @brief Build the header blocks: BinaryLogHeader_t plus the channel names
+ *        from DataNames.h and the FlightState names.
+ * @param out Output, kBinaryLogHeaderCapacity_bytes long.
+ * @return Length in bytes (a multiple of kBinaryBlockSize_bytes), or 0 if the
+ *         tables outgrew kBinaryLogHeaderCapacity_bytes.
+ */
+std::size_t encodeBinaryLogHeader(uint8_t* out);
+
+/**
+ * @brief Packs records into one data block at a time.
+ *
+ * @note When to use: on the logger, one instance per open file. Call
+ *       append() until it returns false, then finish() and write the block.
+ */
+class BinaryBlockWriter {
+public:
+    BinaryBlockWriter() { reset(); }
+
+    /**
+     * @brief Add one record to the current block.
+     * @return true if it fit; false if the block is full (nothing was added).
+     */
+    bool append(uint32_t timestamp_ms, uint8_t name, float value);
+
+    /**
+     * @brief Add one vector record: @p count values sharing a timestamp, on
+     *        channels name, name + 1, ...
+     * @return true if it fit; false if the block is full (nothing was added).
+     */
+    bool appendVector(uint32_t timestamp_ms, uint8_t name, const float* values, uint8_t count);
+
+    // True when no record was added since the last finish()
+    bool isEmpty() const { return finished_ || recordCount_ == 0U; }
+
+    /**
+     * @brief Fill in the block header; the next append() starts a new block.
+     * @return The finished kBinaryBlockSize_bytes block; valid until the next append().
+     */
+    const uint8_t* finish();
+
+    uint32_t getBlocksWritten() const { return sequence_; }
+
+private:
+    void reset();
+    // Reserve a record of @p bodySize bytes after its name and timestamp; nullptr if the block is full
+    uint8_t* beginRecord(uint32_t timestamp_ms, uint8_t name, std::size_t bodySize);
+
+    std::array<uint8_t, kBinaryBlockSize_bytes> block_ = {};
+    bool finished_ = false;
+    std::size_t length_ = 0;
+    uint16_t recordCount_ = 0;
+    uint32_t sequence_ = 0;
+    uint32_t firstTimestamp_ms_ = 0;
+    uint32_t lastTimestamp_ms_ = 0;
+};
+
+/**
+ * @brief Host-side reader for binary logs.
+ *
+ * Records come out through the same IRecordSink as FlashDecoder, so tools can
+ * write them with formatCsvLine() and get the exact bytes CSV mode would have
+ * written.
+ *
+ * @note When to use: post-flight, on the laptop (tools/bigsd_decoder).
+ */
+class BinaryLogDecoder {
+public:
+    explicit BinaryLogDecoder(IRecordSink& sink) : sink_(sink) {}
+
+    /**
+     * @brief Parse the header blocks at the start of a log.
+     * @return int 0 on success, -1 if the magic, version or tables are invalid.
+     */
+    int parseHeader(const uint8_t* data, std::size_t size_bytes);
+
+    /**
+     * @brief Decode one data block.
+     * @return int 0 when decoded, 1 for an unwritten block (no block magic),
+     *         -1 for a CRC or record error (the block is skipped).
+     */
+    int decodeBlock(const uint8_t* block);
+
+    /**
+     * @brief Decode every data block after the header.
+     * @return int 0 on success, -1 if the header is invalid.
+     */
+    int decodeLog(const uint8_t* data, std::size_t size_bytes);
+
+    /**
+     * @brief Binary search for the last data block starting at or before @p timestamp_ms.
+     * @return Byte offset of that block, or the first data block if all start later.
+     *         Requires parseHeader(); blocks must be in time order.
+     */
+    std::size_t findBlock(const uint8_t* data, std::size_t size_bytes, uint32_t timestamp_ms) const;
+
+    // Name of a channel or flight state from the header tables, or nullptr
+    const char* getChannelName(uint8_t name) const;
+    const char* getStateName(uint8_t state) const;
+
+    uint32_t getRecordCount() const { return records_; }
+    uint32_t getBlockCount() const { return blocks_; }
+    uint32_t getBadBlockCount() const { return badBlocks_; }
+
+private:
+    using NameTable = std::array<std::array<char, 32>, 256>;
+
+    IRecordSink& sink_;
+    uint16_t headerBlocks_ = 0;
+    NameTable channelNames_ = {};
+    std::array<std::array<char, 32>, 32> stateNames_ = {};
+
+    uint32_t records_ = 0;
+    uint32_t blocks_ = 0;
+    uint32_t badBlocks_ = 0;
+};
+
+#endif // BINARY_LOG_FORMAT_H
@@ -122,6 +122,44 @@ class CircularArray {
         return maxSize;
     }
 
+    uint8_t getSize(){
+        return currentSize;
+    }
+
+    // Window statistics over the stored elements; T() when empty
+    T getMean(){
+        if (currentSize == 0) {
+            return T();
+        }
+        T sum = T();
+        for (uint8_t i = 0; i < currentSize; ++i) {
+            sum += getFromHead(i);
+        }
+        return sum / static_cast<T>(currentSize);
+    }
+
+    T getMin(){
+        if (currentSize == 0) {
+            return T();
+        }
+        T minValue = getFromHead(0);
+        for (uint8_t i = 1; i < currentSize; ++i) {
+            minValue = std::min(minValue, getFromHead(i));
+        }
+        return minValue;
+    }
+
+    T getMax(){
+        if (currentSize == 0) {
+            return T();
+        }
+        T maxValue = getFromHead(0);
+        for (uint8_t i = 1; i < currentSize; ++i) {
+            maxValue = std::max(maxValue, getFromHead(i));
+        }
+        return maxValue;
+    }
+
     T getMedian(){
         if (currentSize == 0) {
         // Handle the case when the array is empty
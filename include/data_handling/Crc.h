@@ -0,0 +1,26 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection).
+ * @param data Bytes to checksum.
+ * @param length Number of bytes.
+ * @param crc Running value; pass the previous result to checksum a buffer in pieces.
+ * @note When to use: short integrity checks such as flash page headers.
+ */
+uint16_t crc16Ccitt(const uint8_t* data, std::size_t length, uint16_t crc = 0xFFFFU);
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as used by zlib and Python's binascii.crc32).
+ * @param data Bytes to checksum.
+ * @param length Number of bytes.
+ * @param crc Running value; pass the previous result to checksum a buffer in pieces.
+ * @note When to use: whole-page checks on links where a 16-bit CRC is too weak,
+ *       e.g. flash dumps over serial.
+ */
+uint32_t crc32(const uint8_t* data, std::size_t length, uint32_t crc = 0U);
+
+#endif // CRC_H
@@ -0,0 +1,41 @@
+#ifndef CSV_FORMAT_H
+#define CSV_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Longest "%.6f" of a float: sign, 39 integer digits, point, 6 decimals
+constexpr std::size_t kMaxFixed6Length_bytes = 47;
+
+// Longest "timestamp,name,value\n" line
+constexpr std::size_t kMaxCsvLineLength_bytes = 10 + 1 + 3 + 1 + kMaxFixed6Length_bytes + 1;
+
+/**
+ * @brief Write @p value in decimal, like printf("%u").
+ * @param out Output, at least 10 bytes. Not null terminated.
+ * @return Number of characters written.
+ */
+std::size_t formatUnsigned(uint32_t value, char* out);
+
+/**
+ * @brief Write @p value like printf("%.6f", (double)value), byte for byte.
+ *
+ * The float is converted exactly and rounded half to even at the sixth
+ * decimal, as glibc and newlib do, without printf or floating-point math.
+ * Infinities and NaN print as "inf" and "nan" with their sign.
+ * @param out Output, at least kMaxFixed6Length_bytes. Not null terminated.
+ * @return Number of characters written.
+ */
+std::size_t formatFixed6(float value, char* out);
+
+/**
+ * @brief Write one "timestamp,name,value\n" CSV line, identical to
+ *        printf("%lu,%u,%.6f\n", ...).
+ * @param out Output, at least kMaxCsvLineLength_bytes. Not null terminated.
+ * @return Number of characters written.
+ * @note When to use: per-sample text logging (DataSaverBigSD), where
+ *       varargs float formatting dominates the cost of a save.
+ */
+std::size_t formatCsvLine(uint32_t timestamp_ms, uint8_t name, float value, char* out);
+
+#endif // CSV_FORMAT_H
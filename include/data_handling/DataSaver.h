@@ -2,8 +2,20 @@
 #define DATA_SAVER_H
 
 #include "data_handling/DataPoint.h"
+#include "data_handling/DataVector.h"
+#include <cstddef>
 #include <cstdint>
 
+/**
+ * @brief A data point with the channel it belongs to, for batched saves.
+ * @note When to use: collect samples (e.g. drained from a sensor FIFO or a
+ *       queue) and pass them to IDataSaver::saveDataPoints() in one call.
+ */
+struct NamedDataPoint {
+    uint8_t name;
+    DataPoint dataPoint;
+};
+
  
 /**
  * @brief Abstract interface for persisting timestamped data points.
@@ -36,6 +48,50 @@ class IDataSaver {
             return saveDataPoint(DataPoint(timestamp_ms, data), name);
         }
 
+        /**
+         * @brief Persist several data points in order.
+         *
+         * The default calls saveDataPoint() for each point. Savers override it
+         * to check their state once and copy or format the whole batch in bulk.
+         * @param points Points to store, in the order they should be written.
+         * @param count  Number of points.
+         * @return 0 when every point was saved, otherwise the first non-zero
+         *         saveDataPoint() result; the points after it are not saved.
+         * @note When to use: batched ingestion, e.g. a sensor FIFO drained
+         *       once per loop, where per-sample calls dominate the cost.
+         */
+        virtual int saveDataPoints(const NamedDataPoint* points, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                const int result = saveDataPoint(points[i].dataPoint, points[i].name);
+                if (result != 0) {
+                    return result;
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Persist a multi-value sample under one label.
+         *
+         * The default saves component i as a DataPoint on channel name + i.
+         * Savers override it to store the sample as one record.
+         * @param vector Components and their shared timestamp.
+         * @param name   Channel of the first component, e.g. ACCELEROMETER_X.
+         * @return 0 when every component was saved, otherwise the first
+         *         non-zero saveDataPoint() result.
+         * @note When to use: IMU and magnetometer triplets, instead of one
+         *       saveDataPoint() call per axis.
+         */
+        virtual int saveDataVector(const DataVector& vector, uint8_t name) {
+            for (uint8_t i = 0; i < vector.size; i++) {
+                const int result = saveDataPoint(vector.at(i), static_cast<uint8_t>(name + i));
+                if (result != 0) {
+                    return result;
+                }
+            }
+            return 0;
+        }
+
         /**
          * @brief Optional hook for initialization.
          * @note When to use: override if the saver needs hardware/filesystem
@@ -56,6 +112,17 @@ class IDataSaver {
             (void)launchTimestamp_ms;
         }
 
+        /**
+         * @brief Notification that the rocket has landed.
+         * @param landingTimestamp_ms Timestamp of landing, in milliseconds.
+         * @note When to use: override to bound or slow down logging during the
+         *       recovery wait (e.g., cap the landed data written to flash).
+         */
+        virtual void landingDetected(uint32_t landingTimestamp_ms){
+            // Default implementation does nothing
+            (void)landingTimestamp_ms;
+        }
+
         // default method that does nothing, can be overridden
         virtual void clearPostLaunchMode(){
             // default implementation does nothing
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "ArduinoHAL.h"
+#include "data_handling/BinaryLogFormat.h"
 #include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
 
@@ -21,13 +22,39 @@ enum BigSDDataSaverError {
     DS_FLUSH_FAILED = -5       // Failed to flush buffer to file
 };
 
+enum class BigSDLogFormat : uint8_t {
+    kCsv,    // "timestamp,name,value" text lines in /stream-<n>.csv
+    kBinary  // 512-byte blocks of delta-timestamped records in /stream-<n>.bin, see BinaryLogFormat.h
+};
+
 /**
- * @brief Buffered CSV writer targeting large SD cards via SdFat.
+ * @brief Buffered CSV or binary writer targeting large SD cards via SdFat.
+ *
+ * Lines and blocks go into an 8 KiB ring. Saves only write whole,
+ * sector-aligned chunks of up to kWriteChunk_bytes. The one exception is the
+ * sync point: every kSyncInterval_ms the partly filled last sector is written
+ * and then rewritten once it fills, which costs the card a read-modify-write.
+ * The log is split into pre-allocated segments of up to 4 MiB,
+ * /stream-<n>.csv then /stream-<n>-1.csv, ... (same for .bin); concatenate
+ * them in order to get the whole log. CSV segments end on a line boundary,
+ * and tools/bigsd_decoder finds and decodes the later .bin segments itself.
+ * The next segment is created and pre-allocated from service() before the
+ * current one fills.
+ *
  * @note When to use: high-volume logging to removable media where batched
  *       writes and periodic syncs reduce wear and latency.
  */
 class DataSaverBigSD : public IDataSaver {
 public:
+    // One SD sector
+    static constexpr uint16_t kSectorSize_bytes = 512;
+    // Largest single write: 8 sectors, enough to keep the card in its fast multi-block mode
+    static constexpr uint16_t kWriteChunk_bytes = 4096;
+    static constexpr uint16_t kRingSize_bytes = 2 * kWriteChunk_bytes;
+    static constexpr uint32_t kSegmentSize_bytes = kPreAllocateSize_MiB * kBytesPerMiB_bytes;
+    // service() prepares the next segment once the current one is this close to full
+    static constexpr uint32_t kSegmentHeadroom_bytes = 512U * 1024U;
+
     explicit DataSaverBigSD(uint8_t csPin = 5);
 
     /**
@@ -37,41 +64,129 @@ public:
     bool begin();
 
     /**
-     * @brief Buffer a CSV line (timestamp,name,value) and flush in batches.
+     * @brief Choose the file format. Takes effect at the next begin().
+     *
+     * Binary records take 6 bytes instead of ~25 for a CSV line and skip
+     * float formatting; tools/bigsd_decoder turns a binary log back into the
+     * exact CSV text. Defaults to BigSDLogFormat::kCsv.
+     * @note When to use: high sample rates where CSV would saturate the card or the CPU.
+     */
+    void setFormat(BigSDLogFormat format) { format_ = format; }
+
+    BigSDLogFormat getFormat() const { return format_; }
+
+    /**
+     * @brief Buffer a CSV line (timestamp,name,value) or binary record.
+     *
+     * Issues at most one write of kWriteChunk_bytes, and only once a whole
+     * chunk is buffered. Syncs and segment changes wait for service(), unless
+     * service() has never been called.
      * @param dataPoint Timestamped value to log.
      * @param name      8-bit channel identifier written in the CSV line.
      * @note When to use: routine logging path once begin() succeeds.
      */
     int  saveDataPoint(const DataPoint& dataPoint, uint8_t name) override;
 
+    /**
+     * @brief Buffer several points; the same records as calling
+     *        saveDataPoint() for each.
+     *
+     * Reads the clock and does the housekeeping once per batch. Whole chunks
+     * are written as they fill, so a long batch issues one write per chunk.
+     */
+    int  saveDataPoints(const NamedDataPoint* points, size_t count) override;
+
+    /**
+     * @brief Buffer a multi-value sample. In binary mode it is one vector
+     *        record (16 bytes for a triplet instead of 18); CSV mode writes
+     *        one line per channel, as separate saves would.
+     */
+    int  saveDataVector(const DataVector& vector, uint8_t name) override;
+
+    /**
+     * @brief Housekeeping for the quiet part of the loop. It writes whole
+     *        sectors that are older than kFlushMs, syncs every
+     *        kSyncInterval_ms and pre-allocates the next segment.
+     * @return DS_SUCCESS, or DS_FLUSH_FAILED if a write failed.
+     * @note When to use: once per loop after the time-critical work, e.g.
+     *       after sensors are read and telemetry is sent. If the application
+     *       never calls it, saveDataPoint() does this work itself.
+     */
+    int service();
+
     /**
      * @brief Flush pending bytes and close the file.
      * @note When to use: before power-off or media removal to avoid loss.
      */
     void end();
 
+    // Longest single file write issued from saveDataPoint(), in bytes
+    uint32_t getLargestSaveWrite() const { return largestSaveWrite_bytes_; }
+
+    // Index of the segment being written (0 is /stream-<n>.csv)
+    uint16_t getSegment() const { return segment_; }
+
 private:
-    static std::string nextFreeFilePath();                    // /stream‑<n>.csv
+    using SdFile_t = File32;
+
+    static std::string nextFreeFilePath(const char* extension);   // /stream‑<n><extension>
+
+    // Copy bytes into the ring; false if there is no room
+    bool pushToRing(const uint8_t* data, size_t length);
+    int saveCsv(const DataPoint& dataPoint, uint8_t name);
+    int saveBinary(const DataPoint& dataPoint, uint8_t name, uint32_t now);
+    // Format one point into the ring and write a chunk if one is full
+    int bufferDataPoint(const DataPoint& dataPoint, uint8_t name, uint32_t now);
+    // Write one chunk if a whole one is buffered
+    int writeFullChunk();
+
+    // Write up to maxBytes of whole buffered sectors from the ring
+    int writeSectors(uint32_t maxBytes);
+    // Write the partly filled last sector in place; it is rewritten once full
+    int writeTail();
+    // Ring room for @p length bytes, writing a chunk to make some if needed
+    bool makeRoom(size_t length);
+    bool pushBinaryBlock();
+    int housekeeping(uint32_t now);
+    std::string segmentPath(uint16_t segment) const;
+    bool openSegment(SdFile_t& file, uint16_t segment);
+    bool prepareNextSegment();
+    bool switchSegment();
+    // Drop a cut-off CSV line from the end of the active segment, then sync and close it
+    void closeActiveSegment();
 
     uint8_t csPin_;
     bool ready_ {false};
 
     /* single shared SdFat instance */
     static SdFat sd_;
-    using SdFile_t = File32;
 
-    SdFile_t file_;
     std::string filePath_;
 
     /* buffering parameters */
-    static constexpr uint16_t kBufSize_bytes = 512;   // one SD sector
-    static constexpr uint16_t kFlushLines = 64;    // flush after N lines
-    static constexpr uint32_t kFlushMs    = 200;   // or after 200 ms
-
-    /* buffering state */
-    char buf_[kBufSize_bytes] = {};
-    uint16_t bufLen_ = 0;
-    uint16_t linesPending_ = 0;
+    static constexpr uint32_t kFlushMs    = 200;   // write buffered sectors after 200 ms
+
+    /* ring state; positions count bytes since begin() */
+    uint8_t ring_[kRingSize_bytes] = {};
+    uint32_t ringHead_ = 0;         // Bytes appended
+    uint32_t ringTail_ = 0;         // Bytes written to the card
     uint32_t lastFlushMs_ = 0;
     uint32_t lastSyncMs_ = 0;
+    bool serviced_ = false;         // service() has been called since begin()
+    uint32_t largestSaveWrite_bytes_ = 0;
+
+    /* segments: files_[active_] is being written, the other is the next one once prepared */
+    SdFile_t files_[2];
+    uint8_t active_ = 0;
+    std::string basePath_;          // Path without the extension
+    const char* extension_ = ".csv";
+    uint16_t segment_ = 0;
+    uint32_t segmentWritten_bytes_ = 0;  // Whole sectors written to the active segment
+    uint32_t segmentCut_bytes_ = 0;      // Start of a line at the end of a full CSV segment, rewritten in the next one
+    bool nextSegmentReady_ = false;
+
+    /* binary mode */
+    BigSDLogFormat format_ = BigSDLogFormat::kCsv;
+    BinaryBlockWriter block_;
+    uint32_t blockStartMs_ = 0;    // When the current block got its first record
 };
@@ -7,9 +7,16 @@
 #include "ArduinoHAL.h"
 #include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
+#include "data_handling/SerialFrameFormat.h"
+
+enum class SerialLogFormat : uint8_t {
+    kRecords,  // One 12-byte record per sample, "\0\r\n" delimited
+    kBatched   // COBS frames of up to 40 samples with a CRC, see SerialFrameFormat.h
+};
 
 /**
- * @brief IDataSaver implementation that streams CSV packets over UART.
+ * @brief IDataSaver implementation that streams binary records over UART,
+ *        one per sample or batched into framed packets.
  * @note When to use: log data to an external serial data logger when file
  *       systems (SD/SPI flash) are unavailable or you need live passthrough.
  */
@@ -35,8 +42,39 @@ class DataSaverSDSerial: public IDataSaver {
          */
         virtual int saveDataPoint(const DataPoint& dataPoint, uint8_t name) override;
 
+        /**
+         * @brief Send several points; the same bytes as calling saveDataPoint()
+         *        for each, but records go out up to 21 per write() call.
+         */
+        int saveDataPoints(const NamedDataPoint* points, size_t count) override;
+
+        /**
+         * @brief Choose the wire format. Defaults to SerialLogFormat::kRecords,
+         *        which existing loggers and decoders expect.
+         *
+         * Batched frames take about 6.3 bytes per sample instead of 12 and go
+         * out in one write per frame. Each frame carries a CRC and a sequence
+         * number, so corruption and lost frames are detected rather than
+         * misaligning the records that follow. Switching flushes the current frame.
+         * @note When to use: high sample rates, where the per-sample delimiter
+         *       and write call limit the logger's bandwidth.
+         */
+        void setFormat(SerialLogFormat format);
+
+        SerialLogFormat getFormat() const { return format_; }
+
+        /**
+         * @brief Send the frame being filled, if any. A frame otherwise goes
+         *        out once it is full or a sample falls outside its 255 ms range.
+         * @note When to use: before a pause in logging (e.g. after landing) so
+         *       the last samples are not held back.
+         */
+        void flush();
+
     private:
         HardwareSerial &sdSerial_;
+        SerialLogFormat format_ = SerialLogFormat::kRecords;
+        SerialFrameWriter frame_;
 
 };
 
@@ -4,34 +4,15 @@
 #include "ArduinoHAL.h"
 #include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
+#include "data_handling/FlashDumpProtocol.h"
+#include "data_handling/FlashFormat.h"
+#include "data_handling/FloatCompression.h"
 #include <array>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 
-
-constexpr uint32_t kMetadataStartAddress = 0x000000;  // Start writing metadata at the beginning of flash
-constexpr uint32_t kDataStartAddress = 0x001000;  // Start writing data after 1 sector (4kB) of metadata
-constexpr uint32_t kPostLaunchFlagAddress = 0x000000;  // Address of the post-launch flag
-constexpr uint32_t kLaunchStartAddressAddress = 0x000001;  // Address of the launch start address (32 bits)
-
-constexpr uint8_t kPostLaunchFlagTrue = 0x00; // Flag to indicate post-launch mode is active
-constexpr uint8_t kPostLaunchFlagFalse = 0x01; // Flag to indicate post-launch mode is not active
-
-constexpr uint8_t kEmptyPageValue = 0xFF;
-
-
-#pragma pack(push, 1)  // Pack the struct to avoid padding between the name and datas
-typedef struct { // NOLINT(altera-struct-pack-align)
-    uint8_t name;
-    float data;
-} Record_t; 
-
-typedef struct { // NOLINT(altera-struct-pack-align)
-    uint8_t name;
-    uint32_t timestamp_ms;
-} TimestampRecord_t;
-#pragma pack(pop)  // Stop packing from here on out
-
 /**
  * @brief SPI flash implementation of IDataSaver with timestamp compression.
  * @note When to use: onboard non-volatile logging where SD cards are
@@ -42,6 +23,18 @@ public:
 
     static constexpr size_t kBufferSize_bytes = 256;
 
+    // Pre-launch data launchDetected() protects by default
+    static constexpr uint32_t kDefaultPreLaunchHistory_ms = 60000;
+
+    // Most recent sectors whose first timestamp is kept for the launch rollback (6 bytes each)
+    static constexpr size_t kSectorIndexEntries = 128;
+
+    // Directory slots in the flight directory sector
+    static constexpr uint32_t kMaxFlightEntries = 4096U / sizeof(FlightEntry_t);
+
+    // Flash written after landing before further writes are refused (64 pages)
+    static constexpr uint32_t kDefaultLandedDataBudget_bytes = 16384;
+
     /**
      * @brief Construct a new DataSaverSPI object
      * 
@@ -66,6 +59,30 @@ public:
      */
     int saveDataPoint(const DataPoint& dataPoint, uint8_t name) override;
 
+    /**
+     * @brief Saves several data points; same flash contents as calling
+     *        saveDataPoint() for each.
+     *
+     * The write-blocking state is checked once and again only after a page
+     * flush, and uncompressed records are copied straight into the page
+     * buffer while they fit.
+     * @return int 0 on success, 1 when writes are blocked by post-launch state,
+     *         and -1 on write/buffer error; the points after it are not saved.
+     */
+    int saveDataPoints(const NamedDataPoint* points, size_t count) override;
+
+    /**
+     * @brief Saves a multi-value sample for channels name, name + 1, ...
+     *        behind at most one timestamp record.
+     *
+     * Raw pages get one vector record (see kVectorRecordName), 14 bytes for a
+     * triplet instead of 15. Compressed pages predict each channel on its
+     * own, so there the components are saved as separate records.
+     * @return int 0 on success, 1 when writes are blocked by post-launch state,
+     *         and -1 on write/buffer error.
+     */
+    int saveDataVector(const DataVector& vector, uint8_t name) override;
+
     /**
      * @brief Persist a bare timestamp entry to flash.
      * @param timestamp_ms Timestamp in milliseconds to record.
@@ -78,9 +95,15 @@ public:
 
     /**
      * @brief Initialize the flash chip and metadata.
+     *
+     * With page headers enabled, also binary-searches the ring for the write
+     * head (O(log pages) page reads) and resumes logging after it. A chip in
+     * post-launch mode keeps its launch protection and continues logging
+     * until the protected data would be overwritten.
      * @note When to use: call during setup before any saveDataPoint usage.
      * @return true when flash is initialized and writable for logging.
-     * @return false when initialization fails or chip is already in post-launch mode.
+     * @return false when initialization fails or, without page headers, the
+     *         chip is already in post-launch mode.
      */
     virtual bool begin() override;
 
@@ -117,8 +140,11 @@ public:
      * not overwritten
      * 
      * Data is saved in a circular fashion but once the address where the launch detected
-     * is reached this will stop saving data entirely. Also keeps 1 minute of data from before
-     * the launch was detected (b/c launch can be detected late and we have extra room)
+     * is reached this will stop saving data entirely. Also keeps setPreLaunchHistory()
+     * (1 minute by default) of data from before the launch was detected (b/c launch can
+     * be detected late and we have extra room). The protected address is the start of
+     * the sector that was being written at launch time minus the history, found in a
+     * RAM index of each sector's first timestamp, so at most one extra sector is kept.
      * 
      * The rocket may not be recovered for several hours, this prevents the cool launch data
      * from being overwitten with boring laying-on-the-ground data.
@@ -126,15 +152,200 @@ public:
      */
     void launchDetected(uint32_t launchTimestamp_ms);
 
+    /**
+     * @brief Set how much data from before launch launchDetected() protects.
+     *
+     * Bounded by the sector index: at most kSectorIndexEntries sectors
+     * (512 KB, about 2.5 minutes at the rates in docs/FlashDataSaving.md).
+     */
+    void setPreLaunchHistory(uint32_t history_ms) { preLaunchHistory_ms_ = history_ms; }
+
+    /**
+     * @brief Call this when landing is detected to bound the data written
+     *        while waiting for recovery.
+     *
+     * Once the landed budget (see setLandedDataBudget) has been flushed to
+     * flash, saveDataPoint() writes out any partly filled page, then refuses
+     * further writes and returns 1. This keeps
+     * hours on the ground from wearing the chip or cycling it back to the
+     * launch-protected address. Cleared by clearPostLaunchMode() and
+     * clearInternalState().
+     * @param landingTimestamp_ms Timestamp at which landing was detected.
+     */
+    void landingDetected(uint32_t landingTimestamp_ms) override;
+
+    /**
+     * @brief Set how many bytes may be written after landingDetected(); rounded
+     *        down to whole pages. 0 stops logging as soon as landing is detected.
+     */
+    void setLandedDataBudget(uint32_t budget_bytes) { landedDataBudget_bytes_ = budget_bytes; }
+
+    /**
+     * @brief Returns whether writes have stopped because the landed budget is used up.
+     */
+    bool isLandedBudgetExhausted() const {
+        return landed_ && static_cast<uint64_t>(bufferFlushes_ - landedStartFlushes_) * kBufferSize_bytes +
+                                  kBufferSize_bytes > landedDataBudget_bytes_;
+    }
+
+    /**
+     * @brief Switch between raw Byte5 pages and compressed pages.
+     *
+     * Compressed pages use FloatCompressor (per-channel XOR-delta floats,
+     * delta timestamps, predicted names) and start with kCompressedPageMarker,
+     * so both formats can coexist on the chip. Any partially filled page is
+     * flushed in the old format first.
+     * @param compressor Encoder state, about 1.9 KB (non-owning, one per saver,
+     *        must outlive its use). nullptr, the default, writes raw pages, so
+     *        builds that never compress do not pay for it.
+     * @note When to use: before logging starts, to fit more flight time on
+     *       the chip at the cost of a host-side decode step.
+     */
+    void setCompressor(FloatCompressor* compressor);
+
+    bool isCompressionEnabled() const { return compressor_ != nullptr; }
+
+    /**
+     * @brief Start every page with a PageHeader_t (sequence number, first
+     *        timestamp and CRC).
+     *
+     * Headers cost 11 bytes per page (49 instead of 51 Byte5 records) but let
+     * begin() find the write head after a reboot and resume logging right
+     * after the last flight instead of at kDataStartAddress. dumpData() then
+     * streams pages oldest first and skips erased ones. Any partially filled
+     * page is flushed in the old format first. Off by default.
+     * @param enabled true to write page headers.
+     * @note When to use: always on flight hardware, where a brownout must not
+     *       cost the flight data. Enable before begin().
+     */
+    void setPageHeadersEnabled(bool enabled);
+
+    bool isPageHeadersEnabled() const { return pageHeaders_; }
+
+    // Sequence number the next written page will carry
+    uint32_t getNextPageSequence() const { return pageSequence_; }
+
+    // Page headers read by the last write head search in begin()
+    uint32_t getHeadSearchReads() const { return headSearchReads_; }
+
+    /**
+     * @brief Hand full pages to a background context instead of writing them
+     *        from inside saveDataPoint().
+     *
+     * With background flushing on, a full page is swapped for the second
+     * page buffer and left pending until serviceFlush() writes it (including
+     * any sector erase). saveDataPoint() only touches the chip when both
+     * buffers are full; each such wait is counted in getFlushOverruns().
+     * Turning it off waits for the pending page first. Off by default.
+     * @param enabled true to defer page writes to serviceFlush().
+     * @note When to use: when sector erases (tens of ms) must not stall the
+     *       flight loop and something else can call serviceFlush(), e.g. a
+     *       flash DMA completion, the second core, or a thread on native.
+     */
+    void setBackgroundFlush(bool enabled);
+
+    bool isBackgroundFlush() const { return backgroundFlush_; }
+
+    /**
+     * @brief Write the pending page, if any. Safe to call from a context other
+     *        than the one calling saveDataPoint().
+     * @return int 0 when a page was written, 1 when nothing was pending or
+     *         another context is using the flash, -1 when the write failed
+     *         (the page is dropped and counted in getFlushErrors()).
+     */
+    int serviceFlush();
+
+    bool hasPendingFlush() const { return pagePending_.load(std::memory_order_acquire); }
+
+    // Times saveDataPoint() had to wait for the chip because both buffers were full
+    uint32_t getFlushOverruns() const { return flushOverruns_; }
+
+    // Pending pages that serviceFlush() failed to write
+    uint32_t getFlushErrors() const { return flushErrors_.load(std::memory_order_relaxed); }
+
     /**
      * @brief Stream all recorded data to a serial connection.
      * @param serial            Output stream.
      * @param ignoreEmptyPages  Skip pages that appear unwritten.
+     *
+     * Raw pages are sent as 'lsh' followed by 51 records. Compressed pages
+     * are sent as 'lsc' followed by all 256 page bytes; decode them with
+     * FloatCompressor::decodePage(). Pages with a PageHeader_t are sent as
+     * 'lsp' followed by all 256 page bytes, oldest page first, and erased
+     * pages are always skipped.
      * @note When to use: post-flight data retrieval before erasing or
      *       redeploying the flash chip.
      */
     void dumpData(Stream &serial, bool ignoreEmptyPages);
 
+    /**
+     * @brief Stream the data region with the sliding-window protocol in
+     *        FlashDumpProtocol.h instead of waiting for an 'n' after every page.
+     *
+     * Up to kDumpWindow_pages frames are in flight at once. Each page carries
+     * its index and a CRC32, the host acks cumulatively and NAKs missing
+     * pages, and only those pages are resent. Erased pages are sent as
+     * 10-byte frames. Pages are sent in address order from @p startPage to
+     * the end of the chip, so the link runs at about 96% of its raw rate
+     * regardless of round-trip latency.
+     * @param serial    Link to a host running DumpReceiver.
+     * @param startPage First page to send: 0 for a full dump, or the
+     *                  receiver's getNextPage() to resume an interrupted one.
+     * @param endPage   One past the last page to send; clamped to one lap of
+     *                  the ring. Pages past the end of the chip wrap to the
+     *                  start of the data region. Defaults to the end of the chip.
+     * @return int 0 when the host confirmed every page, -1 on a flash read
+     *         error or after kDumpAbortTimeout_ms without progress.
+     * @note When to use: post-flight retrieval of a whole chip; dumpData()
+     *       remains for the existing ground tools.
+     */
+    int dumpDataWindowed(Stream &serial, uint32_t startPage = 0,
+                         uint32_t endPage = std::numeric_limits<uint32_t>::max());
+
+    // Number of flights in the directory, oldest first
+    uint32_t getFlightCount();
+
+    /**
+     * @brief Read a flight from the directory.
+     *
+     * launchDetected() appends an entry with the launch-protected start
+     * address. The end address is programmed into the same entry when the
+     * landed budget runs out, launch protection stops writes, or
+     * clearPostLaunchMode() is called. The directory lives in its own sector,
+     * so clearing the post-launch flag keeps it; it is only erased when all
+     * kMaxFlightEntries slots are used.
+     * @param index 0 for the oldest flight, up to getFlightCount() - 1.
+     * @return true and fills @p entry when the flight exists.
+     */
+    bool getFlight(uint32_t index, FlightEntry_t& entry);
+
+    // Look a flight up by its id; false when it is not in the directory
+    bool findFlight(uint16_t flightId, FlightEntry_t& entry);
+
+    /**
+     * @brief Pages of a flight in dumpDataWindowed() numbering.
+     *
+     * A flight that wrapped around the chip gets an @p endPage past the last
+     * page. A flight that is still open ends at the write head, or covers the
+     * whole ring when the head is unknown (rebooted without page headers).
+     * @return false when the flight is not in the directory.
+     */
+    bool getFlightPages(uint16_t flightId, uint32_t& firstPage, uint32_t& endPage);
+
+    /**
+     * @brief Dump only one flight with the windowed protocol.
+     *
+     * The host constructs its DumpReceiver with the flight's first page, see
+     * printFlights(). Resume with dumpDataWindowed(serial, nextPage, endPage).
+     * @return int 0 on success, 1 when the flight is unknown, -1 as dumpDataWindowed().
+     * @note When to use: at the pad after recovery, to pull the last flight
+     *       in seconds instead of dumping the whole chip.
+     */
+    int dumpFlight(Stream &serial, uint16_t flightId);
+
+    // Print one line per flight: id, launch time, first page, end page, open/closed
+    void printFlights(Stream &serial);
+
     /**
      * @brief Reset in-memory pointers without erasing flash contents.
      * @note When to use: restart logging logic while preserving prior data on
@@ -225,6 +436,12 @@ private:
 
     bool postLaunchMode_;
 
+    // Landed data budget, see landingDetected(). Atomic like bufferFlushes_,
+    // which the background flush context updates while they are compared.
+    std::atomic<bool> landed_{false};
+    std::atomic<uint32_t> landedStartFlushes_{0};
+    uint32_t landedDataBudget_bytes_ = kDefaultLandedDataBudget_bytes;
+
 private:
     /**
      * @brief Helper to write a block of bytes to flash at the current
@@ -244,10 +461,22 @@ private:
      */
     bool readFromFlash(uint32_t& readAddress, uint8_t* buffer, size_t length);
 
-    // Write buffer to improve write performance
-    uint8_t buffer_[kBufferSize_bytes] = {};
+    // Ping-pong write buffers: buffer_ is filled while the other page may be
+    // pending for serviceFlush() in background mode
+    uint8_t pages_[2][kBufferSize_bytes] = {};
+    uint8_t* buffer_ = pages_[0];
     size_t bufferIndex_ = 0;
-    uint32_t bufferFlushes_ = 0; // Keep track of how many times the buffer has been flushed
+    std::atomic<uint32_t> bufferFlushes_{0}; // Keep track of how many times the buffer has been flushed
+
+    // Background flush state, see setBackgroundFlush()
+    bool backgroundFlush_ = false;
+    uint8_t* pendingPage_ = nullptr;
+    std::atomic<bool> pagePending_{false};
+    uint32_t flushOverruns_ = 0;
+    std::atomic<uint32_t> flushErrors_{0};
+
+    // Serializes flash access between the logging and background contexts
+    std::atomic_flag flashLock_ = ATOMIC_FLAG_INIT;
 
 public:
     /**
@@ -347,7 +576,8 @@ private:
     bool shouldStopForPostLaunchWindow();
 
     /**
-     * @brief Flushes the buffer to flash.
+     * @brief Flushes the buffer to flash, or hands it to serviceFlush() in
+     *        background mode.
      * 
      * Returns 0 on success
      * Returns 1 if the buffer is empty
@@ -355,12 +585,80 @@ private:
      */
     int flushBuffer();
 
+    /**
+     * @brief Writes one page at the next write address, handling wrap-around,
+     *        post-launch protection and sector erases. Caller holds flashLock_.
+     * @param page Page of kBufferSize_bytes to write.
+     * @return int 0 on success; -1 on error or when protection stops writing.
+     */
+    int writePage(uint8_t* page);
+
+    // Note the first timestamp of a freshly opened page and reserve its header if enabled
+    void openPage();
+
+    // Remember that @p sector starts with data from @p firstTimestamp_ms. Caller holds flashLock_.
+    void recordSectorStart(uint32_t sector, uint32_t firstTimestamp_ms);
+
+    // Refill the sector index from the page headers of the sectors behind the write head
+    void rebuildSectorIndex();
+
+    // Start of the sector holding data from preLaunchHistory_ms_ before launch. Caller holds flashLock_.
+    uint32_t computeLaunchWriteAddress() const;
+
+    /**
+     * @brief Reads the header of data page @p index and checks its CRC.
+     * @return true and sets @p sequence when the page carries a valid header.
+     */
+    bool readPageSequence(uint32_t index, uint32_t& sequence);
+
+    // Find the write head from the page headers and resume after it, see begin()
+    void recoverWriteHead();
+
+    // First byte of the payload: after the header when page headers are on
+    size_t payloadOffset() const { return pageHeaders_ ? sizeof(PageHeader_t) : 0U; }
+
+    // End of the record space on a raw page: dumpData() sends raw pages as
+    // whole 5-byte records, so the bytes past the last one stay unused
+    size_t payloadEnd() const {
+        return payloadOffset() + (kBufferSize_bytes - payloadOffset()) / sizeof(Record_t) * sizeof(Record_t);
+    }
+
+    /**
+     * @brief Checks that a record may be written now and writes the timestamp
+     *        record first if one is due.
+     * @return int 0 when the record may follow, otherwise the save's result.
+     */
+    int prepareRecord(uint32_t timestamp_ms);
+
+    /**
+     * @brief Reads data page @p page and writes it as a dump frame. Caller holds flashLock_.
+     * @param frame Scratch buffer of kDumpPageFrameSize_bytes.
+     * @return true when sent; false when the flash read failed.
+     */
+    bool sendDumpPage(Stream &serial, uint32_t page, uint8_t* frame);
+
+    // Read the flight directory into the counters below on first use. Caller holds flashLock_.
+    void loadFlightDirectory();
+
+    // Append an open entry for the flight that launchDetected() just protected. Caller holds flashLock_.
+    void openFlight();
+
+    // Program the end address of the open flight, if any. Caller holds flashLock_.
+    void closeFlight();
+
+    // Reads directory slot @p slot and checks its CRC. Caller holds flashLock_.
+    bool readFlightEntry(uint32_t slot, FlightEntry_t& entry);
+
+    // Service the pending page from this context, waiting if another context is writing it
+    void waitForPendingFlush();
+
     /**
      * @brief Adds data to the buffer
      * 
      * @param data   The data to add
      * @param length The length of the data
-     * @return int   0 on success; non-zero on error
+     * @return int   0 on success; 1 if the flush used up the landed budget
+     *               (nothing was added); -1 on error
      */
     int addDataToBuffer(const uint8_t* data, size_t length);
 
@@ -370,24 +668,78 @@ private:
     /**
      * @brief Adds a 5-byte record payload to the page buffer.
      * @param record Pointer to packed record bytes.
-     * @return int 0 on success; -1 on flush/buffer error.
+     * @return int 0 on success; 1 if refused by the landed budget; -1 on flush/buffer error.
      */
     int addRecordToBuffer(Record_t * record) {
+        if (compressor_ != nullptr) {
+            uint32_t bits = 0;
+            memcpy(&bits, &record->data, sizeof(bits));
+            return addCompressedRecord(record->name, bits);
+        }
         return addDataToBuffer(reinterpret_cast<const uint8_t*>(record), 5);
     }
 
     /**
      * @brief Adds a 5-byte timestamp record payload to the page buffer.
      * @param record Pointer to packed timestamp record bytes.
-     * @return int 0 on success; -1 on flush/buffer error.
+     * @return int 0 on success; 1 if refused by the landed budget; -1 on flush/buffer error.
      */
     int addRecordToBuffer(TimestampRecord_t * record) {
+        if (compressor_ != nullptr) {
+            return addCompressedRecord(record->name, record->timestamp_ms);
+        }
         return addDataToBuffer(reinterpret_cast<const uint8_t*>(record), 5);
     }
 
+    /**
+     * @brief Encodes a record into the compressed page, flushing and opening
+     *        a new page when it does not fit.
+     * @param name Data name.
+     * @param valueBits Raw float bits, or the timestamp for TIMESTAMP.
+     * @return int 0 on success; 1 if refused by the landed budget; -1 on flush/buffer error.
+     */
+    int addCompressedRecord(uint8_t name, uint32_t valueBits);
+
+    /**
+     * @brief Write out the records accepted before the landed budget ran out
+     *        and close the flight.
+     * @return 1, the result for a save refused by the budget.
+     */
+    int stopForLandedBudget();
+
+    // Forget the compressor's open page, if compressing
+    void closeCompressedPage() {
+        if (compressor_ != nullptr) {
+            compressor_->closePage();
+        }
+    }
+
+    // Pre-launch rollback index, see launchDetected(). A ring of the most
+    // recent sectors and the timestamp in effect when their first page opened.
+    std::array<uint16_t, kSectorIndexEntries> indexSector_ = {};
+    std::array<uint32_t, kSectorIndexEntries> indexFirstTimestamp_ms_ = {};
+    size_t indexNext_ = 0;
+    size_t indexCount_ = 0;
+    std::array<uint32_t, 2> pageFirstTimestamp_ms_ = {};  // Per entry of pages_
+    uint32_t preLaunchHistory_ms_ = kDefaultPreLaunchHistory_ms;
+
+    // Flight directory, see getFlight()
+    bool flightDirectoryLoaded_ = false;
+    uint32_t flightSlotsUsed_ = 0;  // Slots written, including torn ones
+    uint16_t lastFlightId_ = 0;
+    bool flightOpen_ = false;       // The entry in the last used slot is ours to close
+
+    // Page headers, see setPageHeadersEnabled()
+    bool pageHeaders_ = false;
+    uint32_t pageSequence_ = 0;
+    uint32_t headSearchReads_ = 0;
+
+    // Compressed page format, see setCompressor()
+    FloatCompressor* compressor_ = nullptr;
+
     // The chip will keep overwriting data forever unless post launch data is being protected.
     // Once it wraps back around to the launch write address, it will stop writing data.
-    bool isChipFullDueToPostLaunchProtection_;
+    std::atomic<bool> isChipFullDueToPostLaunchProtection_;
 
     // If the flight computer boots and is already in post launch mode, do not write to flash.
     // Calling clearPostLaunchMode() will allow writing to flash again after a reboot.
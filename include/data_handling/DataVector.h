@@ -0,0 +1,58 @@
+#ifndef DATAVECTOR_H
+#define DATAVECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/DataPoint.h"
+
+// Most components a DataVector can hold: an X/Y/Z triplet, the widest group
+// of consecutive channels in DataNames.h
+constexpr std::size_t kMaxDataVectorSize = 3;
+
+/**
+ * @brief Several floats sampled together, with one timestamp.
+ *
+ * Saved under one label: component i belongs to channel label + i, which is
+ * how DataNames.h lays out the X, Y and Z channels of each sensor.
+ * @note When to use: accelerometer, gyroscope and magnetometer triplets and
+ *       other values that are always read together, so they are handled and
+ *       stored as one sample rather than one DataPoint per axis.
+ */
+class DataVector {
+public:
+    uint32_t timestamp_ms;
+    uint8_t size;  // Components in use, at most kMaxDataVectorSize
+    std::array<float, kMaxDataVectorSize> data;
+
+    /**
+     * @brief Default construct an empty vector.
+     */
+    DataVector()
+    : timestamp_ms(0UL), size(0U), data{{0.0F, 0.0F, 0.0F}} {}
+
+    /**
+     * @brief Construct an X/Y/Z triplet.
+     * @note When to use: the three axes of an IMU or magnetometer reading.
+     */
+    DataVector(uint32_t timestamp_ms_in, float x, float y, float z)
+    : timestamp_ms(timestamp_ms_in), size(3U), data{{x, y, z}} {}
+
+    /**
+     * @brief Construct from @p count values; components past kMaxDataVectorSize are dropped.
+     */
+    DataVector(uint32_t timestamp_ms_in, const float* values, std::size_t count)
+    : timestamp_ms(timestamp_ms_in), size(0U), data{{0.0F, 0.0F, 0.0F}} {
+        for (; size < count && size < kMaxDataVectorSize; size++) {
+            data[size] = values[size];
+        }
+    }
+
+    // Component @p i as a DataPoint with the vector's timestamp
+    DataPoint at(std::size_t i) const {
+        return DataPoint(timestamp_ms, data[i]);
+    }
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef FLASH_DECODER_H
+#define FLASH_DECODER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/FlashFormat.h"
+
+// One data record with the timestamp in effect when it was written
+struct DecodedRecord {
+    uint32_t timestamp_ms;
+    uint8_t name;
+    float value;
+};
+
+/**
+ * @brief Receives the records decoded by a FlashDecoder, in log order.
+ */
+class IRecordSink {
+public:
+    virtual ~IRecordSink() = default;
+    virtual void onRecord(const DecodedRecord& record) = 0;
+};
+
+/**
+ * @brief Host-side decoder for everything DataSaverSPI writes.
+ *
+ * Handles raw Byte5 pages, pages with a PageHeader_t and compressed pages,
+ * either from a flash image (pages back to back, as written by
+ * tools/dump_receiver) or from the stream dumpData() sends ('abcdef'
+ * preamble, 'lsh' / 'lsc' / 'lsp' pages, 'EOF' + flags trailer).
+ *
+ * TIMESTAMP records are not passed on; they set the timestamp of the records
+ * that follow, which is how DataSaverSPI omits per-record timestamps. Vector
+ * records come out as one record per component. The
+ * stream is parsed with a byte-at-a-time state machine that resynchronizes on
+ * the next page marker, so it may be fed in chunks of any size.
+ *
+ * @note When to use: post-flight analysis on a laptop, through
+ *       tools/flash_decoder or directly from other host tools and tests.
+ */
+class FlashDecoder {
+public:
+    explicit FlashDecoder(IRecordSink& sink) : sink_(sink) {}
+
+    /**
+     * @brief Decode one kFlashPageSize_bytes page as written to flash.
+     * @return int 0 when decoded, 1 when the page is erased, -1 when a
+     *         header CRC or compressed page is malformed (the page is skipped).
+     */
+    int decodePage(const uint8_t* page);
+
+    /**
+     * @brief Decode an image of the data region, page 0 at offset 0.
+     *
+     * When the image holds pages with valid headers, decoding starts at the
+     * lowest sequence number and wraps around, so a ring that wrapped comes
+     * out oldest first. Otherwise pages are decoded in address order.
+     * @param image Image bytes; a trailing partial page is ignored.
+     * @param size_bytes Size of @p image.
+     */
+    void decodeImage(const uint8_t* image, std::size_t size_bytes);
+
+    // Feed the next chunk of a dumpData() stream
+    void feedDump(const uint8_t* data, std::size_t length);
+
+    // True once the 'EOF' trailer of a dumpData() stream was seen
+    bool isDumpComplete() const { return state_ == DumpState::kTrailer || state_ == DumpState::kDone; }
+
+    // Flag letters sent after 'EOF' (D, T, P, B, F; see DataSaverSPI::dumpData()), null terminated
+    const char* getDumpFlags() const { return flags_.data(); }
+
+    uint32_t getRecordCount() const { return records_; }
+    uint32_t getPageCount() const { return pages_; }
+    uint32_t getErasedPageCount() const { return erasedPages_; }
+    uint32_t getMalformedPageCount() const { return malformedPages_; }
+
+private:
+    enum class DumpState : uint8_t { kPreamble, kMarker, kPayload, kTrailer, kDone };
+
+    // Emit the raw records (5-byte and vector) in @p length bytes, stopping at erased bytes
+    void decodeRecords(const uint8_t* data, std::size_t length);
+
+    // Decode a compressed page body starting with kCompressedPageMarker
+    int decodeCompressed(const uint8_t* data, std::size_t size_bytes);
+
+    void pushDumpByte(uint8_t byte);
+
+    IRecordSink& sink_;
+    uint32_t timestamp_ms_ = 0;
+
+    uint32_t records_ = 0;
+    uint32_t pages_ = 0;
+    uint32_t erasedPages_ = 0;
+    uint32_t malformedPages_ = 0;
+
+    // dumpData() stream state
+    DumpState state_ = DumpState::kPreamble;
+    std::size_t matched_ = 0;                  // Preamble bytes matched so far
+    std::array<uint8_t, 3> marker_ = {};       // Last three bytes seen between pages
+    uint8_t pageType_ = 0;                     // 'h', 'c' or 'p'
+    std::array<uint8_t, kFlashPageSize_bytes> page_ = {};
+    std::size_t pageLength_ = 0;
+    std::size_t payloadSize_ = 0;
+    std::array<char, 8> flags_ = {};
+    std::size_t flagCount_ = 0;
+};
+
+#endif // FLASH_DECODER_H
@@ -0,0 +1,163 @@
+#ifndef FLASH_DUMP_PROTOCOL_H
+#define FLASH_DUMP_PROTOCOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Sliding-window flash dump protocol, see DataSaverSPI::dumpDataWindowed().
+// Shared by the flight computer (sender) and the host (DumpReceiver), so it
+// must not depend on ArduinoHAL.h.
+//
+// Device -> host frames, all integers little endian:
+//   'D' 'P' page(u32) data[256] crc32   Written page
+//   'D' 'Z' page(u32) crc32             Erased page (all 0xFF)
+//   'D' 'E' endPage(u32) crc32          Every page before endPage was acknowledged
+// The crc32 covers everything after the 'D'. Pages are numbered from
+// kDataStartAddress; numbers past the last page of the chip wrap around, so a
+// flight that wrapped is still sent with increasing page numbers.
+//
+// Host -> device control messages, 7 bytes each:
+//   type(u8) page(u32) crc16            crc16 covers the type and page
+//   'A' page: every page before `page` was received (cumulative ack)
+//   'N' page: `page` is missing or was corrupted, send it again
+//   'F' endPage: end frame received, the dump is complete
+
+constexpr uint8_t kDumpSync = 'D';
+constexpr uint8_t kDumpPageFrame = 'P';
+constexpr uint8_t kDumpEmptyFrame = 'Z';
+constexpr uint8_t kDumpEndFrame = 'E';
+
+constexpr uint8_t kDumpAck = 'A';
+constexpr uint8_t kDumpNak = 'N';
+constexpr uint8_t kDumpFinished = 'F';
+
+constexpr std::size_t kDumpPageSize_bytes = 256;
+constexpr std::size_t kDumpShortFrameSize_bytes = 10;                                  // Sync, type, page, crc32
+constexpr std::size_t kDumpPageFrameSize_bytes = kDumpShortFrameSize_bytes + kDumpPageSize_bytes;
+constexpr std::size_t kDumpControlSize_bytes = 7;
+
+// Pages in flight before the sender waits for an ack (8.5 KB, fits a USB CDC buffer)
+constexpr uint32_t kDumpWindow_pages = 32;
+
+// Sender resends every unacknowledged page after this long without an ack
+constexpr uint32_t kDumpRetransmitTimeout_ms = 200;
+
+// Sender gives up after this long without the host acknowledging anything new
+constexpr uint32_t kDumpAbortTimeout_ms = 10000;
+
+/**
+ * @brief Build a device -> host frame.
+ * @param type kDumpPageFrame, kDumpEmptyFrame or kDumpEndFrame.
+ * @param page Page index, or the end page for kDumpEndFrame.
+ * @param data kDumpPageSize_bytes of page data for kDumpPageFrame; ignored otherwise.
+ * @param out Output, at least kDumpPageFrameSize_bytes long.
+ * @return Length of the frame in bytes.
+ */
+std::size_t encodeDumpFrame(uint8_t type, uint32_t page, const uint8_t* data, uint8_t* out);
+
+/**
+ * @brief Build a host -> device control message.
+ * @param type kDumpAck, kDumpNak or kDumpFinished.
+ * @param page Page the message refers to.
+ * @param out Output, at least kDumpControlSize_bytes long.
+ */
+void encodeDumpControl(uint8_t type, uint32_t page, uint8_t* out);
+
+/**
+ * @brief Reassembles control messages from a byte stream on the device.
+ *
+ * Bytes that do not form a message with a valid CRC are skipped one at a
+ * time, so the parser resynchronizes after a lost or corrupted byte.
+ */
+class DumpControlParser {
+public:
+    /**
+     * @brief Feed one received byte.
+     * @return true when it completed a valid message; read it with getType() and getPage().
+     */
+    bool push(uint8_t byte);
+
+    uint8_t getType() const { return type_; }
+    uint32_t getPage() const { return page_; }
+
+private:
+    std::array<uint8_t, kDumpControlSize_bytes> buffer_ = {};
+    std::size_t length_ = 0;
+    uint8_t type_ = 0;
+    uint32_t page_ = 0;
+};
+
+/**
+ * @brief Receives the pages and transmits the control messages of a DumpReceiver.
+ */
+class IDumpSink {
+public:
+    virtual ~IDumpSink() = default;
+
+    /**
+     * @brief Called once per page, possibly out of order.
+     * @param page Page index; the page lives at kDataStartAddress + (page % pages on the chip) * 256.
+     * @param data kDumpPageSize_bytes of page data, or nullptr for an erased page.
+     */
+    virtual void onPage(uint32_t page, const uint8_t* data) = 0;
+
+    // Send a control message back to the device
+    virtual void sendControl(const uint8_t* message, std::size_t length) = 0;
+};
+
+/**
+ * @brief Host side of the windowed dump protocol.
+ *
+ * Feed it every byte read from the serial port. Each valid frame is acked
+ * with the first page still missing; pages skipped over by a later frame are
+ * NAKed once so the sender retransmits them without waiting for its timeout.
+ * Frames with a bad CRC are dropped and the parser rescans from the next byte.
+ *
+ * @note When to use: on the ground station or laptop reading a flight
+ *       computer that runs DataSaverSPI::dumpDataWindowed(). To resume an
+ *       interrupted dump, construct it with the previous getNextPage() and
+ *       pass the same page to dumpDataWindowed(). See tools/dump_receiver.
+ */
+class DumpReceiver {
+public:
+    /**
+     * @param sink Receives pages and sends control messages (non-owning).
+     * @param startPage First page the sender will send.
+     */
+    explicit DumpReceiver(IDumpSink& sink, uint32_t startPage = 0);
+
+    // Feed bytes read from the device
+    void process(const uint8_t* data, std::size_t length);
+
+    // True once the end frame arrived with every page received
+    bool isDone() const { return done_; }
+
+    // First page not yet received; everything before it has been passed to the sink
+    uint32_t getNextPage() const { return nextPage_; }
+
+    uint32_t getPagesReceived() const { return pagesReceived_; }
+    uint32_t getCrcErrors() const { return crcErrors_; }
+    uint32_t getDuplicates() const { return duplicates_; }
+
+private:
+    void pushByte(uint8_t byte);
+    void handleFrame(uint8_t type, uint32_t page, const uint8_t* data);
+    void sendControl(uint8_t type, uint32_t page);
+    void dropFront(std::size_t count);
+
+    IDumpSink& sink_;
+    std::array<uint8_t, kDumpPageFrameSize_bytes> frame_ = {};
+    std::size_t frameLength_ = 0;
+
+    uint32_t nextPage_;
+    uint32_t received_ = 0;  // Bit i: page nextPage_ + i was received
+    uint32_t nakSent_ = 0;   // Bit i: page nextPage_ + i was already NAKed
+    bool done_ = false;
+
+    uint32_t pagesReceived_ = 0;
+    uint32_t crcErrors_ = 0;
+    uint32_t duplicates_ = 0;
+};
+
+#endif // FLASH_DUMP_PROTOCOL_H
@@ -0,0 +1,73 @@
+#ifndef FLASH_FORMAT_H
+#define FLASH_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// On-chip layout written by DataSaverSPI, see docs/FlashDataSaving.md. Kept
+// free of ArduinoHAL.h so host tools such as FlashDecoder can share it.
+
+constexpr uint32_t kMetadataStartAddress = 0x000000;  // Start writing metadata at the beginning of flash
+constexpr uint32_t kFlightDirectoryAddress = 0x001000;  // Second metadata sector: append-only flight directory
+constexpr uint32_t kDataStartAddress = 0x002000;  // Start writing data after 2 sectors (8kB) of metadata
+constexpr uint32_t kPostLaunchFlagAddress = 0x000000;  // Address of the post-launch flag
+constexpr uint32_t kLaunchStartAddressAddress = 0x000001;  // Address of the launch start address (32 bits)
+
+constexpr uint8_t kPostLaunchFlagTrue = 0x00; // Flag to indicate post-launch mode is active
+constexpr uint8_t kPostLaunchFlagFalse = 0x01; // Flag to indicate post-launch mode is not active
+
+constexpr uint8_t kEmptyPageValue = 0xFF;
+constexpr uint32_t kFlashPageSize_bytes = 256;  // DataSaverSPI writes whole pages of this size
+
+constexpr uint8_t kPageHeaderMagic = 0xA5; // First byte of a page that starts with a PageHeader_t
+
+constexpr uint32_t kFlightOpenEndAddress = 0xFFFFFFFF; // FlightEntry_t::endAddress of a flight still being logged
+
+// Vector record on raw pages: name byte kVectorRecordName + n for n components
+// (2 to kMaxVectorRecordComponents), the label, then n floats for channels
+// label, label + 1, ... A triplet takes 14 bytes instead of three 5-byte records.
+constexpr uint8_t kVectorRecordName = 0xF0;
+constexpr uint8_t kMaxVectorRecordComponents = 3;
+
+constexpr std::size_t vectorRecordSize(uint8_t components) {
+    return 2U + static_cast<std::size_t>(components) * sizeof(float);
+}
+
+// Components of the vector record starting with @p name, or 0 for any other record
+constexpr uint8_t vectorRecordComponents(uint8_t name) {
+    return (name >= kVectorRecordName + 2U && name <= kVectorRecordName + kMaxVectorRecordComponents)
+               ? static_cast<uint8_t>(name - kVectorRecordName)
+               : 0U;
+}
+
+
+#pragma pack(push, 1)  // Pack the struct to avoid padding between the name and datas
+typedef struct { // NOLINT(altera-struct-pack-align)
+    uint8_t name;
+    float data;
+} Record_t; 
+
+typedef struct { // NOLINT(altera-struct-pack-align)
+    uint8_t name;
+    uint32_t timestamp_ms;
+} TimestampRecord_t;
+
+// Optional header at the start of each page, see DataSaverSPI::setPageHeadersEnabled()
+typedef struct { // NOLINT(altera-struct-pack-align)
+    uint8_t magic;              // kPageHeaderMagic
+    uint32_t sequence;          // Increments by one for every page written
+    uint32_t firstTimestamp_ms; // Last timestamp written before the page was opened
+    uint16_t crc16;             // CRC-16/CCITT of the whole page except this field
+} PageHeader_t;
+
+// One flight in the directory at kFlightDirectoryAddress, see DataSaverSPI::getFlight()
+typedef struct { // NOLINT(altera-struct-pack-align)
+    uint16_t flightId;           // Starts at 1 and increments for every launch
+    uint32_t startAddress;       // Launch-protected address, including the pre-launch rollback
+    uint32_t launchTimestamp_ms;
+    uint16_t crc16;              // CRC-16/CCITT of the fields above
+    uint32_t endAddress;         // Exclusive; kFlightOpenEndAddress until the flight is closed
+} FlightEntry_t;
+#pragma pack(pop)  // Stop packing from here on out
+
+#endif // FLASH_FORMAT_H
@@ -0,0 +1,149 @@
+#ifndef FLOAT_COMPRESSION_H
+#define FLOAT_COMPRESSION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// First byte of a compressed flash page. Raw Byte5 pages start with a data
+// name (< 0x80) and erased pages with 0xFF, so the three never collide.
+constexpr uint8_t kCompressedPageMarker = 0xC5;
+
+// Marker (1) + record count (uint16 LE) + base timestamp (uint32 LE)
+constexpr std::size_t kCompressedPageHeaderSize_bytes = 7;
+
+// Worst case per record: 9 name bits + 3 control + 5 leading + 5 length + 32 value bits
+constexpr uint8_t kMaxCompressedRecordBits = 54;
+
+/**
+ * @brief Per-channel state shared by the page encoder and decoder.
+ *
+ * Everything is reset at the start of each page so pages decode on their own.
+ * Validity is tracked with two 256-bit masks, so a reset costs 64 bytes of
+ * memset instead of clearing the ~1 KB of tables.
+ */
+class CompressionChannelTable {
+public:
+    void reset();
+
+    // Previous value of a channel, 0 if the channel has not appeared in this page
+    uint32_t previousBits(uint8_t name) const { return hasValue(name) ? previous_[name] : 0U; }
+
+    // Current XOR window of a channel; length 0 means there is none yet
+    uint8_t windowLeading(uint8_t name) const { return hasValue(name) ? leading_[name] : 0U; }
+    uint8_t windowLength(uint8_t name) const { return hasValue(name) ? length_[name] : 0U; }
+
+    void storeValue(uint8_t name, uint32_t bits);
+    void storeWindow(uint8_t name, uint8_t leading, uint8_t length);
+
+    /**
+     * @brief Predicts the next record name from the name written before it.
+     * @return true and sets @p predicted when a prediction is available.
+     */
+    bool predictNext(uint8_t& predicted) const;
+
+    // Records @p name as the successor of the previous name and makes it the new previous name
+    void advanceName(uint8_t name);
+
+private:
+    bool hasValue(uint8_t name) const { return (valueSeen_[name >> 3] & (1U << (name & 7U))) != 0U; }
+    bool hasSuccessor(uint8_t name) const { return (successorSeen_[name >> 3] & (1U << (name & 7U))) != 0U; }
+
+    std::array<uint32_t, 256> previous_ = {};
+    std::array<uint8_t, 256> leading_ = {};
+    std::array<uint8_t, 256> length_ = {};
+    std::array<uint8_t, 256> successor_ = {};
+    std::array<uint8_t, 32> valueSeen_ = {};
+    std::array<uint8_t, 32> successorSeen_ = {};
+    bool hasLastName_ = false;
+    uint8_t lastName_ = 0;
+};
+
+/**
+ * @brief Lossless Gorilla-style (XOR-delta) page encoder for Byte5 records.
+ *
+ * Each record is a name followed by a value:
+ * - Name: `1` when it matches the channel that followed the previous name last
+ *   time, otherwise `0` and 8 bits. Logging loops save channels in a fixed
+ *   order, so almost every name costs one bit.
+ * - Float value: XOR with the channel's previous value. `0` when unchanged,
+ *   `10` + bits when the XOR fits the channel's previous leading/trailing-zero
+ *   window, otherwise `110` + 5 bits leading zeros + 5 bits (length - 1) + bits.
+ *   Noisy sensor values often flip a carry through many mantissa bits, so
+ *   `111` + 5 bits (length - 1) + bits instead stores the zigzag difference
+ *   of the values as order-preserving integers when that is shorter.
+ * - TIMESTAMP value: delta from the previous timestamp; `0` + 7 bits,
+ *   `10` + 14 bits or `11` + 32 bits.
+ *
+ * Every page starts with kCompressedPageMarker, the record count and the
+ * timestamp in effect when the page was opened, so a page never depends on
+ * the one before it. append() is O(1) with at most kMaxCompressedRecordBits
+ * written, which bounds the per-sample encode time.
+ *
+ * @note When to use: through DataSaverSPI::setCompressor(). Use
+ *       decodePage() on the host to turn a compressed page back into raw
+ *       Byte5 records.
+ */
+class FloatCompressor {
+public:
+    /**
+     * @brief Start a new page in @p page. Clears all per-channel state.
+     * @param page Page buffer (non-owning, must outlive the open page).
+     * @param pageSize_bytes Size of the page; must be > kCompressedPageHeaderSize_bytes.
+     * @param baseTimestamp_ms Timestamp the first records of this page belong to.
+     */
+    void beginPage(uint8_t* page, std::size_t pageSize_bytes, uint32_t baseTimestamp_ms);
+
+    /**
+     * @brief Encode one record into the open page.
+     * @param name Data name (TIMESTAMP values are delta-coded as integers).
+     * @param valueBits Raw bits of the float, or the timestamp for TIMESTAMP.
+     * @return true when written; false (page unchanged) when it does not fit
+     *         or no page is open.
+     */
+    bool append(uint8_t name, uint32_t valueBits);
+
+    /**
+     * @brief Write the record count into the header and pad the unused tail
+     *        with 0xFF so flushing it does not program the remaining cells.
+     *        The page stays open, so append() may still be called afterwards.
+     */
+    void finishPage();
+
+    // Forget the open page, e.g. after it was flushed
+    void closePage() { page_ = nullptr; }
+
+    bool isPageOpen() const { return page_ != nullptr; }
+
+    // Bytes of the page in use, including the header; 0 when no page is open
+    std::size_t getBytesUsed() const { return page_ == nullptr ? 0U : (bitPos_ + 7U) / 8U; }
+
+    uint16_t getRecordCount() const { return recordCount_; }
+
+    /**
+     * @brief Expand a compressed page back to raw Byte5 records.
+     *
+     * The output starts with a TIMESTAMP record holding the page's base
+     * timestamp, followed by one 5-byte record per encoded record.
+     * @param page Page starting with kCompressedPageMarker.
+     * @param pageSize_bytes Size of the page.
+     * @param out Output buffer.
+     * @param outCapacity_bytes Size of @p out.
+     * @param outLength_bytes Set to the number of bytes written on success.
+     * @return 0 on success, -1 on a malformed page or when @p out is too small.
+     */
+    static int decodePage(const uint8_t* page, std::size_t pageSize_bytes, uint8_t* out,
+                          std::size_t outCapacity_bytes, std::size_t& outLength_bytes);
+
+private:
+    void writeBits(uint32_t value, uint8_t count);
+
+    uint8_t* page_ = nullptr;
+    std::size_t pageSize_bytes_ = 0;
+    std::size_t bitPos_ = 0;
+    uint16_t recordCount_ = 0;
+    uint32_t lastTimestamp_ms_ = 0;
+    CompressionChannelTable channels_;
+};
+
+#endif // FLOAT_COMPRESSION_H
@@ -0,0 +1,79 @@
+#ifndef LANDED_THROTTLE_H
+#define LANDED_THROTTLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/SensorDataHandler.h"
+#include "data_handling/Telemetry.h"
+
+/**
+ * @brief Switches sensor polling, SensorDataHandler save intervals and
+ *        telemetry periods to slow landed rates in one call.
+ *
+ * Holds non-owning views of the handler and stream lists (same lifetime rule
+ * as Telemetry). apply() is idempotent and cannot be undone; a landed rocket
+ * stays landed until it is power cycled.
+ *
+ * @note When to use: call apply() on entry to STATE_LANDED, e.g. from a
+ *       captureless lambda registered with registerOnStateEntry(), and gate
+ *       sensor reads with shouldPollSensors() so flash wear and battery drain
+ *       drop during long recovery waits.
+ */
+class LandedThrottle {
+public:
+    /**
+     * @param handlers Handlers to slow down (non-owning, must outlive this object).
+     * @param handlerCount Number of handlers.
+     * @param streams Telemetry streams to slow down (non-owning, must outlive this object).
+     * @param streamCount Number of streams.
+     * @param landedSaveInterval_ms Save interval applied to every handler.
+     * @param landedTelemetryPeriod_ms Send period applied to every stream.
+     * @param landedPollInterval_ms Minimum time between sensor polls once landed.
+     */
+    LandedThrottle(SensorDataHandler* const* handlers, std::size_t handlerCount,
+                   SendableSensorData* const* streams, std::size_t streamCount,
+                   uint16_t landedSaveInterval_ms, uint16_t landedTelemetryPeriod_ms,
+                   uint16_t landedPollInterval_ms);
+
+    /**
+     * @brief Construct from std::arrays (compile-time sized). The arrays must outlive this object.
+     */
+    template <std::size_t N, std::size_t M>
+    LandedThrottle(const std::array<SensorDataHandler*, N>& handlers,
+                   const std::array<SendableSensorData*, M>& streams,
+                   uint16_t landedSaveInterval_ms, uint16_t landedTelemetryPeriod_ms,
+                   uint16_t landedPollInterval_ms)
+        : LandedThrottle(handlers.data(), N, streams.data(), M, landedSaveInterval_ms,
+                         landedTelemetryPeriod_ms, landedPollInterval_ms) {}
+
+    /**
+     * @brief Apply the landed rates to every handler and stream.
+     */
+    void apply();
+
+    bool isApplied() const { return applied_; }
+
+    /**
+     * @brief Whether the sensors should be read on this loop iteration.
+     * @param now_ms Current time in milliseconds.
+     * @return Always true before apply(); afterwards true at most once per landedPollInterval_ms.
+     */
+    bool shouldPollSensors(uint32_t now_ms);
+
+private:
+    SensorDataHandler* const* handlers_;
+    const std::size_t handlerCount_;
+    SendableSensorData* const* streams_;
+    const std::size_t streamCount_;
+    uint16_t landedSaveInterval_ms_;
+    uint16_t landedTelemetryPeriod_ms_;
+    uint16_t landedPollInterval_ms_;
+
+    bool applied_ = false;
+    bool polledSinceApply_ = false;
+    uint32_t lastPoll_ms_ = 0;
+};
+
+#endif // LANDED_THROTTLE_H
@@ -0,0 +1,155 @@
+#ifndef MULTI_DATA_SAVER_H
+#define MULTI_DATA_SAVER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaver.h"
+
+// Per-sink counters, see MultiDataSaver::getStats()
+struct MultiSinkStats {
+    uint32_t saved = 0;         // Points the sink accepted (returned 0)
+    uint32_t failed = 0;        // Points the sink returned non-zero for
+    uint32_t filtered = 0;      // Points on a channel the sink does not take
+    uint32_t rateLimited = 0;   // Points within the sink's interval for that channel
+    uint32_t stallSkipped = 0;  // Points dropped while the sink was backed off after a stall
+    uint32_t stalls = 0;        // Saves that took longer than the stall limit
+    uint32_t worstSave_us = 0;  // Longest single save
+};
+
+/**
+ * @brief Fans one stream of data points out to several savers.
+ *
+ * Each sink has its own channel filter, its own minimum interval per channel
+ * (measured in data timestamps, like SensorDataHandler) and a priority. Sinks
+ * are called in priority order, so a slow low-priority sink cannot delay a
+ * sample for a faster one. A sink that fails still leaves the others saving.
+ * With a stall limit set, a sink whose save blocks longer than the limit is
+ * skipped for a back-off period instead of stalling every caller.
+ *
+ * Launch, landing and post-launch notifications and begin() go to every sink.
+ *
+ * @note When to use: give one SensorDataHandler per sensor a MultiDataSaver to
+ *       log the same data to several places, e.g. everything to SPI flash and
+ *       a decimated copy to SD, instead of duplicating handlers.
+ */
+class MultiDataSaver : public IDataSaver {
+public:
+    static constexpr std::size_t kMaxSinks = 4;
+    // Channels below this get a filter bit and a rate limit; higher names always pass
+    static constexpr uint8_t kMaxChannels = 64;
+    // Points staged per sink call in saveDataPoints(); larger batches are split
+    static constexpr std::size_t kMaxBatch = 32;
+
+    using IDataSaver::saveDataPoint; // Allow the use of the other saveDataPoint overload
+
+    /**
+     * @brief Add a destination.
+     * @param saver    Saver to forward to (non-owning).
+     * @param priority Higher priorities are called first; equal priorities keep the order added.
+     * @return Handle for the other per-sink calls, or -1 if kMaxSinks are in use.
+     * @note When to use: during setup, before the first save.
+     */
+    int addSink(IDataSaver* saver, uint8_t priority = 0);
+
+    /**
+     * @brief Minimum time between saved points of one channel for this sink.
+     * @param interval_ms 0 (the default) saves every point.
+     * @note When to use: keep a decimated copy on a slower or smaller medium.
+     */
+    void setRateLimit(int sink, uint16_t interval_ms);
+
+    /**
+     * @brief Choose whether the sink receives a channel. All channels are on by default.
+     * @note When to use: keep bulky or debug-only channels off a sink.
+     */
+    void setChannelEnabled(int sink, uint8_t name, bool enabled);
+
+    // Turn every channel off (or on), before enabling (or disabling) a few
+    void setAllChannelsEnabled(int sink, bool enabled);
+
+    /**
+     * @brief Back a slow sink off instead of letting it block the loop.
+     *
+     * When one save takes longer than @p limit_us, the sink gets no points for
+     * the next @p backoff_ms; those are counted in stallSkipped.
+     * @param limit_us 0 (the default) never backs off.
+     * @note When to use: sinks that can block for a long time, such as an SD
+     *       card that pauses for internal housekeeping.
+     */
+    void setStallLimit(int sink, uint32_t limit_us, uint32_t backoff_ms);
+
+    /**
+     * @brief Forward a point to every sink that takes it.
+     * @return 0 if every sink that took the point saved it, otherwise the
+     *         first non-zero result in priority order.
+     */
+    int saveDataPoint(const DataPoint& dataPoint, uint8_t name) override;
+
+    /**
+     * @brief Forward a batch: each sink gets the points it takes in one
+     *        saveDataPoints() call per kMaxBatch points.
+     *
+     * The filter and rate limit are applied point by point, counting the
+     * points already staged for the sink. The rate limit only advances when
+     * the sink's call succeeds; if it fails, all the points staged for that
+     * call are counted as failed, as with saveDataPoint().
+     * @return Same as saveDataPoint().
+     */
+    int saveDataPoints(const NamedDataPoint* points, size_t count) override;
+
+    /**
+     * @brief Forward a vector to every sink that takes its label.
+     *
+     * The filter and rate limit use @p name, the label of the first
+     * component, so each sink receives whole vectors.
+     * @return Same as saveDataPoint().
+     */
+    int saveDataVector(const DataVector& vector, uint8_t name) override;
+
+    // Calls begin() on every sink; true if all of them succeeded
+    bool begin() override;
+    void launchDetected(uint32_t launchTimestamp_ms) override;
+    void landingDetected(uint32_t landingTimestamp_ms) override;
+    void clearPostLaunchMode() override;
+
+    const MultiSinkStats& getStats(int sink) const { return sinks_[static_cast<std::size_t>(sink)].stats; }
+    std::size_t getSinkCount() const { return sinkCount_; }
+
+private:
+    // When each channel was last saved, for the rate limit
+    struct RateState {
+        uint64_t seen = 0;          // Bit n: lastSave_ms[n] holds a save
+        std::array<uint32_t, kMaxChannels> lastSave_ms = {};
+    };
+
+    struct Sink {
+        IDataSaver* saver = nullptr;
+        uint8_t priority = 0;
+        uint16_t interval_ms = 0;
+        uint64_t channels = ~0ULL;  // Bit n: channel n is forwarded
+        RateState rate;
+        uint32_t stallLimit_us = 0;
+        uint32_t stallBackoff_ms = 0;
+        uint32_t stalledAt_ms = 0;
+        bool stalled = false;
+        MultiSinkStats stats;
+    };
+
+    // Whether the sink takes the point now, rate limited against @p rate; updates its counters when it does not
+    static bool accepts(Sink& sink, const RateState& rate, const DataPoint& dataPoint, uint8_t name);
+    // Start the rate limit interval for a channel
+    static void markSaved(RateState& rate, const DataPoint& dataPoint, uint8_t name);
+    // Update the timing, stall state and counters after one call carrying @p points points
+    static void recordResult(Sink& sink, uint32_t start_us, int result, uint32_t points, int& firstError);
+
+    std::array<Sink, kMaxSinks> sinks_ = {};
+    std::array<uint8_t, kMaxSinks> order_ = {};  // Sink indices, highest priority first
+    std::array<NamedDataPoint, kMaxBatch> batch_ = {};  // Points staged for one sink
+    RateState batchRate_;  // The sink's rate state with batch_ saved, kept if the call succeeds
+    std::size_t sinkCount_ = 0;
+};
+
+#endif // MULTI_DATA_SAVER_H
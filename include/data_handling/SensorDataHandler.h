@@ -5,6 +5,7 @@
 #define SensorDataHandler_H
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -13,6 +14,14 @@
 #include "data_handling/CircularArray.h"
 #include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
+#include "data_handling/DataVector.h"
+
+// What SensorDataHandler saves once per save interval, see setDecimation()
+enum class DecimationMode : uint8_t {
+    kDrop,     // The sample that ends the interval; the ones before it are dropped (default)
+    kAverage,  // The mean of every sample in the interval (boxcar / first-order CIC)
+    kMinMax    // The lowest and the highest sample in the interval, each at its own timestamp
+};
 
 /**
  * @brief Buffers sensor samples and forwards them to an IDataSaver at a
@@ -41,6 +50,16 @@ public:
      */
     int addData(DataPoint data);
 
+    /**
+     * @brief Ingest a multi-value sample and persist it as one vector if the
+     *        save interval elapsed.
+     * @param data Sample whose first component belongs to this handler's name.
+     * @return Status from the underlying saver.
+     * @note When to use: one handler per triplet sensor (named after its X
+     *       channel) instead of one handler per axis.
+     */
+    int addData(const DataVector& data);
+
     /**
      * @brief Set the minimum gap between persisted samples.
      * @param interval_ms Minimum milliseconds between writes.
@@ -48,21 +67,59 @@ public:
      */
     void restrictSaveSpeed(uint16_t interval_ms);
 
+    /**
+     * @brief Choose how the samples within one save interval are reduced.
+     *
+     * kAverage and kMinMax keep an O(1) running accumulator between saves, so
+     * a slow log still represents every sample seen instead of aliasing
+     * whichever one happened to land on the interval. The average is saved
+     * with the timestamp of the sample that ends the interval. kMinMax saves
+     * up to two points per interval, in time order; vectors are averaged in
+     * kMinMax mode since their components cannot share one timestamp.
+     * Changing the mode discards the current interval's accumulator.
+     * @note When to use: with restrictSaveSpeed() on fast sensors logged or
+     *       sent at a low rate; kMinMax when peaks matter more than the mean.
+     */
+    void setDecimation(DecimationMode mode);
+
+    DecimationMode getDecimation() const {return decimation_;}
+
     uint8_t getName() const {return name_;}
 
+    // Last point saved; in kMinMax mode, the sample that ended the last interval
     DataPoint getLastDataPointSaved() const {
         return lastDataPointSaved_;
     }
 
+    // Last vector saved through addData(const DataVector&); size 0 before the first
+    const DataVector& getLastDataVectorSaved() const {
+        return lastDataVectorSaved_;
+    }
+
  
 protected:
     IDataSaver* dataSaver;
 private:
+    // Add one sample's components to the running sums
+    void accumulate(const float* values, std::size_t count);
+    // Mean of component i over the current interval
+    float windowMean(std::size_t i) const;
+
     uint8_t name_;
     uint16_t saveInterval_ms_; // The minimum time between each data point that is saved to the SD card
     uint32_t lastSaveTime_ms_; // The last time a data point was saved to the SD card
 
+    DecimationMode decimation_;
+    uint32_t windowCount_;  // Samples accumulated since the last save
+    // Sums are kept relative to the interval's first sample, so large offsets
+    // such as pressure do not swamp small variations in float precision
+    std::array<float, kMaxDataVectorSize> windowOrigin_;
+    std::array<float, kMaxDataVectorSize> windowSum_;
+    DataPoint windowMin_;
+    DataPoint windowMax_;
+
     DataPoint lastDataPointSaved_;
+    DataVector lastDataVectorSaved_;
 };
 
 #endif // DATAHANDLER_H
@@ -0,0 +1,121 @@
+#ifndef SERIAL_FRAME_FORMAT_H
+#define SERIAL_FRAME_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/FlashDecoder.h"
+
+// Batched frames written by DataSaverSDSerial in SerialLogFormat::kBatched mode.
+// Shared with host tools, so it must not depend on ArduinoHAL.h.
+//
+// Each frame is COBS encoded and ends with a 0x00 byte, which never appears
+// inside an encoded frame, so a receiver resynchronizes at the next zero.
+// Before encoding, all integers little endian:
+//   version(u8) sequence(u16) baseTimestamp_ms(u32) count(u8)
+//   count x [name(u8) delta(u8) value(f32)]
+//   crc16                      CRC-16/CCITT of everything before it
+// A record's timestamp is baseTimestamp_ms + delta; a record more than 255 ms
+// after the base, or before it, starts the next frame. The sequence counts
+// frames, so the receiver can tell a dropped frame from a quiet link.
+
+constexpr uint8_t kSerialFrameVersion = 1;
+constexpr uint8_t kSerialFrameDelimiter = 0x00;
+
+constexpr std::size_t kSerialFrameHeaderSize_bytes = 8;
+constexpr std::size_t kSerialRecordSize_bytes = 6;
+constexpr std::size_t kSerialFrameMaxRecords = 40;
+
+// Largest frame before COBS: 250 bytes, so encoding adds exactly one byte
+constexpr std::size_t kSerialFrameMaxRaw_bytes =
+    kSerialFrameHeaderSize_bytes + kSerialFrameMaxRecords * kSerialRecordSize_bytes + 2;
+
+// COBS adds one byte per started 254-byte run, plus the delimiter
+constexpr std::size_t kSerialFrameMaxEncoded_bytes = kSerialFrameMaxRaw_bytes + kSerialFrameMaxRaw_bytes / 254 + 2;
+
+/**
+ * @brief COBS-encode @p length bytes; the output contains no zero bytes.
+ * @param out Output, at least length + length / 254 + 1 bytes. The delimiter is not added.
+ * @return Encoded length.
+ */
+std::size_t cobsEncode(const uint8_t* data, std::size_t length, uint8_t* out);
+
+/**
+ * @brief Decode one COBS frame (without its delimiter). @p out may equal @p data.
+ * @return Decoded length, or -1 if the frame holds a zero or a run past its end.
+ */
+int cobsDecode(const uint8_t* data, std::size_t length, uint8_t* out);
+
+/**
+ * @brief Packs records into one frame at a time.
+ *
+ * @note When to use: on the flight computer, one instance per serial port.
+ *       Call append() until it returns false, then finish() and write the frame.
+ */
+class SerialFrameWriter {
+public:
+    /**
+     * @brief Add one record to the current frame.
+     * @return true if it fit; false if the frame is full or the timestamp is
+     *         out of the frame's range (nothing was added).
+     */
+    bool append(uint32_t timestamp_ms, uint8_t name, float value);
+
+    bool isEmpty() const { return count_ == 0U; }
+
+    /**
+     * @brief Encode the frame, delimiter included, and start the next one.
+     * @param out Output, at least kSerialFrameMaxEncoded_bytes.
+     * @return Bytes to send, or 0 if the frame was empty.
+     */
+    std::size_t finish(uint8_t* out);
+
+    uint16_t getSequence() const { return sequence_; }
+
+private:
+    std::array<uint8_t, kSerialFrameMaxRaw_bytes> frame_ = {};
+    uint8_t count_ = 0;
+    uint16_t sequence_ = 0;
+    uint32_t baseTimestamp_ms_ = 0;
+};
+
+/**
+ * @brief Receiver for batched frames.
+ *
+ * Feed it the serial stream in chunks of any size. Records from frames with
+ * a valid CRC go to the same IRecordSink as the flash and SD decoders;
+ * corrupted or truncated frames are counted and dropped as a whole.
+ *
+ * @note When to use: on the host or a logger that reads a DataSaverSDSerial
+ *       in SerialLogFormat::kBatched mode.
+ */
+class SerialFrameDecoder {
+public:
+    explicit SerialFrameDecoder(IRecordSink& sink) : sink_(sink) {}
+
+    void process(const uint8_t* data, std::size_t length);
+
+    uint32_t getFrameCount() const { return frames_; }
+    uint32_t getRecordCount() const { return records_; }
+    uint32_t getBadFrameCount() const { return badFrames_; }
+    // Frames missing between good frames, from gaps in the sequence numbers
+    uint32_t getLostFrameCount() const { return lostFrames_; }
+
+private:
+    void handleFrame();
+
+    IRecordSink& sink_;
+    std::array<uint8_t, kSerialFrameMaxEncoded_bytes> buffer_ = {};
+    std::size_t length_ = 0;
+    bool overflow_ = false;
+    bool haveSequence_ = false;
+    uint16_t nextSequence_ = 0;
+
+    uint32_t frames_ = 0;
+    uint32_t records_ = 0;
+    uint32_t badFrames_ = 0;
+    uint32_t lostFrames_ = 0;
+};
+
+#endif // SERIAL_FRAME_FORMAT_H
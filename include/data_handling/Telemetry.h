@@ -99,6 +99,7 @@ inline std::uint16_t hzToPeriod_ms(std::uint16_t frequency_hz) {
  * For multi groups, you can provide either:
  * - raw pointer + count (most general)
  * - std::array (preferred when size is fixed at compile time)
+ * - one SDH fed with DataVectors (same bytes on the wire as a multi group)
  */
 struct SendableSensorData {
     // --- Payload configuration ---
@@ -109,6 +110,9 @@ struct SendableSensorData {
     /** Multi-value group. Pointer to an external array of SDHs. */
     SensorDataHandler* const* multiSDH;
 
+    /** Vector stream. If non-null, sends its last DataVector like a multi group. */
+    SensorDataHandler* vectorSDH;
+
     /** Length of multiSDH array. */
     // Shall not be changed after construction
     // Used to iterate over multiSDH
@@ -133,6 +137,7 @@ struct SendableSensorData {
     SendableSensorData(SensorDataHandler* sdh, std::uint16_t sendFrequency_hz)
         : singleSDH(sdh),
           multiSDH(0),
+          vectorSDH(0),
           multiSDHLength(0),
           multiSDHDataLabel(0),
           period_ms(TelemetryFmt::hzToPeriod_ms(sendFrequency_hz)),
@@ -150,11 +155,31 @@ struct SendableSensorData {
                        std::uint16_t sendFrequency_hz)
         : singleSDH(0),
           multiSDH(sdhList.data()),
+          vectorSDH(0),
           multiSDHLength(M),
           multiSDHDataLabel(label),
           period_ms(TelemetryFmt::hzToPeriod_ms(sendFrequency_hz)),
           lastSentTimestamp_ms(0) {}
 
+    /**
+     * @brief Create a stream from one SDH that is fed DataVectors.
+     *
+     * Sends the label and the first @p vectorSize components of
+     * getLastDataVectorSaved(), so the ground station sees the same packet as
+     * a multi group of one SDH per axis.
+     */
+    SendableSensorData(SensorDataHandler* sdh,
+                       std::uint8_t label,
+                       std::size_t vectorSize,
+                       std::uint16_t sendFrequency_hz)
+        : singleSDH(0),
+          multiSDH(0),
+          vectorSDH(sdh),
+          multiSDHLength(vectorSize),
+          multiSDHDataLabel(label),
+          period_ms(TelemetryFmt::hzToPeriod_ms(sendFrequency_hz)),
+          lastSentTimestamp_ms(0) {}
+
     /**
      * @brief Return true if enough time has elapsed such that this stream wants to be sent again.
      */
@@ -174,6 +199,9 @@ struct SendableSensorData {
 
     /** @brief Convenience: true if configured as a multi SDH stream. */
     bool isMulti() const { return (multiSDH != 0) && (multiSDHLength != 0); }
+
+    /** @brief Convenience: true if configured as a vector SDH stream. */
+    bool isVector() const { return (vectorSDH != 0) && (multiSDHLength != 0); }
 };
 
 /**
@@ -241,6 +269,7 @@ private:
     // Packet building helpers
     void preparePacket(std::uint32_t timestamp_ms);
     void addSingleSDHToPacket(SensorDataHandler* sdh);
+    void addFloatToPacket(float value);
     void addSSDToPacket(SendableSensorData* ssd);
     void setPacketToZero();
     void addEndMarker();
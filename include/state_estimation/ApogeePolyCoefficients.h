@@ -0,0 +1,42 @@
+#ifndef APOGEE_POLY_COEFFICIENTS_H
+#define APOGEE_POLY_COEFFICIENTS_H
+
+// Regression coefficients for ApogeePredictor::polyUpdate().
+//
+// These are the legacy hand-entered coefficients, kept so polyUpdate() behaves
+// as it always has. The fitting tool in test/test_apogee_poly_fit compares them
+// against a fresh fit of the data/ flights on every run. To replace them, e.g.
+// for a new airframe, place its flight CSVs in data/ and run the tool, which
+// overwrites this file:
+//
+//     APOGEE_POLY_FIT_WRITE=1 pio test -e native -f test_apogee_poly_fit
+//
+// Feature order: [1, v, a, dh, v^2, v*a, v*dh, a^2, a*dh, dh^2]
+// where v = vertical velocity (m/s), a = inertial vertical acceleration (m/s^2)
+// and dh = v^2 / (2|a|). The model predicts the altitude still to be gained (m).
+
+#include <array>
+#include <cstddef>
+
+namespace ApogeePolyCoefficients {
+
+constexpr size_t kFeatureCount = 10;
+
+constexpr std::array<float, kFeatureCount> kCoefficients = {{
+    /* 1 */ 0.00000000F,
+    /* vertical_velocity */ 5.06108448F,
+    /* vertical_acceleration */ 63.94744144F,
+    /* delta_h_simple */ 0.52115350F,
+    /* vertical_velocity^2 */ 0.01494354F,
+    /* vertical_velocity vertical_acceleration */ 0.46012269F,
+    /* vertical_velocity delta_h_simple */ 0.01274390F,
+    /* vertical_acceleration^2 */ 3.27864634F,
+    /* vertical_acceleration delta_h_simple */ -0.00747177F,
+    /* delta_h_simple^2 */ -0.00208120F,
+}};
+
+constexpr float kIntercept = 308.64734694F;
+
+}  // namespace ApogeePolyCoefficients
+
+#endif  // APOGEE_POLY_COEFFICIENTS_H
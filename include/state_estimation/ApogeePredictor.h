@@ -1,8 +1,10 @@
 #ifndef APOGEE_PREDICTOR_H
 #define APOGEE_PREDICTOR_H
 
+#include <array>
 #include <cstdint>
 
+#include "state_estimation/ApogeePolyCoefficients.h"
 #include "state_estimation/VerticalVelocityEstimator.h"
 
 
@@ -41,6 +43,7 @@ public:
     /** Optional: Update using a quadratic-drag model (more accurate under drag) */
     void quadUpdate();
 
+    /** Update using the fitted polynomial model in ApogeePolyCoefficients.h */
     void polyUpdate();
 
     void analyticUpdate();
@@ -55,6 +58,14 @@ public:
     [[nodiscard]] float    getFilteredDeceleration()      const;
     [[nodiscard]] float    getDragCoefficient()      const;
 
+    /**
+     * @brief Builds the polyUpdate() feature vector from velocity and acceleration.
+     * @note When to use: shared with the offline fitting tool so the training
+     *       features always match what runs on the flight computer.
+     */
+    static std::array<float, ApogeePolyCoefficients::kFeatureCount>
+    polyFeatures(float velocity_mps, float acceleration_mps2);
+
 
 private:
     const VerticalVelocityEstimator& vve_;
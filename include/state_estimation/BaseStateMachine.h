@@ -9,6 +9,17 @@
 #include "state_estimation/StateEstimationTypes.h"
 #include "state_estimation/States.h"
 
+/**
+ * @brief When state-entry callbacks run.
+ * Immediate: inside changeState(), i.e. inside update() (default).
+ * Deferred: changeState() only queues them; the application runs them later
+ *           with dispatchPendingEvents(), outside the sensor-critical path.
+ */
+enum class CallbackDispatch : uint8_t {
+    Immediate,
+    Deferred,
+};
+
 /**
  * @brief Base class for flight state machines driven by IMU/altimeter data.
  * @note When to use: derive a concrete state machine to map sensor inputs to
@@ -22,6 +33,7 @@ class BaseStateMachine {
         using StateEntryCallback = void (*)();
 
         static constexpr std::size_t kMaxStateEntryCallbacks = 32;
+        static constexpr std::size_t kMaxPendingEvents = 32;
 
         explicit BaseStateMachine(FlightState initialState = STATE_UNARMED);
         virtual ~BaseStateMachine() = default;
@@ -46,10 +58,46 @@ class BaseStateMachine {
          * @brief Register a callback to invoke each time a target state is entered.
          * @param targetState The state that triggers the callback.
          * @param functionPtr Function to call when entering @p targetState.
+         * @param priority Deferred dispatch order, higher runs first; equal
+         *        priorities run in the order their events were queued.
+         *        Immediate dispatch always uses registration order.
          * @return true if callback was registered, false for nullptr, duplicate,
          *         or full callback buffer.
          */
-        bool registerOnStateEntry(FlightState targetState, StateEntryCallback functionPtr);
+        bool registerOnStateEntry(FlightState targetState, StateEntryCallback functionPtr, uint8_t priority = 0);
+
+        /**
+         * @brief Choose whether state-entry callbacks run inside update() or from dispatchPendingEvents().
+         * @note When to use: select Deferred when callbacks do heavy work (pyro arming,
+         *       flash metadata writes, telemetry bursts) that must not stretch the
+         *       sensor loop. Events already queued stay queued when switching back.
+         */
+        void setCallbackDispatch(CallbackDispatch mode) { dispatchMode_ = mode; }
+        CallbackDispatch getCallbackDispatch() const { return dispatchMode_; }
+
+        /**
+         * @brief Run every queued state-entry callback, highest priority first.
+         * @return Number of callbacks run.
+         * @note When to use: call from the main loop at a point where the
+         *       application can afford the callbacks' work (e.g. after sensor
+         *       reads and logging). Does nothing in Immediate mode unless
+         *       events were queued before switching.
+         */
+        std::size_t dispatchPendingEvents();
+
+        std::size_t getPendingEventCount() const { return pendingCount_; }
+
+        /**
+         * @brief Callbacks dropped because the pending queue was full.
+         */
+        uint32_t getDroppedEventCount() const { return droppedEvents_; }
+
+        /**
+         * @brief Time from the state change to the start of its callback, in microseconds.
+         */
+        uint32_t getLastEventLatency_us() const { return lastEventLatency_us_; }
+        uint32_t getMaxEventLatency_us() const { return maxEventLatency_us_; }
+        void resetEventStats();
 
         static constexpr std::size_t getMaxStateEntryCallbacks() {
             return kMaxStateEntryCallbacks;
@@ -72,11 +120,29 @@ class BaseStateMachine {
         struct StateCallbackRegistration {
             FlightState state;
             StateEntryCallback functionPtr;
+            uint8_t priority;
         };
 
+        struct PendingEvent {
+            StateEntryCallback functionPtr;
+            uint8_t priority;
+            uint32_t sequence;    // queue order, breaks priority ties
+            uint32_t queuedAt_us;
+        };
+
+        void queueEvent(const StateCallbackRegistration& registration);
+
         FlightState state_;
         std::size_t callbackCount_ = 0;
         std::array<StateCallbackRegistration, kMaxStateEntryCallbacks> onStateEntryCallbacks_{};
+
+        CallbackDispatch dispatchMode_ = CallbackDispatch::Immediate;
+        std::size_t pendingCount_ = 0;
+        std::array<PendingEvent, kMaxPendingEvents> pendingEvents_{};
+        uint32_t nextSequence_ = 0;
+        uint32_t droppedEvents_ = 0;
+        uint32_t lastEventLatency_us_ = 0;
+        uint32_t maxEventLatency_us_ = 0;
 };
 
 #endif
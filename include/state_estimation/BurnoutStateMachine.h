@@ -1,21 +1,20 @@
 #ifndef BASM_STATE_MACHINE_H
 #define BASM_STATE_MACHINE_H
 
-#include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
 
 #include "state_estimation/ApogeeDetector.h"
-#include "state_estimation/BaseStateMachine.h"
 #include "state_estimation/LaunchDetector.h"
-#include "state_estimation/StateEstimationTypes.h"
-#include "state_estimation/States.h"
+#include "state_estimation/TableStateMachine.h"
+#include "state_estimation/VerticalVelocityEstimator.h"
 
 /**
  * @brief State machine variant that explicitly models motor burnout before coast.
  * @note When to use: flights requiring a distinct burnout phase separate from
  *       powered ascent and coast, originally designed for aerobrake testing.
+ *       The transitions are a TableStateMachine profile in BurnoutStateMachine.cpp.
  */
-class BurnoutStateMachine : public BaseStateMachine {
+class BurnoutStateMachine : public TableStateMachine {
   public:
     /**
      * @brief Construct with logging and detector dependencies.
@@ -27,21 +26,6 @@ class BurnoutStateMachine : public BaseStateMachine {
      */
     BurnoutStateMachine(IDataSaver* dataSaver, LaunchDetector* launchDetector, ApogeeDetector* apogeeDetector,
       VerticalVelocityEstimator* verticalVelocityEstimator);
-
-    /**
-     * @brief Update machine with new sensor inputs and transition on burnout cues.
-     * @param accel Latest acceleration readings.
-     * @param alt   Latest altitude sample.
-     * @note When to use: call each sensor update; return value can reflect
-     *       transition outcomes.
-     */
-    int update(const AccelerationTriplet& accel, const DataPoint& alt) override;
-
-  private:
-    IDataSaver* dataSaver_;
-    LaunchDetector* launchDetector_;
-    ApogeeDetector* apogeeDetector_;
-    VerticalVelocityEstimator* verticalVelocityEstimator_;
 };
 
 
@@ -0,0 +1,100 @@
+#ifndef DESCENT_DETECTOR_H
+#define DESCENT_DETECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/CircularArray.h"
+#include "data_handling/DataPoint.h"
+#include "state_estimation/VerticalVelocityEstimator.h"
+
+constexpr std::size_t kDescentWindowSlots = 20;
+static_assert(kDescentWindowSlots <= kMaxCircularArrayCapacity,
+              "DescentDetector window allocation must fit CircularArray's uint8_t max size");
+
+/**
+ * @brief Detects parachute deployments and landing from windowed statistics
+ *        of the VerticalVelocityEstimator outputs.
+ *
+ * Estimated velocity and altitude are sampled every windowInterval_ms into
+ * fixed windows of kDescentWindowSlots samples. Once a window is full:
+ *   - Drogue: the window is stable (velocity spread below stableSpread_mps)
+ *     while descending faster than kMinDrogueDescentRate_mps. Free fall after
+ *     apogee changes velocity by ~10 m/s every second, so it is never stable.
+ *   - Main: after drogue, a stable window with a descent rate below
+ *     mainRateRatio times the fastest stable drogue descent rate.
+ *   - Landed: |mean velocity| below landedSpeed_mps and altitude spread below
+ *     landedAltitudeSpread_m, held for landedHold_ms.
+ * Each event latches until reset().
+ *
+ * @note When to use: after apogee, to move the state machine through the
+ *       deployment and landed states (see StateMachine) and throttle logging
+ *       during long recovery waits.
+ */
+class DescentDetector {
+public:
+    static constexpr float kMinDrogueDescentRate_mps = 5.0F;
+
+    /**
+     * @param windowInterval_ms Time between window samples; the window spans
+     *        kDescentWindowSlots * windowInterval_ms (1 s by default).
+     * @param stableSpread_mps Max velocity spread in a window for a steady descent under canopy.
+     * @param mainRateRatio Main is detected when the descent rate drops below this fraction of the drogue rate.
+     * @param landedSpeed_mps Max |mean velocity| for a landed window.
+     * @param landedAltitudeSpread_m Max altitude spread for a landed window.
+     * @param landedHold_ms How long the landed condition must hold.
+     */
+    explicit DescentDetector(uint16_t windowInterval_ms = 50,
+                             float stableSpread_mps = 3.0F,
+                             float mainRateRatio = 0.6F,
+                             float landedSpeed_mps = 1.0F,
+                             float landedAltitudeSpread_m = 2.0F,
+                             uint32_t landedHold_ms = 5000);
+
+    /**
+     * @brief Sample the estimator. Calls faster than windowInterval_ms are ignored.
+     * @param verticalVelocityEstimator Estimator already updated with the latest sample.
+     */
+    void update(VerticalVelocityEstimator* verticalVelocityEstimator);
+
+    bool isDrogueDeployed() const { return drogueDeployed_; }
+    bool isMainDeployed() const { return mainDeployed_; }
+    bool isLanded() const { return landed_; }
+
+    /** @brief Timestamps (ms) at which each event was detected; 0 if not detected. */
+    uint32_t getDrogueDeployedTime() const { return drogueTime_ms_; }
+    uint32_t getMainDeployedTime() const { return mainTime_ms_; }
+    uint32_t getLandedTime() const { return landedTime_ms_; }
+
+    /** @brief Mean descent rate (positive down) over the last full window, in m/s. */
+    float getDescentRate_mps() const { return descentRate_mps_; }
+
+    void reset();
+
+private:
+    uint16_t windowInterval_ms_;
+    float stableSpread_mps_;
+    float mainRateRatio_;
+    float landedSpeed_mps_;
+    float landedAltitudeSpread_m_;
+    uint32_t landedHold_ms_;
+
+    CircularArray<float, kDescentWindowSlots> velocityWindow_;
+    CircularArray<float, kDescentWindowSlots> altitudeWindow_;
+    bool hasSample_ = false;
+    uint32_t lastSample_ms_ = 0;
+
+    float descentRate_mps_ = 0.0F;
+    float drogueDescentRate_mps_ = 0.0F;   // fastest stable descent rate seen under drogue
+    bool landedCandidate_ = false;
+    uint32_t landedCandidateStart_ms_ = 0;
+
+    bool drogueDeployed_ = false;
+    bool mainDeployed_ = false;
+    bool landed_ = false;
+    uint32_t drogueTime_ms_ = 0;
+    uint32_t mainTime_ms_ = 0;
+    uint32_t landedTime_ms_ = 0;
+};
+
+#endif // DESCENT_DETECTOR_H
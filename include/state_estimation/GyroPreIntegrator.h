@@ -0,0 +1,66 @@
+#ifndef GYRO_PRE_INTEGRATOR_H
+#define GYRO_PRE_INTEGRATOR_H
+
+#include <cstdint>
+
+#include "state_estimation/StateEstimationTypes.h"
+
+/**
+ * @brief Accumulates gyro samples at the IMU's native rate into a single rotation vector.
+ *
+ * Each sample adds a trapezoidal delta-angle plus a coning correction
+ * (Savage's single-sample-plus-previous form):
+ *
+ *      dTheta_k = 0.5 * (w_{k-1} + w_k) * dt
+ *      beta    += 0.5 * (alpha + dTheta_{k-1} / 6) x dTheta_k
+ *      alpha   += dTheta_k
+ *
+ * so rotation that happens between orientation updates is not lost, and
+ * non-commuting rotation (coning) is captured. Per sample this is a handful
+ * of float multiply/adds; no trigonometry.
+ *
+ * Only attitude is pre-integrated. Sculling (the velocity counterpart) is not
+ * needed because no estimator integrates body-frame velocity increments.
+ *
+ * @note When to use: call addSample() for every gyro read and pass consume()
+ *       to OrientationEstimator::update() at the (lower) orientation rate.
+ */
+class GyroPreIntegrator {
+public:
+    GyroPreIntegrator();
+
+    /**
+     * @brief Add one gyro sample (rad/s). The sample time is taken from gyro.x.timestamp_ms.
+     * The first sample only establishes the time base. Samples that are not newer
+     * than the previous one are ignored.
+     */
+    void addSample(const GyroTriplet& gyro);
+
+    /**
+     * @brief Return the rotation accumulated since the last consume() and start a new interval.
+     * The interval starts where the previous one ended, so no rotation is dropped.
+     */
+    RotationDelta consume();
+
+    /** @brief Number of sample intervals accumulated since the last consume() */
+    uint16_t getSampleCount() const { return sampleCount_; }
+
+    /** @brief Forget all state, including the time base. */
+    void reset();
+
+private:
+    // Accumulated delta-angle (alpha) and coning correction (beta), rad
+    float alphaX_, alphaY_, alphaZ_; //NOLINT(readability-isolate-declaration)
+    float betaX_, betaY_, betaZ_; //NOLINT(readability-isolate-declaration)
+
+    // Previous delta-angle and rate, for the coning term and the trapezoid
+    float prevDeltaX_, prevDeltaY_, prevDeltaZ_; //NOLINT(readability-isolate-declaration)
+    float prevRateX_, prevRateY_, prevRateZ_; //NOLINT(readability-isolate-declaration)
+
+    uint32_t intervalStart_ms_;
+    uint32_t lastSample_ms_;
+    uint16_t sampleCount_;
+    bool hasTimeBase_;
+};
+
+#endif // GYRO_PRE_INTEGRATOR_H
@@ -1,10 +1,23 @@
 #ifndef ORIENTATION_ESTIMATOR_H
 #define ORIENTATION_ESTIMATOR_H
 
+#include <cstdint>
+
 #include "data_handling/DataPoint.h"
 #include "state_estimation/StateEstimationTypes.h"
 #include "state_estimation/States.h"
 
+/**
+ * @brief Integration scheme used for the in-flight (pure gyro) attitude update.
+ * - Exponential: exact rotation for a constant rate over dt; accurate at high spin rates
+ *   and low update rates.
+ * - FirstOrder: q += qDot * dt followed by renormalization (legacy behavior).
+ */
+enum class GyroIntegrator : uint8_t {
+    Exponential,
+    FirstOrder
+};
+
 /**
  * @brief Orientation estimator using Madgwick's algorithm for sensor fusion.
  * 
@@ -15,10 +28,12 @@
  */
 class OrientationEstimator {
 public:
-    OrientationEstimator(float gainPad = 0.05f, float gainFlight = 0.005f)
+    OrientationEstimator(float gainPad = 0.05f, float gainFlight = 0.005f,
+                         GyroIntegrator integrator = GyroIntegrator::Exponential)
         : q0(1.0f), q1(0.0f), q2(0.0f), q3(0.0f),
           betaPad(gainPad), betaFlight(gainFlight),
-          roll(0.0f), pitch(0.0f), yaw(0.0f), hasLaunched(false), lastUpdateTime(0) {}
+          roll(0.0f), pitch(0.0f), yaw(0.0f), eulerStale(false), hasLaunched(false), lastUpdateTime(0),
+          gyroIntegrator(integrator) {}
 
     /**
      * @brief Update the orientation estimator with new sensor data.
@@ -26,29 +41,46 @@ public:
      * Calls updateFullAHRS or updateIMU when on pad, directly updates orientation estimate
      * from gyro data only when in flight.
      * @param accel Acceleration triplet (x, y, z) in m/s^2
-     * @param gyro Gyroscope triplet (x, y, z) in degrees/s
+     * @param gyro Gyroscope triplet (x, y, z) in rad/s
      * @param mag Magnetometer triplet (x, y, z) in microteslas
      * @param currentTime Current timestamp in milliseconds
      */
     void update(AccelerationTriplet accel, GyroTriplet gyro, MagTriplet mag, uint32_t currentTime);
 
+    /**
+     * @brief Update the orientation estimator with a rotation pre-integrated by GyroPreIntegrator.
+     * In flight the accumulated rotation (including coning) is applied directly, so
+     * orientation can run slower than the IMU without losing rotation between calls.
+     * On the pad the mean rate over the interval is fed to the AHRS filter.
+     * Does nothing if the delta holds no samples.
+     * @param accel Acceleration triplet (x, y, z) in m/s^2
+     * @param rotation Rotation accumulated since the previous call
+     * @param mag Magnetometer triplet (x, y, z) in microteslas
+     */
+    void update(AccelerationTriplet accel, const RotationDelta& rotation, MagTriplet mag);
+
     Quaternion getQuaternion() const{
         Quaternion q = {q0, q1, q2, q3};
         return q;
     }
     void launchDetected() { hasLaunched = true;}
-    float getRoll() const { return roll; }
-    float getPitch() const { return pitch; }
-    float getYaw() const { return yaw; }
+    void setGyroIntegrator(GyroIntegrator integrator) { gyroIntegrator = integrator; }
+    GyroIntegrator getGyroIntegrator() const { return gyroIntegrator; }
+    // Euler angles are computed on first access after an update, not at IMU rate
+    float getRoll() const { refreshEuler(); return roll; }
+    float getPitch() const { refreshEuler(); return pitch; }
+    float getYaw() const { refreshEuler(); return yaw; }
     
 private:
     float q0, q1, q2, q3;   // quaternion
     float betaPad;
     float betaFlight;
     float beta; // determines how much the algorithm relies on the accelerometer vs the gyroscope. Higher beta means more reliance on accel.
-    float roll, pitch, yaw; // Euler angles in degrees
+    mutable float roll, pitch, yaw; // Euler angles in degrees, cached from the quaternion
+    mutable bool eulerStale; // true when the quaternion changed since roll/pitch/yaw were computed
     bool hasLaunched;
     uint32_t lastUpdateTime;   // timestamp of the last update in milliseconds
+    GyroIntegrator gyroIntegrator; // scheme used by the pure gyro path
 
     /**
      * @brief Update the orientation estimate using the full AHRS algorithm (gyro + accel + mag).
@@ -71,12 +103,32 @@ private:
      */
     void updateIMU(AccelerationTriplet accel, GyroTriplet gyro, uint32_t currentTime);
 
+    /**
+     * @brief Rotate the quaternion by a body-frame rotation vector (rad), q = q * exp(rotation / 2).
+     * Exact for a constant angular rate over the interval, so accuracy does not degrade
+     * with spin rate or a lower update rate. Uses a Taylor series for tiny angles.
+     */
+    void integrateRotationVector(float rotX, float rotY, float rotZ);
+
+    /**
+     * @brief Legacy first-order integration q += 0.5 * q * omega * dt, then renormalize.
+     */
+    void integrateFirstOrder(float gyroX, float gyroY, float gyroZ, float dt);
+
     /*
     * @brief Compute Euler angles (roll, pitch, yaw) from the current quaternion estimate.
-    * This is called every update to keep the Euler angles in sync with the quaternion.
+    * Called lazily through refreshEuler() so the trigonometry runs at the rate the angles are read,
+    * not at the IMU update rate.
     * The Euler angles are in degrees and follow the aerospace convention (roll around x-axis, pitch around y-axis, yaw around z-axis).
     */
-    void getEuler();
+    void getEuler() const;
+
+    void refreshEuler() const {
+        if (eulerStale) {
+            getEuler();
+            eulerStale = false;
+        }
+    }
 };
 
 
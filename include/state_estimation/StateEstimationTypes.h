@@ -1,6 +1,8 @@
 #ifndef STATE_ESTIMATION_TYPES_H
 #define STATE_ESTIMATION_TYPES_H
 
+#include <cstdint>
+
 #include "data_handling/DataPoint.h"
 
 struct AccelerationTriplet {
@@ -21,6 +23,19 @@ struct MagTriplet {
     DataPoint z;
 };
 
+/**
+ * @brief Body-frame rotation accumulated between two instants, as a rotation vector in radians.
+ * Produced by GyroPreIntegrator and consumed by OrientationEstimator.
+ */
+struct RotationDelta {
+    float x;
+    float y;
+    float z;
+    uint32_t startTime_ms;
+    uint32_t endTime_ms;
+    uint16_t sampleCount;
+};
+
 struct alignas(16) Quaternion {
     float w;
     float x;
@@ -1,21 +1,22 @@
 #ifndef FLIGHT_STATE_MACHINE_H
 #define FLIGHT_STATE_MACHINE_H
 
-#include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
 #include "state_estimation/ApogeeDetector.h"
-#include "state_estimation/BaseStateMachine.h"
+#include "state_estimation/DescentDetector.h"
 #include "state_estimation/FastLaunchDetector.h"
 #include "state_estimation/LaunchDetector.h"
-#include "state_estimation/States.h"
+#include "state_estimation/TableStateMachine.h"
 #include "state_estimation/VerticalVelocityEstimator.h"
 
 /**
  * @brief Nominal flight state machine using launch/apogee detection and VVE.
  * @note When to use: standard flights where launch->coast->descent transitions
  *       are driven by detectors and logging is desired at each change.
+ *       With a DescentDetector it continues through drogue, main and landed.
+ *       The transitions are a TableStateMachine profile in StateMachine.cpp.
  */
-class StateMachine : public BaseStateMachine {
+class StateMachine : public TableStateMachine {
   public: 
     /**
      * @brief Wire dependencies for the state machine.
@@ -23,27 +24,15 @@ class StateMachine : public BaseStateMachine {
      * @param launchDetector Launch detector instance.
      * @param apogeeDetector Apogee detector instance.
      * @param verticalVelocityEstimator Vertical velocity estimator instance.
+     * @param fastLaunchDetector Fast launch detector instance.
+     * @param descentDetector Deployment/landing detector. Without it the machine
+     *        stays in DESCENT after apogee and runs no estimators there, as before.
      * @note When to use: build once during setup with already configured
      *       estimator/detector instances.
      */
     StateMachine(IDataSaver* dataSaver, LaunchDetector* launchDetector, ApogeeDetector* apogeeDetector, 
-                 VerticalVelocityEstimator* verticalVelocityEstimator, FastLaunchDetector* fastLaunchDetector);
-
-    /**
-     * @brief Process new sensor data and transition states if thresholds are met.
-     * @param accel Latest acceleration measurements.
-     * @param alt   Latest altitude sample.
-     * @note When to use: call on every control loop iteration.
-     */
-    int update(const AccelerationTriplet& accel, const DataPoint& alt) override;
-
-  private:
-    IDataSaver* dataSaver_;
-    LaunchDetector* launchDetector_;
-    ApogeeDetector* apogeeDetector_;
-    VerticalVelocityEstimator* verticalVelocityEstimator_;
-    FastLaunchDetector* fastLaunchDetector_;
-    uint32_t fldLaunchTime_ms_ = 0;
+                 VerticalVelocityEstimator* verticalVelocityEstimator, FastLaunchDetector* fastLaunchDetector,
+                 DescentDetector* descentDetector = nullptr);
 };
 
 
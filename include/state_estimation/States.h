@@ -27,4 +27,7 @@ enum FlightState : uint8_t {
     STATE_LANDED,           // 9
 };
 
+// Number of FlightState values, for tables indexed by state. Keep equal to the last state + 1.
+constexpr uint8_t kFlightStateCount = static_cast<uint8_t>(STATE_LANDED) + 1U;
+
 #endif
\ No newline at end of file
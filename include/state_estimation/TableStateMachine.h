@@ -0,0 +1,170 @@
+#ifndef TABLE_STATE_MACHINE_H
+#define TABLE_STATE_MACHINE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaver.h"
+#include "state_estimation/ApogeeDetector.h"
+#include "state_estimation/BaseStateMachine.h"
+#include "state_estimation/DescentDetector.h"
+#include "state_estimation/FastLaunchDetector.h"
+#include "state_estimation/LaunchDetector.h"
+#include "state_estimation/StateEstimationTypes.h"
+#include "state_estimation/States.h"
+#include "state_estimation/VerticalVelocityEstimator.h"
+
+/**
+ * @brief Conditions a transition row can wait on.
+ * Evaluated by TableStateMachine with a switch; detectors missing from the
+ * machine make their guards false.
+ */
+enum class TransitionGuard : uint8_t {
+    LaunchDetected,          // LaunchDetector::isLaunched()
+    FastLaunchDetected,      // FastLaunchDetector::hasLaunched()
+    FastLaunchWindowExpired, // FLD confirmation window passed without LaunchDetector confirmation
+    ApogeeDetected,          // ApogeeDetector::isApogeeDetected()
+    Coasting,                // VVE inertial vertical acceleration <= 0
+    DrogueDeployed,          // DescentDetector::isDrogueDeployed()
+    MainDeployed,            // DescentDetector::isMainDeployed()
+    Landed,                  // DescentDetector::isLanded()
+};
+
+/**
+ * @brief Estimator updates to run while in a state (bit flags).
+ * They run in the order listed here, before the state's guards are checked.
+ * The fast launch detector is skipped once the launch detector has fired, so
+ * it never sees the sample that launches the machine into ASCENT.
+ */
+namespace StateUpdate {
+constexpr uint8_t kNone = 0U;
+constexpr uint8_t kLaunchDetector = 1U << 0U;
+constexpr uint8_t kFastLaunchDetector = 1U << 1U;
+constexpr uint8_t kVerticalVelocity = 1U << 2U;
+constexpr uint8_t kApogeeDetector = 1U << 3U;
+constexpr uint8_t kDescentDetector = 1U << 4U;
+}  // namespace StateUpdate
+
+/**
+ * @brief Side effects of taking a transition (bit flags).
+ * They run in the order listed here, after the state has changed and the
+ * on-entry callbacks have been dispatched.
+ */
+namespace TransitionAction {
+constexpr uint16_t kNone = 0U;
+constexpr uint16_t kRecordFastLaunchTime = 1U << 0U;      // remember the FLD launch time for the window guard
+constexpr uint16_t kResetFastLaunch = 1U << 1U;           // forget the FLD launch and reset the detector
+constexpr uint16_t kLogStateChange = 1U << 2U;            // save STATE_CHANGE with the new state
+constexpr uint16_t kSaverLaunchAtLaunchTime = 1U << 3U;   // dataSaver->launchDetected(LaunchDetector time)
+constexpr uint16_t kSaverLaunchAtFastLaunch = 1U << 4U;   // dataSaver->launchDetected(FastLaunchDetector time)
+constexpr uint16_t kClearPostLaunchMode = 1U << 5U;       // dataSaver->clearPostLaunchMode()
+constexpr uint16_t kInitApogeeDetector = 1U << 6U;        // apogeeDetector->init() at the current altitude
+constexpr uint16_t kUpdateVerticalVelocity = 1U << 7U;    // one VVE update with the current sample
+constexpr uint16_t kSaverLandingDetected = 1U << 8U;      // dataSaver->landingDetected(DescentDetector time)
+constexpr uint16_t kLogStateChangeAtY = 1U << 9U;         // like kLogStateChange, stamped with accel.y's timestamp
+}  // namespace TransitionAction
+
+/**
+ * @brief One row of a transition table: in @p from, when @p guard holds, go to @p to and run @p actions.
+ * Rows for the same state must be adjacent; they are checked in table order and the first match wins.
+ */
+struct StateTransition {
+    FlightState from;
+    TransitionGuard guard;
+    FlightState to;
+    uint16_t actions;
+};
+
+/**
+ * @brief Estimator updates run every update() while in @p state.
+ * Every state the profile can be in must be listed, even with StateUpdate::kNone.
+ */
+struct StateUpdates {
+    FlightState state;
+    uint8_t updates;
+};
+
+/**
+ * @brief A complete flight profile as data. The tables must outlive the machine
+ *        (define them as constexpr arrays at namespace scope).
+ */
+struct FlightProfile {
+    FlightState initialState;
+    const StateTransition* transitions;
+    uint8_t transitionCount;
+    const StateUpdates* states;
+    uint8_t stateCount;
+};
+
+/**
+ * @brief Flight state machine engine driven by a declarative FlightProfile.
+ *
+ * At construction the profile is flattened into per-state row ranges and
+ * update masks, so update() is a fixed sequence of switch dispatches over the
+ * current state's rows: no virtual calls inside the engine, no allocation, and
+ * a loop bound equal to the table size. The worst-case update() time seen in
+ * each state is recorded for timing budgets.
+ *
+ * @note When to use: define a new flight profile (dual deploy, airstart, ...)
+ *       as a transition table instead of writing another update() switch.
+ */
+class TableStateMachine : public BaseStateMachine {
+  public:
+    /**
+     * @param profile Flight profile tables.
+     * @param dataSaver Logger used to persist state changes.
+     * @param launchDetector Launch detector instance.
+     * @param apogeeDetector Apogee detector instance.
+     * @param verticalVelocityEstimator Vertical velocity estimator instance.
+     * @param fastLaunchDetector Optional fast launch detector (nullptr if unused).
+     * @param descentDetector Optional deployment/landing detector (nullptr if unused).
+     */
+    TableStateMachine(const FlightProfile& profile, IDataSaver* dataSaver, LaunchDetector* launchDetector,
+                      ApogeeDetector* apogeeDetector, VerticalVelocityEstimator* verticalVelocityEstimator,
+                      FastLaunchDetector* fastLaunchDetector = nullptr, DescentDetector* descentDetector = nullptr);
+
+    /**
+     * @brief Run the current state's estimator updates, then take the first transition whose guard holds.
+     * @return 0 on success, 1 if the current state is not part of the profile,
+     *         2 if the profile failed validation at construction.
+     */
+    int update(const AccelerationTriplet& accel, const DataPoint& alt) override;
+
+    /**
+     * @brief False when the profile tables were malformed (e.g. rows for a state not adjacent).
+     */
+    bool isProfileValid() const { return profileValid_; }
+
+    /**
+     * @brief Longest update() seen while in @p state, in microseconds.
+     */
+    uint32_t getWorstCaseUpdateTime_us(FlightState state) const;
+
+    void resetUpdateTimes();
+
+  private:
+    void runStateUpdates(uint8_t updates, const AccelerationTriplet& accel, const DataPoint& alt);
+    bool isGuardSatisfied(TransitionGuard guard, const AccelerationTriplet& accel);
+    void runActions(uint16_t actions, FlightState newState, const AccelerationTriplet& accel, const DataPoint& alt);
+
+    const StateTransition* transitions_;
+    IDataSaver* dataSaver_;
+    LaunchDetector* launchDetector_;
+    ApogeeDetector* apogeeDetector_;
+    VerticalVelocityEstimator* verticalVelocityEstimator_;
+    FastLaunchDetector* fastLaunchDetector_;
+    DescentDetector* descentDetector_;
+    uint32_t fldLaunchTime_ms_ = 0;
+    bool profileValid_ = true;
+
+    // Flattened profile, indexed by FlightState
+    std::array<uint8_t, kFlightStateCount> firstRow_{};
+    std::array<uint8_t, kFlightStateCount> rowCount_{};
+    std::array<uint8_t, kFlightStateCount> stateUpdates_{};
+    std::array<bool, kFlightStateCount> stateKnown_{};
+    std::array<uint32_t, kFlightStateCount> worstUpdate_us_{};
+};
+
+#endif
@@ -0,0 +1,323 @@
+#include "data_handling/BinaryLogFormat.h"
+
+#include "data_handling/Crc.h"
+#include "data_handling/DataNames.h"
+#include "state_estimation/States.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+struct NamedValue {
+    uint8_t value;
+    const char* name;
+};
+
+#define NAMED_VALUE(name) {static_cast<uint8_t>(name), #name}
+
+// Keep in sync with DataNames.h
+const NamedValue kChannels[] = {
+    NAMED_VALUE(ACCELEROMETER_X), NAMED_VALUE(ACCELEROMETER_Y), NAMED_VALUE(ACCELEROMETER_Z),
+    NAMED_VALUE(GYROSCOPE_X), NAMED_VALUE(GYROSCOPE_Y), NAMED_VALUE(GYROSCOPE_Z),
+    NAMED_VALUE(TEMPERATURE), NAMED_VALUE(PRESSURE), NAMED_VALUE(ALTITUDE),
+    NAMED_VALUE(MAGNETOMETER_X), NAMED_VALUE(MAGNETOMETER_Y), NAMED_VALUE(MAGNETOMETER_Z),
+    NAMED_VALUE(MEDIAN_ACCELERATION_SQUARED), NAMED_VALUE(AVERAGE_CYCLE_RATE), NAMED_VALUE(NUM_PACKETS_SENT),
+    NAMED_VALUE(TIMESTAMP), NAMED_VALUE(STATE_CHANGE), NAMED_VALUE(CURRENT_STATE), NAMED_VALUE(FLIGHT_ID),
+    NAMED_VALUE(EST_APOGEE), NAMED_VALUE(EST_VERTICAL_VELOCITY), NAMED_VALUE(EST_ALTITUDE),
+    NAMED_VALUE(TIME_TO_APOGEE), NAMED_VALUE(ROLL), NAMED_VALUE(PITCH), NAMED_VALUE(YAW),
+    NAMED_VALUE(BATTERY_VOLTAGE), NAMED_VALUE(FIN_DEPLOYMENT_AMOUNT),
+};
+
+// Keep in sync with States.h
+const NamedValue kStates[] = {
+    NAMED_VALUE(STATE_UNARMED), NAMED_VALUE(STATE_ARMED), NAMED_VALUE(STATE_SOFT_ASCENT),
+    NAMED_VALUE(STATE_ASCENT), NAMED_VALUE(STATE_POWERED_ASCENT), NAMED_VALUE(STATE_COAST_ASCENT),
+    NAMED_VALUE(STATE_DESCENT), NAMED_VALUE(STATE_DROGUE_DEPLOYED), NAMED_VALUE(STATE_MAIN_DEPLOYED),
+    NAMED_VALUE(STATE_LANDED),
+};
+
+#undef NAMED_VALUE
+
+// Append a table; returns the new offset, or 0 if it does not fit
+template <std::size_t N>
+std::size_t encodeTable(const NamedValue (&table)[N], uint8_t* out, std::size_t offset) {
+    out[offset++] = static_cast<uint8_t>(N);
+    for (const NamedValue& entry : table) {
+        const std::size_t length = std::strlen(entry.name);
+        if (offset + 2U + length > kBinaryLogHeaderCapacity_bytes) {
+            return 0;
+        }
+        out[offset++] = entry.value;
+        out[offset++] = static_cast<uint8_t>(length);
+        std::memcpy(out + offset, entry.name, length);
+        offset += length;
+    }
+    return offset;
+}
+
+// Parse a table into `names`; returns the new offset, or 0 if it runs past `size`
+template <std::size_t N>
+std::size_t parseTable(const uint8_t* data, std::size_t size, std::size_t offset,
+                       std::array<std::array<char, 32>, N>& names) {
+    if (offset >= size) {
+        return 0;
+    }
+    const uint8_t count = data[offset++];
+    for (uint8_t i = 0; i < count; i++) {
+        if (offset + 2U > size) {
+            return 0;
+        }
+        const uint8_t value = data[offset];
+        const std::size_t length = data[offset + 1U];
+        offset += 2U;
+        if (offset + length > size) {
+            return 0;
+        }
+        if (value < N) {
+            const std::size_t copied = length < 31U ? length : 31U;
+            std::memcpy(names[value].data(), data + offset, copied);
+            names[value][copied] = '\0';
+        }
+        offset += length;
+    }
+    return offset;
+}
+
+// Size of the record at @p record, or 0 if it runs past @p remaining bytes
+std::size_t recordSize(const uint8_t* record, std::size_t remaining) {
+    if (remaining < 2U) {
+        return 0;
+    }
+    std::size_t size = (record[1] == kBinaryDeltaEscape) ? 6U : 2U;
+    if (record[0] == kBinaryVectorRecord) {
+        if (remaining < size + 2U) {
+            return 0;
+        }
+        size += 2U + static_cast<std::size_t>(record[size + 1U]) * sizeof(float);
+    } else {
+        size += sizeof(float);
+    }
+    return size <= remaining ? size : 0U;
+}
+
+uint16_t blockCrc(const uint8_t* block, std::size_t payloadLength_bytes) {
+    const uint16_t crc = crc16Ccitt(block, offsetof(BinaryBlockHeader_t, crc16));
+    return crc16Ccitt(block + sizeof(BinaryBlockHeader_t), payloadLength_bytes, crc);
+}
+
+} // namespace
+
+std::size_t encodeBinaryLogHeader(uint8_t* out) {
+    std::memset(out, 0, kBinaryLogHeaderCapacity_bytes);
+    std::size_t offset = encodeTable(kChannels, out, sizeof(BinaryLogHeader_t));
+    if (offset == 0U || offset >= kBinaryLogHeaderCapacity_bytes) {
+        return 0;
+    }
+    offset = encodeTable(kStates, out, offset);
+    if (offset == 0U) {
+        return 0;
+    }
+
+    const std::size_t blocks = (offset + kBinaryBlockSize_bytes - 1U) / kBinaryBlockSize_bytes;
+    const BinaryLogHeader_t header = {kBinaryLogMagic, kBinaryLogVersion, static_cast<uint16_t>(kBinaryBlockSize_bytes),
+                                      static_cast<uint16_t>(blocks)};
+    std::memcpy(out, &header, sizeof(header));
+    return blocks * kBinaryBlockSize_bytes;
+}
+
+void BinaryBlockWriter::reset() {
+    block_.fill(0U);
+    length_ = sizeof(BinaryBlockHeader_t);
+    recordCount_ = 0;
+    finished_ = false;
+}
+
+uint8_t* BinaryBlockWriter::beginRecord(uint32_t timestamp_ms, uint8_t name, std::size_t bodySize) {
+    if (finished_) {
+        reset();
+    }
+    if (recordCount_ == 0U) {
+        firstTimestamp_ms_ = timestamp_ms;
+        lastTimestamp_ms_ = timestamp_ms;
+    }
+
+    const bool escaped = timestamp_ms < lastTimestamp_ms_ || timestamp_ms - lastTimestamp_ms_ >= kBinaryDeltaEscape;
+    const std::size_t size = 2U + (escaped ? sizeof(timestamp_ms) : 0U) + bodySize;
+    if (length_ + size > kBinaryBlockSize_bytes) {
+        return nullptr;
+    }
+
+    uint8_t* out = block_.data() + length_;
+    *out++ = name;
+    if (escaped) {
+        *out++ = kBinaryDeltaEscape;
+        std::memcpy(out, &timestamp_ms, sizeof(timestamp_ms));
+        out += sizeof(timestamp_ms);
+    } else {
+        *out++ = static_cast<uint8_t>(timestamp_ms - lastTimestamp_ms_);
+    }
+
+    length_ += size;
+    recordCount_++;
+    lastTimestamp_ms_ = timestamp_ms;
+    return out;
+}
+
+bool BinaryBlockWriter::append(uint32_t timestamp_ms, uint8_t name, float value) {
+    uint8_t* out = beginRecord(timestamp_ms, name, sizeof(value));
+    if (out == nullptr) {
+        return false;
+    }
+    std::memcpy(out, &value, sizeof(value));
+    return true;
+}
+
+bool BinaryBlockWriter::appendVector(uint32_t timestamp_ms, uint8_t name, const float* values, uint8_t count) {
+    uint8_t* out = beginRecord(timestamp_ms, kBinaryVectorRecord, 2U + static_cast<std::size_t>(count) * sizeof(float));
+    if (out == nullptr) {
+        return false;
+    }
+    *out++ = name;
+    *out++ = count;
+    std::memcpy(out, values, static_cast<std::size_t>(count) * sizeof(float));
+    return true;
+}
+
+const uint8_t* BinaryBlockWriter::finish() {
+    BinaryBlockHeader_t header = {kBinaryBlockMagic, recordCount_, sequence_, firstTimestamp_ms_,
+                                  static_cast<uint16_t>(length_ - sizeof(BinaryBlockHeader_t)), 0U};
+    std::memcpy(block_.data(), &header, sizeof(header));
+    header.crc16 = blockCrc(block_.data(), header.payloadLength_bytes);
+    std::memcpy(block_.data(), &header, sizeof(header));
+    sequence_++;
+    finished_ = true;
+    return block_.data();
+}
+
+int BinaryLogDecoder::parseHeader(const uint8_t* data, std::size_t size_bytes) {
+    BinaryLogHeader_t header = {};
+    if (size_bytes < sizeof(header)) {
+        return -1;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    // Version 1 is the same format without vector records
+    if (header.magic != kBinaryLogMagic || header.version == 0U || header.version > kBinaryLogVersion ||
+        header.blockSize_bytes != kBinaryBlockSize_bytes || header.headerBlocks == 0U) {
+        return -1;
+    }
+    const std::size_t headerSize = static_cast<std::size_t>(header.headerBlocks) * kBinaryBlockSize_bytes;
+    if (headerSize > size_bytes) {
+        return -1;
+    }
+
+    std::size_t offset = parseTable(data, headerSize, sizeof(header), channelNames_);
+    if (offset == 0U || parseTable(data, headerSize, offset, stateNames_) == 0U) {
+        return -1;
+    }
+    headerBlocks_ = header.headerBlocks;
+    return 0;
+}
+
+int BinaryLogDecoder::decodeBlock(const uint8_t* block) {
+    BinaryBlockHeader_t header = {};
+    std::memcpy(&header, block, sizeof(header));
+    if (header.magic != kBinaryBlockMagic) {
+        return 1;
+    }
+    if (header.payloadLength_bytes > kBinaryBlockPayload_bytes ||
+        blockCrc(block, header.payloadLength_bytes) != header.crc16) {
+        badBlocks_++;
+        return -1;
+    }
+
+    // Validate the whole block before emitting anything from it
+    const uint8_t* payload = block + sizeof(BinaryBlockHeader_t);
+    const std::size_t length = header.payloadLength_bytes;
+    std::size_t offset = 0;
+    uint16_t count = 0;
+    while (offset < length) {
+        const std::size_t size = recordSize(payload + offset, length - offset);
+        if (size == 0U) {
+            break;
+        }
+        offset += size;
+        count++;
+    }
+    if (offset != length || count != header.recordCount) {
+        badBlocks_++;
+        return -1;
+    }
+
+    uint32_t timestamp_ms = header.firstTimestamp_ms;
+    offset = 0;
+    while (offset < length) {
+        const uint8_t name = payload[offset];
+        const uint8_t delta = payload[offset + 1U];
+        offset += 2U;
+        if (delta == kBinaryDeltaEscape) {
+            std::memcpy(&timestamp_ms, payload + offset, sizeof(timestamp_ms));
+            offset += sizeof(timestamp_ms);
+        } else {
+            timestamp_ms += delta;
+        }
+
+        DecodedRecord record = {timestamp_ms, name, 0.0F};
+        uint8_t values = 1;
+        if (name == kBinaryVectorRecord) {
+            record.name = payload[offset];
+            values = payload[offset + 1U];
+            offset += 2U;
+        }
+        for (uint8_t i = 0; i < values; i++) {
+            std::memcpy(&record.value, payload + offset, sizeof(record.value));
+            offset += sizeof(record.value);
+            sink_.onRecord(record);
+            record.name++;
+            records_++;
+        }
+    }
+    blocks_++;
+    return 0;
+}
+
+int BinaryLogDecoder::decodeLog(const uint8_t* data, std::size_t size_bytes) {
+    if (parseHeader(data, size_bytes) != 0) {
+        return -1;
+    }
+    for (std::size_t offset = static_cast<std::size_t>(headerBlocks_) * kBinaryBlockSize_bytes;
+         offset + kBinaryBlockSize_bytes <= size_bytes; offset += kBinaryBlockSize_bytes) {
+        decodeBlock(data + offset);
+    }
+    return 0;
+}
+
+std::size_t BinaryLogDecoder::findBlock(const uint8_t* data, std::size_t size_bytes, uint32_t timestamp_ms) const {
+    const std::size_t first = static_cast<std::size_t>(headerBlocks_) * kBinaryBlockSize_bytes;
+    if (size_bytes < first + kBinaryBlockSize_bytes) {
+        return first;
+    }
+
+    // Unwritten blocks at the end sort after every timestamp
+    std::size_t low = 0;
+    std::size_t high = (size_bytes - first) / kBinaryBlockSize_bytes;
+    while (high - low > 1U) {
+        const std::size_t middle = low + (high - low) / 2U;
+        BinaryBlockHeader_t header = {};
+        std::memcpy(&header, data + first + middle * kBinaryBlockSize_bytes, sizeof(header));
+        if (header.magic == kBinaryBlockMagic && header.firstTimestamp_ms <= timestamp_ms) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return first + low * kBinaryBlockSize_bytes;
+}
+
+const char* BinaryLogDecoder::getChannelName(uint8_t name) const {
+    return channelNames_[name][0] != '\0' ? channelNames_[name].data() : nullptr;
+}
+
+const char* BinaryLogDecoder::getStateName(uint8_t state) const {
+    return state < stateNames_.size() && stateNames_[state][0] != '\0' ? stateNames_[state].data() : nullptr;
+}
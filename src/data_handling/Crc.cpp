@@ -0,0 +1,26 @@
+#include "data_handling/Crc.h"
+
+// Bitwise rather than table-driven: no 512 B / 1 KB tables in RAM, and a
+// 256-byte page still checksums in a few microseconds.
+
+uint16_t crc16Ccitt(const uint8_t* data, std::size_t length, uint16_t crc) {
+    for (std::size_t i = 0; i < length; ++i) {
+        crc = static_cast<uint16_t>(crc ^ (static_cast<uint16_t>(data[i]) << 8));
+        for (uint8_t bit = 0; bit < 8U; ++bit) {
+            const auto shifted = static_cast<uint16_t>(static_cast<uint32_t>(crc) << 1);
+            crc = (crc & 0x8000U) != 0U ? static_cast<uint16_t>(shifted ^ 0x1021U) : shifted;
+        }
+    }
+    return crc;
+}
+
+uint32_t crc32(const uint8_t* data, std::size_t length, uint32_t crc) {
+    crc = ~crc;
+    for (std::size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8U; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,159 @@
+#include "data_handling/CsvFormat.h"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kFixed6Scale = 1000000;
+constexpr uint32_t kLimbBase = 1000000000;  // Nine decimal digits per limb
+constexpr std::size_t kLimbCount = 5;       // 45 digits, enough for FLT_MAX
+
+// Two-digit lookup so each division by 100 yields two characters
+constexpr char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Write exactly @p digits digits of @p value, zero padded
+void formatPadded(uint32_t value, std::size_t digits, char* out) {
+    std::size_t pos = digits;
+    while (pos >= 2U) {
+        const uint32_t pair = (value % 100U) * 2U;
+        value /= 100U;
+        out[--pos] = kDigitPairs[pair + 1U];
+        out[--pos] = kDigitPairs[pair];
+    }
+    if (pos == 1U) {
+        out[0] = static_cast<char>('0' + value % 10U);
+    }
+}
+
+std::size_t digitCount(uint32_t value) {
+    std::size_t digits = 1;
+    while (value >= 10U) {
+        value /= 10U;
+        digits++;
+    }
+    return digits;
+}
+
+std::size_t formatUnsigned64(uint64_t value, char* out) {
+    if (value <= UINT32_MAX) {
+        return formatUnsigned(static_cast<uint32_t>(value), out);
+    }
+    const auto low = static_cast<uint32_t>(value % kLimbBase);
+    const std::size_t length = formatUnsigned64(value / kLimbBase, out);
+    formatPadded(low, 9, out + length);
+    return length + 9U;
+}
+
+// mantissa * 2^shift for shifts past 64 bits, in base-1e9 limbs (only floats >= 2^64)
+std::size_t formatShifted(uint32_t mantissa, int shift, char* out) {
+    std::array<uint32_t, kLimbCount> limbs = {};  // Least significant first
+    limbs[0] = mantissa;
+    while (shift > 0) {
+        const int step = shift < 20 ? shift : 20;  // limb * 2^20 stays below 2^64
+        uint64_t carry = 0;
+        for (uint32_t& limb : limbs) {
+            const uint64_t product = (static_cast<uint64_t>(limb) << step) + carry;
+            limb = static_cast<uint32_t>(product % kLimbBase);
+            carry = product / kLimbBase;
+        }
+        shift -= step;
+    }
+
+    std::size_t top = kLimbCount - 1U;
+    while (top > 0U && limbs[top] == 0U) {
+        top--;
+    }
+    std::size_t length = formatUnsigned(limbs[top], out);
+    while (top > 0U) {
+        formatPadded(limbs[--top], 9, out + length);
+        length += 9U;
+    }
+    return length;
+}
+
+} // namespace
+
+std::size_t formatUnsigned(uint32_t value, char* out) {
+    const std::size_t digits = digitCount(value);
+    formatPadded(value, digits, out);
+    return digits;
+}
+
+std::size_t formatFixed6(float value, char* out) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    std::size_t length = 0;
+    if ((bits >> 31U) != 0U) {
+        out[length++] = '-';
+    }
+    const uint32_t exponentBits = (bits >> 23U) & 0xFFU;
+    uint32_t mantissa = bits & 0x7FFFFFU;
+
+    if (exponentBits == 0xFFU) {
+        std::memcpy(out + length, mantissa == 0U ? "inf" : "nan", 3);
+        return length + 3U;
+    }
+
+    // |value| = mantissa * 2^exponent exactly
+    int exponent = -149;
+    if (exponentBits != 0U) {
+        mantissa |= 0x800000U;
+        exponent = static_cast<int>(exponentBits) - 150;
+    }
+
+    if (exponent >= 0) {
+        if (exponent <= 40) {
+            length += formatUnsigned64(static_cast<uint64_t>(mantissa) << exponent, out + length);
+        } else {
+            length += formatShifted(mantissa, exponent, out + length);
+        }
+        std::memcpy(out + length, ".000000", 7);
+        return length + 7U;
+    }
+
+    // Split into integer and fraction; fraction = fractionBits / 2^shift
+    const auto shift = static_cast<unsigned>(-exponent);
+    uint32_t integer = 0;
+    uint64_t fractionBits = mantissa;
+    if (shift < 32U) {
+        integer = mantissa >> shift;
+        fractionBits = mantissa & ((1U << shift) - 1U);
+    }
+
+    // fractionBits < 2^24, so the scaled numerator fits in 44 bits
+    const uint64_t scaled = fractionBits * kFixed6Scale;
+    uint64_t decimals = 0;
+    bool roundUp = false;
+    if (shift < 64U) {
+        decimals = scaled >> shift;
+        const uint64_t remainder = scaled - (decimals << shift);
+        const uint64_t half = 1ULL << (shift - 1U);
+        roundUp = remainder > half || (remainder == half && (decimals & 1U) != 0U);
+    }
+    if (roundUp) {
+        decimals++;
+        if (decimals == kFixed6Scale) {
+            decimals = 0;
+            integer++;
+        }
+    }
+
+    length += formatUnsigned(integer, out + length);
+    out[length++] = '.';
+    formatPadded(static_cast<uint32_t>(decimals), 6, out + length);
+    return length + 6U;
+}
+
+std::size_t formatCsvLine(uint32_t timestamp_ms, uint8_t name, float value, char* out) {
+    std::size_t length = formatUnsigned(timestamp_ms, out);
+    out[length++] = ',';
+    length += formatUnsigned(name, out + length);
+    out[length++] = ',';
+    length += formatFixed6(value, out + length);
+    out[length++] = '\n';
+    return length;
+}
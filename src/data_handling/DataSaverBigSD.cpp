@@ -1,9 +1,15 @@
 #include "data_handling/DataSaverBigSD.h"
 #include "ArduinoHAL.h"   // for Serial
+#include "data_handling/CsvFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
 
 // one SdFat object for all
-/* static */ SdFat DataSaverBigSD::sd_; //NOLINT(readability-identifier-length)      
-    
+/* static */ SdFat DataSaverBigSD::sd_; //NOLINT(readability-identifier-length)
+
 /* ------------------------------------------------------------------------- */
 DataSaverBigSD::DataSaverBigSD(uint8_t csPin) : csPin_(csPin) {}
 
@@ -11,24 +17,44 @@ DataSaverBigSD::DataSaverBigSD(uint8_t csPin) : csPin_(csPin) {}
 bool DataSaverBigSD::begin() {
     Serial.print(F("Init SD… "));
     pinMode(csPin_, OUTPUT);
-    if (!sd_.begin(csPin_, SD_SCK_MHZ(40))) {     // 40 MHz on ESP32‑S3
+    if (!sd_.begin(csPin_, SD_SCK_MHZ(40))) {     // 40 MHz on ESP32‑S3
         Serial.println(F("fail"));
         return false;
     }
 
-    filePath_ = nextFreeFilePath();
-    if (!file_.open(filePath_.c_str(), O_WRITE | O_CREAT)) {
+    const bool binary = (format_ == BigSDLogFormat::kBinary);
+    extension_ = binary ? ".bin" : ".csv";
+    filePath_ = nextFreeFilePath(extension_);
+    basePath_ = filePath_.substr(0, filePath_.size() - std::strlen(extension_));
+
+    ringHead_ = 0;
+    ringTail_ = 0;
+    active_ = 0;
+    segment_ = 0;
+    segmentWritten_bytes_ = 0;
+    segmentCut_bytes_ = 0;
+    nextSegmentReady_ = false;
+    serviced_ = false;
+    largestSaveWrite_bytes_ = 0;
+
+    if (!openSegment(files_[active_], 0)) {
         Serial.println(F("file create fail"));
         return false;
     }
 
-    // Pre‑allocate 4 MiB so writes stay contiguous (faster & less wear)
-    file_.preAllocate(kPreAllocateSize_MiB * kBytesPerMiB_bytes);
+    if (binary) {
+        // Header blocks are whole sectors, so data blocks stay sector aligned
+        std::array<uint8_t, kBinaryLogHeaderCapacity_bytes> header; //NOLINT(cppcoreguidelines-pro-type-member-init)
+        const std::size_t headerLength = encodeBinaryLogHeader(header.data()); // NOLINT(cppcoreguidelines-init-variables)
+        if (headerLength == 0U || !pushToRing(header.data(), headerLength)) {
+            Serial.println(F("header write fail"));
+            return false;
+        }
+        block_ = BinaryBlockWriter();
+    }
 
     Serial.print(F("Logging to ")); Serial.println(filePath_.c_str());
 
-    bufLen_ = 0;
-    linesPending_ = 0;
     lastFlushMs_ = static_cast<uint32_t>(millis());
     lastSyncMs_ = lastFlushMs_;
     ready_ = true;
@@ -41,77 +67,355 @@ int DataSaverBigSD::saveDataPoint(const DataPoint& dataPoint, uint8_t name) {
         return DS_NOT_READY;
     }
 
-    // Reserve space left
-    size_t remaining = sizeof(buf_) - bufLen_; // NOLINT(cppcoreguidelines-init-variables)
+    const auto now = static_cast<uint32_t>(millis());
+    const int result = bufferDataPoint(dataPoint, name, now); // NOLINT(cppcoreguidelines-init-variables)
+    if (result != DS_SUCCESS) {
+        return result;
+    }
 
-    // Format the new line
-    int numCharsWritten = snprintf(buf_ + bufLen_, remaining, "%lu,%u,%.6f\n", // NOLINT(cppcoreguidelines-init-variables)
-                     static_cast<long unsigned int>(dataPoint.timestamp_ms), name, static_cast<double>(dataPoint.data));
+    // Applications that never call service() get the old inline behavior
+    if (!serviced_) {
+        return housekeeping(now);
+    }
+    return DS_SUCCESS;
+}
 
-    // Check snprintf result
-    if (numCharsWritten <= 0 || (size_t)numCharsWritten >= remaining) {
-        // Flush current buffer and try again if this line couldn’t fit
-        if (file_.write(buf_, bufLen_) != bufLen_) {
-          return DS_BUFFER_WRITE_FAILED;  // failed to write current buffer
-        }
-        file_.sync();  // just to be extra safe during debug
-        bufLen_ = 0;
-        linesPending_ = 0;
+int DataSaverBigSD::saveDataPoints(const NamedDataPoint* points, size_t count) {
+    if (!ready_) {
+        return DS_NOT_READY;
+    }
 
-        // Try again (safe now)
-        remaining = sizeof(buf_);
-        numCharsWritten = snprintf(buf_, remaining, "%lu,%u,%.6f\n", static_cast<long unsigned int>(dataPoint.timestamp_ms), name, static_cast<double>(dataPoint.data));
-        if (numCharsWritten <= 0 || (size_t)numCharsWritten >= remaining) {
-          return DS_LINE_TOO_LONG;  // can't encode this line even in an empty buffer
+    const auto now = static_cast<uint32_t>(millis());
+    for (size_t i = 0; i < count; i++) {
+        const int result = bufferDataPoint(points[i].dataPoint, points[i].name, now); // NOLINT(cppcoreguidelines-init-variables)
+        if (result != DS_SUCCESS) {
+            return result;
         }
     }
 
-    const auto numCharsWritten_u16 = static_cast<uint16_t>(numCharsWritten);
-    bufLen_ = static_cast<uint16_t>(bufLen_ + numCharsWritten_u16);
-    ++linesPending_;
+    if (!serviced_) {
+        return housekeeping(now);
+    }
+    return DS_SUCCESS;
+}
+
+int DataSaverBigSD::saveDataVector(const DataVector& vector, uint8_t name) {
+    if (!ready_) {
+        return DS_NOT_READY;
+    }
 
     const auto now = static_cast<uint32_t>(millis());
-    bool const bufFull = (bufLen_ >= kBufSize_bytes);
-    bool const manyLines = (linesPending_ >= kFlushLines);
-    bool const timeUp = (now - lastFlushMs_ >= kFlushMs);
+    if (format_ == BigSDLogFormat::kBinary) {
+        if (block_.isEmpty()) {
+            blockStartMs_ = now;
+        }
+        if (!block_.appendVector(vector.timestamp_ms, name, vector.data.data(), vector.size)) {
+            if (!pushBinaryBlock()) {
+                return DS_BUFFER_WRITE_FAILED;
+            }
+            blockStartMs_ = now;
+            block_.appendVector(vector.timestamp_ms, name, vector.data.data(), vector.size);
+        }
+        if (writeFullChunk() != DS_SUCCESS) {
+            return DS_FLUSH_FAILED;
+        }
+    } else {
+        // CSV keeps one line per channel, so the text matches per-axis saves
+        for (uint8_t i = 0; i < vector.size; i++) {
+            const int result = bufferDataPoint(vector.at(i), static_cast<uint8_t>(name + i), now); // NOLINT(cppcoreguidelines-init-variables)
+            if (result != DS_SUCCESS) {
+                return result;
+            }
+        }
+    }
+
+    if (!serviced_) {
+        return housekeeping(now);
+    }
+    return DS_SUCCESS;
+}
 
-    if (bufFull || manyLines || timeUp) {
-        if (file_.write(buf_, bufLen_) != bufLen_) {
-          return DS_FLUSH_FAILED;
+int DataSaverBigSD::bufferDataPoint(const DataPoint& dataPoint, uint8_t name, uint32_t now) {
+    const int result = (format_ == BigSDLogFormat::kBinary) ? saveBinary(dataPoint, name, now) // NOLINT(cppcoreguidelines-init-variables)
+                                                            : saveCsv(dataPoint, name);
+    if (result != DS_SUCCESS) {
+        return result;
+    }
+    return writeFullChunk();
+}
+
+int DataSaverBigSD::writeFullChunk() {
+    // One aligned multi-sector write once a whole chunk is buffered
+    if (ringHead_ - ringTail_ >= kWriteChunk_bytes) {
+        const uint32_t before = ringTail_;
+        if (writeSectors(kWriteChunk_bytes) != DS_SUCCESS) {
+            return DS_FLUSH_FAILED;
+        }
+        const uint32_t written = ringTail_ - before;
+        largestSaveWrite_bytes_ = written > largestSaveWrite_bytes_ ? written : largestSaveWrite_bytes_;
+    }
+    return DS_SUCCESS;
+}
+
+/* ----------------------------  service()  -------------------------------- */
+int DataSaverBigSD::service() {
+    if (!ready_) {
+        return DS_NOT_READY;
+    }
+    serviced_ = true;
+    return housekeeping(static_cast<uint32_t>(millis()));
+}
+
+int DataSaverBigSD::housekeeping(uint32_t now) {
+    // Same data-loss window as before: a partly filled binary block goes out after kFlushMs
+    if (format_ == BigSDLogFormat::kBinary && !block_.isEmpty() && now - blockStartMs_ >= kFlushMs) {
+        if (!pushBinaryBlock()) {
+            return DS_FLUSH_FAILED;
+        }
+    }
+
+    if (now - lastFlushMs_ >= kFlushMs) {
+        while (ringHead_ - ringTail_ >= kSectorSize_bytes) {
+            if (writeSectors(kWriteChunk_bytes) != DS_SUCCESS) {
+                return DS_FLUSH_FAILED;
+            }
         }
-        bufLen_ = 0;
-        linesPending_ = 0;
         lastFlushMs_ = now;
+    }
 
-        if (now - lastSyncMs_ >= kSyncInterval_ms) {
-            file_.sync();
-            lastSyncMs_ = now;
+    if (now - lastSyncMs_ >= kSyncInterval_ms) {
+        if (writeTail() != DS_SUCCESS) {
+            return DS_FLUSH_FAILED;
         }
+        files_[active_].sync();
+        lastSyncMs_ = now;
+    }
+
+    // Switch here rather than in the next save, which would have to sync and close the full one
+    if (segmentWritten_bytes_ >= kSegmentSize_bytes && !switchSegment()) {
+        return DS_FLUSH_FAILED;
+    }
+    if (!nextSegmentReady_ && segmentWritten_bytes_ + kSegmentHeadroom_bytes >= kSegmentSize_bytes) {
+        if (!prepareNextSegment()) {
+            return DS_FLUSH_FAILED;
+        }
+    }
+    return DS_SUCCESS;
+}
+
+/* ---------------------------  ring buffer  ------------------------------- */
+bool DataSaverBigSD::pushToRing(const uint8_t* data, size_t length) {
+    if (ringHead_ - ringTail_ + length > kRingSize_bytes) {
+        return false;
     }
+    const uint32_t offset = ringHead_ % kRingSize_bytes;
+    const size_t first = (length < kRingSize_bytes - offset) ? length : kRingSize_bytes - offset; // NOLINT(cppcoreguidelines-init-variables)
+    std::memcpy(ring_ + offset, data, first);
+    std::memcpy(ring_, data + first, length - first);
+    ringHead_ += static_cast<uint32_t>(length);
+    return true;
+}
 
-    return 0;
+bool DataSaverBigSD::makeRoom(size_t length) {
+    if (ringHead_ - ringTail_ + length <= kRingSize_bytes) {
+        return true;
+    }
+    // Only reached if chunks could not be written earlier
+    return writeSectors(kWriteChunk_bytes) == DS_SUCCESS && ringHead_ - ringTail_ + length <= kRingSize_bytes;
 }
 
+int DataSaverBigSD::saveCsv(const DataPoint& dataPoint, uint8_t name) {
+    if (!makeRoom(kMaxCsvLineLength_bytes)) {
+        return DS_BUFFER_WRITE_FAILED;
+    }
+
+    // Same text as "%lu,%u,%.6f\n", without going through printf; formatted in place unless it would wrap
+    const uint32_t offset = ringHead_ % kRingSize_bytes;
+    if (kRingSize_bytes - offset >= kMaxCsvLineLength_bytes) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        ringHead_ += static_cast<uint32_t>(formatCsvLine(dataPoint.timestamp_ms, name, dataPoint.data, reinterpret_cast<char*>(ring_ + offset)));
+        return DS_SUCCESS;
+    }
+    std::array<char, kMaxCsvLineLength_bytes> line; //NOLINT(cppcoreguidelines-pro-type-member-init)
+    const std::size_t length = formatCsvLine(dataPoint.timestamp_ms, name, dataPoint.data, line.data()); // NOLINT(cppcoreguidelines-init-variables)
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    pushToRing(reinterpret_cast<const uint8_t*>(line.data()), length);
+    return DS_SUCCESS;
+}
+
+int DataSaverBigSD::saveBinary(const DataPoint& dataPoint, uint8_t name, uint32_t now) {
+    if (block_.isEmpty()) {
+        blockStartMs_ = now;
+    }
+    if (!block_.append(dataPoint.timestamp_ms, name, dataPoint.data)) {
+        if (!pushBinaryBlock()) {
+            return DS_BUFFER_WRITE_FAILED;
+        }
+        blockStartMs_ = now;
+        block_.append(dataPoint.timestamp_ms, name, dataPoint.data);
+    }
+    return DS_SUCCESS;
+}
+
+bool DataSaverBigSD::pushBinaryBlock() {
+    // Check for room first: finish() starts a new block, so a failed push would lose this one
+    if (!makeRoom(kBinaryBlockSize_bytes)) {
+        return false;
+    }
+    return pushToRing(block_.finish(), kBinaryBlockSize_bytes);
+}
+
+/* ---------------------------  card writes  ------------------------------- */
+int DataSaverBigSD::writeSectors(uint32_t maxBytes) {
+    if (segmentWritten_bytes_ >= kSegmentSize_bytes && !switchSegment()) {
+        return DS_BUFFER_WRITE_FAILED;
+    }
+
+    // Whole sectors only, contiguous in the ring and within the segment
+    const uint32_t offset = ringTail_ % kRingSize_bytes;
+    uint32_t length = (ringHead_ - ringTail_) / kSectorSize_bytes * kSectorSize_bytes;
+    if (length > maxBytes) {
+        length = maxBytes;
+    }
+    if (length > kRingSize_bytes - offset) {
+        length = kRingSize_bytes - offset;
+    }
+    if (length > kSegmentSize_bytes - segmentWritten_bytes_) {
+        length = kSegmentSize_bytes - segmentWritten_bytes_;
+    }
+    if (length == 0U) {
+        return DS_SUCCESS;
+    }
+
+    SdFile_t& file = files_[active_];
+    file.seekSet(segmentWritten_bytes_);  // Overwrites a tail written by writeTail()
+    if (file.write(ring_ + offset, length) != static_cast<int>(length)) {
+        return DS_BUFFER_WRITE_FAILED;
+    }
+    segmentWritten_bytes_ += length;
+
+    // A CSV segment ends after its last whole line; the rest of that line stays
+    // in the ring for the next segment, and closeActiveSegment() trims it here
+    uint32_t keep = length;
+    if (format_ == BigSDLogFormat::kCsv && segmentWritten_bytes_ == kSegmentSize_bytes) {
+        while (keep > 0U && ring_[offset + keep - 1U] != '\n') {
+            keep--;
+        }
+        if (keep == 0U) {
+            keep = length;  // No line break in the whole write; cannot happen with CSV lines
+        }
+        segmentCut_bytes_ = length - keep;
+    }
+    ringTail_ += keep;
+    return DS_SUCCESS;
+}
+
+int DataSaverBigSD::writeTail() {
+    const uint32_t length = ringHead_ - ringTail_;
+    if (length == 0U) {
+        return DS_SUCCESS;
+    }
+    if (segmentWritten_bytes_ >= kSegmentSize_bytes && !switchSegment()) {
+        return DS_BUFFER_WRITE_FAILED;
+    }
+
+    // Less than a sector (whole sectors are written first), possibly wrapping in the ring
+    const uint32_t offset = ringTail_ % kRingSize_bytes;
+    const uint32_t first = (length < kRingSize_bytes - offset) ? length : kRingSize_bytes - offset; // NOLINT(cppcoreguidelines-init-variables)
+    SdFile_t& file = files_[active_];
+    file.seekSet(segmentWritten_bytes_);
+    if (file.write(ring_ + offset, first) != static_cast<int>(first)) {
+        return DS_BUFFER_WRITE_FAILED;
+    }
+    if (length > first && file.write(ring_, length - first) != static_cast<int>(length - first)) {
+        return DS_BUFFER_WRITE_FAILED;
+    }
+    return DS_SUCCESS;
+}
+
+/* -----------------------------  segments  -------------------------------- */
+std::string DataSaverBigSD::segmentPath(uint16_t segment) const {
+    if (segment == 0U) {
+        return basePath_ + extension_;
+    }
+    return basePath_ + "-" + std::to_string(segment) + extension_;
+}
+
+bool DataSaverBigSD::openSegment(SdFile_t& file, uint16_t segment) {
+    if (!file.open(segmentPath(segment).c_str(), O_WRITE | O_CREAT)) {
+        return false;
+    }
+    // Pre‑allocate the whole segment so writes stay contiguous (faster & less wear)
+    file.preAllocate(kSegmentSize_bytes);
+    return true;
+}
+
+bool DataSaverBigSD::prepareNextSegment() {
+    nextSegmentReady_ = openSegment(files_[active_ ^ 1U], static_cast<uint16_t>(segment_ + 1U));
+    return nextSegmentReady_;
+}
+
+bool DataSaverBigSD::switchSegment() {
+    // Normally prepared by service(); opening it here is the slow fallback
+    if (!nextSegmentReady_ && !prepareNextSegment()) {
+        return false;
+    }
+    closeActiveSegment();
+    active_ ^= 1U;
+    segment_++;
+    segmentWritten_bytes_ = 0;
+    nextSegmentReady_ = false;
+
+    // After a cut the ring tail is mid-sector. Rotate the ring (once per segment)
+    // so it is sector aligned again and writes stay whole sectors.
+    const uint32_t shift = (kSectorSize_bytes - ringTail_ % kSectorSize_bytes) % kSectorSize_bytes;
+    if (shift != 0U) {
+        std::rotate(ring_, ring_ + kRingSize_bytes - shift, ring_ + kRingSize_bytes);
+        ringTail_ += shift;
+        ringHead_ += shift;
+    }
+    return true;
+}
+
+void DataSaverBigSD::closeActiveSegment() {
+    SdFile_t& file = files_[active_];
+    if (segmentCut_bytes_ != 0U) {
+        file.truncate(kSegmentSize_bytes - segmentCut_bytes_);
+        segmentCut_bytes_ = 0;
+    }
+    file.sync();
+    file.close();
+}
 
 /* -----------------------------  end()  ----------------------------------- */
 void DataSaverBigSD::end() {
     if (!ready_) {
         return;
     }
-    if (bufLen_ > 0) {
-        file_.write(buf_, bufLen_);
-        bufLen_ = 0;
+    if (format_ == BigSDLogFormat::kBinary && !block_.isEmpty()) {
+        pushBinaryBlock();
+    }
+    while (ringHead_ - ringTail_ >= kSectorSize_bytes) {
+        if (writeSectors(kWriteChunk_bytes) != DS_SUCCESS) {
+            break;
+        }
+    }
+    writeTail();
+    closeActiveSegment();
+    if (nextSegmentReady_) {
+        // Prepared but never written
+        files_[active_ ^ 1U].close();
+        sd_.remove(segmentPath(static_cast<uint16_t>(segment_ + 1U)).c_str());
+        nextSegmentReady_ = false;
     }
-    file_.sync();
-    file_.close();
     ready_ = false;
 }
 
 /* -------------------  nextFreeFilePath()  -------------------------------- */
-std::string DataSaverBigSD::nextFreeFilePath() {
+std::string DataSaverBigSD::nextFreeFilePath(const char* extension) {
     std::array<char, kFilePathBufferSize> path;
     for (uint16_t flightNumber = 0;; ++flightNumber) {
-        snprintf(path.data(), sizeof(path), "/stream-%u.csv", flightNumber);
+        snprintf(path.data(), sizeof(path), "/stream-%u%s", flightNumber, extension);
         if (!sd_.exists(path.data())) {
             return std::string(path.data());
         }
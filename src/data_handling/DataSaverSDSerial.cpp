@@ -14,6 +14,9 @@ struct SerialData {
 // NOLINTEND(cppcoreguidelines-pro-type-member-init, hicpp-member-init)
 #pragma pack(pop)
 
+// 252 bytes, so a batch of records fits a typical 256-byte UART FIFO
+constexpr size_t kRecordsPerWrite = 21;
+
 
 /*
 * Saves the data to the SD card via serial
@@ -30,6 +33,52 @@ DataSaverSDSerial::DataSaverSDSerial(HardwareSerial &sdSerial) : sdSerial_(sdSer
 }
 
 int DataSaverSDSerial::saveDataPoint(const DataPoint& dataPoint, uint8_t name){
-    dataToSDCardSerial(name, dataPoint.timestamp_ms, dataPoint.data, sdSerial_);
+    if (format_ == SerialLogFormat::kRecords) {
+        dataToSDCardSerial(name, dataPoint.timestamp_ms, dataPoint.data, sdSerial_);
+        return 0;
+    }
+    if (!frame_.append(dataPoint.timestamp_ms, name, dataPoint.data)) {
+        flush();
+        frame_.append(dataPoint.timestamp_ms, name, dataPoint.data);
+    }
+    return 0;
+}
+
+int DataSaverSDSerial::saveDataPoints(const NamedDataPoint* points, size_t count) {
+    if (format_ == SerialLogFormat::kBatched) {
+        for (size_t i = 0; i < count; i++) {
+            const DataPoint& dataPoint = points[i].dataPoint;
+            if (!frame_.append(dataPoint.timestamp_ms, points[i].name, dataPoint.data)) {
+                flush();
+                frame_.append(dataPoint.timestamp_ms, points[i].name, dataPoint.data);
+            }
+        }
+        return 0;
+    }
+
+    // Stage records on the stack and send them in one write
+    std::array<SerialData, kRecordsPerWrite> staged; //NOLINT(cppcoreguidelines-pro-type-member-init)
+    size_t stagedCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        staged[stagedCount++] = {points[i].dataPoint.timestamp_ms, points[i].dataPoint.data, points[i].name, {{'\0', '\r', '\n'}}};
+        if (stagedCount == staged.size() || i + 1U == count) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            sdSerial_.write(reinterpret_cast<const uint8_t*>(staged.data()), stagedCount * sizeof(SerialData));
+            stagedCount = 0;
+        }
+    }
     return 0;
 }
+
+void DataSaverSDSerial::setFormat(SerialLogFormat format) {
+    flush();
+    format_ = format;
+}
+
+void DataSaverSDSerial::flush() {
+    std::array<uint8_t, kSerialFrameMaxEncoded_bytes> encoded; //NOLINT(cppcoreguidelines-pro-type-member-init)
+    const std::size_t length = frame_.finish(encoded.data()); // NOLINT(cppcoreguidelines-init-variables)
+    if (length > 0U) {
+        sdSerial_.write(encoded.data(), length);
+    }
+}
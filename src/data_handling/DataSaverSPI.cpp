@@ -1,9 +1,38 @@
 #include "data_handling/DataSaverSPI.h"
+#include "data_handling/Crc.h"
 #include "data_handling/DataNames.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <limits>
 
+namespace {
+
+// Spins until the flash lock is free. The holder keeps it for at most one
+// page write plus sector erase, or for a whole dump on the ground.
+class FlashLockGuard {
+public:
+    explicit FlashLockGuard(std::atomic_flag& lock) : lock_(lock) {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    ~FlashLockGuard() { lock_.clear(std::memory_order_release); }
+    FlashLockGuard(const FlashLockGuard&) = delete;
+    FlashLockGuard& operator=(const FlashLockGuard&) = delete;
+
+private:
+    std::atomic_flag& lock_;
+};
+
+// CRC of a page with a PageHeader_t, skipping the CRC field itself
+uint16_t pageCrc(const uint8_t* page) {
+    const uint16_t crc = crc16Ccitt(page, offsetof(PageHeader_t, crc16));
+    return crc16Ccitt(page + sizeof(PageHeader_t), DataSaverSPI::kBufferSize_bytes - sizeof(PageHeader_t), crc);
+}
+
+}  // namespace
+
 DataSaverSPI::DataSaverSPI(uint16_t timestampInterval_ms,
                            Adafruit_SPIFlash* flash)
     : timestampInterval_ms_(timestampInterval_ms),
@@ -18,23 +47,31 @@ DataSaverSPI::DataSaverSPI(uint16_t timestampInterval_ms,
   clearInternalState();
 }
 
-int DataSaverSPI::saveDataPoint(const DataPoint& dataPoint, uint8_t name) {
+int DataSaverSPI::prepareRecord(uint32_t timestamp_ms) {
   if (rebootedInPostLaunchMode_ || isChipFullDueToPostLaunchProtection_) {
     return 1;  // Do not save if writes are blocked by post-launch state.
   }
+  if (isLandedBudgetExhausted()) {
+    return stopForLandedBudget();
+  }
 
     // Write a timestamp automatically if enough time has passed since the last one
-    uint32_t const timestamp = dataPoint.timestamp_ms;
-    if (timestamp - lastTimestamp_ms_ > timestampInterval_ms_) {
-      int const timestampResult = saveTimestamp(timestamp);
-      if (timestampResult != 0) {
-        return timestampResult;
-      }
+    if (timestamp_ms - lastTimestamp_ms_ > timestampInterval_ms_) {
+      return saveTimestamp(timestamp_ms);
+    }
+    return 0;
+}
+
+int DataSaverSPI::saveDataPoint(const DataPoint& dataPoint, uint8_t name) {
+    int const prepareResult = prepareRecord(dataPoint.timestamp_ms);
+    if (prepareResult != 0) {
+      return prepareResult;
     }
 
     Record_t record = {name, dataPoint.data};
-    if (addRecordToBuffer(&record) != 0) {
-      if (isChipFullDueToPostLaunchProtection_) {
+    int const recordResult = addRecordToBuffer(&record);
+    if (recordResult != 0) {
+      if (recordResult > 0 || isChipFullDueToPostLaunchProtection_) {
         return 1;
       }
       return -1;
@@ -44,14 +81,96 @@ int DataSaverSPI::saveDataPoint(const DataPoint& dataPoint, uint8_t name) {
     return 0;
 }
 
+int DataSaverSPI::saveDataPoints(const NamedDataPoint* points, size_t count) {
+    size_t saved = 0;
+    while (saved < count) {
+      // Only a flush or a timestamp record can change the blocking state or the page
+      if (rebootedInPostLaunchMode_ || isChipFullDueToPostLaunchProtection_) {
+        break;
+      }
+      if (isLandedBudgetExhausted()) {
+        return stopForLandedBudget();
+      }
+      const int result = saveDataPoint(points[saved].dataPoint, points[saved].name);
+      if (result != 0) {
+        return result;
+      }
+      saved++;
+
+      // Straight into the open page while records fit and no timestamp is due
+      if (compressor_ != nullptr || bufferIndex_ == 0) {
+        continue;
+      }
+      while (saved < count && bufferIndex_ + sizeof(Record_t) <= payloadEnd() &&
+             points[saved].dataPoint.timestamp_ms - lastTimestamp_ms_ <= timestampInterval_ms_) {
+        uint8_t* out = buffer_ + bufferIndex_;
+        out[0] = points[saved].name;
+        memcpy(out + 1, &points[saved].dataPoint.data, sizeof(float));
+        bufferIndex_ += sizeof(Record_t);
+        saved++;
+      }
+      lastDataPoint_ = points[saved - 1U].dataPoint;
+    }
+    return saved == count ? 0 : 1;
+}
+
+int DataSaverSPI::saveDataVector(const DataVector& vector, uint8_t name) {
+    static_assert(kMaxDataVectorSize <= kMaxVectorRecordComponents, "A DataVector must fit one vector record");
+    if (vector.size < 2U || compressor_ != nullptr) {
+      // One component is an ordinary record, and compressed pages predict each channel on its own
+      for (size_t i = 0; i < vector.size; i++) {
+        const int componentResult = saveDataPoint(vector.at(i), static_cast<uint8_t>(name + i));
+        if (componentResult != 0) {
+          return componentResult;
+        }
+      }
+      return 0;
+    }
+
+    int const prepareResult = prepareRecord(vector.timestamp_ms);
+    if (prepareResult != 0) {
+      return prepareResult;
+    }
+
+    // Where the vector record would not fit, separate records fill the rest of the page
+    if (bufferIndex_ != 0U && bufferIndex_ + vectorRecordSize(vector.size) > payloadEnd()) {
+      for (size_t i = 0; i < vector.size; i++) {
+        const int componentResult = saveDataPoint(vector.at(i), static_cast<uint8_t>(name + i));
+        if (componentResult != 0) {
+          return componentResult;
+        }
+      }
+      return 0;
+    }
+
+    std::array<uint8_t, vectorRecordSize(kMaxVectorRecordComponents)> record; //NOLINT(cppcoreguidelines-pro-type-member-init)
+    record[0] = static_cast<uint8_t>(kVectorRecordName + vector.size);
+    record[1] = name;
+    memcpy(record.data() + 2, vector.data.data(), vector.size * sizeof(float));
+    int const recordResult = addDataToBuffer(record.data(), vectorRecordSize(vector.size));
+    if (recordResult != 0) {
+      if (recordResult > 0 || isChipFullDueToPostLaunchProtection_) {
+        return 1;
+      }
+      return -1;
+    }
+
+    lastDataPoint_ = vector.at(vector.size - 1U);
+    return 0;
+}
+
 int DataSaverSPI::saveTimestamp(uint32_t timestamp_ms){
     if (rebootedInPostLaunchMode_ || isChipFullDueToPostLaunchProtection_) {
       return 1;  // Do not save if writes are blocked by post-launch state.
     }
+    if (isLandedBudgetExhausted()) {
+      return stopForLandedBudget();
+    }
 
     TimestampRecord_t timeStampRecord = {TIMESTAMP, timestamp_ms};
-    if (addRecordToBuffer(&timeStampRecord) != 0) {
-      if (isChipFullDueToPostLaunchProtection_) {
+    int const recordResult = addRecordToBuffer(&timeStampRecord);
+    if (recordResult != 0) {
+      if (recordResult > 0 || isChipFullDueToPostLaunchProtection_) {
         return 1;
       }
       return -1;
@@ -62,11 +181,18 @@ int DataSaverSPI::saveTimestamp(uint32_t timestamp_ms){
 }
 
 int DataSaverSPI::addDataToBuffer(const uint8_t* data, size_t length) {
-    if (bufferIndex_ + length > kBufferSize_bytes) {
+    if (bufferIndex_ + length > payloadEnd()) {
         // Flush the buffer
         if (flushBuffer() < 0) {
           return -1;
         }
+        if (isLandedBudgetExhausted()) {
+          return 1;  // That page used up the budget; nothing would write this one out
+        }
+    }
+
+    if (bufferIndex_ == 0) {
+        openPage();
     }
 
     // Copy the data into the buffer
@@ -75,6 +201,62 @@ int DataSaverSPI::addDataToBuffer(const uint8_t* data, size_t length) {
     return 0;
 }
 
+int DataSaverSPI::addCompressedRecord(uint8_t name, uint32_t valueBits) {
+    const size_t offset = payloadOffset();
+    if (!compressor_->isPageOpen()) {
+        openPage();
+        compressor_->beginPage(buffer_ + offset, kBufferSize_bytes - offset, lastTimestamp_ms_);
+    }
+    if (!compressor_->append(name, valueBits)) {
+        if (flushBuffer() < 0) {
+          return -1;
+        }
+        if (isLandedBudgetExhausted()) {
+          return 1;
+        }
+        openPage();
+        compressor_->beginPage(buffer_ + offset, kBufferSize_bytes - offset, lastTimestamp_ms_);
+        if (!compressor_->append(name, valueBits)) {
+          return -1;  // A single record always fits an empty page
+        }
+    }
+    bufferIndex_ = offset + compressor_->getBytesUsed();
+    return 0;
+}
+
+void DataSaverSPI::openPage() {
+    pageFirstTimestamp_ms_[buffer_ == pages_[0] ? 0U : 1U] = lastTimestamp_ms_;
+    if (!pageHeaders_) {
+        return;
+    }
+    PageHeader_t const header = {kPageHeaderMagic, 0U, lastTimestamp_ms_, 0U};  // Sequence and CRC are set by writePage()
+    memcpy(buffer_, &header, sizeof(header));
+    bufferIndex_ = sizeof(header);
+}
+
+void DataSaverSPI::setPageHeadersEnabled(bool enabled) {
+    if (enabled == pageHeaders_) {
+        return;
+    }
+    flushBuffer();
+    waitForPendingFlush();  // The background context reads pageHeaders_ while writing
+    bufferIndex_ = 0;
+    closeCompressedPage();
+    pageHeaders_ = enabled;
+}
+
+void DataSaverSPI::setCompressor(FloatCompressor* compressor) {
+    if (compressor == compressor_) {
+        return;
+    }
+    flushBuffer();
+    // Whatever could not be flushed cannot be reinterpreted in the new format
+    bufferIndex_ = 0;
+    closeCompressedPage();
+    compressor_ = compressor;
+    closeCompressedPage();
+}
+
 uint32_t DataSaverSPI::normalizeDataAddress(uint32_t address) const {
     if (address >= flash_->size()) {
         return kDataStartAddress;
@@ -93,6 +275,7 @@ DataSaverSPI::SectorEraseResult DataSaverSPI::eraseSectorForWriteAndLatchOnProte
     uint32_t sectorNumber) {
     if (isProtectedLaunchSector(sectorNumber)) {
         isChipFullDueToPostLaunchProtection_ = true;
+        closeFlight();
         return SectorEraseResult::kProtectedSectorLatched;
     }
     if (!flash_->eraseSector(sectorNumber)) {
@@ -113,15 +296,55 @@ bool DataSaverSPI::shouldStopForPostLaunchWindow() {
         return false;
     }
     isChipFullDueToPostLaunchProtection_ = true;
+    closeFlight();
     return true;
 }
 
-// Write the entire buffer to flash.
+// Write the entire buffer to flash, or queue it for serviceFlush().
 int DataSaverSPI::flushBuffer() {
     if (bufferIndex_ == 0) {
         return 1;  // Nothing to flush
     }
 
+    if (compressor_ != nullptr) {
+        compressor_->finishPage();
+    } else {
+        // Records vary in length, so mark where they end instead of leaving an older page's bytes
+        memset(buffer_ + bufferIndex_, kEmptyPageValue, kBufferSize_bytes - bufferIndex_);
+    }
+
+    if (!backgroundFlush_) {
+        int result = 0;
+        {
+            FlashLockGuard const guard(flashLock_);
+            result = writePage(buffer_);
+            if (result == 0 && isLandedBudgetExhausted()) {
+                closeFlight();  // Nothing more will be written for this flight
+            }
+        }
+        if (result != 0) {
+            return result;
+        }
+        bufferIndex_ = 0; // Reset the buffer
+        closeCompressedPage();
+        return 0;
+    }
+
+    if (pagePending_.load(std::memory_order_acquire)) {
+        // Both buffers are full: the background context fell behind
+        flushOverruns_++;
+        waitForPendingFlush();
+    }
+
+    pendingPage_ = buffer_;
+    pagePending_.store(true, std::memory_order_release);
+    buffer_ = (buffer_ == pages_[0]) ? pages_[1] : pages_[0];
+    bufferIndex_ = 0;
+    closeCompressedPage();
+    return 0;
+}
+
+int DataSaverSPI::writePage(uint8_t* page) {
     // If the next write would go past the end of the flash, wrap around to the beginning of the data section.
     if (nextWriteAddress_ + kBufferSize_bytes > flash_->size()) {
         nextWriteAddress_ = kDataStartAddress;
@@ -144,10 +367,25 @@ int DataSaverSPI::flushBuffer() {
         }
     }
 
+    if (pageHeaders_) {
+        PageHeader_t header = {};
+        memcpy(&header, page, sizeof(header));
+        header.sequence = pageSequence_;
+        memcpy(page, &header, sizeof(header));
+        header.crc16 = pageCrc(page);
+        memcpy(page, &header, sizeof(header));
+    }
+
     // Write 1 page of data.
-    if (!flash_->writeBuffer(nextWriteAddress_, buffer_, kBufferSize_bytes)) {
+    if (!flash_->writeBuffer(nextWriteAddress_, page, kBufferSize_bytes)) {
         return -1;
     }
+    if (pageHeaders_) {
+        pageSequence_++;
+    }
+    if (nextWriteAddress_ % SFLASH_SECTOR_SIZE == 0U) {
+        recordSectorStart(nextWriteAddress_ / SFLASH_SECTOR_SIZE, pageFirstTimestamp_ms_[page == pages_[0] ? 0U : 1U]);
+    }
 
     nextWriteAddress_ = normalizeDataAddress(nextWriteAddress_ + kBufferSize_bytes);
 
@@ -163,11 +401,54 @@ int DataSaverSPI::flushBuffer() {
         }
     }
 
-    bufferIndex_ = 0; // Reset the buffer
     bufferFlushes_++;
     return 0;
 }
 
+int DataSaverSPI::stopForLandedBudget() {
+    // In background mode the page that used up the budget may have been
+    // written after more records were accepted; they still go to flash
+    if (bufferIndex_ != 0) {
+        flushBuffer();
+    }
+    waitForPendingFlush();
+    FlashLockGuard const guard(flashLock_);
+    closeFlight();  // Nothing more will be written for this flight
+    return 1;
+}
+
+int DataSaverSPI::serviceFlush() {
+    if (!pagePending_.load(std::memory_order_acquire)) {
+        return 1;
+    }
+    if (flashLock_.test_and_set(std::memory_order_acquire)) {
+        return 1;  // Another context is using the flash
+    }
+    int result = 1;
+    if (pagePending_.load(std::memory_order_acquire)) {
+        result = writePage(pendingPage_);
+        if (result != 0) {
+            flushErrors_.fetch_add(1U, std::memory_order_relaxed);
+        }
+        pagePending_.store(false, std::memory_order_release);
+    }
+    flashLock_.clear(std::memory_order_release);
+    return result;
+}
+
+void DataSaverSPI::waitForPendingFlush() {
+    while (pagePending_.load(std::memory_order_acquire)) {
+        serviceFlush();
+    }
+}
+
+void DataSaverSPI::setBackgroundFlush(bool enabled) {
+    if (!enabled) {
+        waitForPendingFlush();
+    }
+    backgroundFlush_ = enabled;
+}
+
 
 bool DataSaverSPI::begin() {
     if (flash_ == nullptr) {
@@ -178,6 +459,17 @@ bool DataSaverSPI::begin() {
     }
 
     this->postLaunchMode_ = isPostLaunchMode();
+    if (pageHeaders_) {
+        FlashLockGuard const guard(flashLock_);
+        recoverWriteHead();
+        if (postLaunchMode_) {
+            // Resume after the flight; launch protection picks up where it left off
+            std::array<uint8_t, sizeof(launchWriteAddress_)> bytes;
+            flash_->readBuffer(kLaunchStartAddressAddress, bytes.data(), bytes.size());
+            std::memcpy(&launchWriteAddress_, bytes.data(), sizeof(launchWriteAddress_));
+        }
+        return true;
+    }
     if (postLaunchMode_) {
         // If we are already in post-launch mode, then don't write to flash at all.
         rebootedInPostLaunchMode_ = true;
@@ -187,7 +479,157 @@ bool DataSaverSPI::begin() {
     return true;
 }
 
+bool DataSaverSPI::readPageSequence(uint32_t index, uint32_t& sequence) {
+    std::array<uint8_t, kBufferSize_bytes> page; //NOLINT(cppcoreguidelines-init-variables)
+    uint32_t address = kDataStartAddress + index * static_cast<uint32_t>(kBufferSize_bytes);
+    headSearchReads_++;
+    if (!readFromFlash(address, page.data(), page.size()) || page[0] != kPageHeaderMagic) {
+        return false;
+    }
+    PageHeader_t header = {};
+    memcpy(&header, page.data(), sizeof(header));
+    if (header.crc16 != pageCrc(page.data())) {
+        return false;  // Torn or corrupted page
+    }
+    sequence = header.sequence;
+    return true;
+}
+
+void DataSaverSPI::recoverWriteHead() {
+    const auto pageCount = static_cast<uint32_t>((flash_->size() - kDataStartAddress) / kBufferSize_bytes);
+    headSearchReads_ = 0;
+
+    // Walking the ring from page 0, the current lap's sequences increase up to
+    // the head; everything after it is erased, torn, or older than page 0. So
+    // "valid and sequence >= page 0's" holds for a prefix of the pages and the
+    // head is found by binary search in O(log pages) reads.
+    uint32_t headIndex = 0;
+    uint32_t firstSequence = 0;
+    if (readPageSequence(0, firstSequence)) {
+        uint32_t low = 0;
+        uint32_t high = pageCount;
+        uint32_t lastSequence = firstSequence;
+        while (high - low > 1U) {
+            const uint32_t mid = low + (high - low) / 2U;
+            uint32_t sequence = 0;
+            if (readPageSequence(mid, sequence) && sequence >= firstSequence) {
+                low = mid;
+                lastSequence = sequence;
+            } else {
+                high = mid;
+            }
+        }
+        headIndex = low + 1U;
+        pageSequence_ = lastSequence + 1U;
+    } else {
+        // Page 0 is erased: an empty chip, or the head just wrapped and the newest page is the last one
+        uint32_t lastSequence = 0;
+        if (readPageSequence(pageCount - 1U, lastSequence)) {
+            pageSequence_ = lastSequence + 1U;
+        }
+    }
+    if (headIndex >= pageCount) {
+        headIndex = 0;
+    }
+
+    uint32_t address = kDataStartAddress + headIndex * static_cast<uint32_t>(kBufferSize_bytes);
+    preparedSectorNumber_ = std::numeric_limits<uint32_t>::max();
+    if (address % SFLASH_SECTOR_SIZE != 0U) {
+        // The rest of the head's sector was erased when it was entered, unless
+        // a brownout tore the head page: NOR cannot reprogram that page, so
+        // continue at the next sector instead.
+        std::array<uint8_t, kBufferSize_bytes> page; //NOLINT(cppcoreguidelines-init-variables)
+        uint32_t readAddress = address;
+        headSearchReads_++;
+        bool erased = readFromFlash(readAddress, page.data(), page.size());
+        for (size_t i = 0; erased && i < page.size(); i++) {
+            erased = page[i] == kEmptyPageValue;
+        }
+        if (erased) {
+            preparedSectorNumber_ = address / SFLASH_SECTOR_SIZE;
+        } else {
+            address = normalizeDataAddress((address / SFLASH_SECTOR_SIZE + 1U) * SFLASH_SECTOR_SIZE);
+        }
+    }
+    nextWriteAddress_ = address;
+    rebuildSectorIndex();
+}
+
+void DataSaverSPI::recordSectorStart(uint32_t sector, uint32_t firstTimestamp_ms) {
+    indexSector_[indexNext_] = static_cast<uint16_t>(sector);
+    indexFirstTimestamp_ms_[indexNext_] = firstTimestamp_ms;
+    indexNext_ = (indexNext_ + 1U) % kSectorIndexEntries;
+    if (indexCount_ < kSectorIndexEntries) {
+        indexCount_++;
+    }
+}
+
+void DataSaverSPI::rebuildSectorIndex() {
+    const uint32_t firstSector = kDataStartAddress / SFLASH_SECTOR_SIZE;
+    const auto sectorCount = static_cast<uint32_t>(flash_->size() / SFLASH_SECTOR_SIZE) - firstSector;
+    const auto pageCount = static_cast<uint32_t>((flash_->size() - kDataStartAddress) / kBufferSize_bytes);
+    indexNext_ = 0;
+    indexCount_ = 0;
+
+    // Walk back from the sector holding the newest page for as long as the
+    // sectors' first pages get older, filling the ring from its end so the
+    // newest sector ends up just before indexNext_. A reboot restarts the
+    // clock, so older data with larger timestamps ends the walk too.
+    const uint32_t headPage = (nextWriteAddress_ - kDataStartAddress) / static_cast<uint32_t>(kBufferSize_bytes);
+    const uint32_t newestPage = (headPage + pageCount - 1U) % pageCount;
+    uint32_t sector = newestPage / static_cast<uint32_t>(SFLASH_SECTOR_SIZE / kBufferSize_bytes);
+    uint32_t newerSequence = pageSequence_;
+    uint32_t newerTimestamp_ms = std::numeric_limits<uint32_t>::max();
+    std::array<uint8_t, kBufferSize_bytes> page; //NOLINT(cppcoreguidelines-init-variables)
+    for (size_t i = 0; i < kSectorIndexEntries; i++) {
+        uint32_t address = kDataStartAddress + sector * static_cast<uint32_t>(SFLASH_SECTOR_SIZE);
+        if (!readFromFlash(address, page.data(), page.size()) || page[0] != kPageHeaderMagic) {
+            break;
+        }
+        PageHeader_t header = {};
+        memcpy(&header, page.data(), sizeof(header));
+        if (header.crc16 != pageCrc(page.data()) || header.sequence >= newerSequence ||
+            header.firstTimestamp_ms > newerTimestamp_ms) {
+            break;
+        }
+
+        const size_t slot = kSectorIndexEntries - 1U - i;
+        indexSector_[slot] = static_cast<uint16_t>(firstSector + sector);
+        indexFirstTimestamp_ms_[slot] = header.firstTimestamp_ms;
+        indexCount_++;
+        newerSequence = header.sequence;
+        newerTimestamp_ms = header.firstTimestamp_ms;
+        sector = (sector + sectorCount - 1U) % sectorCount;
+    }
+}
+
+uint32_t DataSaverSPI::computeLaunchWriteAddress() const {
+    const uint32_t cutoff_ms = launchTimestamp_ms_ > preLaunchHistory_ms_ ? launchTimestamp_ms_ - preLaunchHistory_ms_ : 0U;
+
+    // Newest sector that was opened at or before the cutoff; every sector
+    // after it only holds newer data
+    size_t slot = indexNext_;
+    for (size_t i = 0; i < indexCount_; i++) {
+        slot = (slot + kSectorIndexEntries - 1U) % kSectorIndexEntries;
+        if (indexFirstTimestamp_ms_[slot] <= cutoff_ms) {
+            return static_cast<uint32_t>(indexSector_[slot]) * static_cast<uint32_t>(SFLASH_SECTOR_SIZE);
+        }
+    }
+
+    // The index does not reach back far enough: keep the oldest sector it
+    // knows, or else the sector holding the newest page on the chip
+    if (indexCount_ > 0U) {
+        return static_cast<uint32_t>(indexSector_[slot]) * static_cast<uint32_t>(SFLASH_SECTOR_SIZE);
+    }
+    uint32_t newestPage = nextWriteAddress_ - static_cast<uint32_t>(kBufferSize_bytes);
+    if (nextWriteAddress_ <= kDataStartAddress) {
+        newestPage = static_cast<uint32_t>(flash_->size() - kBufferSize_bytes);
+    }
+    return newestPage - newestPage % static_cast<uint32_t>(SFLASH_SECTOR_SIZE);
+}
+
 bool DataSaverSPI::isPostLaunchMode() {
+    FlashLockGuard const guard(flashLock_);
     uint8_t flag = 0;
     flash_->readBuffer(kPostLaunchFlagAddress, &flag, sizeof(flag));
     this->postLaunchMode_ = (flag == kPostLaunchFlagTrue);
@@ -195,15 +637,20 @@ bool DataSaverSPI::isPostLaunchMode() {
 }
 
 void DataSaverSPI::clearPostLaunchMode() {
+    FlashLockGuard const guard(flashLock_);
     flash_->eraseSector(kMetadataStartAddress / SFLASH_SECTOR_SIZE);
     
     uint8_t flag = kPostLaunchFlagFalse;
     flash_->writeBuffer(kPostLaunchFlagAddress, &flag, sizeof(flag));
 
+    closeFlight();
     postLaunchMode_ = false;
+    landed_ = false;
 }
 
 void DataSaverSPI::dumpData(Stream &serial, bool ignoreEmptyPages) { //NOLINT(readability-function-cognitive-complexity)
+    waitForPendingFlush();
+    FlashLockGuard const guard(flashLock_);
     uint32_t readAddress = kDataStartAddress; //NOLINT(cppcoreguidelines-init-variables) //NOLINT(misc-const-correctness)
     // For each page write 51 sets of 5 bytes to serial with a newline
     std::array<uint8_t, SFLASH_PAGE_SIZE> buffer; //NOLINT(cppcoreguidelines-init-variables)
@@ -213,10 +660,17 @@ void DataSaverSPI::dumpData(Stream &serial, bool ignoreEmptyPages) { //NOLINT(re
     // If not in post-launch mode, erase the next sector after the next write address.
     // This ensures that we don't accidentally dump old data from previous flights
     // If ignoreEmptyPages is true, then we don't need to erase the next sector
-    if (!postLaunchMode_ && !ignoreEmptyPages) {
+    // Headered pages are found by their sequence numbers, so nothing needs erasing
+    if (!postLaunchMode_ && !ignoreEmptyPages && !pageHeaders_) {
         flash_->eraseSector(nextWriteAddress_ / SFLASH_SECTOR_SIZE + 1);
     }
 
+    // With page headers, walk the whole ring once starting at the oldest page (just past the write head)
+    if (pageHeaders_) {
+        readAddress = nextWriteAddress_;
+    }
+    uint32_t pagesLeft = static_cast<uint32_t>((flash_->size() - kDataStartAddress) / SFLASH_PAGE_SIZE);
+
     // To ensure it's lined-up let's set a '\n' , '\r' and a 's' at the start
     serial.write('a');
     serial.write('b');
@@ -230,15 +684,19 @@ void DataSaverSPI::dumpData(Stream &serial, bool ignoreEmptyPages) { //NOLINT(re
     bool stoppedFromEmptyPage = false;
     bool badRead = false;
    
-    while (readAddress < flash_->size()) { 
+    while (readAddress < flash_->size() && pagesLeft > 0U) { 
+        pagesLeft--;
         if (!readFromFlash(readAddress, buffer.data(), SFLASH_PAGE_SIZE)) {
             badRead = true;
             return;
         }
+        if (pageHeaders_ && readAddress >= flash_->size()) {
+            readAddress = kDataStartAddress;
+        }
 
         // If the first name of this page is 255 then break
         if (buffer[0] == kEmptyPageValue) {
-            if (ignoreEmptyPages) {
+            if (ignoreEmptyPages || pageHeaders_) {
                 continue;
             }
             done = true;
@@ -247,15 +705,24 @@ void DataSaverSPI::dumpData(Stream &serial, bool ignoreEmptyPages) { //NOLINT(re
         }
 
         // At the start of each page, write some alignment characters
-        std::array<uint8_t, 3> startLine = {'l', 's', 'h'};
-        serial.write(startLine.data(), 3);
-
-
-
-        for (size_t i = 0; i < numRecordsPerPage; i++) { //NOLINT(cppcoreguidelines-init-variables)
-
-            serial.write(buffer.data() + i * recordSize, recordSize);
-            // serial.write('\n');
+        if (buffer[0] == kPageHeaderMagic) {
+            std::array<uint8_t, 3> startLine = {'l', 's', 'p'};
+            serial.write(startLine.data(), 3);
+            serial.write(buffer.data(), SFLASH_PAGE_SIZE);
+        } else if (buffer[0] == kCompressedPageMarker) {
+            // Compressed pages are only meaningful whole
+            std::array<uint8_t, 3> startLine = {'l', 's', 'c'};
+            serial.write(startLine.data(), 3);
+            serial.write(buffer.data(), SFLASH_PAGE_SIZE);
+        } else {
+            std::array<uint8_t, 3> startLine = {'l', 's', 'h'};
+            serial.write(startLine.data(), 3);
+
+            for (size_t i = 0; i < numRecordsPerPage; i++) { //NOLINT(cppcoreguidelines-init-variables)
+
+                serial.write(buffer.data() + i * recordSize, recordSize);
+                // serial.write('\n');
+            }
         }
 
         // Wait for a 'n' character to be received before continuing (10 second timeout)
@@ -269,6 +736,9 @@ void DataSaverSPI::dumpData(Stream &serial, bool ignoreEmptyPages) { //NOLINT(re
 
     }
 
+    // A headered dump wraps, so it is finished once the whole ring has been walked
+    const bool finished = readAddress >= flash_->size() || (pageHeaders_ && pagesLeft == 0U);
+
     for (size_t i = 0; i < kBufferSize_bytes; i++){
         std::array<uint8_t, 3> doneLine = {'E', 'O', 'F'};
         serial.write(doneLine.data(), doneLine.size());
@@ -284,15 +754,279 @@ void DataSaverSPI::dumpData(Stream &serial, bool ignoreEmptyPages) { //NOLINT(re
         if (badRead){
             serial.write('B');
         }
-        if (readAddress >= flash_->size()){
+        if (finished){
             serial.write('F');
         }
     }
 }
 
+bool DataSaverSPI::sendDumpPage(Stream &serial, uint32_t page, uint8_t* frame) {
+    std::array<uint8_t, SFLASH_PAGE_SIZE> data; //NOLINT(cppcoreguidelines-init-variables)
+    const auto pageCount = static_cast<uint32_t>((flash_->size() - kDataStartAddress) / SFLASH_PAGE_SIZE);
+    uint32_t readAddress = kDataStartAddress + (page % pageCount) * static_cast<uint32_t>(SFLASH_PAGE_SIZE);
+    if (!readFromFlash(readAddress, data.data(), data.size())) {
+        return false;
+    }
+
+    bool erased = true;
+    for (size_t i = 0; i < data.size() && erased; i++) {
+        erased = (data[i] == kEmptyPageValue);
+    }
+    const size_t length = encodeDumpFrame(erased ? kDumpEmptyFrame : kDumpPageFrame, page, data.data(), frame);
+    serial.write(frame, length);
+    return true;
+}
+
+int DataSaverSPI::dumpDataWindowed(Stream &serial, uint32_t startPage, uint32_t endPage) { //NOLINT(readability-function-cognitive-complexity)
+    static_assert(kBufferSize_bytes == kDumpPageSize_bytes, "Dump frames carry exactly one flash page");
+    waitForPendingFlush();
+    FlashLockGuard const guard(flashLock_);
+
+    const uint32_t pageCount = static_cast<uint32_t>((flash_->size() - kDataStartAddress) / SFLASH_PAGE_SIZE);
+    if (endPage == std::numeric_limits<uint32_t>::max()) {
+        endPage = pageCount;
+    }
+    startPage = std::min(startPage, endPage);
+    endPage = std::min(endPage, startPage + pageCount);  // At most one lap of the ring
+
+    std::array<uint8_t, kDumpPageFrameSize_bytes> frame; //NOLINT(cppcoreguidelines-init-variables)
+    DumpControlParser parser;
+
+    uint32_t basePage = startPage;  // First page not yet acknowledged
+    uint32_t nextPage = startPage;  // First page never sent
+
+    // Pages NAKed by the host or timed out, sent before any new page
+    std::array<uint32_t, kDumpWindow_pages> resend; //NOLINT(cppcoreguidelines-init-variables)
+    size_t resendCount = 0;
+
+    bool endSent = false;
+    uint32_t lastProgress_ms = static_cast<uint32_t>(millis());
+    uint32_t lastSend_ms = lastProgress_ms;
+
+    while (true) {
+        // Apply every control message that has arrived
+        int received = serial.read(); //NOLINT(cppcoreguidelines-init-variables)
+        while (received >= 0) {
+            if (parser.push(static_cast<uint8_t>(received))) {
+                const uint32_t page = parser.getPage();
+                if (parser.getType() == kDumpFinished && page == endPage) {
+                    return 0;
+                }
+                if (parser.getType() == kDumpAck && page > basePage && page <= nextPage) {
+                    basePage = page;
+                    lastProgress_ms = static_cast<uint32_t>(millis());
+                } else if (parser.getType() == kDumpNak && page >= basePage && page < nextPage &&
+                           resendCount < resend.size()) {
+                    resend[resendCount++] = page;
+                }
+            }
+            received = serial.read();
+        }
+
+        const uint32_t now_ms = static_cast<uint32_t>(millis());
+        if (now_ms - lastProgress_ms > kDumpAbortTimeout_ms) {
+            return -1;
+        }
+
+        if (resendCount > 0U) {
+            const uint32_t page = resend[--resendCount];
+            if (page >= basePage && !sendDumpPage(serial, page, frame.data())) {
+                return -1;
+            }
+            lastSend_ms = now_ms;
+        } else if (nextPage < endPage && nextPage - basePage < kDumpWindow_pages) {
+            if (!sendDumpPage(serial, nextPage, frame.data())) {
+                return -1;
+            }
+            nextPage++;
+            lastSend_ms = now_ms;
+        } else if (basePage == endPage && (!endSent || now_ms - lastSend_ms >= kDumpRetransmitTimeout_ms)) {
+            serial.write(frame.data(), encodeDumpFrame(kDumpEndFrame, endPage, nullptr, frame.data()));
+            endSent = true;
+            lastSend_ms = now_ms;
+        } else if (now_ms - lastSend_ms >= kDumpRetransmitTimeout_ms) {
+            // The tail of the window or its acks were lost: go back and resend everything unacknowledged
+            resendCount = 0;
+            for (uint32_t page = nextPage; page > basePage && resendCount < resend.size(); page--) {
+                resend[resendCount++] = page - 1U;
+            }
+            lastSend_ms = now_ms;
+        }
+    }
+}
+
+bool DataSaverSPI::readFlightEntry(uint32_t slot, FlightEntry_t& entry) {
+    if (!flash_->readBuffer(kFlightDirectoryAddress + slot * static_cast<uint32_t>(sizeof(FlightEntry_t)),
+                            reinterpret_cast<uint8_t*>(&entry), sizeof(entry))) {
+        return false;
+    }
+    return entry.crc16 == crc16Ccitt(reinterpret_cast<const uint8_t*>(&entry), offsetof(FlightEntry_t, crc16));
+}
+
+void DataSaverSPI::loadFlightDirectory() {
+    if (flightDirectoryLoaded_) {
+        return;
+    }
+    flightDirectoryLoaded_ = true;
+    flightSlotsUsed_ = 0;
+    lastFlightId_ = 0;
+    flightOpen_ = false;
+
+    // Slots are appended in order, so the first erased slot ends the directory
+    std::array<uint8_t, sizeof(FlightEntry_t)> erased; //NOLINT(cppcoreguidelines-init-variables)
+    erased.fill(kEmptyPageValue);
+    FlightEntry_t entry = {};
+    for (uint32_t slot = 0; slot < kMaxFlightEntries; slot++) {
+        const bool valid = readFlightEntry(slot, entry);
+        if (!valid && memcmp(&entry, erased.data(), sizeof(entry)) == 0) {
+            break;
+        }
+        flightSlotsUsed_ = slot + 1U;
+        if (valid) {
+            lastFlightId_ = entry.flightId;
+            // A flight left open by a reboot in post-launch mode keeps logging with page headers
+            flightOpen_ = entry.endAddress == kFlightOpenEndAddress && postLaunchMode_;
+        } else {
+            flightOpen_ = false;  // Torn by a brownout while being appended
+        }
+    }
+}
+
+void DataSaverSPI::openFlight() {
+    loadFlightDirectory();
+    if (flightSlotsUsed_ >= kMaxFlightEntries) {
+        // Older flights than these have long been overwritten in the data ring
+        flash_->eraseSector(kFlightDirectoryAddress / SFLASH_SECTOR_SIZE);
+        flightSlotsUsed_ = 0;
+    }
+
+    lastFlightId_ = static_cast<uint16_t>(lastFlightId_ + 1U);
+    if (lastFlightId_ == 0U || lastFlightId_ == 0xFFFFU) {
+        lastFlightId_ = 1U;  // Keep ids distinguishable from erased slots
+    }
+    FlightEntry_t entry = {lastFlightId_, launchWriteAddress_, launchTimestamp_ms_, 0U, kFlightOpenEndAddress};
+    entry.crc16 = crc16Ccitt(reinterpret_cast<const uint8_t*>(&entry), offsetof(FlightEntry_t, crc16));
+    // The end address stays erased so closeFlight() can program it later
+    flash_->writeBuffer(kFlightDirectoryAddress + flightSlotsUsed_ * static_cast<uint32_t>(sizeof(FlightEntry_t)),
+                        reinterpret_cast<const uint8_t*>(&entry), offsetof(FlightEntry_t, endAddress));
+    flightSlotsUsed_++;
+    flightOpen_ = true;
+}
+
+void DataSaverSPI::closeFlight() {
+    if (!flightOpen_) {
+        return;
+    }
+    flightOpen_ = false;
+    std::array<uint8_t, sizeof(uint32_t)> bytes; //NOLINT(cppcoreguidelines-init-variables)
+    std::memcpy(bytes.data(), &nextWriteAddress_, bytes.size());
+    flash_->writeBuffer(kFlightDirectoryAddress + (flightSlotsUsed_ - 1U) * static_cast<uint32_t>(sizeof(FlightEntry_t)) +
+                            static_cast<uint32_t>(offsetof(FlightEntry_t, endAddress)),
+                        bytes.data(), bytes.size());
+}
+
+uint32_t DataSaverSPI::getFlightCount() {
+    FlashLockGuard const guard(flashLock_);
+    loadFlightDirectory();
+    uint32_t count = 0;
+    FlightEntry_t entry = {};
+    for (uint32_t slot = 0; slot < flightSlotsUsed_; slot++) {
+        if (readFlightEntry(slot, entry)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool DataSaverSPI::getFlight(uint32_t index, FlightEntry_t& entry) {
+    FlashLockGuard const guard(flashLock_);
+    loadFlightDirectory();
+    for (uint32_t slot = 0; slot < flightSlotsUsed_; slot++) {
+        if (readFlightEntry(slot, entry)) {
+            if (index == 0U) {
+                return true;
+            }
+            index--;
+        }
+    }
+    return false;
+}
+
+bool DataSaverSPI::findFlight(uint16_t flightId, FlightEntry_t& entry) {
+    FlashLockGuard const guard(flashLock_);
+    loadFlightDirectory();
+    // Newest first: ids restart after the directory sector is recycled
+    for (uint32_t slot = flightSlotsUsed_; slot > 0U; slot--) {
+        if (readFlightEntry(slot - 1U, entry) && entry.flightId == flightId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DataSaverSPI::getFlightPages(uint16_t flightId, uint32_t& firstPage, uint32_t& endPage) {
+    FlightEntry_t entry = {};
+    if (!findFlight(flightId, entry)) {
+        return false;
+    }
+    const auto pageCount = static_cast<uint32_t>((flash_->size() - kDataStartAddress) / kBufferSize_bytes);
+    const auto pageOf = [pageCount](uint32_t address) {
+        return ((address - kDataStartAddress) / static_cast<uint32_t>(kBufferSize_bytes)) % pageCount;
+    };
+    firstPage = pageOf(entry.startAddress);
+
+    uint32_t endAddress = entry.endAddress;
+    if (endAddress == kFlightOpenEndAddress) {
+        const bool headKnown = flightOpen_ && !rebootedInPostLaunchMode_;
+        if (!headKnown || flightId != lastFlightId_) {
+            endPage = firstPage + pageCount;  // Unknown end: the whole ring from the launch onwards
+            return true;
+        }
+        endAddress = nextWriteAddress_;
+    }
+    const uint32_t last = pageOf(endAddress);
+    endPage = last >= firstPage ? last : last + pageCount;
+    return true;
+}
+
+int DataSaverSPI::dumpFlight(Stream &serial, uint16_t flightId) {
+    uint32_t firstPage = 0;
+    uint32_t endPage = 0;
+    if (!getFlightPages(flightId, firstPage, endPage)) {
+        return 1;
+    }
+    return dumpDataWindowed(serial, firstPage, endPage);
+}
+
+void DataSaverSPI::printFlights(Stream &serial) {
+    const uint32_t count = getFlightCount();
+    serial.println("id launch_ms first_page end_page");
+    for (uint32_t i = 0; i < count; i++) {
+        FlightEntry_t entry = {};
+        uint32_t firstPage = 0;
+        uint32_t endPage = 0;
+        if (!getFlight(i, entry) || !getFlightPages(entry.flightId, firstPage, endPage)) {
+            continue;
+        }
+        serial.print(static_cast<unsigned int>(entry.flightId));
+        serial.print(" ");
+        serial.print(static_cast<unsigned long>(entry.launchTimestamp_ms));
+        serial.print(" ");
+        serial.print(static_cast<unsigned long>(firstPage));
+        serial.print(" ");
+        serial.print(static_cast<unsigned long>(endPage));
+        serial.println(entry.endAddress == kFlightOpenEndAddress ? " open" : "");
+    }
+}
+
 void DataSaverSPI::clearInternalState() {
+    FlashLockGuard const guard(flashLock_);
+    pagePending_.store(false, std::memory_order_release);  // Drop a page the background context has not written
+    pendingPage_ = nullptr;
+    buffer_ = pages_[0];
     bufferIndex_ = 0;
-    memset(buffer_, 0, kBufferSize_bytes);
+    memset(pages_, 0, sizeof(pages_));
+    closeCompressedPage();
     lastDataPoint_ = {0, 0};
     nextWriteAddress_ = kDataStartAddress;
     lastTimestamp_ms_ = 0;
@@ -301,10 +1035,25 @@ void DataSaverSPI::clearInternalState() {
     bufferFlushes_ = 0;
     isChipFullDueToPostLaunchProtection_ = false;
     preparedSectorNumber_ = std::numeric_limits<uint32_t>::max();
+    landed_ = false;
+    landedStartFlushes_ = 0;
+    indexNext_ = 0;
+    indexCount_ = 0;
+    flightDirectoryLoaded_ = false;  // Reloaded from flash on next use
+    flightOpen_ = false;
 }
 
 void DataSaverSPI::eraseAllData() {
-    flash_->eraseChip();
+    waitForPendingFlush();
+    {
+        FlashLockGuard const guard(flashLock_);
+        flash_->eraseChip();
+    }
+    pageSequence_ = 0;
+    flightDirectoryLoaded_ = true;  // The directory is now empty
+    flightSlotsUsed_ = 0;
+    lastFlightId_ = 0;
+    flightOpen_ = false;
     clearPostLaunchMode();
 
     clearInternalState();
@@ -322,6 +1071,9 @@ void DataSaverSPI::launchDetected(uint32_t launchTimestamp_ms) {
         return;
     }
 
+    // The background context may be writing a page and moving nextWriteAddress_
+    FlashLockGuard const guard(flashLock_);
+
     // 0.5) Clear the metadata sector to avoid 0 --> 1 inabilities
     flash_->eraseSector(kMetadataStartAddress / SFLASH_SECTOR_SIZE);
 
@@ -330,77 +1082,30 @@ void DataSaverSPI::launchDetected(uint32_t launchTimestamp_ms) {
     flash_->writeBuffer(kPostLaunchFlagAddress, &flag, sizeof(flag));
     postLaunchMode_ = true;
 
-    // 2) Compute how many bytes we want to roll back to capture ~1 minute of pre-launch data.
-    //    If you always store timestamps + name + DataPoint, factor that in:
-    //
-    //    struct DataRecord {
-    //        uint8_t  name;
-    //        DataPoint data;
-    //        // occasionally 4 more bytes for a timestamp if we cross the interval threshold
-    //    };
-    //
-    //    For simplicity, let's assume worst-case all data points have the 4-byte timestamp:
-    //      size_t recordSize = sizeof(uint32_t) // timestamp
-    //                        + sizeof(uint8_t)  // name
-    //                        + sizeof(DataPoint); 
-    //
-    //    If you only occasionally store the timestamp, you might want a more nuanced approach.
-    // 
-    const size_t recordSize_bytes = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(DataPoint);
-    uint32_t const oneMinuteInMs = 60000;
-    uint32_t const dataPointsPerMinute = oneMinuteInMs / timestampInterval_ms_;
-    uint64_t rollbackSize_bytes = static_cast<uint64_t>(dataPointsPerMinute) * static_cast<uint64_t>(recordSize_bytes);
-
-    // 3) Clamp rollbackSize_bytes to something reasonable. We must not exceed
-    //    the usable flash region (from address=1 to address=flash size - 1).
-    const size_t flashSize_bytes = flash_->size();
-    const size_t maxUsable_bytes = (flashSize_bytes > static_cast<size_t>(kDataStartAddress))
-        ? (flashSize_bytes - static_cast<size_t>(kDataStartAddress))
-        : 0U;
-    const auto maxUsable = static_cast<uint64_t>(maxUsable_bytes);
-    if (rollbackSize_bytes > maxUsable) {
-        // If we can't keep an entire minute, just keep as much as we can
-        rollbackSize_bytes = maxUsable;
-    }
-
-    // 4) Next, we do ring-buffer math to find the new launch write address,
-    //    which is "1 minute's worth of data behind the next write address" in a circular sense.
-
-    //    Because the next write address can be anywhere in [1, flash size - 1],
-    //    let’s do a safe modular subtraction:
-    //
-    //       newAddr = (next write address + flash size - rollback size)
-    //                 % flash size
-    //
-    //    Then we ensure it’s never 0 because 0 is used for metadata.
-
-    const auto sizeOfFlash = static_cast<uint32_t>(flashSize_bytes);
-
-    // Make sure we aren't in the metadata region
+    // 2) Roll back to the sector that was being written preLaunchHistory_ms_
+    //    before launch. Every flush that opens a sector records its first
+    //    timestamp in RAM, so this keeps the requested history to within one
+    //    sector instead of guessing from a worst-case record size.
     if (nextWriteAddress_ < kDataStartAddress) {
         nextWriteAddress_ = kDataStartAddress;
     }
-
-    // Use 64-bit to avoid any negative wrap during the subtraction.
-    int64_t potentialAddr = static_cast<int64_t>(nextWriteAddress_)
-                          + static_cast<int64_t>(sizeOfFlash)  // ensure positivity
-                          - static_cast<int64_t>(rollbackSize_bytes);
-
-    // Modulo by sizeOfFlash to bring it back into [0, sizeOfFlash-1].
-    potentialAddr = potentialAddr % sizeOfFlash;
-
-    // If result lands in the metadata region, wrap back into the data region.
-    if (potentialAddr < static_cast<int64_t>(kDataStartAddress)) {
-        potentialAddr += sizeOfFlash;
-    }
-
-
-    launchWriteAddress_ = static_cast<uint32_t>(potentialAddr);
+    launchWriteAddress_ = computeLaunchWriteAddress();
 
     std::array<uint8_t, sizeof(launchWriteAddress_)> bytes;
     std::memcpy(bytes.data(), &launchWriteAddress_, sizeof(launchWriteAddress_));
     flash_->writeBuffer(kLaunchStartAddressAddress, bytes.data(), bytes.size());
 
+    // 3) Record the flight in the directory so it can be dumped on its own
+    openFlight();
+}
+
+void DataSaverSPI::landingDetected(uint32_t landingTimestamp_ms) {
+    (void)landingTimestamp_ms;
+    if (landed_) {
+        return;
+    }
+    landedStartFlushes_ = bufferFlushes_.load();
+    landed_ = true;  // After the start count, so a reader never sees landed_ with a stale count
 }
 
 bool DataSaverSPI::writeToFlash(const uint8_t* data, size_t length) {
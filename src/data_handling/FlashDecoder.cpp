@@ -0,0 +1,200 @@
+#include "data_handling/FlashDecoder.h"
+
+#include "data_handling/Crc.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/FloatCompression.h"
+
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr std::size_t kRecordSize_bytes = sizeof(Record_t);
+constexpr std::size_t kRawRecordsPerPage = kFlashPageSize_bytes / kRecordSize_bytes;
+
+// Enough for a compressed page of 2-bit records
+constexpr std::size_t kMaxDecodedPage_bytes = (kFlashPageSize_bytes * 4U + 1U) * kRecordSize_bytes;
+
+constexpr std::array<uint8_t, 6> kDumpPreamble = {'a', 'b', 'c', 'd', 'e', 'f'};
+
+bool isErased(const uint8_t* page) {
+    for (std::size_t i = 0; i < kFlashPageSize_bytes; i++) {
+        if (page[i] != kEmptyPageValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same check DataSaverSPI applies when it recovers the write head
+bool readHeader(const uint8_t* page, PageHeader_t& header) {
+    if (page[0] != kPageHeaderMagic) {
+        return false;
+    }
+    std::memcpy(&header, page, sizeof(header));
+    uint16_t crc = crc16Ccitt(page, offsetof(PageHeader_t, crc16));
+    crc = crc16Ccitt(page + sizeof(PageHeader_t), kFlashPageSize_bytes - sizeof(PageHeader_t), crc);
+    return crc == header.crc16;
+}
+
+} // namespace
+
+void FlashDecoder::decodeRecords(const uint8_t* data, std::size_t length) {
+    for (std::size_t offset = 0; offset + kRecordSize_bytes <= length;) {
+        const uint8_t* record = data + offset;
+        const uint8_t name = record[0];
+        if (name == kEmptyPageValue) {
+            return;  // The rest of the page was never written
+        }
+        if (name == TIMESTAMP) {
+            std::memcpy(&timestamp_ms_, record + 1, sizeof(timestamp_ms_));
+            offset += kRecordSize_bytes;
+            continue;
+        }
+
+        const uint8_t components = vectorRecordComponents(name);
+        if (components != 0U) {
+            if (offset + vectorRecordSize(components) > length) {
+                return;  // Cut off; DataSaverSPI never splits a record across pages
+            }
+            for (uint8_t i = 0; i < components; i++) {
+                DecodedRecord decoded = {timestamp_ms_, static_cast<uint8_t>(record[1] + i), 0.0F};
+                std::memcpy(&decoded.value, record + 2 + i * sizeof(float), sizeof(decoded.value));
+                sink_.onRecord(decoded);
+                records_++;
+            }
+            offset += vectorRecordSize(components);
+            continue;
+        }
+
+        DecodedRecord decoded = {timestamp_ms_, name, 0.0F};
+        std::memcpy(&decoded.value, record + 1, sizeof(decoded.value));
+        sink_.onRecord(decoded);
+        records_++;
+        offset += kRecordSize_bytes;
+    }
+}
+
+int FlashDecoder::decodeCompressed(const uint8_t* data, std::size_t size_bytes) {
+    std::array<uint8_t, kMaxDecodedPage_bytes> decoded; //NOLINT(cppcoreguidelines-init-variables)
+    std::size_t length = 0;
+    if (FloatCompressor::decodePage(data, size_bytes, decoded.data(), decoded.size(), length) != 0) {
+        return -1;
+    }
+    decodeRecords(decoded.data(), length);
+    return 0;
+}
+
+int FlashDecoder::decodePage(const uint8_t* page) {
+    if (isErased(page)) {
+        erasedPages_++;
+        return 1;
+    }
+    pages_++;
+
+    const uint8_t* payload = page;
+    std::size_t payloadSize = kFlashPageSize_bytes;
+    if (page[0] == kPageHeaderMagic) {
+        PageHeader_t header = {};
+        if (!readHeader(page, header)) {
+            malformedPages_++;
+            return -1;
+        }
+        timestamp_ms_ = header.firstTimestamp_ms;
+        payload += sizeof(PageHeader_t);
+        payloadSize -= sizeof(PageHeader_t);
+    }
+
+    if (payload[0] == kCompressedPageMarker) {
+        if (decodeCompressed(payload, payloadSize) != 0) {
+            malformedPages_++;
+            return -1;
+        }
+        return 0;
+    }
+    decodeRecords(payload, payloadSize);
+    return 0;
+}
+
+void FlashDecoder::decodeImage(const uint8_t* image, std::size_t size_bytes) {
+    const std::size_t pageCount = size_bytes / kFlashPageSize_bytes;
+
+    // Start at the oldest headered page so a wrapped ring decodes in order
+    std::size_t first = 0;
+    uint32_t oldest = std::numeric_limits<uint32_t>::max();
+    PageHeader_t header = {};
+    for (std::size_t i = 0; i < pageCount; i++) {
+        if (readHeader(image + i * kFlashPageSize_bytes, header) && header.sequence < oldest) {
+            oldest = header.sequence;
+            first = i;
+        }
+    }
+
+    for (std::size_t i = 0; i < pageCount; i++) {
+        decodePage(image + ((first + i) % pageCount) * kFlashPageSize_bytes);
+    }
+}
+
+void FlashDecoder::feedDump(const uint8_t* data, std::size_t length) {
+    for (std::size_t i = 0; i < length; i++) {
+        pushDumpByte(data[i]);
+    }
+}
+
+void FlashDecoder::pushDumpByte(uint8_t byte) {
+    switch (state_) {
+        case DumpState::kPreamble:
+            if (byte == kDumpPreamble[matched_]) {
+                matched_++;
+            } else {
+                matched_ = (byte == kDumpPreamble[0]) ? 1U : 0U;
+            }
+            if (matched_ == kDumpPreamble.size()) {
+                state_ = DumpState::kMarker;
+            }
+            return;
+
+        case DumpState::kMarker:
+            // Anything between pages (e.g. a page cut short by a dropped byte) is skipped
+            marker_[0] = marker_[1];
+            marker_[1] = marker_[2];
+            marker_[2] = byte;
+            if (marker_[0] == 'l' && marker_[1] == 's' && (byte == 'h' || byte == 'c' || byte == 'p')) {
+                pageType_ = byte;
+                // Raw pages are sent as their 51 records, without the unused last byte
+                payloadSize_ = (byte == 'h') ? kRawRecordsPerPage * kRecordSize_bytes : kFlashPageSize_bytes;
+                pageLength_ = 0;
+                state_ = DumpState::kPayload;
+            } else if (marker_[0] == 'E' && marker_[1] == 'O' && byte == 'F') {
+                state_ = DumpState::kTrailer;
+            }
+            return;
+
+        case DumpState::kPayload:
+            page_[pageLength_++] = byte;
+            if (pageLength_ == payloadSize_) {
+                if (pageType_ == 'h') {
+                    pages_++;
+                    decodeRecords(page_.data(), payloadSize_);
+                } else {
+                    decodePage(page_.data());
+                }
+                marker_.fill(0U);
+                state_ = DumpState::kMarker;
+            }
+            return;
+
+        case DumpState::kTrailer:
+            // The trailer repeats; the first copy's flags are enough
+            if (byte == 'E' || flagCount_ + 1U >= flags_.size()) {
+                state_ = DumpState::kDone;
+            } else {
+                flags_[flagCount_++] = static_cast<char>(byte);
+            }
+            return;
+
+        case DumpState::kDone:
+        default:
+            return;
+    }
+}
@@ -0,0 +1,183 @@
+#include "data_handling/FlashDumpProtocol.h"
+
+#include "data_handling/Crc.h"
+
+#include <cstring>
+
+static_assert(kDumpWindow_pages <= 32U, "DumpReceiver tracks the window in a 32-bit mask");
+
+namespace {
+
+void putUint32(uint8_t* out, uint32_t value) {
+    for (std::size_t i = 0; i < 4U; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8U * i));
+    }
+}
+
+uint32_t getUint32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < 4U; ++i) {
+        value |= static_cast<uint32_t>(in[i]) << (8U * i);
+    }
+    return value;
+}
+
+// Length of a frame with the given type byte, 0 when the type is unknown
+std::size_t frameSize(uint8_t type) {
+    switch (type) {
+        case kDumpPageFrame:
+            return kDumpPageFrameSize_bytes;
+        case kDumpEmptyFrame:
+        case kDumpEndFrame:
+            return kDumpShortFrameSize_bytes;
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+std::size_t encodeDumpFrame(uint8_t type, uint32_t page, const uint8_t* data, uint8_t* out) {
+    const std::size_t size = frameSize(type);
+    out[0] = kDumpSync;
+    out[1] = type;
+    putUint32(out + 2, page);
+    if (type == kDumpPageFrame) {
+        memcpy(out + 6, data, kDumpPageSize_bytes);
+    }
+    putUint32(out + size - 4U, crc32(out + 1, size - 5U));
+    return size;
+}
+
+void encodeDumpControl(uint8_t type, uint32_t page, uint8_t* out) {
+    out[0] = type;
+    putUint32(out + 1, page);
+    const uint16_t crc = crc16Ccitt(out, 5);
+    out[5] = static_cast<uint8_t>(crc & 0xFFU);
+    out[6] = static_cast<uint8_t>(crc >> 8);
+}
+
+bool DumpControlParser::push(uint8_t byte) {
+    buffer_[length_++] = byte;
+    if (length_ < kDumpControlSize_bytes) {
+        return false;
+    }
+
+    const uint16_t crc = crc16Ccitt(buffer_.data(), 5);
+    const bool valid = (buffer_[5] == static_cast<uint8_t>(crc & 0xFFU)) &&
+                       (buffer_[6] == static_cast<uint8_t>(crc >> 8));
+    if (valid) {
+        type_ = buffer_[0];
+        page_ = getUint32(buffer_.data() + 1);
+        length_ = 0;
+        return true;
+    }
+
+    // Slide by one byte and keep waiting for a valid message
+    memmove(buffer_.data(), buffer_.data() + 1, kDumpControlSize_bytes - 1U);
+    length_ = kDumpControlSize_bytes - 1U;
+    return false;
+}
+
+DumpReceiver::DumpReceiver(IDumpSink& sink, uint32_t startPage)
+    : sink_(sink), nextPage_(startPage) {}
+
+void DumpReceiver::process(const uint8_t* data, std::size_t length) {
+    for (std::size_t i = 0; i < length; ++i) {
+        pushByte(data[i]);
+    }
+}
+
+void DumpReceiver::pushByte(uint8_t byte) {
+    frame_[frameLength_++] = byte;
+
+    // Every pass either waits for more bytes or drops at least one, so this is
+    // bounded by the frame length
+    while (frameLength_ > 0U) {
+        if (frame_[0] != kDumpSync) {
+            dropFront(1);
+            continue;
+        }
+        if (frameLength_ < 2U) {
+            return;
+        }
+        const std::size_t size = frameSize(frame_[1]);
+        if (size == 0U) {
+            dropFront(1);
+            continue;
+        }
+        if (frameLength_ < size) {
+            return;
+        }
+
+        if (crc32(frame_.data() + 1, size - 5U) == getUint32(frame_.data() + size - 4U)) {
+            handleFrame(frame_[1], getUint32(frame_.data() + 2), frame_.data() + 6);
+            dropFront(size);
+        } else {
+            // A lost byte shifts the next frame into this one; rescan from the byte after the sync
+            crcErrors_++;
+            dropFront(1);
+        }
+    }
+}
+
+void DumpReceiver::handleFrame(uint8_t type, uint32_t page, const uint8_t* data) {
+    if (type == kDumpEndFrame) {
+        if (nextPage_ >= page) {
+            done_ = true;
+            sendControl(kDumpFinished, page);
+        } else {
+            sendControl(kDumpAck, nextPage_);
+        }
+        return;
+    }
+
+    if (page < nextPage_) {
+        duplicates_++;
+        sendControl(kDumpAck, nextPage_);
+        return;
+    }
+    const uint32_t offset = page - nextPage_;
+    if (offset >= kDumpWindow_pages) {
+        // The sender never runs this far ahead; treat it as noise
+        sendControl(kDumpAck, nextPage_);
+        return;
+    }
+
+    const uint32_t bit = 1U << offset;
+    if ((received_ & bit) != 0U) {
+        duplicates_++;
+    } else {
+        sink_.onPage(page, type == kDumpPageFrame ? data : nullptr);
+        received_ |= bit;
+        pagesReceived_++;
+    }
+
+    // Ask once for every page this frame skipped over
+    for (uint32_t i = 0; i < offset; ++i) {
+        const uint32_t missing = 1U << i;
+        if ((received_ & missing) == 0U && (nakSent_ & missing) == 0U) {
+            sendControl(kDumpNak, nextPage_ + i);
+            nakSent_ |= missing;
+        }
+    }
+
+    // Slide the window over every page received in order
+    for (uint32_t i = 0; i < kDumpWindow_pages && (received_ & 1U) != 0U; ++i) {
+        received_ >>= 1;
+        nakSent_ >>= 1;
+        nextPage_++;
+    }
+    sendControl(kDumpAck, nextPage_);
+}
+
+void DumpReceiver::sendControl(uint8_t type, uint32_t page) {
+    std::array<uint8_t, kDumpControlSize_bytes> message = {};
+    encodeDumpControl(type, page, message.data());
+    sink_.sendControl(message.data(), message.size());
+}
+
+void DumpReceiver::dropFront(std::size_t count) {
+    memmove(frame_.data(), frame_.data() + count, frameLength_ - count);
+    frameLength_ -= count;
+}
@@ -0,0 +1,360 @@
+#include "data_handling/FloatCompression.h"
+#include "data_handling/DataNames.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t kNameBits = 8;
+constexpr uint8_t kWindowLeadingBits = 5;
+constexpr uint8_t kWindowLengthBits = 5;
+constexpr uint8_t kValueBits = 32;
+constexpr uint32_t kShortDeltaLimit_ms = 1U << 7;
+constexpr uint32_t kMediumDeltaLimit_ms = 1U << 14;
+constexpr std::size_t kRecordSize_bytes = 5;
+
+constexpr uint8_t kDeltaLengthBits = 5;
+
+// Control code, optional header and payload of one encoded value
+struct ValueCode {
+    uint8_t prefix;
+    uint8_t prefixBits;
+    uint32_t header;
+    uint8_t headerBits;
+    uint32_t payload;
+    uint8_t payloadBits;
+    bool newWindow;
+};
+
+uint8_t leadingZeros(uint32_t x) {
+    return static_cast<uint8_t>(__builtin_clz(x));  // x != 0
+}
+
+uint8_t trailingZeros(uint32_t x) {
+    return static_cast<uint8_t>(__builtin_ctz(x));  // x != 0
+}
+
+// Maps float bits onto unsigned integers with the same ordering as the floats,
+// so nearby values have a small difference even across a power of two
+uint32_t toOrdered(uint32_t bits) {
+    return (bits & 0x80000000U) != 0U ? ~bits : (bits | 0x80000000U);
+}
+
+uint32_t fromOrdered(uint32_t ordered) {
+    return (ordered & 0x80000000U) != 0U ? (ordered & 0x7FFFFFFFU) : ~ordered;
+}
+
+uint32_t zigzagEncode(uint32_t difference) {
+    return (difference << 1) ^ (0U - (difference >> 31));
+}
+
+uint32_t zigzagDecode(uint32_t zigzag) {
+    return (zigzag >> 1) ^ (0U - (zigzag & 1U));
+}
+
+ValueCode encodeTimestamp(uint32_t delta_ms) {
+    if (delta_ms < kShortDeltaLimit_ms) {
+        return {0x0U, 1, 0U, 0, delta_ms, 7, false};
+    }
+    if (delta_ms < kMediumDeltaLimit_ms) {
+        return {0x2U, 2, 0U, 0, delta_ms, 14, false};
+    }
+    return {0x3U, 2, 0U, 0, delta_ms, kValueBits, false};
+}
+
+// Cheapest of: unchanged, XOR in the previous window, XOR in a new window,
+// or the zigzag difference of the ordered values
+ValueCode encodeFloat(uint32_t bits, uint32_t previousBits, uint8_t windowLeading, uint8_t windowLength) {
+    const uint32_t xorBits = bits ^ previousBits;
+    if (xorBits == 0U) {
+        return {0x0U, 1, 0U, 0, 0U, 0, false};
+    }
+    const uint8_t leading = leadingZeros(xorBits);
+    const uint8_t trailing = trailingZeros(xorBits);
+    ValueCode code = {};
+    if (windowLength != 0U && leading >= windowLeading &&
+        trailing >= kValueBits - windowLeading - windowLength) {
+        const auto shift = static_cast<uint8_t>(kValueBits - windowLeading - windowLength);
+        code = {0x2U, 2, 0U, 0, xorBits >> shift, windowLength, false};
+    } else {
+        const auto length = static_cast<uint8_t>(kValueBits - leading - trailing);
+        const uint32_t header = (static_cast<uint32_t>(leading) << kWindowLengthBits) | (length - 1U);
+        code = {0x6U, 3, header, kWindowLeadingBits + kWindowLengthBits, xorBits >> trailing, length, true};
+    }
+
+    const uint32_t zigzag = zigzagEncode(toOrdered(bits) - toOrdered(previousBits));  // != 0
+    const auto deltaLength = static_cast<uint8_t>(kValueBits - leadingZeros(zigzag));
+    if (3U + kDeltaLengthBits + deltaLength < static_cast<unsigned>(code.prefixBits + code.headerBits + code.payloadBits)) {
+        code = {0x7U, 3, deltaLength - 1U, kDeltaLengthBits, zigzag, deltaLength, false};
+    }
+    return code;
+}
+
+// Bounds-checked MSB-first reader for decodePage()
+class BitReader {
+public:
+    BitReader(const uint8_t* data, std::size_t size_bytes, std::size_t startBit)
+        : data_(data), sizeBits_(size_bytes * 8U), bitPos_(startBit) {}
+
+    bool read(uint8_t count, uint32_t& value) {
+        if (bitPos_ + count > sizeBits_) {
+            return false;
+        }
+        value = 0U;
+        while (count > 0U) {
+            const auto used = static_cast<uint8_t>(bitPos_ & 7U);
+            const auto available = static_cast<uint8_t>(8U - used);
+            const uint8_t take = count < available ? count : available;
+            const auto chunk = static_cast<uint32_t>(
+                (static_cast<uint32_t>(data_[bitPos_ >> 3]) >> (available - take)) & ((1U << take) - 1U));
+            value = (value << take) | chunk;
+            bitPos_ += take;
+            count = static_cast<uint8_t>(count - take);
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    std::size_t sizeBits_;
+    std::size_t bitPos_;
+};
+
+void writeRecord(uint8_t* out, uint8_t name, uint32_t valueBits) {
+    out[0] = name;
+    std::memcpy(out + 1, &valueBits, sizeof(valueBits));
+}
+
+}  // namespace
+
+void CompressionChannelTable::reset() {
+    valueSeen_.fill(0U);
+    successorSeen_.fill(0U);
+    hasLastName_ = false;
+    lastName_ = 0;
+}
+
+void CompressionChannelTable::storeValue(uint8_t name, uint32_t bits) {
+    if (!hasValue(name)) {
+        length_[name] = 0U;  // Stale window from an earlier page
+        valueSeen_[name >> 3] = static_cast<uint8_t>(valueSeen_[name >> 3] | (1U << (name & 7U)));
+    }
+    previous_[name] = bits;
+}
+
+void CompressionChannelTable::storeWindow(uint8_t name, uint8_t leading, uint8_t length) {
+    leading_[name] = leading;
+    length_[name] = length;
+}
+
+bool CompressionChannelTable::predictNext(uint8_t& predicted) const {
+    if (!hasLastName_ || !hasSuccessor(lastName_)) {
+        return false;
+    }
+    predicted = successor_[lastName_];
+    return true;
+}
+
+void CompressionChannelTable::advanceName(uint8_t name) {
+    if (hasLastName_) {
+        successor_[lastName_] = name;
+        successorSeen_[lastName_ >> 3] =
+            static_cast<uint8_t>(successorSeen_[lastName_ >> 3] | (1U << (lastName_ & 7U)));
+    }
+    hasLastName_ = true;
+    lastName_ = name;
+}
+
+void FloatCompressor::beginPage(uint8_t* page, std::size_t pageSize_bytes, uint32_t baseTimestamp_ms) {
+    if (page == nullptr || pageSize_bytes <= kCompressedPageHeaderSize_bytes) {
+        page_ = nullptr;
+        return;
+    }
+    page_ = page;
+    pageSize_bytes_ = pageSize_bytes;
+    recordCount_ = 0;
+    lastTimestamp_ms_ = baseTimestamp_ms;
+    channels_.reset();
+
+    page_[0] = kCompressedPageMarker;
+    page_[1] = 0U;
+    page_[2] = 0U;
+    for (std::size_t i = 0; i < sizeof(uint32_t); ++i) {
+        page_[3 + i] = static_cast<uint8_t>(baseTimestamp_ms >> (8U * i));
+    }
+    bitPos_ = kCompressedPageHeaderSize_bytes * 8U;
+}
+
+bool FloatCompressor::append(uint8_t name, uint32_t valueBits) {
+    if (page_ == nullptr || recordCount_ == UINT16_MAX) {
+        return false;
+    }
+
+    uint8_t predicted = 0;
+    const bool namePredicted = channels_.predictNext(predicted) && predicted == name;
+    const bool isTimestamp = name == TIMESTAMP;
+    const ValueCode code = isTimestamp
+        ? encodeTimestamp(valueBits - lastTimestamp_ms_)
+        : encodeFloat(valueBits, channels_.previousBits(name), channels_.windowLeading(name),
+                      channels_.windowLength(name));
+
+    const std::size_t cost = (namePredicted ? 1U : 1U + kNameBits) + code.prefixBits + code.headerBits +
+                             code.payloadBits;
+    if (bitPos_ + cost > pageSize_bytes_ * 8U) {
+        return false;
+    }
+
+    if (namePredicted) {
+        writeBits(1U, 1);
+    } else {
+        writeBits(0U, 1);
+        writeBits(name, kNameBits);
+    }
+    writeBits(code.prefix, code.prefixBits);
+    writeBits(code.header, code.headerBits);
+    writeBits(code.payload, code.payloadBits);
+
+    if (isTimestamp) {
+        lastTimestamp_ms_ = valueBits;
+    } else {
+        channels_.storeValue(name, valueBits);
+        if (code.newWindow) {
+            channels_.storeWindow(name, static_cast<uint8_t>(code.header >> kWindowLengthBits), code.payloadBits);
+        }
+    }
+    channels_.advanceName(name);
+    recordCount_++;
+    return true;
+}
+
+void FloatCompressor::finishPage() {
+    if (page_ == nullptr) {
+        return;
+    }
+    page_[1] = static_cast<uint8_t>(recordCount_ & 0xFFU);
+    page_[2] = static_cast<uint8_t>(recordCount_ >> 8);
+    for (std::size_t i = getBytesUsed(); i < pageSize_bytes_; ++i) {
+        page_[i] = 0xFFU;
+    }
+}
+
+void FloatCompressor::writeBits(uint32_t value, uint8_t count) {
+    // At most 5 iterations for a 32-bit value
+    while (count > 0U) {
+        const std::size_t byte = bitPos_ >> 3;
+        const auto used = static_cast<uint8_t>(bitPos_ & 7U);
+        const auto available = static_cast<uint8_t>(8U - used);
+        const uint8_t take = count < available ? count : available;
+        const auto chunk = static_cast<uint8_t>((value >> (count - take)) & ((1U << take) - 1U));
+        const auto shifted = static_cast<uint8_t>(chunk << (available - take));
+        // The first bits of a byte overwrite it, so stale buffer contents never leak in
+        page_[byte] = used == 0U ? shifted : static_cast<uint8_t>(page_[byte] | shifted);
+        bitPos_ += take;
+        count = static_cast<uint8_t>(count - take);
+    }
+}
+
+int FloatCompressor::decodePage(const uint8_t* page, std::size_t pageSize_bytes, uint8_t* out,
+                                std::size_t outCapacity_bytes, std::size_t& outLength_bytes) {
+    if (page == nullptr || out == nullptr || pageSize_bytes <= kCompressedPageHeaderSize_bytes ||
+        page[0] != kCompressedPageMarker) {
+        return -1;
+    }
+    const auto recordCount = static_cast<uint16_t>(page[1] | (page[2] << 8));
+    uint32_t timestamp_ms = 0;
+    for (std::size_t i = 0; i < sizeof(uint32_t); ++i) {
+        timestamp_ms |= static_cast<uint32_t>(page[3 + i]) << (8U * i);
+    }
+    if ((static_cast<std::size_t>(recordCount) + 1U) * kRecordSize_bytes > outCapacity_bytes) {
+        return -1;
+    }
+
+    writeRecord(out, TIMESTAMP, timestamp_ms);
+    std::size_t written = kRecordSize_bytes;
+
+    CompressionChannelTable channels;
+    channels.reset();
+    BitReader reader(page, pageSize_bytes, kCompressedPageHeaderSize_bytes * 8U);
+
+    for (uint16_t r = 0; r < recordCount; ++r) {
+        uint32_t bit = 0;
+        uint32_t name32 = 0;
+        uint8_t predicted = 0;
+        if (!reader.read(1, bit)) {
+            return -1;
+        }
+        if (bit == 1U) {
+            if (!channels.predictNext(predicted)) {
+                return -1;
+            }
+            name32 = predicted;
+        } else if (!reader.read(kNameBits, name32)) {
+            return -1;
+        }
+        const auto name = static_cast<uint8_t>(name32);
+
+        // Prefix codes: 0, 10, 11 for timestamps; 0, 10, 110, 111 for floats
+        const uint8_t maxPrefixBits = name == TIMESTAMP ? 2U : 3U;
+        uint32_t prefix = 0;
+        uint8_t prefixBits = 0;
+        do {
+            uint32_t prefixBit = 0;
+            if (!reader.read(1, prefixBit)) {
+                return -1;
+            }
+            prefix = (prefix << 1) | prefixBit;
+            prefixBits++;
+        } while ((prefix & 1U) == 1U && prefixBits < maxPrefixBits);
+
+        uint32_t value = 0;
+        if (name == TIMESTAMP) {
+            const auto deltaBits = static_cast<uint8_t>(prefix == 0U ? 7U : (prefix == 0x2U ? 14U : kValueBits));
+            uint32_t delta_ms = 0;
+            if (!reader.read(deltaBits, delta_ms)) {
+                return -1;
+            }
+            timestamp_ms += delta_ms;
+            value = timestamp_ms;
+        } else {
+            const uint32_t previousBits = channels.previousBits(name);
+            value = previousBits;
+            if (prefix == 0x2U) {
+                const uint8_t length = channels.windowLength(name);
+                uint32_t payload = 0;
+                if (length == 0U || !reader.read(length, payload)) {
+                    return -1;
+                }
+                value = previousBits ^ (payload << (kValueBits - channels.windowLeading(name) - length));
+            } else if (prefix == 0x6U) {
+                uint32_t header = 0;
+                uint32_t payload = 0;
+                if (!reader.read(kWindowLeadingBits + kWindowLengthBits, header)) {
+                    return -1;
+                }
+                const auto leading = static_cast<uint8_t>(header >> kWindowLengthBits);
+                const auto length = static_cast<uint8_t>((header & ((1U << kWindowLengthBits) - 1U)) + 1U);
+                if (leading + length > kValueBits || !reader.read(length, payload)) {
+                    return -1;
+                }
+                value = previousBits ^ (payload << (kValueBits - leading - length));
+                channels.storeValue(name, previousBits);  // Mark the channel seen before storing its window
+                channels.storeWindow(name, leading, length);
+            } else if (prefix == 0x7U) {
+                uint32_t header = 0;
+                uint32_t zigzag = 0;
+                if (!reader.read(kDeltaLengthBits, header) || !reader.read(static_cast<uint8_t>(header + 1U), zigzag)) {
+                    return -1;
+                }
+                value = fromOrdered(toOrdered(previousBits) + zigzagDecode(zigzag));
+            }
+            channels.storeValue(name, value);
+        }
+        channels.advanceName(name);
+
+        writeRecord(out + written, name, value);
+        written += kRecordSize_bytes;
+    }
+
+    outLength_bytes = written;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "data_handling/LandedThrottle.h"
+
+LandedThrottle::LandedThrottle(SensorDataHandler* const* handlers, std::size_t handlerCount,
+                               SendableSensorData* const* streams, std::size_t streamCount,
+                               uint16_t landedSaveInterval_ms, uint16_t landedTelemetryPeriod_ms,
+                               uint16_t landedPollInterval_ms)
+    : handlers_(handlers),
+      handlerCount_(handlers == nullptr ? 0U : handlerCount),
+      streams_(streams),
+      streamCount_(streams == nullptr ? 0U : streamCount),
+      landedSaveInterval_ms_(landedSaveInterval_ms),
+      landedTelemetryPeriod_ms_(landedTelemetryPeriod_ms),
+      landedPollInterval_ms_(landedPollInterval_ms) {}
+
+void LandedThrottle::apply() {
+    if (applied_) {
+        return;
+    }
+    for (std::size_t i = 0; i < handlerCount_; ++i) {
+        if (handlers_[i] != nullptr) {
+            handlers_[i]->restrictSaveSpeed(landedSaveInterval_ms_);
+        }
+    }
+    for (std::size_t i = 0; i < streamCount_; ++i) {
+        if (streams_[i] != nullptr) {
+            streams_[i]->period_ms = landedTelemetryPeriod_ms_;
+        }
+    }
+    applied_ = true;
+}
+
+bool LandedThrottle::shouldPollSensors(uint32_t now_ms) {
+    if (!applied_) {
+        return true;
+    }
+    if (polledSinceApply_ && now_ms - lastPoll_ms_ < landedPollInterval_ms_) {
+        return false;
+    }
+    polledSinceApply_ = true;
+    lastPoll_ms_ = now_ms;
+    return true;
+}
@@ -0,0 +1,189 @@
+#include "data_handling/MultiDataSaver.h"
+#include "ArduinoHAL.h"
+
+int MultiDataSaver::addSink(IDataSaver* saver, uint8_t priority) {
+    if (saver == nullptr || sinkCount_ == kMaxSinks) {
+        return -1;
+    }
+    const std::size_t index = sinkCount_++;
+    sinks_[index].saver = saver;
+    sinks_[index].priority = priority;
+
+    // Insert after every sink of the same or higher priority
+    std::size_t position = index;
+    while (position > 0U && sinks_[order_[position - 1U]].priority < priority) {
+        order_[position] = order_[position - 1U];
+        position--;
+    }
+    order_[position] = static_cast<uint8_t>(index);
+    return static_cast<int>(index);
+}
+
+void MultiDataSaver::setRateLimit(int sink, uint16_t interval_ms) {
+    if (sink >= 0 && static_cast<std::size_t>(sink) < sinkCount_) {
+        sinks_[static_cast<std::size_t>(sink)].interval_ms = interval_ms;
+    }
+}
+
+void MultiDataSaver::setChannelEnabled(int sink, uint8_t name, bool enabled) {
+    if (sink < 0 || static_cast<std::size_t>(sink) >= sinkCount_ || name >= kMaxChannels) {
+        return;
+    }
+    uint64_t& channels = sinks_[static_cast<std::size_t>(sink)].channels;
+    const uint64_t bit = 1ULL << name;
+    channels = enabled ? (channels | bit) : (channels & ~bit);
+}
+
+void MultiDataSaver::setAllChannelsEnabled(int sink, bool enabled) {
+    if (sink >= 0 && static_cast<std::size_t>(sink) < sinkCount_) {
+        sinks_[static_cast<std::size_t>(sink)].channels = enabled ? ~0ULL : 0ULL;
+    }
+}
+
+void MultiDataSaver::setStallLimit(int sink, uint32_t limit_us, uint32_t backoff_ms) {
+    if (sink >= 0 && static_cast<std::size_t>(sink) < sinkCount_) {
+        Sink& target = sinks_[static_cast<std::size_t>(sink)];
+        target.stallLimit_us = limit_us;
+        target.stallBackoff_ms = backoff_ms;
+        target.stalled = false;
+    }
+}
+
+bool MultiDataSaver::accepts(Sink& sink, const RateState& rate, const DataPoint& dataPoint, uint8_t name) {
+    if (name < kMaxChannels) {
+        const uint64_t bit = 1ULL << name;
+        if ((sink.channels & bit) == 0U) {
+            sink.stats.filtered++;
+            return false;
+        }
+        if ((rate.seen & bit) != 0U && dataPoint.timestamp_ms - rate.lastSave_ms[name] < sink.interval_ms) {
+            sink.stats.rateLimited++;
+            return false;
+        }
+    }
+    if (sink.stalled) {
+        if (static_cast<uint32_t>(millis()) - sink.stalledAt_ms < sink.stallBackoff_ms) {
+            sink.stats.stallSkipped++;
+            return false;
+        }
+        sink.stalled = false;
+    }
+    return true;
+}
+
+void MultiDataSaver::markSaved(RateState& rate, const DataPoint& dataPoint, uint8_t name) {
+    if (name < kMaxChannels) {
+        rate.lastSave_ms[name] = dataPoint.timestamp_ms;
+        rate.seen |= 1ULL << name;
+    }
+}
+
+void MultiDataSaver::recordResult(Sink& sink, uint32_t start_us, int result, uint32_t points, int& firstError) {
+    const uint32_t elapsed_us = static_cast<uint32_t>(micros()) - start_us;
+    sink.stats.worstSave_us = elapsed_us > sink.stats.worstSave_us ? elapsed_us : sink.stats.worstSave_us;
+    if (sink.stallLimit_us != 0U && elapsed_us > sink.stallLimit_us) {
+        sink.stats.stalls++;
+        sink.stalled = true;
+        sink.stalledAt_ms = static_cast<uint32_t>(millis());
+    }
+    if (result != 0) {
+        sink.stats.failed += points;
+        firstError = (firstError == 0) ? result : firstError;
+        return;
+    }
+    sink.stats.saved += points;
+}
+
+int MultiDataSaver::saveDataPoint(const DataPoint& dataPoint, uint8_t name) {
+    int firstError = 0;
+    for (std::size_t i = 0; i < sinkCount_; ++i) {
+        Sink& sink = sinks_[order_[i]];
+        if (!accepts(sink, sink.rate, dataPoint, name)) {
+            continue;
+        }
+
+        const auto start_us = static_cast<uint32_t>(micros());
+        const int result = sink.saver->saveDataPoint(dataPoint, name);
+        recordResult(sink, start_us, result, 1U, firstError);
+        if (result == 0) {
+            markSaved(sink.rate, dataPoint, name);
+        }
+    }
+    return firstError;
+}
+
+int MultiDataSaver::saveDataPoints(const NamedDataPoint* points, size_t count) {
+    int firstError = 0;
+    for (std::size_t start = 0; start < count; start += kMaxBatch) {
+        const std::size_t chunk = (count - start < kMaxBatch) ? count - start : kMaxBatch;
+        for (std::size_t i = 0; i < sinkCount_; ++i) {
+            Sink& sink = sinks_[order_[i]];
+            // Staged points are marked in a copy so later points of the batch see the
+            // rate limit, while the sink's own state waits for the call to succeed
+            batchRate_ = sink.rate;
+            std::size_t staged = 0;
+            for (std::size_t p = start; p < start + chunk; ++p) {
+                if (accepts(sink, batchRate_, points[p].dataPoint, points[p].name)) {
+                    markSaved(batchRate_, points[p].dataPoint, points[p].name);
+                    batch_[staged++] = points[p];
+                }
+            }
+            if (staged == 0U) {
+                continue;
+            }
+
+            const auto start_us = static_cast<uint32_t>(micros());
+            const int result = sink.saver->saveDataPoints(batch_.data(), staged);
+            recordResult(sink, start_us, result, static_cast<uint32_t>(staged), firstError);
+            if (result == 0) {
+                sink.rate = batchRate_;
+            }
+        }
+    }
+    return firstError;
+}
+
+int MultiDataSaver::saveDataVector(const DataVector& vector, uint8_t name) {
+    int firstError = 0;
+    const DataPoint label = vector.at(0);
+    for (std::size_t i = 0; i < sinkCount_; ++i) {
+        Sink& sink = sinks_[order_[i]];
+        if (!accepts(sink, sink.rate, label, name)) {
+            continue;
+        }
+
+        const auto start_us = static_cast<uint32_t>(micros());
+        const int result = sink.saver->saveDataVector(vector, name);
+        recordResult(sink, start_us, result, 1U, firstError);
+        if (result == 0) {
+            markSaved(sink.rate, label, name);
+        }
+    }
+    return firstError;
+}
+
+bool MultiDataSaver::begin() {
+    bool ok = true;
+    for (std::size_t i = 0; i < sinkCount_; ++i) {
+        ok = sinks_[order_[i]].saver->begin() && ok;
+    }
+    return ok;
+}
+
+void MultiDataSaver::launchDetected(uint32_t launchTimestamp_ms) {
+    for (std::size_t i = 0; i < sinkCount_; ++i) {
+        sinks_[order_[i]].saver->launchDetected(launchTimestamp_ms);
+    }
+}
+
+void MultiDataSaver::landingDetected(uint32_t landingTimestamp_ms) {
+    for (std::size_t i = 0; i < sinkCount_; ++i) {
+        sinks_[order_[i]].saver->landingDetected(landingTimestamp_ms);
+    }
+}
+
+void MultiDataSaver::clearPostLaunchMode() {
+    for (std::size_t i = 0; i < sinkCount_; ++i) {
+        sinks_[order_[i]].saver->clearPostLaunchMode();
+    }
+}
@@ -8,6 +8,12 @@ SensorDataHandler::SensorDataHandler(uint8_t name, IDataSaver* dataSaver_in)
       name_(name),
       saveInterval_ms_(0U),
       lastSaveTime_ms_(0UL),
+      decimation_(DecimationMode::kDrop),
+      windowCount_(0UL),
+      windowOrigin_(),
+      windowSum_(),
+      windowMin_({0UL, 0.0F}),
+      windowMax_({0UL, 0.0F}),
       lastDataPointSaved_({0UL, 0.0F})
 {}
 
@@ -15,13 +21,81 @@ void SensorDataHandler::restrictSaveSpeed(uint16_t interval_ms){
     this->saveInterval_ms_ = interval_ms;
 }
 
+void SensorDataHandler::setDecimation(DecimationMode mode){
+    decimation_ = mode;
+    windowCount_ = 0UL;
+}
+
+void SensorDataHandler::accumulate(const float* values, std::size_t count){
+    for (std::size_t i = 0; i < count; i++) {
+        if (windowCount_ == 0UL) {
+            windowOrigin_[i] = values[i];
+            windowSum_[i] = 0.0F;
+        } else {
+            windowSum_[i] += values[i] - windowOrigin_[i];
+        }
+    }
+    windowCount_++;
+}
+
+float SensorDataHandler::windowMean(std::size_t i) const {
+    return windowOrigin_[i] + windowSum_[i] / static_cast<float>(windowCount_);
+}
 
 int SensorDataHandler::addData(DataPoint data){
+    if (decimation_ == DecimationMode::kAverage) {
+        accumulate(&data.data, 1U);
+    } else if (decimation_ == DecimationMode::kMinMax) {
+        if (windowCount_ == 0UL || data.data < windowMin_.data) {
+            windowMin_ = data;
+        }
+        if (windowCount_ == 0UL || data.data > windowMax_.data) {
+            windowMax_ = data;
+        }
+        windowCount_++;
+    }
+
     // Check if the data is old enough to be saved based on the interval
     if (data.timestamp_ms - lastSaveTime_ms_ >= saveInterval_ms_) {
-        dataSaver->saveDataPoint(data, name_);
+        DataPoint saved = data;
+        if (decimation_ == DecimationMode::kAverage) {
+            saved.data = windowMean(0U);
+        } else if (decimation_ == DecimationMode::kMinMax) {
+            // Both extremes in the order they were sampled; one point if the interval was flat
+            const bool maxFirst = windowMax_.timestamp_ms < windowMin_.timestamp_ms;
+            const DataPoint& first = maxFirst ? windowMax_ : windowMin_;
+            saved = maxFirst ? windowMin_ : windowMax_;
+            if (first.data < saved.data || saved.data < first.data) {
+                dataSaver->saveDataPoint(first, name_);
+            }
+        }
+        dataSaver->saveDataPoint(saved, name_);
+        lastSaveTime_ms_ = data.timestamp_ms;
+        // Telemetry reads this, so in kMinMax mode it tracks the signal rather than the envelope
+        lastDataPointSaved_ = (decimation_ == DecimationMode::kMinMax) ? data : saved;
+        windowCount_ = 0UL;
+    }
+
+    return 0;
+}
+
+int SensorDataHandler::addData(const DataVector& data){
+    if (decimation_ != DecimationMode::kDrop) {
+        accumulate(data.data.data(), data.size);
+    }
+
+    if (data.timestamp_ms - lastSaveTime_ms_ >= saveInterval_ms_) {
+        DataVector saved = data;
+        if (decimation_ != DecimationMode::kDrop) {
+            for (std::size_t i = 0; i < saved.size; i++) {
+                saved.data[i] = windowMean(i);
+            }
+        }
+        dataSaver->saveDataVector(saved, name_);
         lastSaveTime_ms_ = data.timestamp_ms;
-        lastDataPointSaved_ = data;
+        lastDataVectorSaved_ = saved;
+        lastDataPointSaved_ = saved.at(0);
+        windowCount_ = 0UL;
     }
 
     return 0;
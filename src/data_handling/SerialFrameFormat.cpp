@@ -0,0 +1,154 @@
+#include "data_handling/SerialFrameFormat.h"
+
+#include "data_handling/Crc.h"
+
+#include <cstring>
+
+namespace {
+
+void putUint(uint8_t* out, uint32_t value, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8U * i));
+    }
+}
+
+uint32_t getUint(const uint8_t* in, std::size_t size) {
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint32_t>(in[i]) << (8U * i);
+    }
+    return value;
+}
+
+} // namespace
+
+std::size_t cobsEncode(const uint8_t* data, std::size_t length, uint8_t* out) {
+    std::size_t codeIndex = 0;
+    std::size_t outLength = 1;
+    uint8_t code = 1;
+    for (std::size_t i = 0; i < length; ++i) {
+        if (data[i] != 0U) {
+            out[outLength++] = data[i];
+            code++;
+        }
+        if (data[i] == 0U || code == 0xFFU) {
+            out[codeIndex] = code;
+            code = 1;
+            codeIndex = outLength++;
+        }
+    }
+    out[codeIndex] = code;
+    return outLength;
+}
+
+int cobsDecode(const uint8_t* data, std::size_t length, uint8_t* out) {
+    std::size_t in = 0;
+    std::size_t outLength = 0;
+    while (in < length) {
+        const uint8_t code = data[in++];
+        if (code == 0U || in + code - 1U > length) {
+            return -1;
+        }
+        for (uint8_t i = 1; i < code; ++i) {
+            if (data[in] == 0U) {
+                return -1;
+            }
+            out[outLength++] = data[in++];
+        }
+        // A short run stands for a zero, except at the very end
+        if (code != 0xFFU && in < length) {
+            out[outLength++] = 0U;
+        }
+    }
+    return static_cast<int>(outLength);
+}
+
+bool SerialFrameWriter::append(uint32_t timestamp_ms, uint8_t name, float value) {
+    if (count_ == kSerialFrameMaxRecords) {
+        return false;
+    }
+    if (count_ == 0U) {
+        baseTimestamp_ms_ = timestamp_ms;
+    } else if (timestamp_ms < baseTimestamp_ms_ || timestamp_ms - baseTimestamp_ms_ > 0xFFU) {
+        return false;
+    }
+
+    uint8_t* out = frame_.data() + kSerialFrameHeaderSize_bytes + count_ * kSerialRecordSize_bytes;
+    uint32_t valueBits = 0;
+    std::memcpy(&valueBits, &value, sizeof(valueBits));
+    out[0] = name;
+    out[1] = static_cast<uint8_t>(timestamp_ms - baseTimestamp_ms_);
+    putUint(out + 2, valueBits, 4);
+    count_++;
+    return true;
+}
+
+std::size_t SerialFrameWriter::finish(uint8_t* out) {
+    if (count_ == 0U) {
+        return 0;
+    }
+    uint8_t* frame = frame_.data();
+    frame[0] = kSerialFrameVersion;
+    putUint(frame + 1, sequence_, 2);
+    putUint(frame + 3, baseTimestamp_ms_, 4);
+    frame[7] = count_;
+    const std::size_t length = kSerialFrameHeaderSize_bytes + count_ * kSerialRecordSize_bytes;
+    putUint(frame + length, crc16Ccitt(frame, length), 2);
+
+    std::size_t encoded = cobsEncode(frame, length + 2U, out);
+    out[encoded++] = kSerialFrameDelimiter;
+    count_ = 0;
+    sequence_++;
+    return encoded;
+}
+
+void SerialFrameDecoder::process(const uint8_t* data, std::size_t length) {
+    for (std::size_t i = 0; i < length; ++i) {
+        if (data[i] == kSerialFrameDelimiter) {
+            handleFrame();
+            length_ = 0;
+            overflow_ = false;
+        } else if (length_ < buffer_.size()) {
+            buffer_[length_++] = data[i];
+        } else {
+            overflow_ = true;  // Lost a delimiter; drop everything up to the next one
+        }
+    }
+}
+
+void SerialFrameDecoder::handleFrame() {
+    if (length_ == 0U) {
+        return;  // Back-to-back delimiters, e.g. a receiver that started mid-frame
+    }
+    const int decoded = overflow_ ? -1 : cobsDecode(buffer_.data(), length_, buffer_.data());
+    if (decoded < static_cast<int>(kSerialFrameHeaderSize_bytes + 2U)) {
+        badFrames_++;
+        return;
+    }
+    const auto size = static_cast<std::size_t>(decoded);
+    const uint8_t* frame = buffer_.data();
+    const std::size_t count = frame[7];
+    if (frame[0] != kSerialFrameVersion || size != kSerialFrameHeaderSize_bytes + count * kSerialRecordSize_bytes + 2U ||
+        getUint(frame + size - 2U, 2) != crc16Ccitt(frame, size - 2U)) {
+        badFrames_++;
+        return;
+    }
+
+    const auto sequence = static_cast<uint16_t>(getUint(frame + 1, 2));
+    if (haveSequence_) {
+        lostFrames_ += static_cast<uint16_t>(sequence - nextSequence_);
+    }
+    haveSequence_ = true;
+    nextSequence_ = static_cast<uint16_t>(sequence + 1U);
+    frames_++;
+
+    const uint32_t base_ms = getUint(frame + 3, 4);
+    const uint8_t* record = frame + kSerialFrameHeaderSize_bytes;
+    for (std::size_t i = 0; i < count; ++i, record += kSerialRecordSize_bytes) {
+        const uint32_t valueBits = getUint(record + 2, 4);
+        DecodedRecord decodedRecord = {base_ms + record[1], record[0], 0.0F};
+        std::memcpy(&decodedRecord.value, &valueBits, sizeof(valueBits));
+        sink_.onRecord(decodedRecord);
+        records_++;
+    }
+}
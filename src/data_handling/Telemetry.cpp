@@ -9,7 +9,7 @@ std::size_t bytesNeededForSSD(const SendableSensorData* ssd) {
     if (ssd->isSingle()) {
         return 1U + TelemetryFmt::kBytesInU32_bytes;
     }
-    if (ssd->isMulti()) {
+    if (ssd->isMulti() || ssd->isVector()) {
         // label + N floats
         return 1U + (static_cast<std::size_t>(ssd->multiSDHLength) * TelemetryFmt::kBytesInU32_bytes);
     }
@@ -162,9 +162,12 @@ void Telemetry::preparePacket(std::uint32_t timestamp_ms) {
 }
 
 void Telemetry::addSingleSDHToPacket(SensorDataHandler* sdh) {
-    float floatData = sdh->getLastDataPointSaved().data; 
+    addFloatToPacket(sdh->getLastDataPointSaved().data);
+}
+
+void Telemetry::addFloatToPacket(float value) {
     uint32_t data = 0;
-    memcpy(&data, &floatData, sizeof(data)); // Move float data into an uint32_t for bytewise access
+    memcpy(&data, &value, sizeof(data)); // Move float data into an uint32_t for bytewise access
     TelemetryFmt::writeU32Be(&this->packet_[nextEmptyPacketIndex_], data);
     nextEmptyPacketIndex_ += TelemetryFmt::kBytesInU32_bytes;
 }
@@ -184,6 +187,15 @@ void Telemetry::addSSDToPacket(SendableSensorData* ssd) {
             this->addSingleSDHToPacket(ssd->multiSDH[i]); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
         }
     }
+    if (ssd->isVector()) {
+        this->packet_[nextEmptyPacketIndex_] = ssd->multiSDHDataLabel;
+        nextEmptyPacketIndex_ += 1;
+        const DataVector& vector = ssd->vectorSDH->getLastDataVectorSaved();
+        for (size_t i = 0; i < ssd->multiSDHLength; i++) {
+            // Zero for components the vector does not have (e.g. before the first save)
+            this->addFloatToPacket(i < vector.size && i < kMaxDataVectorSize ? vector.data[i] : 0.0F);
+        }
+    }
 }
 
 void Telemetry::setPacketToZero() {
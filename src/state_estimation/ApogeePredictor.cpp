@@ -109,46 +109,16 @@ void ApogeePredictor::polyUpdate() {
     const float velocity_mps = vve_.getEstimatedVelocity();
     const float acceleration_mps2 = vve_.getInertialVerticalAcceleration();
 
-    constexpr size_t kFeatureCount = 10; // NOLINT(cppcoreguidelines-init-variables)
-
-    // Polynomial Regression Coefficients for C++
-    const std::array<float, kFeatureCount> coeffs = {
-        /* 1 */ 0.00000000F,
-        /* vertical_velocity */ 5.06108448F,
-        /* vertical_acceleration */ 63.94744144F,
-        /* delta_h_simple */ 0.52115350F,
-        /* vertical_velocity^2 */ 0.01494354F,
-        /* vertical_velocity vertical_acceleration */ 0.46012269F,
-        /* vertical_velocity delta_h_simple */ 0.01274390F,
-        /* vertical_acceleration^2 */ 3.27864634F,
-        /* vertical_acceleration delta_h_simple */ -0.00747177F,
-        /* delta_h_simple^2 */ -0.00208120F,
-    };
-    const float intercept = 308.64734694F;
-
-    // ───────────────────────────────────────────────────────
-    // Compute delta_h_simple = v^2 / (2 * decel), with decel > 0
     const float decel = std::fabs(acceleration_mps2);
-    const float delta_h_simple = kOneHalf * (velocity_mps * velocity_mps) / decel;
 
     // ───────────────────────────────────────────────────────
     // Evaluate the regression model
-    const std::array<float, kFeatureCount> inputs = {
-        1.0F,
-        velocity_mps,               // vertical_velocity
-        acceleration_mps2,          // vertical_acceleration
-        delta_h_simple,
-        velocity_mps * velocity_mps,  // vertical_velocity^2
-        velocity_mps * acceleration_mps2, // vertical_velocity vertical_acceleration
-        velocity_mps * delta_h_simple, // vertical_velocity delta_h_simple
-        acceleration_mps2 * acceleration_mps2, // vertical_acceleration^2
-        acceleration_mps2 * delta_h_simple, // vertical_acceleration delta_h_simple
-        delta_h_simple * delta_h_simple, // delta_h_simple^2
-    };
+    const std::array<float, ApogeePolyCoefficients::kFeatureCount> inputs =
+        polyFeatures(velocity_mps, acceleration_mps2);
 
-    float apogeeRemaining_m = intercept;
-    for (size_t i = 0; i < kFeatureCount; ++i) { // NOLINT(cppcoreguidelines-init-variables)
-        apogeeRemaining_m += coeffs[i] * inputs[i];
+    float apogeeRemaining_m = ApogeePolyCoefficients::kIntercept;
+    for (size_t i = 0; i < ApogeePolyCoefficients::kFeatureCount; ++i) { // NOLINT(cppcoreguidelines-init-variables)
+        apogeeRemaining_m += ApogeePolyCoefficients::kCoefficients[i] * inputs[i];
     }
 
     // ───────────────────────────────────────────────────────
@@ -164,9 +134,26 @@ void ApogeePredictor::polyUpdate() {
     lastTs_ = currentTimestamp_ms;
     lastVel_ = velocity_mps;
     numWarmups_ = std::min(numWarmups_ + 1, kMaxWarmups);
+}
 
-    // printf("Current Timestamp: %u, Altitude: %.2f, Velocity: %.2f, Acceleration: %.2f, Predicted Apogee Remaining: %.2f, Delta H: %.2f\n",
-    //        currentTimestamp_ms, altitude_m, velocity_mps, acceleration_mps2, apogeeRemaining_m, delta_h_simple);
+std::array<float, ApogeePolyCoefficients::kFeatureCount>
+ApogeePredictor::polyFeatures(float velocity_mps, float acceleration_mps2) {
+    // Compute delta_h_simple = v^2 / (2 * decel), with decel > 0
+    const float decel = std::fabs(acceleration_mps2);
+    const float delta_h_simple = kOneHalf * (velocity_mps * velocity_mps) / decel;
+
+    return {{
+        1.0F,
+        velocity_mps,               // vertical_velocity
+        acceleration_mps2,          // vertical_acceleration
+        delta_h_simple,
+        velocity_mps * velocity_mps,  // vertical_velocity^2
+        velocity_mps * acceleration_mps2, // vertical_velocity vertical_acceleration
+        velocity_mps * delta_h_simple, // vertical_velocity delta_h_simple
+        acceleration_mps2 * acceleration_mps2, // vertical_acceleration^2
+        acceleration_mps2 * delta_h_simple, // vertical_acceleration delta_h_simple
+        delta_h_simple * delta_h_simple, // delta_h_simple^2
+    }};
 }
 
 
@@ -1,3 +1,5 @@
+#include "ArduinoHAL.h"
+
 #include "state_estimation/BaseStateMachine.h"
 
 BaseStateMachine::BaseStateMachine(FlightState initialState) : state_(initialState) {}
@@ -6,7 +8,7 @@ uint8_t BaseStateMachine::getState() const {
     return static_cast<uint8_t>(state_);
 }
 
-bool BaseStateMachine::registerOnStateEntry(FlightState targetState, StateEntryCallback functionPtr) {
+bool BaseStateMachine::registerOnStateEntry(FlightState targetState, StateEntryCallback functionPtr, uint8_t priority) {
     if (functionPtr == nullptr) {
         return false;
     }
@@ -25,7 +27,7 @@ bool BaseStateMachine::registerOnStateEntry(FlightState targetState, StateEntryC
     }
 
     // Register the new callback
-    onStateEntryCallbacks_[callbackCount_] = {targetState, functionPtr};
+    onStateEntryCallbacks_[callbackCount_] = {targetState, functionPtr, priority};
     callbackCount_++;
     return true;
 }
@@ -37,10 +39,15 @@ bool BaseStateMachine::changeState(FlightState newState) {
 
     state_ = newState;
 
-    // Calling the registered callbacks for the new state
+    // Calling (or queueing) the registered callbacks for the new state
     for (std::size_t i = 0; i < callbackCount_; i++) {
         const StateCallbackRegistration& registration = onStateEntryCallbacks_[i];
-        if (registration.state == state_) {
+        if (registration.state != state_) {
+            continue;
+        }
+        if (dispatchMode_ == CallbackDispatch::Deferred) {
+            queueEvent(registration);
+        } else {
             registration.functionPtr();
         }
     }
@@ -48,6 +55,54 @@ bool BaseStateMachine::changeState(FlightState newState) {
     return true;
 }
 
+void BaseStateMachine::queueEvent(const StateCallbackRegistration& registration) {
+    if (pendingCount_ >= kMaxPendingEvents) {
+        // Never block or overwrite inside update(); the loss is visible through getDroppedEventCount()
+        droppedEvents_++;
+        return;
+    }
+    pendingEvents_[pendingCount_] = {registration.functionPtr, registration.priority, nextSequence_++,
+                                     static_cast<uint32_t>(micros())};
+    pendingCount_++;
+}
+
+std::size_t BaseStateMachine::dispatchPendingEvents() {
+    // Callbacks take no arguments and cannot reach changeState(), so the queue
+    // only shrinks here and the loop is bounded by kMaxPendingEvents.
+    std::size_t dispatched = 0;
+    while (pendingCount_ > 0) {
+        // Pick the highest priority, oldest event
+        std::size_t next = 0;
+        for (std::size_t i = 1; i < pendingCount_; i++) {
+            const PendingEvent& candidate = pendingEvents_[i];
+            const PendingEvent& best = pendingEvents_[next];
+            if (candidate.priority > best.priority ||
+                (candidate.priority == best.priority &&
+                 static_cast<int32_t>(candidate.sequence - best.sequence) < 0)) {
+                next = i;
+            }
+        }
+
+        const PendingEvent event = pendingEvents_[next];
+        pendingEvents_[next] = pendingEvents_[pendingCount_ - 1];
+        pendingCount_--;
+
+        lastEventLatency_us_ = static_cast<uint32_t>(micros()) - event.queuedAt_us;
+        if (lastEventLatency_us_ > maxEventLatency_us_) {
+            maxEventLatency_us_ = lastEventLatency_us_;
+        }
+        event.functionPtr();
+        dispatched++;
+    }
+    return dispatched;
+}
+
+void BaseStateMachine::resetEventStats() {
+    droppedEvents_ = 0;
+    lastEventLatency_us_ = 0;
+    maxEventLatency_us_ = 0;
+}
+
 FlightState BaseStateMachine::getFlightState() const {
     return state_;
 }
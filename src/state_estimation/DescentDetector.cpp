@@ -0,0 +1,85 @@
+#include "state_estimation/DescentDetector.h"
+
+#include <cmath>
+
+DescentDetector::DescentDetector(uint16_t windowInterval_ms,
+                                 float stableSpread_mps,
+                                 float mainRateRatio,
+                                 float landedSpeed_mps,
+                                 float landedAltitudeSpread_m,
+                                 uint32_t landedHold_ms)
+    : windowInterval_ms_(windowInterval_ms),
+      stableSpread_mps_(stableSpread_mps),
+      mainRateRatio_(mainRateRatio),
+      landedSpeed_mps_(landedSpeed_mps),
+      landedAltitudeSpread_m_(landedAltitudeSpread_m),
+      landedHold_ms_(landedHold_ms) {}
+
+void DescentDetector::update(VerticalVelocityEstimator* verticalVelocityEstimator) {
+    const uint32_t timestamp_ms = verticalVelocityEstimator->getTimestamp();
+    if (hasSample_ && timestamp_ms - lastSample_ms_ < windowInterval_ms_) {
+        return;
+    }
+    hasSample_ = true;
+    lastSample_ms_ = timestamp_ms;
+
+    velocityWindow_.push(verticalVelocityEstimator->getEstimatedVelocity());
+    altitudeWindow_.push(verticalVelocityEstimator->getEstimatedAltitude());
+    if (!velocityWindow_.isFull()) {
+        return;
+    }
+
+    const float meanVelocity_mps = velocityWindow_.getMean();
+    descentRate_mps_ = -meanVelocity_mps;
+    const bool stable = velocityWindow_.getMax() - velocityWindow_.getMin() < stableSpread_mps_;
+
+    if (!drogueDeployed_) {
+        if (stable && descentRate_mps_ >= kMinDrogueDescentRate_mps) {
+            drogueDeployed_ = true;
+            drogueTime_ms_ = timestamp_ms;
+            drogueDescentRate_mps_ = descentRate_mps_;
+        }
+    } else if (!mainDeployed_ && stable) {
+        if (descentRate_mps_ > drogueDescentRate_mps_) {
+            drogueDescentRate_mps_ = descentRate_mps_;
+        } else if (descentRate_mps_ < mainRateRatio_ * drogueDescentRate_mps_) {
+            mainDeployed_ = true;
+            mainTime_ms_ = timestamp_ms;
+        }
+    }
+
+    if (landed_) {
+        return;
+    }
+    const bool quiet = std::fabs(meanVelocity_mps) < landedSpeed_mps_ &&
+                       altitudeWindow_.getMax() - altitudeWindow_.getMin() < landedAltitudeSpread_m_;
+    if (!quiet) {
+        landedCandidate_ = false;
+        return;
+    }
+    if (!landedCandidate_) {
+        landedCandidate_ = true;
+        landedCandidateStart_ms_ = timestamp_ms;
+    }
+    if (timestamp_ms - landedCandidateStart_ms_ >= landedHold_ms_) {
+        landed_ = true;
+        landedTime_ms_ = timestamp_ms;
+    }
+}
+
+void DescentDetector::reset() {
+    velocityWindow_.clear();
+    altitudeWindow_.clear();
+    hasSample_ = false;
+    lastSample_ms_ = 0;
+    descentRate_mps_ = 0.0F;
+    drogueDescentRate_mps_ = 0.0F;
+    landedCandidate_ = false;
+    landedCandidateStart_ms_ = 0;
+    drogueDeployed_ = false;
+    mainDeployed_ = false;
+    landed_ = false;
+    drogueTime_ms_ = 0;
+    mainTime_ms_ = 0;
+    landedTime_ms_ = 0;
+}
@@ -0,0 +1,93 @@
+#include "state_estimation/GyroPreIntegrator.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace {
+constexpr float kOneHalf = 0.5F;
+constexpr float kOneSixth = 1.0F / 6.0F;
+constexpr float kMsToSeconds = 0.001F;
+}  // namespace
+
+GyroPreIntegrator::GyroPreIntegrator() { reset(); }
+
+void GyroPreIntegrator::reset() {
+    alphaX_ = 0.0F;
+    alphaY_ = 0.0F;
+    alphaZ_ = 0.0F;
+    betaX_ = 0.0F;
+    betaY_ = 0.0F;
+    betaZ_ = 0.0F;
+    prevDeltaX_ = 0.0F;
+    prevDeltaY_ = 0.0F;
+    prevDeltaZ_ = 0.0F;
+    prevRateX_ = 0.0F;
+    prevRateY_ = 0.0F;
+    prevRateZ_ = 0.0F;
+    intervalStart_ms_ = 0;
+    lastSample_ms_ = 0;
+    sampleCount_ = 0;
+    hasTimeBase_ = false;
+}
+
+void GyroPreIntegrator::addSample(const GyroTriplet& gyro) {
+    const uint32_t now_ms = gyro.x.timestamp_ms;
+    const float rateX = gyro.x.data;
+    const float rateY = gyro.y.data;
+    const float rateZ = gyro.z.data;
+
+    if (!hasTimeBase_) {
+        hasTimeBase_ = true;
+        intervalStart_ms_ = now_ms;
+        lastSample_ms_ = now_ms;
+        prevRateX_ = rateX;
+        prevRateY_ = rateY;
+        prevRateZ_ = rateZ;
+        return;
+    }
+    if (now_ms <= lastSample_ms_ || sampleCount_ == std::numeric_limits<uint16_t>::max()) {
+        return;
+    }
+
+    const float dt_s = static_cast<float>(now_ms - lastSample_ms_) * kMsToSeconds;
+    const float halfDt = kOneHalf * dt_s;
+    const float deltaX = (prevRateX_ + rateX) * halfDt;
+    const float deltaY = (prevRateY_ + rateY) * halfDt;
+    const float deltaZ = (prevRateZ_ + rateZ) * halfDt;
+
+    // Coning: 0.5 * (alpha + prevDelta / 6) x delta
+    const float crossX = alphaX_ + prevDeltaX_ * kOneSixth;
+    const float crossY = alphaY_ + prevDeltaY_ * kOneSixth;
+    const float crossZ = alphaZ_ + prevDeltaZ_ * kOneSixth;
+    betaX_ += kOneHalf * (crossY * deltaZ - crossZ * deltaY);
+    betaY_ += kOneHalf * (crossZ * deltaX - crossX * deltaZ);
+    betaZ_ += kOneHalf * (crossX * deltaY - crossY * deltaX);
+
+    alphaX_ += deltaX;
+    alphaY_ += deltaY;
+    alphaZ_ += deltaZ;
+
+    prevDeltaX_ = deltaX;
+    prevDeltaY_ = deltaY;
+    prevDeltaZ_ = deltaZ;
+    prevRateX_ = rateX;
+    prevRateY_ = rateY;
+    prevRateZ_ = rateZ;
+    lastSample_ms_ = now_ms;
+    ++sampleCount_;
+}
+
+RotationDelta GyroPreIntegrator::consume() {
+    const RotationDelta delta = {alphaX_ + betaX_, alphaY_ + betaY_, alphaZ_ + betaZ_,
+                                 intervalStart_ms_, lastSample_ms_, sampleCount_};
+
+    alphaX_ = 0.0F;
+    alphaY_ = 0.0F;
+    alphaZ_ = 0.0F;
+    betaX_ = 0.0F;
+    betaY_ = 0.0F;
+    betaZ_ = 0.0F;
+    intervalStart_ms_ = lastSample_ms_;
+    sampleCount_ = 0;
+    return delta;
+}
@@ -10,6 +10,10 @@ constexpr float kFour = 4.0F;
 constexpr float kEight = 8.0F;
 constexpr float kRecipTwo = 0.5F;
 constexpr float kMilliToSec = 1000.0F;
+constexpr float kSixth = 1.0F / 6.0F;
+constexpr float kTwentyFourth = 1.0F / 24.0F;
+// Below this rotation angle (rad) sin/cos are replaced by their Taylor series
+constexpr float kSmallAngle_rad = 1.0e-3F;
 
 
 void OrientationEstimator::update(AccelerationTriplet accel,
@@ -53,23 +57,13 @@ void OrientationEstimator::update(AccelerationTriplet accel,
             updateIMU(accel, gyro, currentTime);
         } else {
             // PURE GYRO INTEGRATION (no correction)
-            const float qDot1 = kRecipTwo * (-q1 * gyroX - q2 * gyroY - q3 * gyroZ);
-            const float qDot2 = kRecipTwo * ( q0 * gyroX + q2 * gyroZ - q3 * gyroY);
-            const float qDot3 = kRecipTwo * ( q0 * gyroY - q1 * gyroZ + q3 * gyroX);
-            const float qDot4 = kRecipTwo * ( q0 * gyroZ + q1 * gyroY - q2 * gyroX);
-
-            q0 += qDot1 * dt;
-            q1 += qDot2 * dt;
-            q2 += qDot3 * dt;
-            q3 += qDot4 * dt;
-
-            const float recipNorm = kOne / static_cast<float>(std::sqrt(q0*q0 + q1*q1 + q2*q2 + q3*q3));
-            q0 *= recipNorm;
-            q1 *= recipNorm;
-            q2 *= recipNorm;
-            q3 *= recipNorm;
-
-            getEuler();
+            if (gyroIntegrator == GyroIntegrator::FirstOrder) {
+                integrateFirstOrder(gyroX, gyroY, gyroZ, dt);
+            } else {
+                integrateRotationVector(gyroX * dt, gyroY * dt, gyroZ * dt);
+            }
+
+            eulerStale = true;
             lastUpdateTime = currentTime;
         }
         return;
@@ -79,6 +73,33 @@ void OrientationEstimator::update(AccelerationTriplet accel,
     updateFullAHRS(accel, gyro, mag, currentTime);
 }
 
+void OrientationEstimator::update(AccelerationTriplet accel,
+                                  const RotationDelta& rotation,
+                                  MagTriplet mag)
+{
+    if (rotation.sampleCount == 0 || rotation.endTime_ms <= rotation.startTime_ms) {
+        return;
+    }
+
+    if (hasLaunched) {
+        beta = betaFlight;
+        integrateRotationVector(rotation.x, rotation.y, rotation.z);
+        eulerStale = true;
+        lastUpdateTime = rotation.endTime_ms;
+        return;
+    }
+
+    // Pad: the AHRS filters work on rates, so feed the mean rate over the interval
+    lastUpdateTime = rotation.startTime_ms;
+    const float recipInterval = kMilliToSec / static_cast<float>(rotation.endTime_ms - rotation.startTime_ms);
+    const GyroTriplet meanRate = {
+        DataPoint(rotation.endTime_ms, rotation.x * recipInterval),
+        DataPoint(rotation.endTime_ms, rotation.y * recipInterval),
+        DataPoint(rotation.endTime_ms, rotation.z * recipInterval)
+    };
+    update(accel, meanRate, mag, rotation.endTime_ms);
+}
+
 void OrientationEstimator::updateFullAHRS(AccelerationTriplet accel, GyroTriplet gyro, MagTriplet mag, uint32_t currentTime){
 	float accelX = accel.x.data;
     float accelY = accel.y.data;
@@ -199,7 +220,7 @@ void OrientationEstimator::updateFullAHRS(AccelerationTriplet accel, GyroTriplet
 	q2 *= recipNorm;
 	q3 *= recipNorm;
 
-	getEuler();
+	eulerStale = true;
 	lastUpdateTime = currentTime;
 }
 
@@ -289,11 +310,65 @@ void OrientationEstimator::updateIMU(AccelerationTriplet accel, GyroTriplet gyro
 	q2 *= recipNorm;
 	q3 *= recipNorm;
 
-	getEuler();
+	eulerStale = true;
 	lastUpdateTime = currentTime;
 }
 
-void OrientationEstimator::getEuler()
+void OrientationEstimator::integrateRotationVector(float rotX, float rotY, float rotZ)
+{
+    // Quaternion exponential of half the rotation vector: dq = [cos(|r|/2), r * sin(|r|/2) / |r|]
+    const float angleSq = rotX * rotX + rotY * rotY + rotZ * rotZ;
+    const float halfAngleSq = angleSq * kRecipTwo * kRecipTwo;
+
+    float dqW = 0.0F;
+    float scale = 0.0F; // sin(|r|/2) / |r|
+    if (angleSq < kSmallAngle_rad * kSmallAngle_rad) {
+        dqW = kOne - halfAngleSq * kRecipTwo + halfAngleSq * halfAngleSq * kTwentyFourth;
+        scale = kRecipTwo * (kOne - halfAngleSq * kSixth);
+    } else {
+        const auto angle = static_cast<float>(std::sqrt(angleSq));
+        const float halfAngle = kRecipTwo * angle;
+        dqW = static_cast<float>(std::cos(halfAngle));
+        scale = static_cast<float>(std::sin(halfAngle)) / angle;
+    }
+    const float dqX = rotX * scale;
+    const float dqY = rotY * scale;
+    const float dqZ = rotZ * scale;
+
+    // Body-frame rates: q = q * dq
+    const float w = q0 * dqW - q1 * dqX - q2 * dqY - q3 * dqZ;
+    const float x = q0 * dqX + q1 * dqW + q2 * dqZ - q3 * dqY;
+    const float y = q0 * dqY - q1 * dqZ + q2 * dqW + q3 * dqX;
+    const float z = q0 * dqZ + q1 * dqY - q2 * dqX + q3 * dqW;
+
+    // dq is unit length, so this only removes accumulated float rounding
+    const float recipNorm = kOne / static_cast<float>(std::sqrt(w * w + x * x + y * y + z * z));
+    q0 = w * recipNorm;
+    q1 = x * recipNorm;
+    q2 = y * recipNorm;
+    q3 = z * recipNorm;
+}
+
+void OrientationEstimator::integrateFirstOrder(float gyroX, float gyroY, float gyroZ, float dt)
+{
+    const float qDot1 = kRecipTwo * (-q1 * gyroX - q2 * gyroY - q3 * gyroZ);
+    const float qDot2 = kRecipTwo * ( q0 * gyroX + q2 * gyroZ - q3 * gyroY);
+    const float qDot3 = kRecipTwo * ( q0 * gyroY - q1 * gyroZ + q3 * gyroX);
+    const float qDot4 = kRecipTwo * ( q0 * gyroZ + q1 * gyroY - q2 * gyroX);
+
+    q0 += qDot1 * dt;
+    q1 += qDot2 * dt;
+    q2 += qDot3 * dt;
+    q3 += qDot4 * dt;
+
+    const float recipNorm = kOne / static_cast<float>(std::sqrt(q0*q0 + q1*q1 + q2*q2 + q3*q3));
+    q0 *= recipNorm;
+    q1 *= recipNorm;
+    q2 *= recipNorm;
+    q3 *= recipNorm;
+}
+
+void OrientationEstimator::getEuler() const
 {
     // Roll (x-accelXis rotation)
     roll = static_cast<float>(std::atan2(
@@ -0,0 +1,184 @@
+#include "ArduinoHAL.h"
+
+#include "data_handling/DataNames.h"
+#include "state_estimation/TableStateMachine.h"
+
+TableStateMachine::TableStateMachine(const FlightProfile& profile, IDataSaver* dataSaver,
+                                     LaunchDetector* launchDetector, ApogeeDetector* apogeeDetector,
+                                     VerticalVelocityEstimator* verticalVelocityEstimator,
+                                     FastLaunchDetector* fastLaunchDetector, DescentDetector* descentDetector)
+    : BaseStateMachine(profile.initialState),
+      transitions_(profile.transitions),
+      dataSaver_(dataSaver),
+      launchDetector_(launchDetector),
+      apogeeDetector_(apogeeDetector),
+      verticalVelocityEstimator_(verticalVelocityEstimator),
+      fastLaunchDetector_(fastLaunchDetector),
+      descentDetector_(descentDetector)
+{
+    if (profile.initialState >= kFlightStateCount ||
+        (profile.transitionCount > 0 && profile.transitions == nullptr) ||
+        (profile.stateCount > 0 && profile.states == nullptr)) {
+        profileValid_ = false;
+        return;
+    }
+
+    for (uint8_t i = 0; i < profile.stateCount; ++i) {
+        const StateUpdates& entry = profile.states[i];
+        if (entry.state >= kFlightStateCount || stateKnown_[entry.state]) {
+            profileValid_ = false;
+            return;
+        }
+        stateKnown_[entry.state] = true;
+        stateUpdates_[entry.state] = entry.updates;
+    }
+
+    // Flatten the transition rows into one contiguous [firstRow, firstRow + rowCount) range per state
+    for (uint8_t i = 0; i < profile.transitionCount; ++i) {
+        const StateTransition& row = profile.transitions[i];
+        if (row.from >= kFlightStateCount || row.to >= kFlightStateCount || !stateKnown_[row.from]) {
+            profileValid_ = false;
+            return;
+        }
+        if (rowCount_[row.from] == 0) {
+            firstRow_[row.from] = i;
+        } else if (static_cast<uint8_t>(firstRow_[row.from] + rowCount_[row.from]) != i) {
+            profileValid_ = false; // rows for this state are split across the table
+            return;
+        }
+        ++rowCount_[row.from];
+    }
+}
+
+int TableStateMachine::update(const AccelerationTriplet& accel, const DataPoint& alt) {
+    if (!profileValid_) {
+        return 2;
+    }
+
+    const FlightState state = getFlightState();
+    if (!stateKnown_[state]) {
+        // Unexpected state, error return
+        return 1;
+    }
+
+    const unsigned long start_us = micros();
+
+    runStateUpdates(stateUpdates_[state], accel, alt);
+
+    const uint8_t first = firstRow_[state];
+    const uint8_t count = rowCount_[state];
+    for (uint8_t i = 0; i < count; ++i) {
+        const StateTransition& row = transitions_[first + i];
+        if (isGuardSatisfied(row.guard, accel)) {
+            changeState(row.to);
+            runActions(row.actions, row.to, accel, alt);
+            break;
+        }
+    }
+
+    const auto elapsed_us = static_cast<uint32_t>(micros() - start_us);
+    if (elapsed_us > worstUpdate_us_[state]) {
+        worstUpdate_us_[state] = elapsed_us;
+    }
+    return 0;
+}
+
+uint32_t TableStateMachine::getWorstCaseUpdateTime_us(FlightState state) const {
+    return state < kFlightStateCount ? worstUpdate_us_[state] : 0U;
+}
+
+void TableStateMachine::resetUpdateTimes() {
+    worstUpdate_us_.fill(0U);
+}
+
+void TableStateMachine::runStateUpdates(uint8_t updates, const AccelerationTriplet& accel, const DataPoint& alt) {
+    if ((updates & StateUpdate::kLaunchDetector) != 0U && launchDetector_ != nullptr) {
+        launchDetector_->update(accel);
+    }
+    if ((updates & StateUpdate::kFastLaunchDetector) != 0U && fastLaunchDetector_ != nullptr &&
+        (launchDetector_ == nullptr || !launchDetector_->isLaunched())) {
+        fastLaunchDetector_->update(accel);
+    }
+    if ((updates & StateUpdate::kVerticalVelocity) != 0U && verticalVelocityEstimator_ != nullptr) {
+        verticalVelocityEstimator_->update(accel, alt);
+    }
+    if ((updates & StateUpdate::kApogeeDetector) != 0U && apogeeDetector_ != nullptr &&
+        verticalVelocityEstimator_ != nullptr) {
+        apogeeDetector_->update(verticalVelocityEstimator_);
+    }
+    if ((updates & StateUpdate::kDescentDetector) != 0U && descentDetector_ != nullptr &&
+        verticalVelocityEstimator_ != nullptr) {
+        descentDetector_->update(verticalVelocityEstimator_);
+    }
+}
+
+bool TableStateMachine::isGuardSatisfied(TransitionGuard guard, const AccelerationTriplet& accel) {
+    switch (guard) {
+        case TransitionGuard::LaunchDetected:
+            return launchDetector_ != nullptr && launchDetector_->isLaunched();
+
+        case TransitionGuard::FastLaunchDetected:
+            return fastLaunchDetector_ != nullptr && fastLaunchDetector_->hasLaunched();
+
+        case TransitionGuard::FastLaunchWindowExpired:
+            return fastLaunchDetector_ != nullptr &&
+                   accel.x.timestamp_ms - fldLaunchTime_ms_ > fastLaunchDetector_->getConfirmationWindow();
+
+        case TransitionGuard::ApogeeDetected:
+            return apogeeDetector_ != nullptr && apogeeDetector_->isApogeeDetected();
+
+        case TransitionGuard::Coasting:
+            // When acceleration returns to less than gravity after launch, we're coasting
+            return verticalVelocityEstimator_ != nullptr &&
+                   verticalVelocityEstimator_->getInertialVerticalAcceleration() <= 0;
+
+        case TransitionGuard::DrogueDeployed:
+            return descentDetector_ != nullptr && descentDetector_->isDrogueDeployed();
+
+        case TransitionGuard::MainDeployed:
+            return descentDetector_ != nullptr && descentDetector_->isMainDeployed();
+
+        case TransitionGuard::Landed:
+            return descentDetector_ != nullptr && descentDetector_->isLanded();
+    }
+    return false;
+}
+
+void TableStateMachine::runActions(uint16_t actions, FlightState newState, const AccelerationTriplet& accel,
+                                   const DataPoint& alt) {
+    if ((actions & TransitionAction::kRecordFastLaunchTime) != 0U && fastLaunchDetector_ != nullptr) {
+        fldLaunchTime_ms_ = fastLaunchDetector_->getLaunchedTime();
+    }
+    if ((actions & TransitionAction::kResetFastLaunch) != 0U) {
+        fldLaunchTime_ms_ = 0;
+        if (fastLaunchDetector_ != nullptr) {
+            fastLaunchDetector_->reset();
+        }
+    }
+    if (dataSaver_ != nullptr) {
+        if ((actions & TransitionAction::kLogStateChange) != 0U) {
+            dataSaver_->saveDataPoint(DataPoint(accel.x.timestamp_ms, newState), STATE_CHANGE);
+        }
+        if ((actions & TransitionAction::kLogStateChangeAtY) != 0U) {
+            dataSaver_->saveDataPoint(DataPoint(accel.y.timestamp_ms, newState), STATE_CHANGE);
+        }
+        if ((actions & TransitionAction::kSaverLaunchAtLaunchTime) != 0U && launchDetector_ != nullptr) {
+            dataSaver_->launchDetected(launchDetector_->getLaunchedTime());
+        }
+        if ((actions & TransitionAction::kSaverLaunchAtFastLaunch) != 0U && fastLaunchDetector_ != nullptr) {
+            dataSaver_->launchDetected(fastLaunchDetector_->getLaunchedTime());
+        }
+        if ((actions & TransitionAction::kClearPostLaunchMode) != 0U) {
+            dataSaver_->clearPostLaunchMode();
+        }
+        if ((actions & TransitionAction::kSaverLandingDetected) != 0U && descentDetector_ != nullptr) {
+            dataSaver_->landingDetected(descentDetector_->getLandedTime());
+        }
+    }
+    if ((actions & TransitionAction::kInitApogeeDetector) != 0U && apogeeDetector_ != nullptr) {
+        apogeeDetector_->init({alt.data, alt.timestamp_ms});
+    }
+    if ((actions & TransitionAction::kUpdateVerticalVelocity) != 0U && verticalVelocityEstimator_ != nullptr) {
+        verticalVelocityEstimator_->update(accel, alt);
+    }
+}
@@ -91,7 +91,7 @@ private:
     float altitude_;              // Current altitude (m)
     float velocity_;              // Current vertical velocity (m/s)
     float netAcceleration_;       // Net acceleration applied to velocity (m/s²)
-    bool hasLanded_;            // Simulation complete flag
+    bool hasLanded_ = false;      // Simulation complete flag
 
     // --- Apogee tracking ---
     float apogeeAltitude_;        // Maximum altitude reached (m)
@@ -0,0 +1,462 @@
+#include "unity.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data_handling/DataPoint.h"
+#include "state_estimation/ApogeePolyCoefficients.h"
+#include "state_estimation/ApogeePredictor.h"
+#include "state_estimation/VerticalVelocityEstimator.h"
+
+// Offline fitting tool for ApogeePredictor::polyUpdate().
+//
+// Replays the flight CSVs in data/ through VerticalVelocityEstimator, builds the
+// exact feature vector used on the flight computer, solves the least-squares
+// regression for the altitude still to be gained, reports leave-one-flight-out
+// error and writes a constexpr coefficient header.
+//
+// By default the header is written to the system temp directory so that running
+// the test suite never modifies the tree. To replace the shipped coefficients run:
+//
+//     APOGEE_POLY_FIT_WRITE=1 pio test -e native -f test_apogee_poly_fit
+
+namespace {
+
+constexpr size_t kFeatureCount = ApogeePolyCoefficients::kFeatureCount;
+using FeatureVector = std::array<double, kFeatureCount>;
+
+const char* const kFlightFiles[] = {
+    "data/MARTHA_3-8_1.3_B2_SingleID_transformed.csv",
+    "data/MARTHA_IREC_2025_B2_transformed.csv",
+    "data/AA Data Collection - Second Launch Trimmed.csv",
+};
+
+const char* const kFeatureNames[kFeatureCount] = {
+    "1",
+    "vertical_velocity",
+    "vertical_acceleration",
+    "delta_h_simple",
+    "vertical_velocity^2",
+    "vertical_velocity vertical_acceleration",
+    "vertical_velocity delta_h_simple",
+    "vertical_acceleration^2",
+    "vertical_acceleration delta_h_simple",
+    "delta_h_simple^2",
+};
+
+const char* const kGeneratedHeaderName = "apogee_poly_coefficients_generated.h";
+const char* const kShippedHeaderPath = "include/state_estimation/ApogeePolyCoefficients.h";
+
+// Only coasting samples are used for training: the model is meant to be run
+// after burnout while the rocket is still climbing.
+constexpr float kMinTrainingVelocity_mps = 5.0F;
+constexpr float kMaxTrainingAcceleration_mps2 = -1.0F;
+
+// Small ridge term on the standardized features keeps the normal equations
+// well conditioned (several features are strongly collinear).
+constexpr double kRidgeLambda = 1e-9;
+
+struct Sample {
+    FeatureVector features;
+    double remaining_m;
+    size_t flight;
+};
+
+struct PolyFit {
+    FeatureVector coefficients;
+    double intercept;
+};
+
+// Scratch location for the generated header, outside the checkout
+std::string generatedHeaderPath() {
+    const char* dir = std::getenv("TMPDIR");
+    if (dir == nullptr || *dir == '\0') dir = std::getenv("TEMP");
+    if (dir == nullptr || *dir == '\0') dir = "/tmp";
+    return std::string(dir) + "/" + kGeneratedHeaderName;
+}
+
+float safe_stof(const std::string& s, float default_val = 0.0f) {
+    try {
+        return std::stof(s);
+    } catch (...) {
+        return default_val;
+    }
+}
+
+uint32_t safe_stoul(const std::string& s, uint32_t default_val = 0U) {
+    try {
+        const unsigned long parsedValue = std::stoul(s);
+        if (parsedValue > static_cast<unsigned long>(std::numeric_limits<uint32_t>::max())) {
+            return default_val;
+        }
+        return static_cast<uint32_t>(parsedValue);
+    } catch (...) {
+        return default_val;
+    }
+}
+
+FeatureVector buildFeatures(float velocity_mps, float acceleration_mps2) {
+    const std::array<float, kFeatureCount> features =
+        ApogeePredictor::polyFeatures(velocity_mps, acceleration_mps2);
+    FeatureVector out{};
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        out[i] = static_cast<double>(features[i]);
+    }
+    return out;
+}
+
+bool isTrainingSample(float velocity_mps, float acceleration_mps2) {
+    return velocity_mps > kMinTrainingVelocity_mps &&
+           acceleration_mps2 < kMaxTrainingAcceleration_mps2;
+}
+
+/**
+ * Replays one flight CSV through the estimator and appends its coasting
+ * samples. The target is the baro apogee minus the estimated altitude.
+ * @return number of samples added, or 0 if the file could not be read.
+ */
+size_t loadFlight(const char* filename, size_t flight, std::vector<Sample>& samples) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    struct Replayed {
+        uint32_t ts;
+        float altitude;
+        float velocity;
+        float acceleration;
+    };
+    std::vector<Replayed> replayed;
+
+    VerticalVelocityEstimator vve;
+    float trueApogee_m = -std::numeric_limits<float>::max();
+    uint32_t apogeeTs_ms = 0;
+
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string token;
+        std::vector<std::string> tokens;
+        while (std::getline(ss, token, ',')) tokens.push_back(token);
+        if (tokens.size() <= 10) continue;
+
+        const uint32_t ts = safe_stoul(tokens[0]);
+        const float ax = safe_stof(tokens[1]);
+        const float ay = safe_stof(tokens[2]);
+        const float az = safe_stof(tokens[3]);
+        const float alt = safe_stof(tokens[10]);
+
+        if (alt > trueApogee_m) {
+            trueApogee_m = alt;
+            apogeeTs_ms = ts;
+        }
+
+        const AccelerationTriplet accel = {DataPoint(ts, ax), DataPoint(ts, ay), DataPoint(ts, az)};
+        vve.update(accel, DataPoint(ts, alt));
+        replayed.push_back({ts, vve.getEstimatedAltitude(), vve.getEstimatedVelocity(),
+                            vve.getInertialVerticalAcceleration()});
+    }
+
+    size_t added = 0;
+    for (const Replayed& r : replayed) {
+        if (r.ts >= apogeeTs_ms || !isTrainingSample(r.velocity, r.acceleration)) {
+            continue;
+        }
+        samples.push_back({buildFeatures(r.velocity, r.acceleration),
+                           static_cast<double>(trueApogee_m - r.altitude), flight});
+        ++added;
+    }
+    return added;
+}
+
+/**
+ * Solves A x = b in place with partial pivoting. A is n x n row-major.
+ * @return false if the system is singular.
+ */
+template <size_t N>
+bool solveLinearSystem(std::array<std::array<double, N>, N>& A, std::array<double, N>& b) {
+    for (size_t col = 0; col < N; ++col) {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < N; ++row) {
+            if (std::fabs(A[row][col]) > std::fabs(A[pivot][col])) pivot = row;
+        }
+        if (std::fabs(A[pivot][col]) < 1e-300) return false;
+        std::swap(A[pivot], A[col]);
+        std::swap(b[pivot], b[col]);
+
+        for (size_t row = col + 1; row < N; ++row) {
+            const double factor = A[row][col] / A[col][col];
+            for (size_t k = col; k < N; ++k) A[row][k] -= factor * A[col][k];
+            b[row] -= factor * b[col];
+        }
+    }
+    for (size_t i = N; i-- > 0;) {
+        double sum = b[i];
+        for (size_t k = i + 1; k < N; ++k) sum -= A[i][k] * b[k];
+        b[i] = sum / A[i][i];
+    }
+    return true;
+}
+
+/**
+ * Least-squares fit on every sample whose flight != excludedFlight.
+ *
+ * Feature 0 is the constant term; it is folded into the intercept (and its
+ * coefficient left at zero) so the header keeps the polyUpdate() layout.
+ * The remaining features are standardized before forming the normal equations.
+ */
+bool fitPolynomial(const std::vector<Sample>& samples, size_t excludedFlight, PolyFit& fit) {
+    FeatureVector mean{};
+    FeatureVector scale{};
+    double count = 0.0;
+    for (const Sample& s : samples) {
+        if (s.flight == excludedFlight) continue;
+        for (size_t j = 1; j < kFeatureCount; ++j) mean[j] += s.features[j];
+        count += 1.0;
+    }
+    if (count < static_cast<double>(kFeatureCount)) return false;
+    for (size_t j = 1; j < kFeatureCount; ++j) mean[j] /= count;
+
+    for (const Sample& s : samples) {
+        if (s.flight == excludedFlight) continue;
+        for (size_t j = 1; j < kFeatureCount; ++j) {
+            const double d = s.features[j] - mean[j];
+            scale[j] += d * d;
+        }
+    }
+    for (size_t j = 1; j < kFeatureCount; ++j) {
+        scale[j] = std::sqrt(scale[j] / count);
+        if (scale[j] <= 0.0) scale[j] = 1.0;
+    }
+
+    // Column 0 of the standardized design is the constant 1.
+    std::array<std::array<double, kFeatureCount>, kFeatureCount> normal{};
+    std::array<double, kFeatureCount> rhs{};
+    for (const Sample& s : samples) {
+        if (s.flight == excludedFlight) continue;
+        FeatureVector z{};
+        z[0] = 1.0;
+        for (size_t j = 1; j < kFeatureCount; ++j) z[j] = (s.features[j] - mean[j]) / scale[j];
+        for (size_t r = 0; r < kFeatureCount; ++r) {
+            for (size_t c = 0; c < kFeatureCount; ++c) normal[r][c] += z[r] * z[c];
+            rhs[r] += z[r] * s.remaining_m;
+        }
+    }
+    for (size_t j = 1; j < kFeatureCount; ++j) normal[j][j] += kRidgeLambda * count;
+
+    if (!solveLinearSystem(normal, rhs)) return false;
+
+    fit.coefficients.fill(0.0);
+    fit.intercept = rhs[0];
+    for (size_t j = 1; j < kFeatureCount; ++j) {
+        fit.coefficients[j] = rhs[j] / scale[j];
+        fit.intercept -= rhs[j] * mean[j] / scale[j];
+    }
+    return true;
+}
+
+PolyFit shippedFit() {
+    PolyFit fit{};
+    for (size_t j = 0; j < kFeatureCount; ++j) {
+        fit.coefficients[j] = static_cast<double>(ApogeePolyCoefficients::kCoefficients[j]);
+    }
+    fit.intercept = static_cast<double>(ApogeePolyCoefficients::kIntercept);
+    return fit;
+}
+
+// Evaluates in float with float-rounded coefficients, like polyUpdate() does.
+float predictRemaining(const PolyFit& fit, const FeatureVector& features) {
+    float remaining = static_cast<float>(fit.intercept);
+    for (size_t j = 0; j < kFeatureCount; ++j) {
+        remaining += static_cast<float>(fit.coefficients[j]) * static_cast<float>(features[j]);
+    }
+    return remaining;
+}
+
+double rmsError(const PolyFit& fit, const std::vector<Sample>& samples, size_t onlyFlight) {
+    double sumSq = 0.0;
+    size_t n = 0;
+    for (const Sample& s : samples) {
+        if (onlyFlight != SIZE_MAX && s.flight != onlyFlight) continue;
+        const double err = static_cast<double>(predictRemaining(fit, s.features)) - s.remaining_m;
+        sumSq += err * err;
+        ++n;
+    }
+    return n > 0 ? std::sqrt(sumSq / static_cast<double>(n)) : 0.0;
+}
+
+std::string formatCoefficient(double value) {
+    char buf[32];
+    if (value != 0.0 && std::fabs(value) < 1e-4) {
+        std::snprintf(buf, sizeof(buf), "%.8eF", value);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.8fF", value);
+    }
+    return buf;
+}
+
+bool writeHeader(const char* path, const PolyFit& fit) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "#ifndef APOGEE_POLY_COEFFICIENTS_H\n"
+           "#define APOGEE_POLY_COEFFICIENTS_H\n"
+           "\n"
+           "// Regression coefficients for ApogeePredictor::polyUpdate().\n"
+           "//\n"
+           "// This file is generated by the fitting tool in test/test_apogee_poly_fit.\n"
+           "// To refit for a new airframe, place its flight CSVs in data/ and run:\n"
+           "//\n"
+           "//     APOGEE_POLY_FIT_WRITE=1 pio test -e native -f test_apogee_poly_fit\n"
+           "//\n"
+           "// Feature order: [1, v, a, dh, v^2, v*a, v*dh, a^2, a*dh, dh^2]\n"
+           "// where v = vertical velocity (m/s), a = inertial vertical acceleration (m/s^2)\n"
+           "// and dh = v^2 / (2|a|). The model predicts the altitude still to be gained (m).\n"
+           "\n"
+           "#include <array>\n"
+           "#include <cstddef>\n"
+           "\n"
+           "namespace ApogeePolyCoefficients {\n"
+           "\n"
+           "constexpr size_t kFeatureCount = 10;\n"
+           "\n"
+           "constexpr std::array<float, kFeatureCount> kCoefficients = {{\n";
+    for (size_t j = 0; j < kFeatureCount; ++j) {
+        out << "    /* " << kFeatureNames[j] << " */ " << formatCoefficient(fit.coefficients[j]) << ",\n";
+    }
+    out << "}};\n"
+           "\n"
+           "constexpr float kIntercept = " << formatCoefficient(fit.intercept) << ";\n"
+           "\n"
+           "}  // namespace ApogeePolyCoefficients\n"
+           "\n"
+           "#endif  // APOGEE_POLY_COEFFICIENTS_H\n";
+    return out.good();
+}
+
+}  // namespace
+
+/* ---------- Unity fixtures ---------- */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* ---------- Test 1: Solver recovers a known model ---------- */
+void test_fit_recovers_known_polynomial(void) {
+    const PolyFit truth = shippedFit();
+    std::default_random_engine rng{7};
+    std::uniform_real_distribution<float> velocity(10.0F, 250.0F);
+    std::uniform_real_distribution<float> acceleration(-60.0F, -9.0F);
+
+    std::vector<Sample> samples;
+    for (size_t i = 0; i < 4000; ++i) {
+        const FeatureVector f = buildFeatures(velocity(rng), acceleration(rng));
+        double y = truth.intercept;
+        for (size_t j = 0; j < kFeatureCount; ++j) y += truth.coefficients[j] * f[j];
+        samples.push_back({f, y, i % 2});
+    }
+
+    PolyFit fit{};
+    TEST_ASSERT_TRUE(fitPolynomial(samples, SIZE_MAX, fit));
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, static_cast<float>(fit.coefficients[0]));
+
+    // Held-out half must be reproduced to well under a metre
+    PolyFit halfFit{};
+    TEST_ASSERT_TRUE(fitPolynomial(samples, 1, halfFit));
+    TEST_ASSERT_LESS_THAN_FLOAT(0.5, rmsError(halfFit, samples, 1));
+    TEST_ASSERT_LESS_THAN_FLOAT(0.5, rmsError(fit, samples, SIZE_MAX));
+}
+
+/* ---------- Test 2: Generated header round-trips ---------- */
+void test_generated_header_is_parseable(void) {
+    const PolyFit fit = shippedFit();
+    const std::string path = generatedHeaderPath();
+    TEST_ASSERT_TRUE(writeHeader(path.c_str(), fit));
+
+    std::ifstream in(path);
+    TEST_ASSERT_TRUE(in.is_open());
+    std::string line;
+    size_t coefficientLines = 0;
+    bool sawIntercept = false;
+    while (std::getline(in, line)) {
+        if (line.find("/* ") == 4 && line.find(" */ ") != std::string::npos) ++coefficientLines;
+        if (line.find("constexpr float kIntercept = ") == 0) {
+            const float parsed = std::stof(line.substr(29));
+            TEST_ASSERT_EQUAL_FLOAT(ApogeePolyCoefficients::kIntercept, parsed);
+            sawIntercept = true;
+        }
+    }
+    TEST_ASSERT_EQUAL(kFeatureCount, coefficientLines);
+    TEST_ASSERT_TRUE(sawIntercept);
+}
+
+/* ---------- Test 3: Fit the flight CSVs with leave-one-flight-out CV ---------- */
+void test_fit_flight_csvs_cross_validated(void) {
+    std::vector<Sample> samples;
+    size_t flightCount = 0;
+    for (const char* filename : kFlightFiles) {
+        const size_t added = loadFlight(filename, flightCount, samples);
+        TEST_ASSERT_TRUE_MESSAGE(added > 0, ("No coasting samples in CSV: " + std::string(filename)).c_str());
+        ++flightCount;
+    }
+
+    const PolyFit shipped = shippedFit();
+
+    printf("\n===== POLY APOGEE FIT (leave-one-flight-out) =====\n");
+    printf("%-55s %8s %14s %14s\n", "held-out flight", "samples", "refit RMS [m]", "shipped RMS [m]");
+    double heldOutSumSq = 0.0;
+    size_t heldOutCount = 0;
+    for (size_t k = 0; k < flightCount; ++k) {
+        PolyFit fold{};
+        TEST_ASSERT_TRUE_MESSAGE(fitPolynomial(samples, k, fold), "Normal equations are singular");
+
+        size_t n = 0;
+        for (const Sample& s : samples) n += (s.flight == k) ? 1U : 0U;
+        const double foldRms = rmsError(fold, samples, k);
+        heldOutSumSq += foldRms * foldRms * static_cast<double>(n);
+        heldOutCount += n;
+        printf("%-55s %8zu %14.2f %14.2f\n", kFlightFiles[k], n, foldRms, rmsError(shipped, samples, k));
+    }
+    const double heldOutRms = std::sqrt(heldOutSumSq / static_cast<double>(heldOutCount));
+
+    PolyFit all{};
+    TEST_ASSERT_TRUE_MESSAGE(fitPolynomial(samples, SIZE_MAX, all), "Normal equations are singular");
+    const double fitRms = rmsError(all, samples, SIZE_MAX);
+    const double shippedRms = rmsError(shipped, samples, SIZE_MAX);
+
+    printf("Held-out RMS error: %.2f m over %zu samples\n", heldOutRms, heldOutCount);
+    printf("In-sample RMS error: refit %.2f m, shipped %.2f m\n", fitRms, shippedRms);
+    for (size_t j = 0; j < kFeatureCount; ++j) {
+        printf("  %-42s %s\n", kFeatureNames[j], formatCoefficient(all.coefficients[j]).c_str());
+    }
+    printf("  %-42s %s\n", "intercept", formatCoefficient(all.intercept).c_str());
+
+    TEST_ASSERT_TRUE(std::isfinite(heldOutRms));
+    // Least squares on the same samples can only match or beat the shipped model
+    TEST_ASSERT_TRUE(fitRms <= shippedRms * 1.001 + 1e-3);
+
+    const char* writeEnv = std::getenv("APOGEE_POLY_FIT_WRITE");
+    const bool writeShipped = (writeEnv != nullptr) && (std::string(writeEnv) == "1");
+    const std::string path = writeShipped ? std::string(kShippedHeaderPath) : generatedHeaderPath();
+    TEST_ASSERT_TRUE_MESSAGE(writeHeader(path.c_str(), all), "Failed to write coefficient header");
+    printf("Wrote %s\n", path.c_str());
+}
+
+/* ---------- main runner ----------------------- */
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fit_recovers_known_polynomial);
+    RUN_TEST(test_generated_header_is_parseable);
+    RUN_TEST(test_fit_flight_csvs_cross_validated);
+    return UNITY_END();
+}
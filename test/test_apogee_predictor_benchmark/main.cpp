@@ -0,0 +1,271 @@
+#include "unity.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AirResistanceSimulation.h"
+#include "data_handling/DataPoint.h"
+#include "state_estimation/ApogeePredictor.h"
+#include "state_estimation/VerticalVelocityEstimator.h"
+
+// Accuracy-versus-cost benchmark for every ApogeePredictor model.
+//
+// Each model is run over an AirResistanceSimulator sweep and the real flight
+// CSVs. For every flight the prediction is sampled a fixed time before the true
+// apogee (T-10 s, T-5 s, T-2 s) and the RMS apogee error is reported per bucket
+// together with the mean and worst-case wall time per call.
+//
+// Results are printed and written to apogee_predictor_benchmark.csv; plot them
+// with view_benchmark.py. Timings come from the native test build (-O1 with
+// sanitizers), so compare models against each other rather than against the
+// flight computer's absolute budget.
+
+namespace {
+
+struct Method {
+    const char* name;
+    void (ApogeePredictor::*update)();
+};
+
+const std::array<Method, 5> kMethods = {{
+    {"update", &ApogeePredictor::update},
+    {"quadUpdate", &ApogeePredictor::quadUpdate},
+    {"polyUpdate", &ApogeePredictor::polyUpdate},
+    {"analyticUpdate", &ApogeePredictor::analyticUpdate},
+    {"simulateUpdate", &ApogeePredictor::simulateUpdate},
+}};
+
+constexpr size_t kBucketCount = 3;
+const std::array<uint32_t, kBucketCount> kBucketLead_ms = {{10000, 5000, 2000}};
+
+const char* const kFlightFiles[] = {
+    "data/MARTHA_3-8_1.3_B2_SingleID_transformed.csv",
+    "data/MARTHA_IREC_2025_B2_transformed.csv",
+    "data/AA Data Collection - Second Launch Trimmed.csv",
+};
+
+constexpr uint32_t kSimTick_ms = 10;
+constexpr uint32_t kSimLaunch_ms = 2000;
+constexpr float kGravity_mps2 = 9.81F;
+
+struct Sample {
+    uint32_t ts;
+    float ax;
+    float ay;
+    float az;
+    float alt;
+};
+
+struct Flight {
+    std::string name;
+    std::vector<Sample> samples;
+    float trueApogee_m;
+    uint32_t apogeeTs_ms;
+};
+
+enum Source : size_t { kSourceSim = 0, kSourceCsv = 1, kSourceCount = 2 };
+const char* const kSourceNames[kSourceCount] = {"sim", "csv"};
+
+struct Stats {
+    std::array<double, kBucketCount> sumSq{};
+    std::array<size_t, kBucketCount> valid{};
+    std::array<size_t, kBucketCount> invalid{};
+    double totalNs = 0.0;
+    double worstNs = 0.0;
+    size_t calls = 0;
+    size_t flights = 0;
+};
+
+float safe_stof(const std::string& s, float default_val = 0.0f) {
+    try {
+        return std::stof(s);
+    } catch (...) {
+        return default_val;
+    }
+}
+
+uint32_t safe_stoul(const std::string& s, uint32_t default_val = 0U) {
+    try {
+        const unsigned long parsedValue = std::stoul(s);
+        if (parsedValue > static_cast<unsigned long>(std::numeric_limits<uint32_t>::max())) {
+            return default_val;
+        }
+        return static_cast<uint32_t>(parsedValue);
+    } catch (...) {
+        return default_val;
+    }
+}
+
+Flight simulateFlight(float motorAccel, uint32_t burn_ms, float dragCoeff, std::default_random_engine& rng) {
+    std::normal_distribution<float> aclNoise(0.0f, 0.55f);
+    std::normal_distribution<float> altNoise(0.0f, 3.0f);
+
+    AirResistanceSimulator sim(kSimLaunch_ms, motorAccel, burn_ms, kSimTick_ms, dragCoeff);
+    Flight flight;
+    char name[64];
+    std::snprintf(name, sizeof(name), "sim a=%.0f burn=%u k=%.4f", static_cast<double>(motorAccel), burn_ms,
+                  static_cast<double>(dragCoeff));
+    flight.name = name;
+    while (!sim.getHasLanded()) {
+        sim.tick();
+        const uint32_t ts = sim.getCurrentTime();
+        flight.samples.push_back({ts, 0.0f, 0.0f, sim.getInertialVerticalAcl() + kGravity_mps2 + aclNoise(rng),
+                                  sim.getAltitude() + altNoise(rng)});
+    }
+    flight.trueApogee_m = sim.getApogeeAlt();
+    flight.apogeeTs_ms = sim.getApogeeTimestamp();
+    return flight;
+}
+
+bool loadFlight(const char* filename, Flight& flight) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    flight.name = filename;
+    flight.trueApogee_m = -std::numeric_limits<float>::max();
+    flight.apogeeTs_ms = 0;
+
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string token;
+        std::vector<std::string> tokens;
+        while (std::getline(ss, token, ',')) tokens.push_back(token);
+        if (tokens.size() <= 10) continue;
+
+        const Sample s = {safe_stoul(tokens[0]), safe_stof(tokens[1]), safe_stof(tokens[2]),
+                          safe_stof(tokens[3]), safe_stof(tokens[10])};
+        if (s.alt > flight.trueApogee_m) {
+            flight.trueApogee_m = s.alt;
+            flight.apogeeTs_ms = s.ts;
+        }
+        flight.samples.push_back(s);
+    }
+    return !flight.samples.empty();
+}
+
+void runFlight(const Method& method, const Flight& flight, Stats& stats) {
+    VerticalVelocityEstimator vve;
+    ApogeePredictor apo(vve, 0.2f, 0.5f);
+    std::array<bool, kBucketCount> captured{};
+
+    for (const Sample& s : flight.samples) {
+        const AccelerationTriplet accel = {DataPoint(s.ts, s.ax), DataPoint(s.ts, s.ay), DataPoint(s.ts, s.az)};
+        vve.update(accel, DataPoint(s.ts, s.alt));
+
+        const auto start = std::chrono::steady_clock::now();
+        (apo.*method.update)();
+        const auto stop = std::chrono::steady_clock::now();
+        const auto ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        stats.totalNs += ns;
+        stats.worstNs = std::max(stats.worstNs, ns);
+        ++stats.calls;
+
+        for (size_t b = 0; b < kBucketCount; ++b) {
+            if (captured[b] || s.ts + kBucketLead_ms[b] < flight.apogeeTs_ms) continue;
+            captured[b] = true;
+            // Non-finite outputs (e.g. a divide by zero acceleration) count as invalid
+            const float predicted_m = apo.getPredictedApogeeAltitude_m();
+            if (apo.isPredictionValid() && std::isfinite(predicted_m)) {
+                const double err = static_cast<double>(predicted_m - flight.trueApogee_m);
+                stats.sumSq[b] += err * err;
+                ++stats.valid[b];
+            } else {
+                ++stats.invalid[b];
+            }
+        }
+    }
+    ++stats.flights;
+}
+
+double rms(const Stats& stats, size_t bucket) {
+    return stats.valid[bucket] > 0 ? std::sqrt(stats.sumSq[bucket] / static_cast<double>(stats.valid[bucket]))
+                                   : std::numeric_limits<double>::quiet_NaN();
+}
+
+}  // namespace
+
+/* ---------- Unity fixtures ---------- */
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_apogee_predictor_accuracy_and_cost(void) {
+    std::array<std::vector<Flight>, kSourceCount> flights;
+
+    std::default_random_engine rng{42};
+    const float motorAccels[] = {40.0f, 55.0f, 70.0f};
+    const uint32_t burns_ms[] = {1500, 2500};
+    const float dragCoeffs[] = {0.0004f, 0.0008f, 0.0012f};
+    for (float motorAccel : motorAccels) {
+        for (uint32_t burn_ms : burns_ms) {
+            for (float dragCoeff : dragCoeffs) {
+                flights[kSourceSim].push_back(simulateFlight(motorAccel, burn_ms, dragCoeff, rng));
+            }
+        }
+    }
+    for (const char* filename : kFlightFiles) {
+        Flight flight;
+        if (loadFlight(filename, flight)) {
+            flights[kSourceCsv].push_back(flight);
+        } else {
+            printf("Skipping missing CSV: %s\n", filename);
+        }
+    }
+
+    std::array<std::array<Stats, kSourceCount>, kMethods.size()> stats{};
+    for (size_t m = 0; m < kMethods.size(); ++m) {
+        for (size_t src = 0; src < kSourceCount; ++src) {
+            for (const Flight& flight : flights[src]) {
+                runFlight(kMethods[m], flight, stats[m][src]);
+            }
+        }
+    }
+
+    std::ofstream csv("apogee_predictor_benchmark.csv");
+    TEST_ASSERT_TRUE_MESSAGE(csv.is_open(), "Failed to open CSV file for writing");
+    csv << "method,source,flights,rms_t10_m,rms_t5_m,rms_t2_m,invalid_predictions,mean_ns,worst_ns\n";
+
+    printf("\n===== APOGEE PREDICTOR BENCHMARK =====\n");
+    printf("%-15s %-4s %7s %10s %10s %10s %8s %9s %10s\n", "method", "src", "flights", "RMS T-10", "RMS T-5",
+           "RMS T-2", "invalid", "mean ns", "worst ns");
+    for (size_t m = 0; m < kMethods.size(); ++m) {
+        for (size_t src = 0; src < kSourceCount; ++src) {
+            const Stats& s = stats[m][src];
+            if (s.flights == 0) continue;
+            const size_t invalid = s.invalid[0] + s.invalid[1] + s.invalid[2];
+            const double meanNs = s.totalNs / static_cast<double>(s.calls);
+            printf("%-15s %-4s %7zu %10.2f %10.2f %10.2f %8zu %9.1f %10.0f\n", kMethods[m].name, kSourceNames[src],
+                   s.flights, rms(s, 0), rms(s, 1), rms(s, 2), invalid, meanNs, s.worstNs);
+            csv << kMethods[m].name << ',' << kSourceNames[src] << ',' << s.flights << ',' << rms(s, 0) << ','
+                << rms(s, 1) << ',' << rms(s, 2) << ',' << invalid << ',' << meanNs << ',' << s.worstNs << '\n';
+        }
+    }
+    csv.close();
+
+    // Every model must produce a usable prediction close to apogee on the sweep
+    for (size_t m = 0; m < kMethods.size(); ++m) {
+        const Stats& s = stats[m][kSourceSim];
+        TEST_ASSERT_TRUE_MESSAGE(s.valid[kBucketCount - 1] > 0, kMethods[m].name);
+        TEST_ASSERT_TRUE(std::isfinite(rms(s, kBucketCount - 1)));
+        TEST_ASSERT_TRUE(s.calls > 0);
+    }
+}
+
+/* ---------- main runner ----------------------- */
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_apogee_predictor_accuracy_and_cost);
+    return UNITY_END();
+}
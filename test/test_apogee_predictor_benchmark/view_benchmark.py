@@ -0,0 +1,33 @@
+import argparse
+
+import matplotlib.pyplot as plt
+import pandas as pd
+
+# Plots the output of test_apogee_predictor_benchmark:
+# RMS apogee error in each time-to-apogee bucket against mean cost per call.
+
+parser = argparse.ArgumentParser(description="Plot apogee predictor accuracy vs CPU cost")
+parser.add_argument("csv", nargs="?", default="apogee_predictor_benchmark.csv")
+parser.add_argument("--source", default="sim", choices=["sim", "csv"], help="which flight set to plot")
+args = parser.parse_args()
+
+df = pd.read_csv(args.csv)
+df = df[df["source"] == args.source]
+
+buckets = [("rms_t10_m", "T-10 s", "o"), ("rms_t5_m", "T-5 s", "s"), ("rms_t2_m", "T-2 s", "^")]
+
+fig, ax = plt.subplots(figsize=(10, 6))
+for column, label, marker in buckets:
+    ax.scatter(df["mean_ns"], df[column], marker=marker, label=label)
+    for _, row in df.iterrows():
+        ax.annotate(row["method"], (row["mean_ns"], row[column]), fontsize=8,
+                    xytext=(4, 4), textcoords="offset points")
+
+ax.set_xscale("log")
+ax.set_xlabel("Mean cost per call (ns)")
+ax.set_ylabel("RMS apogee error (m)")
+ax.set_title(f"Apogee predictor accuracy vs cost ({args.source} flights)")
+ax.legend()
+ax.grid(True, which="both", alpha=0.3)
+plt.tight_layout()
+plt.show()
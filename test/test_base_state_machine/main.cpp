@@ -107,6 +107,83 @@ void test_callback_registration_capacity_overflow_is_deterministic(void) {
     TEST_ASSERT_EQUAL_UINT32(0, callbackCounts[TestBaseStateMachine::kMaxStateEntryCallbacks]);
 }
 
+std::size_t dispatchOrder[4] = {};
+std::size_t dispatchOrderCount = 0;
+
+template <std::size_t Index>
+void orderedCallback() {
+    if (dispatchOrderCount < 4) {
+        dispatchOrder[dispatchOrderCount++] = Index;
+    }
+}
+
+void test_deferred_callbacks_wait_for_dispatch(void) {
+    TestBaseStateMachine stateMachine(STATE_UNARMED);
+    stateMachine.setCallbackDispatch(CallbackDispatch::Deferred);
+    singleCallbackCount = 0;
+
+    TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_ASCENT, singleCallback));
+    TEST_ASSERT_TRUE(stateMachine.transitionTo(STATE_ASCENT));
+    TEST_ASSERT_EQUAL_UINT32(STATE_ASCENT, stateMachine.getState());
+    TEST_ASSERT_EQUAL_UINT32(0, singleCallbackCount);
+    TEST_ASSERT_EQUAL_UINT32(1, stateMachine.getPendingEventCount());
+
+    TEST_ASSERT_EQUAL_UINT32(1, stateMachine.dispatchPendingEvents());
+    TEST_ASSERT_EQUAL_UINT32(1, singleCallbackCount);
+    TEST_ASSERT_EQUAL_UINT32(0, stateMachine.getPendingEventCount());
+    TEST_ASSERT_EQUAL_UINT32(0, stateMachine.dispatchPendingEvents());
+    TEST_ASSERT_TRUE(stateMachine.getMaxEventLatency_us() >= stateMachine.getLastEventLatency_us());
+}
+
+void test_deferred_dispatch_orders_by_priority_then_fifo(void) {
+    TestBaseStateMachine stateMachine(STATE_UNARMED);
+    stateMachine.setCallbackDispatch(CallbackDispatch::Deferred);
+    dispatchOrderCount = 0;
+
+    TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_ASCENT, &orderedCallback<0>, 1));
+    TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_DESCENT, &orderedCallback<1>, 1));
+    TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_DESCENT, &orderedCallback<2>, 5));
+    TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_ASCENT, &orderedCallback<3>, 0));
+
+    TEST_ASSERT_TRUE(stateMachine.transitionTo(STATE_ASCENT));
+    TEST_ASSERT_TRUE(stateMachine.transitionTo(STATE_DESCENT));
+    TEST_ASSERT_EQUAL_UINT32(4, stateMachine.dispatchPendingEvents());
+
+    // Priority 5, then the two priority 1 events in queue order, then priority 0
+    TEST_ASSERT_EQUAL_UINT32(2, dispatchOrder[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, dispatchOrder[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, dispatchOrder[2]);
+    TEST_ASSERT_EQUAL_UINT32(3, dispatchOrder[3]);
+}
+
+void test_full_pending_queue_counts_dropped_events(void) {
+    TestBaseStateMachine stateMachine(STATE_UNARMED);
+    stateMachine.setCallbackDispatch(CallbackDispatch::Deferred);
+    resetCallbackCounts();
+
+    // Half the callbacks on each state; three entries queue 1.5x the queue capacity
+    constexpr std::size_t kHalf = TestBaseStateMachine::kMaxStateEntryCallbacks / 2;
+    for (std::size_t i = 0; i < kHalf; i++) {
+        TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_ASCENT, overflowCallbacks[i]));
+        TEST_ASSERT_TRUE(stateMachine.registerOnStateEntry(STATE_DESCENT, overflowCallbacks[kHalf + i]));
+    }
+
+    TEST_ASSERT_TRUE(stateMachine.transitionTo(STATE_ASCENT));
+    TEST_ASSERT_TRUE(stateMachine.transitionTo(STATE_DESCENT));
+    TEST_ASSERT_TRUE(stateMachine.transitionTo(STATE_ASCENT));
+    TEST_ASSERT_EQUAL_UINT32(TestBaseStateMachine::kMaxPendingEvents, stateMachine.getPendingEventCount());
+    TEST_ASSERT_EQUAL_UINT32(3 * kHalf - TestBaseStateMachine::kMaxPendingEvents,
+                             stateMachine.getDroppedEventCount());
+
+    TEST_ASSERT_EQUAL_UINT32(TestBaseStateMachine::kMaxPendingEvents, stateMachine.dispatchPendingEvents());
+    for (std::size_t i = 0; i < TestBaseStateMachine::kMaxStateEntryCallbacks; i++) {
+        TEST_ASSERT_EQUAL_UINT32(1, callbackCounts[i]);
+    }
+
+    stateMachine.resetEventStats();
+    TEST_ASSERT_EQUAL_UINT32(0, stateMachine.getDroppedEventCount());
+}
+
 }  // namespace
 
 void setUp(void) {}
@@ -119,5 +196,8 @@ int main(void) {
     RUN_TEST(test_duplicate_callback_registration_is_rejected);
     RUN_TEST(test_nullptr_callback_registration_is_rejected);
     RUN_TEST(test_callback_registration_capacity_overflow_is_deterministic);
+    RUN_TEST(test_deferred_callbacks_wait_for_dispatch);
+    RUN_TEST(test_deferred_dispatch_orders_by_priority_then_fifo);
+    RUN_TEST(test_full_pending_queue_counts_dropped_events);
     return UNITY_END();
 }
@@ -0,0 +1,262 @@
+#include "unity.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "data_handling/BinaryLogFormat.h"
+#include "data_handling/CsvFormat.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaverBigSD.h"
+#include "data_handling/DataVector.h"
+#include "state_estimation/States.h"
+
+namespace {
+
+constexpr uint32_t kSampleCount = 20000;
+
+// Formats decoded records the way CSV mode writes them
+class CsvSink : public IRecordSink {
+public:
+    void onRecord(const DecodedRecord& record) override {
+        char line[kMaxCsvLineLength_bytes];
+        text.append(line, formatCsvLine(record.timestamp_ms, record.name, record.value, line));
+        timestamps.push_back(record.timestamp_ms);
+    }
+
+    std::string text;
+    std::vector<uint32_t> timestamps;
+};
+
+// Sensor-like samples: several channels per tick, with a few long gaps and one clock step back
+DataPoint sample(uint32_t i, uint8_t& name) {
+    uint32_t timestamp_ms = 1000U + (i / 4U) * 2U;
+    if (i > 5000U) {
+        timestamp_ms += 700U;  // Gap longer than a one-byte delta
+    }
+    if (i > 12000U) {
+        timestamp_ms -= 300U;  // Clock stepped backwards
+    }
+    const uint8_t names[] = {ACCELEROMETER_Z, ALTITUDE, PRESSURE, EST_VERTICAL_VELOCITY};
+    name = names[i % 4U];
+    return DataPoint(timestamp_ms, static_cast<float>(i) * 0.173F - 812.5F);
+}
+
+std::vector<uint8_t> logSamples(BigSDLogFormat format) {
+    DataSaverBigSD saver;
+    saver.setFormat(format);
+    TEST_ASSERT_TRUE(saver.begin());
+    for (uint32_t i = 0; i < kSampleCount; i++) {
+        uint8_t name = 0;
+        const DataPoint point = sample(i, name);
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(point, name));
+    }
+    saver.end();
+    const char* path = (format == BigSDLogFormat::kBinary) ? "/stream-0.bin" : "/stream-0.csv";
+    TEST_ASSERT_EQUAL_UINT32(1U, static_cast<uint32_t>(mockSdFiles().count(path)));
+    return mockSdFiles()[path];
+}
+
+} // namespace
+
+void setUp(void) {
+    mockSdFiles().clear();
+}
+
+void tearDown(void) {}
+
+void test_binary_log_decodes_to_identical_csv(void) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<uint8_t> csv = logSamples(BigSDLogFormat::kCsv);
+    const auto csvDone = std::chrono::steady_clock::now();
+    const std::vector<uint8_t> binary = logSamples(BigSDLogFormat::kBinary);
+    const auto binaryDone = std::chrono::steady_clock::now();
+
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(0, decoder.decodeLog(binary.data(), binary.size()));
+    TEST_ASSERT_EQUAL_UINT32(kSampleCount, decoder.getRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(0U, decoder.getBadBlockCount());
+    TEST_ASSERT_TRUE(sink.text == std::string(csv.begin(), csv.end()));
+
+    // Whole sectors only, and several times smaller than the CSV
+    TEST_ASSERT_EQUAL_UINT32(0U, static_cast<uint32_t>(binary.size() % kBinaryBlockSize_bytes));
+    // Partly filled blocks flushed on the 200 ms timer cost some density, hence 2.5x rather than 3x
+    TEST_ASSERT_TRUE(binary.size() * 5U < csv.size() * 2U);
+    std::printf("CSV %zu bytes in %.1f ms, binary %zu bytes in %.1f ms\n", csv.size(),
+                std::chrono::duration<double, std::milli>(csvDone - start).count(), binary.size(),
+                std::chrono::duration<double, std::milli>(binaryDone - csvDone).count());
+}
+
+void test_header_describes_channels_and_states(void) {
+    const std::vector<uint8_t> binary = logSamples(BigSDLogFormat::kBinary);
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(0, decoder.parseHeader(binary.data(), binary.size()));
+    TEST_ASSERT_EQUAL_STRING("ALTITUDE", decoder.getChannelName(ALTITUDE));
+    TEST_ASSERT_EQUAL_STRING("FIN_DEPLOYMENT_AMOUNT", decoder.getChannelName(FIN_DEPLOYMENT_AMOUNT));
+    TEST_ASSERT_EQUAL_STRING("STATE_LANDED", decoder.getStateName(STATE_LANDED));
+    TEST_ASSERT_TRUE(decoder.getChannelName(200U) == nullptr);
+
+    std::vector<uint8_t> corrupt = binary;
+    corrupt[0] = 'X';
+    TEST_ASSERT_EQUAL(-1, decoder.parseHeader(corrupt.data(), corrupt.size()));
+}
+
+void test_find_block_seeks_by_timestamp(void) {
+    // Monotonic timestamps only: seeking assumes blocks are in time order
+    DataSaverBigSD saver;
+    saver.setFormat(BigSDLogFormat::kBinary);
+    TEST_ASSERT_TRUE(saver.begin());
+    for (uint32_t i = 0; i < kSampleCount; i++) {
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(DataPoint(i * 3U, 1.0F), ALTITUDE));
+    }
+    saver.end();
+    const std::vector<uint8_t>& binary = mockSdFiles()["/stream-0.bin"];
+
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(0, decoder.parseHeader(binary.data(), binary.size()));
+    const uint32_t target_ms = 31337U;
+    const size_t offset = decoder.findBlock(binary.data(), binary.size(), target_ms);
+    TEST_ASSERT_EQUAL(0, decoder.decodeBlock(binary.data() + offset));
+    TEST_ASSERT_TRUE(sink.timestamps.front() <= target_ms);
+    TEST_ASSERT_TRUE(sink.timestamps.back() >= target_ms);
+}
+
+void test_corrupt_block_is_skipped(void) {
+    std::vector<uint8_t> binary = logSamples(BigSDLogFormat::kBinary);
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(0, decoder.parseHeader(binary.data(), binary.size()));
+    const size_t firstBlock = decoder.findBlock(binary.data(), binary.size(), 0U);
+    binary[firstBlock + kBinaryBlockSize_bytes + 40U] ^= 0x10U;
+
+    TEST_ASSERT_EQUAL(0, decoder.decodeLog(binary.data(), binary.size()));
+    TEST_ASSERT_EQUAL_UINT32(1U, decoder.getBadBlockCount());
+    TEST_ASSERT_TRUE(decoder.getRecordCount() < kSampleCount);
+    TEST_ASSERT_TRUE(decoder.getRecordCount() > kSampleCount - 100U);
+}
+
+void test_block_writer_escapes_large_deltas(void) {
+    BinaryBlockWriter writer;
+    TEST_ASSERT_TRUE(writer.isEmpty());
+    TEST_ASSERT_TRUE(writer.append(100U, ALTITUDE, 1.0F));
+    TEST_ASSERT_TRUE(writer.append(354U, ALTITUDE, 2.0F));   // Delta 254 fits in a byte
+    TEST_ASSERT_TRUE(writer.append(609U, ALTITUDE, 3.0F));   // Delta 255 is escaped
+    TEST_ASSERT_TRUE(writer.append(5U, ALTITUDE, 4.0F));     // Backwards is escaped
+    const uint8_t* block = writer.finish();
+    TEST_ASSERT_TRUE(writer.isEmpty());
+
+    BinaryBlockHeader_t header = {};
+    std::memcpy(&header, block, sizeof(header));
+    TEST_ASSERT_EQUAL_UINT16(4U, header.recordCount);
+    TEST_ASSERT_EQUAL_UINT16(2U * kBinaryRecordSize_bytes + 2U * kBinaryEscapedRecordSize_bytes,
+                             header.payloadLength_bytes);
+
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(0, decoder.decodeBlock(block));
+    TEST_ASSERT_TRUE(sink.text == "100,8,1.000000\n354,8,2.000000\n609,8,3.000000\n5,8,4.000000\n");
+
+    // A block holds 82 plain records
+    uint32_t appended = 0;
+    while (writer.append(1000U + appended, ALTITUDE, 0.0F)) {
+        appended++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(kBinaryBlockPayload_bytes / kBinaryRecordSize_bytes, appended);
+}
+
+void test_vector_records_decode_to_identical_csv(void) {
+    std::vector<uint8_t> logs[2];
+    const BigSDLogFormat formats[2] = {BigSDLogFormat::kCsv, BigSDLogFormat::kBinary};
+    for (size_t f = 0; f < 2U; f++) {
+        mockSdFiles().clear();
+        DataSaverBigSD saver;
+        saver.setFormat(formats[f]);
+        TEST_ASSERT_TRUE(saver.begin());
+        for (uint32_t i = 0; i < kSampleCount / 3U; i++) {
+            const float x = static_cast<float>(i) * 0.173F - 812.5F;
+            TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataVector(DataVector(1000U + i * 2U, x, -x, x * 0.5F),
+                                                               ACCELEROMETER_X));
+            TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(DataPoint(1000U + i * 2U, x), ALTITUDE));
+        }
+        saver.end();
+        logs[f] = mockSdFiles()[f == 0U ? "/stream-0.csv" : "/stream-0.bin"];
+    }
+
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(0, decoder.decodeLog(logs[1].data(), logs[1].size()));
+    TEST_ASSERT_EQUAL_UINT32(kSampleCount / 3U * 4U, decoder.getRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(0U, decoder.getBadBlockCount());
+    TEST_ASSERT_TRUE(sink.text == std::string(logs[0].begin(), logs[0].end()));
+
+    // A triplet takes 16 bytes instead of three 6-byte records
+    BinaryBlockWriter writer;
+    const float values[3] = {1.0F, 2.0F, 3.0F};
+    TEST_ASSERT_TRUE(writer.appendVector(100U, GYROSCOPE_X, values, 3U));
+    TEST_ASSERT_TRUE(writer.appendVector(101U, GYROSCOPE_X, values, 3U));
+    BinaryBlockHeader_t header = {};
+    std::memcpy(&header, writer.finish(), sizeof(header));
+    TEST_ASSERT_EQUAL_UINT16(2U, header.recordCount);
+    TEST_ASSERT_EQUAL_UINT16(16U + 16U, header.payloadLength_bytes);
+}
+
+void test_binary_log_decodes_across_segments(void) {
+    // Only the first segment has the log header; later ones continue its block stream
+    DataSaverBigSD saver;
+    saver.setFormat(BigSDLogFormat::kBinary);
+    TEST_ASSERT_TRUE(saver.begin());
+    std::string expected;
+    char line[kMaxCsvLineLength_bytes];
+    uint32_t count = 0;
+    for (uint32_t extra = 0; extra < 5000U; count++) {
+        const DataPoint point(count * 3U, static_cast<float>(count) * 0.173F - 812.5F);
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(point, ALTITUDE));
+        expected.append(line, formatCsvLine(point.timestamp_ms, ALTITUDE, point.data, line));
+        extra += (saver.getSegment() > 0U) ? 1U : 0U;
+    }
+    saver.end();
+
+    const std::vector<uint8_t>& first = mockSdFiles()["/stream-0.bin"];
+    const std::vector<uint8_t>& second = mockSdFiles()["/stream-0-1.bin"];
+    TEST_ASSERT_EQUAL_UINT32(DataSaverBigSD::kSegmentSize_bytes, static_cast<uint32_t>(first.size()));
+    std::vector<uint8_t> binary = first;
+    binary.insert(binary.end(), second.begin(), second.end());
+
+    CsvSink sink;
+    BinaryLogDecoder decoder(sink);
+    TEST_ASSERT_EQUAL(-1, decoder.parseHeader(second.data(), second.size()));
+    TEST_ASSERT_EQUAL(0, decoder.decodeLog(binary.data(), binary.size()));
+    TEST_ASSERT_EQUAL_UINT32(count, decoder.getRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(0U, decoder.getBadBlockCount());
+    TEST_ASSERT_TRUE(sink.text == expected);
+
+    // Seeking lands in the second segment
+    CsvSink seekSink;
+    BinaryLogDecoder seeker(seekSink);
+    TEST_ASSERT_EQUAL(0, seeker.parseHeader(binary.data(), binary.size()));
+    const uint32_t target_ms = (count - 100U) * 3U;
+    const size_t offset = seeker.findBlock(binary.data(), binary.size(), target_ms);
+    TEST_ASSERT_TRUE(offset >= first.size());
+    TEST_ASSERT_EQUAL(0, seeker.decodeBlock(binary.data() + offset));
+    TEST_ASSERT_TRUE(seekSink.timestamps.front() <= target_ms);
+    TEST_ASSERT_TRUE(seekSink.timestamps.back() >= target_ms);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_binary_log_decodes_to_identical_csv);
+    RUN_TEST(test_header_describes_channels_and_states);
+    RUN_TEST(test_find_block_seeks_by_timestamp);
+    RUN_TEST(test_corrupt_block_is_skipped);
+    RUN_TEST(test_block_writer_escapes_large_deltas);
+    RUN_TEST(test_vector_records_decode_to_identical_csv);
+    RUN_TEST(test_binary_log_decodes_across_segments);
+    return UNITY_END();
+}
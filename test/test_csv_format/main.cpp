@@ -0,0 +1,133 @@
+#include "unity.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "data_handling/CsvFormat.h"
+
+// formatCsvLine() against the snprintf() call DataSaverBigSD used to make, both
+// for identical output and for throughput.
+
+namespace {
+
+std::string printfLine(uint32_t timestamp_ms, uint8_t name, float value) {
+    char line[128];
+    const int length = std::snprintf(line, sizeof(line), "%lu,%u,%.6f\n", static_cast<long unsigned int>(timestamp_ms),
+                                     name, static_cast<double>(value));
+    return std::string(line, static_cast<size_t>(length));
+}
+
+std::string fastLine(uint32_t timestamp_ms, uint8_t name, float value) {
+    char line[kMaxCsvLineLength_bytes];
+    const size_t length = formatCsvLine(timestamp_ms, name, value, line);
+    TEST_ASSERT_TRUE(length <= sizeof(line));
+    return std::string(line, length);
+}
+
+float fromBits(uint32_t bits) {
+    float value = 0.0F;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void assertSameLine(uint32_t timestamp_ms, uint8_t name, float value) {
+    const std::string expected = printfLine(timestamp_ms, name, value);
+    const std::string actual = fastLine(timestamp_ms, name, value);
+    if (expected != actual) {
+        std::printf("%a: expected '%s' got '%s'\n", static_cast<double>(value), expected.c_str(), actual.c_str());
+    }
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), actual.c_str());
+}
+
+uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525U + 1013904223U;
+    return state;
+}
+
+} // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_integers_match_printf(void) {
+    const uint32_t values[] = {0U, 1U, 9U, 10U, 99U, 100U, 12345U, 999999999U, 1000000000U, UINT32_MAX};
+    for (const uint32_t value : values) {
+        assertSameLine(value, static_cast<uint8_t>(value), 0.0F);
+    }
+    assertSameLine(0U, 255U, 1.0F);
+}
+
+void test_edge_values_match_printf(void) {
+    const float values[] = {
+        0.0F, -0.0F, 1.0F, -1.0F, 0.5F, 0.1F, 9.81F, -273.15F, 101325.0F, 1e-7F, 5e-7F, 4.9999997e-7F, 5.0000006e-7F,
+        0.9999995F, 0.99999994F, 999999.94F, 16777216.0F, 4294967296.0F, 1.8446744e19F, 1e30F,
+        1.0F / 128.0F, 3.0F / 128.0F, 5.0F / 128.0F, 1.0F + 1.0F / 128.0F,  // Exact ties at the seventh decimal
+        std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::min(), std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+    };
+    for (const float value : values) {
+        assertSameLine(123456U, 8U, value);
+    }
+    assertSameLine(1U, 2U, std::numeric_limits<float>::quiet_NaN());
+}
+
+void test_random_floats_match_printf(void) {
+    uint32_t state = 2024U;
+    for (uint32_t i = 0; i < 200000U; i++) {
+        const uint32_t bits = nextRandom(state);
+        const float value = fromBits(bits);
+        if (std::isnan(value)) {
+            continue;  // NaN payloads print the same, but the sign of a NaN is not portable
+        }
+        assertSameLine(nextRandom(state), static_cast<uint8_t>(i), value);
+    }
+    // Sensor-like magnitudes, where rounding at the sixth decimal matters most
+    for (uint32_t i = 0; i < 200000U; i++) {
+        const float value = static_cast<float>(static_cast<int32_t>(nextRandom(state) % 2000001U) - 1000000) / 997.0F;
+        assertSameLine(i * 10U, static_cast<uint8_t>(i % 40U), value);
+    }
+}
+
+void test_throughput_against_snprintf(void) {
+    constexpr uint32_t kLines = 500000;
+    char buffer[512];
+    size_t sink = 0;
+
+    const auto printfStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kLines; i++) {
+        const float value = static_cast<float>(i) * 0.37F - 1000.0F;
+        sink += static_cast<size_t>(std::snprintf(buffer, sizeof(buffer), "%lu,%u,%.6f\n",
+                                                  static_cast<long unsigned int>(i * 10U), i % 40U,
+                                                  static_cast<double>(value)));
+    }
+    const auto printfStop = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < kLines; i++) {
+        const float value = static_cast<float>(i) * 0.37F - 1000.0F;
+        sink += formatCsvLine(i * 10U, static_cast<uint8_t>(i % 40U), value, buffer);
+    }
+    const auto fastStop = std::chrono::steady_clock::now();
+
+    const double printfSeconds = std::chrono::duration<double>(printfStop - printfStart).count();
+    const double fastSeconds = std::chrono::duration<double>(fastStop - printfStop).count();
+    std::printf("\n===== CSV LINE FORMATTING =====\n");
+    std::printf("snprintf      %12.0f lines/s\n", kLines / printfSeconds);
+    std::printf("formatCsvLine %12.0f lines/s (%.1fx)\n", kLines / fastSeconds, printfSeconds / fastSeconds);
+    TEST_ASSERT_TRUE(sink > 0U);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_integers_match_printf);
+    RUN_TEST(test_edge_values_match_printf);
+    RUN_TEST(test_random_floats_match_printf);
+    RUN_TEST(test_throughput_against_snprintf);
+    return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include "unity.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ArduinoHAL.h"
+#include "data_handling/CsvFormat.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaverBigSD.h"
+
+namespace {
+
+// One write of a whole chunk, the most saveDataPoint() may cost on the mock card
+constexpr uint64_t kChunkWrite_us =
+    kMockSdCommand_us + kMockSdSector_us * (DataSaverBigSD::kWriteChunk_bytes / 512U);
+
+DataPoint sample(uint32_t i) {
+    return DataPoint(1000U + i, static_cast<float>(i) * 0.731F - 4000.0F);
+}
+
+std::string expectedCsv(uint32_t count) {
+    std::string text;
+    char line[kMaxCsvLineLength_bytes];
+    for (uint32_t i = 0; i < count; i++) {
+        const DataPoint point = sample(i);
+        text.append(line, formatCsvLine(point.timestamp_ms, ALTITUDE, point.data, line));
+    }
+    return text;
+}
+
+std::string fileText(const char* path) {
+    TEST_ASSERT_EQUAL_UINT32(1U, static_cast<uint32_t>(mockSdFiles().count(path)));
+    const std::vector<uint8_t>& contents = mockSdFiles()[path];
+    return std::string(contents.begin(), contents.end());
+}
+
+// Log @p count lines, calling service() between saves, and check what each save cost
+void logWithService(DataSaverBigSD& saver, uint32_t count) {
+    MockSdStats& stats = mockSdStats();
+    uint64_t worst_us = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const MockSdStats before = stats;
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(sample(i), ALTITUDE));
+        TEST_ASSERT_EQUAL_UINT32(before.unalignedWrites, stats.unalignedWrites);
+        TEST_ASSERT_EQUAL_UINT32(before.syncs, stats.syncs);
+        TEST_ASSERT_EQUAL_UINT32(before.preAllocations, stats.preAllocations);
+        const uint64_t cost_us = stats.elapsed_us - before.elapsed_us;
+        worst_us = cost_us > worst_us ? cost_us : worst_us;
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.service());
+    }
+    TEST_ASSERT_TRUE(worst_us <= kChunkWrite_us);
+    TEST_ASSERT_TRUE(saver.getLargestSaveWrite() <= DataSaverBigSD::kWriteChunk_bytes);
+    std::printf("worst saveDataPoint %llu us on the mock card\n", static_cast<unsigned long long>(worst_us));
+}
+
+} // namespace
+
+void setUp(void) {
+    mockSdFiles().clear();
+    mockSdStats() = MockSdStats();
+}
+
+void tearDown(void) {}
+
+void test_save_issues_only_aligned_chunk_writes(void) {
+    DataSaverBigSD saver;
+    TEST_ASSERT_TRUE(saver.begin());
+    TEST_ASSERT_EQUAL_UINT32(1U, mockSdStats().preAllocations);
+    logWithService(saver, 20000U);
+    saver.end();
+    TEST_ASSERT_TRUE(fileText("/stream-0.csv") == expectedCsv(20000U));
+}
+
+void test_log_rolls_into_preallocated_segments(void) {
+    // About 4.5 MiB of text, past the end of the first segment
+    constexpr uint32_t kCount = 200000U;
+    DataSaverBigSD saver;
+    TEST_ASSERT_TRUE(saver.begin());
+    logWithService(saver, kCount);
+    TEST_ASSERT_EQUAL_UINT16(1U, saver.getSegment());
+    // Both segments were pre-allocated from service() or begin(), never from a save
+    TEST_ASSERT_EQUAL_UINT32(2U, mockSdStats().preAllocations);
+    saver.end();
+
+    // Each segment holds whole lines, and together they are the whole log
+    const std::string first = fileText("/stream-0.csv");
+    const std::string second = fileText("/stream-0-1.csv");
+    TEST_ASSERT_TRUE(first.size() <= DataSaverBigSD::kSegmentSize_bytes);
+    TEST_ASSERT_TRUE(first.size() + kMaxCsvLineLength_bytes > DataSaverBigSD::kSegmentSize_bytes);
+    TEST_ASSERT_EQUAL('\n', first.back());
+    TEST_ASSERT_TRUE(first + second == expectedCsv(kCount));
+    const std::string firstLine = second.substr(0, second.find('\n') + 1U);
+    TEST_ASSERT_TRUE(expectedCsv(kCount).find("\n" + firstLine) != std::string::npos);
+}
+
+void test_end_removes_unused_next_segment(void) {
+    // Into the headroom, so the next segment is prepared but never written
+    constexpr uint32_t kCount = 175000U;
+    DataSaverBigSD saver;
+    TEST_ASSERT_TRUE(saver.begin());
+    logWithService(saver, kCount);
+    TEST_ASSERT_EQUAL_UINT16(0U, saver.getSegment());
+    TEST_ASSERT_EQUAL_UINT32(2U, mockSdStats().preAllocations);
+    saver.end();
+
+    TEST_ASSERT_EQUAL_UINT32(0U, static_cast<uint32_t>(mockSdFiles().count("/stream-0-1.csv")));
+    TEST_ASSERT_TRUE(fileText("/stream-0.csv") == expectedCsv(kCount));
+}
+
+void test_sync_writes_partial_sector_then_completes_it(void) {
+    DataSaverBigSD saver;
+    TEST_ASSERT_TRUE(saver.begin());
+    for (uint32_t i = 0; i < 30U; i++) {
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(sample(i), ALTITUDE));
+    }
+    delay(kSyncInterval_ms + 10U);
+    TEST_ASSERT_EQUAL(DS_SUCCESS, saver.service());
+
+    // The partial sector is on the card before the file is closed
+    TEST_ASSERT_EQUAL_UINT32(1U, mockSdStats().syncs);
+    TEST_ASSERT_TRUE(fileText("/stream-0.csv") == expectedCsv(30U));
+
+    // Later lines complete that sector in place
+    for (uint32_t i = 30U; i < 3000U; i++) {
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(sample(i), ALTITUDE));
+    }
+    saver.end();
+    TEST_ASSERT_TRUE(fileText("/stream-0.csv") == expectedCsv(3000U));
+}
+
+void test_without_service_save_keeps_old_behavior(void) {
+    DataSaverBigSD saver;
+    TEST_ASSERT_TRUE(saver.begin());
+    for (uint32_t i = 0; i < 5000U; i++) {
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(sample(i), ALTITUDE));
+    }
+    delay(kSyncInterval_ms + 10U);
+    TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoint(sample(5000U), ALTITUDE));
+    TEST_ASSERT_EQUAL_UINT32(1U, mockSdStats().syncs);
+    saver.end();
+    TEST_ASSERT_TRUE(fileText("/stream-0.csv") == expectedCsv(5001U));
+}
+
+void test_save_data_points_writes_the_same_text(void) {
+    constexpr uint32_t kCount = 300U * 64U;
+    DataSaverBigSD saver;
+    TEST_ASSERT_TRUE(saver.begin());
+    NamedDataPoint batch[64];
+    for (uint32_t start = 0; start < kCount; start += 64U) {
+        for (uint32_t i = 0; i < 64U; i++) {
+            batch[i] = NamedDataPoint{ALTITUDE, sample(start + i)};
+        }
+        TEST_ASSERT_EQUAL(DS_SUCCESS, saver.saveDataPoints(batch, 64U));
+    }
+    // A long batch writes one chunk at a time
+    TEST_ASSERT_TRUE(saver.getLargestSaveWrite() <= DataSaverBigSD::kWriteChunk_bytes);
+    TEST_ASSERT_EQUAL_UINT32(0U, mockSdStats().unalignedWrites);
+    saver.end();
+    TEST_ASSERT_TRUE(fileText("/stream-0.csv") == expectedCsv(kCount));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_save_issues_only_aligned_chunk_writes);
+    RUN_TEST(test_log_rolls_into_preallocated_segments);
+    RUN_TEST(test_end_removes_unused_next_segment);
+    RUN_TEST(test_sync_writes_partial_sector_then_completes_it);
+    RUN_TEST(test_without_service_save_keeps_old_behavior);
+    RUN_TEST(test_save_data_points_writes_the_same_text);
+    return UNITY_END();
+}
@@ -0,0 +1,178 @@
+#include "unity.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ArduinoHAL.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaverSDSerial.h"
+#include "data_handling/SerialFrameFormat.h"
+
+namespace {
+
+constexpr uint32_t kSampleCount = 10000;
+
+class RecordSink : public IRecordSink {
+public:
+    void onRecord(const DecodedRecord& record) override { records.push_back(record); }
+
+    std::vector<DecodedRecord> records;
+};
+
+// Several channels per tick, with one long gap and one clock step back
+DecodedRecord sample(uint32_t i) {
+    uint32_t timestamp_ms = 1000U + (i / 4U) * 2U;
+    if (i > 4000U) {
+        timestamp_ms += 700U;
+    }
+    if (i > 7000U) {
+        timestamp_ms -= 300U;
+    }
+    const uint8_t names[] = {ACCELEROMETER_Z, ALTITUDE, PRESSURE, EST_VERTICAL_VELOCITY};
+    return DecodedRecord{timestamp_ms, names[i % 4U], static_cast<float>(i) * 0.173F - 812.5F};
+}
+
+std::vector<uint8_t> logSamples(SerialLogFormat format) {
+    HardwareSerial& serial = Serial1;
+    serial.clear();
+    DataSaverSDSerial saver(serial);
+    saver.setFormat(format);
+    for (uint32_t i = 0; i < kSampleCount; i++) {
+        const DecodedRecord record = sample(i);
+        TEST_ASSERT_EQUAL(0, saver.saveDataPoint(DataPoint(record.timestamp_ms, record.value), record.name));
+    }
+    saver.flush();
+    return serial.writtenBytes;
+}
+
+void assertSample(uint32_t i, const DecodedRecord& record) {
+    const DecodedRecord expected = sample(i);
+    TEST_ASSERT_EQUAL_UINT32(expected.timestamp_ms, record.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT8(expected.name, record.name);
+    TEST_ASSERT_EQUAL_MEMORY(&expected.value, &record.value, sizeof(float));
+}
+
+} // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_records_format_is_unchanged(void) {
+    const std::vector<uint8_t> bytes = logSamples(SerialLogFormat::kRecords);
+    TEST_ASSERT_EQUAL_UINT32(kSampleCount * 12U, static_cast<uint32_t>(bytes.size()));
+    TEST_ASSERT_EQUAL_UINT32(kSampleCount, static_cast<uint32_t>(Serial1.writeCalls));
+
+    const DecodedRecord first = sample(0);
+    uint32_t timestamp_ms = 0;
+    std::memcpy(&timestamp_ms, bytes.data(), sizeof(timestamp_ms));
+    TEST_ASSERT_EQUAL_UINT32(first.timestamp_ms, timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT8(first.name, bytes[8]);
+    TEST_ASSERT_EQUAL_UINT8('\0', bytes[9]);
+    TEST_ASSERT_EQUAL_UINT8('\r', bytes[10]);
+    TEST_ASSERT_EQUAL_UINT8('\n', bytes[11]);
+}
+
+void test_batched_frames_decode_to_the_same_samples(void) {
+    const std::vector<uint8_t> bytes = logSamples(SerialLogFormat::kBatched);
+    const size_t writes = Serial1.writeCalls;
+
+    RecordSink sink;
+    SerialFrameDecoder decoder(sink);
+    decoder.process(bytes.data(), bytes.size());
+    TEST_ASSERT_EQUAL_UINT32(kSampleCount, decoder.getRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(0U, decoder.getBadFrameCount());
+    TEST_ASSERT_EQUAL_UINT32(0U, decoder.getLostFrameCount());
+    TEST_ASSERT_EQUAL_UINT32(writes, decoder.getFrameCount());
+    for (uint32_t i = 0; i < kSampleCount; i++) {
+        assertSample(i, sink.records[i]);
+    }
+
+    // Under 6.5 bytes per sample against 12, in one write per frame
+    TEST_ASSERT_TRUE(bytes.size() * 2U < kSampleCount * 13U);
+    TEST_ASSERT_TRUE(writes <= kSampleCount / kSerialFrameMaxRecords + 2U);
+}
+
+void test_corruption_drops_only_the_damaged_frame(void) {
+    std::vector<uint8_t> bytes = logSamples(SerialLogFormat::kBatched);
+
+    // Flip a bit in the third frame and cut one byte out of the fifth
+    std::vector<size_t> ends;
+    for (size_t i = 0; i < bytes.size(); i++) {
+        if (bytes[i] == kSerialFrameDelimiter) {
+            ends.push_back(i);
+        }
+    }
+    bytes.erase(bytes.begin() + static_cast<long>(ends[3] + 20U));
+    bytes[ends[1] + 30U] ^= 0x04U;
+
+    RecordSink sink;
+    SerialFrameDecoder decoder(sink);
+    // Arbitrary chunk sizes, as reads from a UART would give
+    for (size_t offset = 0; offset < bytes.size(); offset += 97U) {
+        const size_t length = bytes.size() - offset < 97U ? bytes.size() - offset : 97U;
+        decoder.process(bytes.data() + offset, length);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2U, decoder.getBadFrameCount());
+    TEST_ASSERT_EQUAL_UINT32(2U, decoder.getLostFrameCount());
+    TEST_ASSERT_EQUAL_UINT32(kSampleCount - 2U * kSerialFrameMaxRecords, decoder.getRecordCount());
+    // Everything after the damage is still aligned
+    assertSample(kSampleCount - 1U, sink.records.back());
+}
+
+void test_save_data_points_sends_the_same_bytes(void) {
+    for (const SerialLogFormat format : {SerialLogFormat::kRecords, SerialLogFormat::kBatched}) {
+        const std::vector<uint8_t> single = logSamples(format);
+
+        Serial1.clear();
+        DataSaverSDSerial saver(Serial1);
+        saver.setFormat(format);
+        NamedDataPoint batch[50];
+        for (uint32_t start = 0; start < kSampleCount; start += 50U) {
+            for (uint32_t i = 0; i < 50U; i++) {
+                const DecodedRecord record = sample(start + i);
+                batch[i] = NamedDataPoint{record.name, DataPoint(record.timestamp_ms, record.value)};
+            }
+            TEST_ASSERT_EQUAL(0, saver.saveDataPoints(batch, 50U));
+        }
+        saver.flush();
+        TEST_ASSERT_TRUE(Serial1.writtenBytes == single);
+    }
+    // Records go out 21 to a write instead of one
+    TEST_ASSERT_TRUE(Serial1.writeCalls < kSampleCount / 5U);
+}
+
+void test_cobs_round_trip(void) {
+    std::vector<uint8_t> data(600U, 0x5AU);
+    data[0] = 0;
+    data[10] = 0;
+    data[11] = 0;
+    data[599] = 0;  // Long runs of non-zero bytes on either side of 254
+
+    std::vector<uint8_t> encoded(data.size() + data.size() / 254U + 1U);
+    const size_t encodedLength = cobsEncode(data.data(), data.size(), encoded.data());
+    TEST_ASSERT_TRUE(encodedLength <= encoded.size());
+    for (size_t i = 0; i < encodedLength; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, encoded[i]);
+    }
+
+    std::vector<uint8_t> decoded(data.size());
+    TEST_ASSERT_EQUAL(static_cast<int>(data.size()), cobsDecode(encoded.data(), encodedLength, decoded.data()));
+    TEST_ASSERT_TRUE(decoded == data);
+
+    // A code byte pointing past the end is rejected
+    encoded[0] = 0xF0U;
+    TEST_ASSERT_EQUAL(-1, cobsDecode(encoded.data(), 5U, decoded.data()));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_format_is_unchanged);
+    RUN_TEST(test_batched_frames_decode_to_the_same_samples);
+    RUN_TEST(test_corruption_drops_only_the_damaged_frame);
+    RUN_TEST(test_save_data_points_sends_the_same_bytes);
+    RUN_TEST(test_cobs_round_trip);
+    return UNITY_END();
+}
@@ -1,11 +1,20 @@
 #include "unity.h"
 #include "data_handling/DataSaverSPI.h"
 #include "data_handling/DataPoint.h"
+#include "data_handling/Crc.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/FlashDecoder.h"
+#include "data_handling/FloatCompression.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
 #include <cstddef>
 #include <cstdint>
 
 DataSaverSPI* dss;
 Adafruit_SPIFlash* flash;
+FloatCompressor compressor;
 
 void setUp(void) {
     flash = new Adafruit_SPIFlash();
@@ -87,8 +96,8 @@ void test_launch_detected(void) {
 }
 
 void test_next_sector_is_erased_before_crossing_boundary(void) {
-    for (size_t i = 0; i < FAKE_MEMORY_SIZE_BYTES; i++) {
-        flash->fakeMemory[i] = 0x00;
+    for (uint32_t address = 0; address < FAKE_MEMORY_SIZE_BYTES; address += SFLASH_SECTOR_SIZE) {
+        std::memset(flash->memoryAt(address), 0x00, SFLASH_SECTOR_SIZE);
     }
     dss->clearInternalState();
 
@@ -110,12 +119,12 @@ void test_next_sector_is_erased_before_crossing_boundary(void) {
     }
 
     TEST_ASSERT_EQUAL_UINT32(flushesToSectorBoundary, dss->getBufferFlushes());
-    TEST_ASSERT_EQUAL_HEX8(0xFF, flash->fakeMemory[expectedBoundaryAddress]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, *flash->memoryAt(expectedBoundaryAddress));
 }
 
 void test_pre_erase_latches_on_protected_launch_sector(void) {
-    for (size_t i = 0; i < FAKE_MEMORY_SIZE_BYTES; i++) {
-        flash->fakeMemory[i] = 0x00;
+    for (uint32_t address = 0; address < FAKE_MEMORY_SIZE_BYTES; address += SFLASH_SECTOR_SIZE) {
+        std::memset(flash->memoryAt(address), 0x00, SFLASH_SECTOR_SIZE);
     }
     dss->clearInternalState();
 
@@ -124,7 +133,7 @@ void test_pre_erase_latches_on_protected_launch_sector(void) {
     uint32_t const launchWriteAddress = protectedSectorStartAddress + 3000U;
     uint32_t const writeAddressBeforeBoundary = protectedSectorStartAddress - DataSaverSPI::kBufferSize_bytes;
 
-    flash->fakeMemory[launchWriteAddress] = 0x5A;
+    *flash->memoryAt(launchWriteAddress) = 0x5A;
     dss->setPostLaunchStateForTest(writeAddressBeforeBoundary, launchWriteAddress, true);
 
     uint32_t const recordsPerFlush = DataSaverSPI::kBufferSize_bytes / sizeof(TimestampRecord_t);
@@ -138,12 +147,12 @@ void test_pre_erase_latches_on_protected_launch_sector(void) {
     // next sector now latches chip-full protection.
     TEST_ASSERT_EQUAL(0, result);
     TEST_ASSERT_TRUE(dss->getIsChipFullDueToPostLaunchProtection());
-    TEST_ASSERT_EQUAL_HEX8(0x5A, flash->fakeMemory[launchWriteAddress]);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, *flash->memoryAt(launchWriteAddress));
 
     result = dss->saveTimestamp(1000U);
     TEST_ASSERT_EQUAL(1, result);
     TEST_ASSERT_TRUE(dss->getIsChipFullDueToPostLaunchProtection());
-    TEST_ASSERT_EQUAL_HEX8(0x5A, flash->fakeMemory[launchWriteAddress]);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, *flash->memoryAt(launchWriteAddress));
 }
 
 void test_flush_wraps_using_full_page_write_size(void) {
@@ -162,6 +171,600 @@ void test_flush_wraps_using_full_page_write_size(void) {
     TEST_ASSERT_EQUAL_UINT32(kDataStartAddress + DataSaverSPI::kBufferSize_bytes, dss->getNextWriteAddress());
 }
 
+void test_landed_data_budget_stops_writes(void) {
+    dss->clearInternalState();
+    dss->setLandedDataBudget(2U * DataSaverSPI::kBufferSize_bytes);
+    dss->launchDetected(0U);
+    dss->landingDetected(100U);
+    TEST_ASSERT_FALSE(dss->isLandedBudgetExhausted());
+
+    // Two pages may be flushed after landing, then writes are refused
+    int result = 0;
+    uint32_t saved = 0;
+    for (uint32_t i = 0; i < 200U && result == 0; i++) {
+        result = dss->saveDataPoint(DataPoint(100U, 1.0f), 1);
+        if (result == 0) {
+            saved++;
+        }
+    }
+    TEST_ASSERT_EQUAL(1, result);
+    TEST_ASSERT_TRUE(dss->isLandedBudgetExhausted());
+    TEST_ASSERT_EQUAL_UINT32(2U, dss->getBufferFlushes());
+    TEST_ASSERT_TRUE(saved > 2U * DataSaverSPI::kBufferSize_bytes / sizeof(Record_t) - 2U);
+    TEST_ASSERT_EQUAL(1, dss->saveTimestamp(5000U));
+
+    // Clearing post-launch mode starts a new flight
+    dss->clearPostLaunchMode();
+    TEST_ASSERT_FALSE(dss->isLandedBudgetExhausted());
+    TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(100U, 1.0f), 1));
+}
+
+void test_landed_budget_flushes_partial_page(void) {
+    for (const bool background : {false, true}) {
+        dss->clearInternalState();
+        dss->setBackgroundFlush(background);
+        dss->setLandedDataBudget(0U);
+        dss->launchDetected(0U);
+        const uint32_t startAddress = dss->getNextWriteAddress();
+
+        // Half a page before landing, then nothing more is taken
+        for (uint32_t i = 0; i < 20U; i++) {
+            TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(100U, static_cast<float>(i)), 1));
+        }
+        const uint32_t flushes = dss->getBufferFlushes();
+        dss->landingDetected(200U);
+        TEST_ASSERT_TRUE(dss->isLandedBudgetExhausted());
+        TEST_ASSERT_EQUAL(1, dss->saveDataPoint(DataPoint(200U, 99.0f), 1));
+
+        // The half page was written before writes were refused
+        TEST_ASSERT_EQUAL_UINT32(flushes + 1U, dss->getBufferFlushes());
+        TEST_ASSERT_EQUAL_UINT32(0U, dss->getBufferIndex());
+        TEST_ASSERT_EQUAL_UINT32(startAddress + DataSaverSPI::kBufferSize_bytes, dss->getNextWriteAddress());
+        Record_t last = {};
+        std::memcpy(&last, flash->memoryAt(startAddress + 19U * sizeof(Record_t)), sizeof(last));
+        TEST_ASSERT_EQUAL_FLOAT(19.0f, last.data);
+        TEST_ASSERT_EQUAL(1, dss->saveDataPoint(DataPoint(200U, 99.0f), 1));
+        TEST_ASSERT_EQUAL_UINT32(flushes + 1U, dss->getBufferFlushes());
+        dss->setBackgroundFlush(false);
+    }
+}
+
+void test_compressed_pages_round_trip_through_flash(void) {
+    dss->clearInternalState();
+    dss->saveDataPoint(DataPoint(500U, 5.0f), ALTITUDE);  // Raw page data before switching
+    dss->setCompressor(&compressor);
+    TEST_ASSERT_TRUE(dss->isCompressionEnabled());
+    TEST_ASSERT_EQUAL_UINT32(1U, dss->getBufferFlushes());  // Partial raw page flushed
+    TEST_ASSERT_EQUAL_UINT8(TIMESTAMP, *flash->memoryAt(kDataStartAddress));
+
+    // 4 channels at 100 Hz for 3 s; a timestamp is written every 110 ms
+    uint32_t saved = 0;
+    for (uint32_t ts = 600; ts < 3600; ts += 10) {
+        const float t = static_cast<float>(ts) / 1000.0f;
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(ts, 9.81f + 0.01f * static_cast<float>(ts % 7)), ACCELEROMETER_Z));
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(ts, 0.5f * t * t), ALTITUDE));
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(ts, 2.0f), CURRENT_STATE));
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(ts, 21.5f), TEMPERATURE));
+        saved += 4;
+    }
+    dss->setCompressor(nullptr);  // Flushes the last compressed page
+    const uint32_t compressedPages = dss->getBufferFlushes() - 1U;
+    // Raw pages hold 51 records, and the data alone is `saved` records
+    TEST_ASSERT_TRUE(compressedPages * 51U * 2U < saved);
+
+    uint32_t decoded = 0;
+    uint32_t lastTimestamp = 0;
+    float lastAltitude = -1.0f;
+    uint8_t out[8192];
+    for (uint32_t page = 0; page < compressedPages; page++) {
+        const uint8_t* data = flash->memoryAt(kDataStartAddress + (page + 1U) * SFLASH_PAGE_SIZE);
+        TEST_ASSERT_EQUAL_UINT8(kCompressedPageMarker, data[0]);
+        size_t length = 0;
+        TEST_ASSERT_EQUAL(0, FloatCompressor::decodePage(data, SFLASH_PAGE_SIZE, out, sizeof(out), length));
+        uint32_t pageBase = 0;
+        std::memcpy(&pageBase, out + 1, sizeof(pageBase));
+        TEST_ASSERT_EQUAL_UINT32(lastTimestamp == 0 ? 500U : lastTimestamp, pageBase);
+        for (size_t i = 5; i < length; i += 5) {
+            if (out[i] == TIMESTAMP) {
+                std::memcpy(&lastTimestamp, out + i + 1, sizeof(lastTimestamp));
+                continue;
+            }
+            decoded++;
+            if (out[i] == ALTITUDE) {
+                float altitude = 0.0f;
+                std::memcpy(&altitude, out + i + 1, sizeof(altitude));
+                TEST_ASSERT_TRUE(altitude > lastAltitude);
+                lastAltitude = altitude;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(saved, decoded);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f * 3.59f * 3.59f, lastAltitude);
+}
+
+void test_background_flush_defers_page_writes(void) {
+    dss->eraseAllData();
+    dss->setBackgroundFlush(true);
+    TEST_ASSERT_TRUE(dss->isBackgroundFlush());
+
+    // 51 records fill the page; the 52nd hands it to the background context
+    for (uint32_t i = 0; i < 52U; i++) {
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(0U, static_cast<float>(i)), 1));
+    }
+    TEST_ASSERT_TRUE(dss->hasPendingFlush());
+    TEST_ASSERT_EQUAL_UINT32(0U, dss->getBufferFlushes());
+    TEST_ASSERT_EQUAL_UINT8(kEmptyPageValue, *flash->memoryAt(kDataStartAddress));
+    TEST_ASSERT_EQUAL(5, dss->getBufferIndex());
+
+    TEST_ASSERT_EQUAL(0, dss->serviceFlush());
+    TEST_ASSERT_EQUAL(1, dss->serviceFlush());  // Nothing left
+    TEST_ASSERT_FALSE(dss->hasPendingFlush());
+    TEST_ASSERT_EQUAL_UINT32(1U, dss->getBufferFlushes());
+    Record_t last = {};
+    std::memcpy(&last, flash->memoryAt(kDataStartAddress + 50U * sizeof(Record_t)), sizeof(last));
+    TEST_ASSERT_EQUAL_UINT8(1, last.name);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, last.data);
+    TEST_ASSERT_EQUAL_UINT32(0U, dss->getFlushOverruns());
+}
+
+void test_background_flush_counts_overruns(void) {
+    dss->eraseAllData();
+    dss->setBackgroundFlush(true);
+
+    // Without serviceFlush() the second full page finds the first still pending and writes it inline
+    for (uint32_t i = 0; i < 2U * 51U + 1U; i++) {
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(0U, static_cast<float>(i)), 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1U, dss->getFlushOverruns());
+    TEST_ASSERT_EQUAL_UINT32(1U, dss->getBufferFlushes());
+    TEST_ASSERT_TRUE(dss->hasPendingFlush());
+
+    // Switching back to blocking writes drains the pending page
+    dss->setBackgroundFlush(false);
+    TEST_ASSERT_FALSE(dss->hasPendingFlush());
+    TEST_ASSERT_EQUAL_UINT32(2U, dss->getBufferFlushes());
+    TEST_ASSERT_EQUAL_UINT32(0U, dss->getFlushErrors());
+}
+
+void test_background_flush_from_worker_thread(void) {
+    dss->eraseAllData();
+    dss->setCompressor(&compressor);
+    dss->setBackgroundFlush(true);
+
+    std::atomic<bool> stop(false);
+    std::thread worker([&stop]() {
+        while (!stop.load()) {
+            dss->serviceFlush();
+            std::this_thread::yield();
+        }
+    });
+
+    // 40 s of one channel at 100 Hz crosses several sector boundaries
+    for (uint32_t ts = 200; ts < 40200; ts += 10) {
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(ts, static_cast<float>(ts)), ALTITUDE));
+    }
+    dss->launchDetected(40000U);  // Shares the flash with the worker
+    dss->setCompressor(nullptr);
+    dss->setBackgroundFlush(false);
+    stop.store(true);
+    worker.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0U, dss->getFlushErrors());
+    const uint32_t pages = dss->getBufferFlushes();
+    TEST_ASSERT_TRUE(pages * SFLASH_PAGE_SIZE > 2U * SFLASH_SECTOR_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(kDataStartAddress + pages * SFLASH_PAGE_SIZE, dss->getNextWriteAddress());
+
+    // Every page landed in order: altitudes increase across the whole log
+    float lastAltitude = 0.0f;
+    uint32_t decoded = 0;
+    uint8_t out[8192];
+    for (uint32_t page = 0; page < pages; page++) {
+        size_t length = 0;
+        TEST_ASSERT_EQUAL(0, FloatCompressor::decodePage(flash->memoryAt(kDataStartAddress + page * SFLASH_PAGE_SIZE),
+                                                         SFLASH_PAGE_SIZE, out, sizeof(out), length));
+        for (size_t i = 5; i < length; i += 5) {
+            if (out[i] != ALTITUDE) {
+                continue;
+            }
+            float altitude = 0.0f;
+            std::memcpy(&altitude, out + i + 1, sizeof(altitude));
+            TEST_ASSERT_EQUAL_FLOAT(lastAltitude + (decoded == 0 ? 200.0f : 10.0f), altitude);
+            lastAltitude = altitude;
+            decoded++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(4000U, decoded);
+}
+
+namespace {
+
+PageHeader_t readHeader(uint32_t address) {
+    PageHeader_t header = {};
+    std::memcpy(&header, flash->memoryAt(address), sizeof(header));
+    return header;
+}
+
+// Saves whole pages of one channel, one record every 10 ms
+uint32_t savePages(DataSaverSPI* saver, uint32_t pages, uint32_t startTimestamp_ms) {
+    const uint32_t before = saver->getBufferFlushes();
+    uint32_t ts = startTimestamp_ms;
+    while (saver->getBufferFlushes() - before < pages) {
+        TEST_ASSERT_EQUAL(0, saver->saveDataPoint(DataPoint(ts, static_cast<float>(ts)), ALTITUDE));
+        ts += 10U;
+    }
+    return ts;
+}
+
+}  // namespace
+
+void test_crc_check_values(void) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX16(0x29B1U, crc16Ccitt(check, sizeof(check)));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926U, crc32(check, sizeof(check)));
+    // Checksumming in pieces matches one pass
+    TEST_ASSERT_EQUAL_HEX16(0x29B1U, crc16Ccitt(check + 4, 5, crc16Ccitt(check, 4)));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926U, crc32(check + 4, 5, crc32(check, 4)));
+}
+
+void test_page_headers_carry_sequence_timestamp_and_crc(void) {
+    dss->eraseAllData();
+    dss->setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(dss->begin());
+    TEST_ASSERT_EQUAL_UINT32(kDataStartAddress, dss->getNextWriteAddress());
+
+    savePages(dss, 3, 1000U);
+    for (uint32_t page = 0; page < 3U; page++) {
+        const uint32_t address = kDataStartAddress + page * SFLASH_PAGE_SIZE;
+        const PageHeader_t header = readHeader(address);
+        TEST_ASSERT_EQUAL_HEX8(kPageHeaderMagic, header.magic);
+        TEST_ASSERT_EQUAL_UINT32(page, header.sequence);
+        const uint8_t* data = flash->memoryAt(address);
+        const uint16_t crc = crc16Ccitt(data + sizeof(PageHeader_t), SFLASH_PAGE_SIZE - sizeof(PageHeader_t),
+                                        crc16Ccitt(data, offsetof(PageHeader_t, crc16)));
+        TEST_ASSERT_EQUAL_HEX16(crc, header.crc16);
+        // 49 records fit behind the header
+        TEST_ASSERT_EQUAL_UINT8(page == 0U ? TIMESTAMP : ALTITUDE, data[sizeof(PageHeader_t)]);
+    }
+    // The first page opened before any timestamp was saved, later ones after the previous page's last
+    TEST_ASSERT_EQUAL_UINT32(0U, readHeader(kDataStartAddress).firstTimestamp_ms);
+    TEST_ASSERT_TRUE(readHeader(kDataStartAddress + SFLASH_PAGE_SIZE).firstTimestamp_ms > 1000U);
+    TEST_ASSERT_EQUAL_UINT32(3U, dss->getNextPageSequence());
+}
+
+void test_begin_recovers_write_head(void) {
+    dss->eraseAllData();
+    dss->setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(dss->begin());
+    const uint32_t ts = savePages(dss, 100, 1000U);
+    const uint32_t head = dss->getNextWriteAddress();
+
+    // Reboot: a fresh saver on the same chip
+    DataSaverSPI rebooted(100, flash);
+    rebooted.setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(head, rebooted.getNextWriteAddress());
+    TEST_ASSERT_EQUAL_UINT32(100U, rebooted.getNextPageSequence());
+    // 1 + log2(65535 pages) header reads plus the erased-head check
+    TEST_ASSERT_TRUE(rebooted.getHeadSearchReads() <= 18U);
+
+    savePages(&rebooted, 1, ts);
+    TEST_ASSERT_EQUAL_UINT32(100U, readHeader(head).sequence);
+    TEST_ASSERT_EQUAL_UINT32(99U, readHeader(head - SFLASH_PAGE_SIZE).sequence);  // Untouched
+}
+
+void test_begin_recovers_wrapped_and_torn_head(void) {
+    dss->eraseAllData();
+    dss->setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(dss->begin());
+    uint32_t ts = savePages(dss, 40, 1000U);  // Sequences 0..39 at the start of the ring
+
+    // Jump to the last 10 pages of the chip and wrap 10 pages into the next lap
+    const auto flashEnd = static_cast<uint32_t>(flash->size());
+    dss->setPostLaunchStateForTest(flashEnd - 10U * SFLASH_PAGE_SIZE, 0U, false);
+    ts = savePages(dss, 20, ts);
+    TEST_ASSERT_EQUAL_UINT32(kDataStartAddress + 10U * SFLASH_PAGE_SIZE, dss->getNextWriteAddress());
+
+    DataSaverSPI rebooted(100, flash);
+    rebooted.setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(kDataStartAddress + 10U * SFLASH_PAGE_SIZE, rebooted.getNextWriteAddress());
+    TEST_ASSERT_EQUAL_UINT32(60U, rebooted.getNextPageSequence());
+
+    // A brownout half-way through the next page leaves it torn: resume at the next sector
+    savePages(&rebooted, 1, ts);
+    std::memcpy(flash->memoryAt(kDataStartAddress + 11U * SFLASH_PAGE_SIZE),
+                flash->memoryAt(kDataStartAddress + 10U * SFLASH_PAGE_SIZE), 128U);
+    DataSaverSPI torn(100, flash);
+    torn.setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(torn.begin());
+    TEST_ASSERT_EQUAL_UINT32(kDataStartAddress + SFLASH_SECTOR_SIZE, torn.getNextWriteAddress());
+    TEST_ASSERT_EQUAL_UINT32(61U, torn.getNextPageSequence());
+}
+
+void test_begin_resumes_logging_in_post_launch_mode(void) {
+    dss->eraseAllData();
+    dss->setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(dss->begin());
+    uint32_t ts = savePages(dss, 20, 1000U);
+    dss->launchDetected(ts);
+    ts = savePages(dss, 5, ts);
+    const uint32_t launchAddress = dss->getLaunchWriteAddress();
+    const uint32_t head = dss->getNextWriteAddress();
+
+    DataSaverSPI rebooted(100, flash);
+    rebooted.setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_FALSE(rebooted.getRebootedInPostLaunchMode());
+    TEST_ASSERT_TRUE(rebooted.quickGetPostLaunchMode());
+    TEST_ASSERT_EQUAL_UINT32(launchAddress, rebooted.getLaunchWriteAddress());
+    TEST_ASSERT_EQUAL_UINT32(head, rebooted.getNextWriteAddress());
+    savePages(&rebooted, 1, ts);
+    TEST_ASSERT_EQUAL_UINT32(25U, readHeader(head).sequence);
+
+    // Without page headers the old behaviour stays: no writes after a post-launch reboot
+    DataSaverSPI legacy(100, flash);
+    TEST_ASSERT_FALSE(legacy.begin());
+    TEST_ASSERT_EQUAL(1, legacy.saveDataPoint(DataPoint(ts, 1.0f), ALTITUDE));
+}
+
+void test_flight_directory_records_flights(void) {
+    dss->eraseAllData();
+    dss->setLandedDataBudget(DataSaverSPI::kBufferSize_bytes);
+    TEST_ASSERT_EQUAL_UINT32(0U, dss->getFlightCount());
+
+    uint32_t ts = savePages(dss, 30, 1000U);
+    dss->launchDetected(ts);
+    const uint32_t launchAddress = dss->getLaunchWriteAddress();
+    ts = savePages(dss, 10, ts);
+    dss->landingDetected(ts);
+    // Uses up the landed budget, which closes the flight; the record that
+    // would start the next page is refused
+    int result = 0;
+    while (result == 0) {
+        result = dss->saveDataPoint(DataPoint(ts, static_cast<float>(ts)), ALTITUDE);
+        ts += 10U;
+    }
+    TEST_ASSERT_EQUAL(1, result);
+    TEST_ASSERT_TRUE(dss->isLandedBudgetExhausted());
+    const uint32_t endAddress = dss->getNextWriteAddress();
+
+    FlightEntry_t flight = {};
+    TEST_ASSERT_EQUAL_UINT32(1U, dss->getFlightCount());
+    TEST_ASSERT_TRUE(dss->getFlight(0, flight));
+    TEST_ASSERT_EQUAL_UINT16(1U, flight.flightId);
+    TEST_ASSERT_EQUAL_UINT32(launchAddress, flight.startAddress);
+    TEST_ASSERT_EQUAL_UINT32(endAddress, flight.endAddress);
+
+    // Clearing the post-launch flag keeps the directory; the next launch appends
+    dss->clearPostLaunchMode();
+    ts = savePages(dss, 5, ts);
+    dss->launchDetected(ts);
+    savePages(dss, 2, ts);
+    TEST_ASSERT_EQUAL_UINT32(2U, dss->getFlightCount());
+    TEST_ASSERT_TRUE(dss->findFlight(2U, flight));
+    TEST_ASSERT_EQUAL_UINT32(ts, flight.launchTimestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32(kFlightOpenEndAddress, flight.endAddress);
+
+    uint32_t firstPage = 0;
+    uint32_t endPage = 0;
+    TEST_ASSERT_TRUE(dss->getFlightPages(2U, firstPage, endPage));
+    TEST_ASSERT_EQUAL_UINT32((dss->getNextWriteAddress() - kDataStartAddress) / SFLASH_PAGE_SIZE, endPage);
+    TEST_ASSERT_FALSE(dss->getFlightPages(3U, firstPage, endPage));
+
+    // The directory survives a reboot
+    DataSaverSPI rebooted(100, flash);
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_UINT32(2U, rebooted.getFlightCount());
+    TEST_ASSERT_TRUE(rebooted.findFlight(1U, flight));
+    TEST_ASSERT_EQUAL_UINT32(endAddress, flight.endAddress);
+
+    // Closing entries and metadata updates only ever clear bits of erased flash
+    TEST_ASSERT_EQUAL_UINT32(0U, flash->getNorViolations());
+}
+
+void test_launch_rollback_keeps_requested_history(void) {
+    dss->eraseAllData();
+    dss->setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(dss->begin());
+    const uint32_t ts = savePages(dss, 200, 1000U);  // About 100 s of data, 8 s per sector
+
+    // A reboot rebuilds the index from the page headers
+    DataSaverSPI rebooted(100, flash);
+    rebooted.setPageHeadersEnabled(true);
+    TEST_ASSERT_TRUE(rebooted.begin());
+
+    const uint32_t history_ms = 20000;
+    dss->setPreLaunchHistory(history_ms);
+    dss->launchDetected(ts);
+    const uint32_t launchAddress = dss->getLaunchWriteAddress();
+    TEST_ASSERT_EQUAL_UINT32(0U, launchAddress % SFLASH_SECTOR_SIZE);
+    TEST_ASSERT_TRUE(readHeader(launchAddress).firstTimestamp_ms <= ts - history_ms);
+    TEST_ASSERT_TRUE(readHeader(launchAddress + SFLASH_SECTOR_SIZE).firstTimestamp_ms > ts - history_ms);
+
+    rebooted.setPreLaunchHistory(history_ms);
+    rebooted.launchDetected(ts);
+    TEST_ASSERT_EQUAL_UINT32(launchAddress, rebooted.getLaunchWriteAddress());
+}
+
+void test_save_blocking_time_on_flash(void) {
+    dss->eraseAllData();
+    dss->setBackgroundFlush(false);
+    flash->resetStats();
+
+    // Foreground flushing: a call blocks for at most one page program plus one sector pre-erase
+    const FakeFlashTiming timing;
+    uint64_t worst_us = 0;
+    const uint32_t saves = 51U * 64U;
+    for (uint32_t i = 0; i < saves; i++) {
+        const uint64_t before = flash->getElapsed_us();
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(1000U + i, static_cast<float>(i)), ALTITUDE));
+        const uint64_t blocked = flash->getElapsed_us() - before;
+        worst_us = blocked > worst_us ? blocked : worst_us;
+    }
+    TEST_ASSERT_TRUE(worst_us >= timing.sectorErase_us);
+    TEST_ASSERT_TRUE(worst_us <= timing.sectorErase_us + 2U * timing.pageProgram_us);
+    // Amortized: a page program and 1/16 of a sector erase per 51 records
+    TEST_ASSERT_TRUE(flash->getElapsed_us() / saves < 100U);
+    TEST_ASSERT_EQUAL_UINT32(0U, flash->getNorViolations());
+
+    // Background flushing: the logging call never waits on the chip
+    dss->setBackgroundFlush(true);
+    for (uint32_t i = 0; i < saves; i++) {
+        const uint64_t before = flash->getElapsed_us();
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(2000U + i, static_cast<float>(i)), ALTITUDE));
+        TEST_ASSERT_EQUAL_UINT32(0U, static_cast<uint32_t>(flash->getElapsed_us() - before));
+        dss->serviceFlush();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0U, flash->getNorViolations());
+}
+
+namespace {
+
+// Samples on three channels with a gap that forces timestamp records
+NamedDataPoint batchSample(uint32_t i) {
+    const uint8_t names[] = {ACCELEROMETER_Z, ALTITUDE, PRESSURE};
+    const uint32_t timestamp_ms = 1000U + (i / 3U) * 7U + (i > 900U ? 5000U : 0U);
+    return NamedDataPoint{names[i % 3U], DataPoint(timestamp_ms, static_cast<float>(i) * 0.37F)};
+}
+
+// Save the same samples one at a time and in batches; the flash must match byte for byte
+void checkBatchMatchesSingle(bool compressed) {
+    constexpr uint32_t kCount = 2000U;
+    constexpr uint32_t kBatch = 37U;  // Not a divisor of a page's records
+    Adafruit_SPIFlash batchFlash;
+    DataSaverSPI batchSaver(100, &batchFlash);
+    dss->clearInternalState();
+    batchSaver.clearInternalState();
+    FloatCompressor batchCompressor;
+    dss->setCompressor(compressed ? &compressor : nullptr);
+    batchSaver.setCompressor(compressed ? &batchCompressor : nullptr);
+
+    for (uint32_t i = 0; i < kCount; i++) {
+        const NamedDataPoint point = batchSample(i);
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(point.dataPoint, point.name));
+    }
+    NamedDataPoint batch[kBatch];
+    for (uint32_t start = 0; start < kCount; start += kBatch) {
+        const uint32_t count = kCount - start < kBatch ? kCount - start : kBatch;
+        for (uint32_t i = 0; i < count; i++) {
+            batch[i] = batchSample(start + i);
+        }
+        TEST_ASSERT_EQUAL(0, batchSaver.saveDataPoints(batch, count));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(dss->getNextWriteAddress(), batchSaver.getNextWriteAddress());
+    TEST_ASSERT_EQUAL_UINT32(dss->getBufferIndex(), batchSaver.getBufferIndex());
+    TEST_ASSERT_EQUAL_UINT32(dss->getLastTimestamp(), batchSaver.getLastTimestamp());
+    TEST_ASSERT_EQUAL_UINT32(dss->getLastDataPoint().timestamp_ms, batchSaver.getLastDataPoint().timestamp_ms);
+    for (uint32_t address = kDataStartAddress; address < dss->getNextWriteAddress(); address += SFLASH_SECTOR_SIZE) {
+        const uint32_t length = dss->getNextWriteAddress() - address < SFLASH_SECTOR_SIZE
+                                    ? dss->getNextWriteAddress() - address : SFLASH_SECTOR_SIZE;
+        TEST_ASSERT_EQUAL_MEMORY(flash->memoryAt(address), batchFlash.memoryAt(address), length);
+    }
+}
+
+} // namespace
+
+void test_save_data_points_matches_single_saves(void) {
+    checkBatchMatchesSingle(false);
+    checkBatchMatchesSingle(true);
+}
+
+void test_save_data_points_stops_at_landed_budget(void) {
+    dss->clearInternalState();
+    dss->setLandedDataBudget(2U * DataSaverSPI::kBufferSize_bytes);
+    dss->launchDetected(0U);
+    dss->landingDetected(100U);
+
+    NamedDataPoint batch[200];
+    for (NamedDataPoint& point : batch) {
+        point = NamedDataPoint{ALTITUDE, DataPoint(100U, 1.0f)};
+    }
+    TEST_ASSERT_EQUAL(1, dss->saveDataPoints(batch, 200U));
+    TEST_ASSERT_TRUE(dss->isLandedBudgetExhausted());
+    TEST_ASSERT_EQUAL_UINT32(2U, dss->getBufferFlushes());
+}
+
+// Every record written to the data region of @p source, in log order
+std::vector<DecodedRecord> decodeFlash(Adafruit_SPIFlash& source, uint32_t end) {
+    struct Collector : IRecordSink {
+        void onRecord(const DecodedRecord& record) override { records.push_back(record); }
+        std::vector<DecodedRecord> records;
+    } collector;
+    FlashDecoder decoder(collector);
+    std::vector<uint8_t> image(end - kDataStartAddress);
+    TEST_ASSERT_TRUE(source.readBuffer(kDataStartAddress, image.data(), image.size()));
+    decoder.decodeImage(image.data(), image.size());
+    return collector.records;
+}
+
+// Log @p count triplets with saveDataVector() into @p vectorSaver and as single points into dss
+void logTriplets(DataSaverSPI& vectorSaver, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t timestamp_ms = 1000U + i * 7U;
+        const float x = static_cast<float>(i) * 0.25F;
+        for (uint8_t axis = 0; axis < 3U; axis++) {
+            TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(timestamp_ms, x + axis), ACCELEROMETER_X + axis));
+        }
+        TEST_ASSERT_EQUAL(0, vectorSaver.saveDataVector(DataVector(timestamp_ms, x, x + 1.0F, x + 2.0F),
+                                                        ACCELEROMETER_X));
+    }
+}
+
+void test_save_data_vector_writes_vector_records(void) {
+    constexpr uint32_t kCount = 3000U;
+    Adafruit_SPIFlash vectorFlash;
+    DataSaverSPI vectorSaver(100, &vectorFlash);
+    dss->clearInternalState();
+    vectorSaver.clearInternalState();
+    logTriplets(vectorSaver, kCount);
+
+    // Timestamp record, then 14-byte vector records
+    const uint8_t* page = vectorFlash.memoryAt(kDataStartAddress);
+    TEST_ASSERT_EQUAL_UINT8(TIMESTAMP, page[0]);
+    TEST_ASSERT_EQUAL_UINT8(kVectorRecordName + 3U, page[5]);
+    TEST_ASSERT_EQUAL_UINT8(ACCELEROMETER_X, page[6]);
+    TEST_ASSERT_EQUAL_UINT8(kVectorRecordName + 3U, page[5U + vectorRecordSize(3U)]);
+    TEST_ASSERT_EQUAL_FLOAT(2.0F, vectorSaver.getLastDataPoint().data - static_cast<float>(kCount - 1U) * 0.25F);
+
+    // The same records in fewer pages, and raw pages keep their last byte unused for dumpData()
+    const uint32_t singleEnd = dss->getNextWriteAddress();
+    const uint32_t vectorEnd = vectorSaver.getNextWriteAddress();
+    TEST_ASSERT_TRUE((vectorEnd - kDataStartAddress) * 20U < (singleEnd - kDataStartAddress) * 19U);
+    for (uint32_t address = kDataStartAddress; address < vectorEnd; address += DataSaverSPI::kBufferSize_bytes) {
+        TEST_ASSERT_EQUAL_UINT8(kEmptyPageValue, *vectorFlash.memoryAt(address + DataSaverSPI::kBufferSize_bytes - 1U));
+    }
+    const std::vector<DecodedRecord> single = decodeFlash(*flash, singleEnd);
+    const std::vector<DecodedRecord> vector = decodeFlash(vectorFlash, vectorEnd);
+    TEST_ASSERT_TRUE(vector.size() > kCount * 3U - 200U);
+    for (size_t i = 0; i < vector.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(single[i].timestamp_ms, vector[i].timestamp_ms);
+        TEST_ASSERT_EQUAL_UINT8(single[i].name, vector[i].name);
+        TEST_ASSERT_EQUAL_FLOAT(single[i].value, vector[i].value);
+    }
+}
+
+void test_compressed_vector_matches_single_saves(void) {
+    // Compressed pages predict each channel on its own, so vectors are saved per component
+    FloatCompressor vectorCompressor;
+    Adafruit_SPIFlash vectorFlash;
+    DataSaverSPI vectorSaver(100, &vectorFlash);
+    dss->clearInternalState();
+    vectorSaver.clearInternalState();
+    dss->setCompressor(&compressor);
+    vectorSaver.setCompressor(&vectorCompressor);
+    logTriplets(vectorSaver, 3000U);
+
+    TEST_ASSERT_EQUAL_UINT32(dss->getNextWriteAddress(), vectorSaver.getNextWriteAddress());
+    TEST_ASSERT_EQUAL_UINT32(dss->getBufferIndex(), vectorSaver.getBufferIndex());
+    for (uint32_t address = kDataStartAddress; address < dss->getNextWriteAddress(); address += SFLASH_SECTOR_SIZE) {
+        const uint32_t length = dss->getNextWriteAddress() - address < SFLASH_SECTOR_SIZE
+                                    ? dss->getNextWriteAddress() - address : SFLASH_SECTOR_SIZE;
+        TEST_ASSERT_EQUAL_MEMORY(flash->memoryAt(address), vectorFlash.memoryAt(address), length);
+    }
+    dss->setCompressor(nullptr);
+}
+
 void test_record_size(void) {
     Record_t record = {1, 2.0f};
     TEST_ASSERT_EQUAL(5, sizeof(record)); // 1 byte for name, 4 bytes for data
@@ -185,5 +788,23 @@ int main(void) {
     RUN_TEST(test_next_sector_is_erased_before_crossing_boundary);
     RUN_TEST(test_pre_erase_latches_on_protected_launch_sector);
     RUN_TEST(test_flush_wraps_using_full_page_write_size);
+    RUN_TEST(test_landed_data_budget_stops_writes);
+    RUN_TEST(test_landed_budget_flushes_partial_page);
+    RUN_TEST(test_compressed_pages_round_trip_through_flash);
+    RUN_TEST(test_background_flush_defers_page_writes);
+    RUN_TEST(test_background_flush_counts_overruns);
+    RUN_TEST(test_background_flush_from_worker_thread);
+    RUN_TEST(test_crc_check_values);
+    RUN_TEST(test_page_headers_carry_sequence_timestamp_and_crc);
+    RUN_TEST(test_begin_recovers_write_head);
+    RUN_TEST(test_begin_recovers_wrapped_and_torn_head);
+    RUN_TEST(test_begin_resumes_logging_in_post_launch_mode);
+    RUN_TEST(test_flight_directory_records_flights);
+    RUN_TEST(test_launch_rollback_keeps_requested_history);
+    RUN_TEST(test_save_blocking_time_on_flash);
+    RUN_TEST(test_save_data_points_matches_single_saves);
+    RUN_TEST(test_save_data_points_stops_at_landed_budget);
+    RUN_TEST(test_save_data_vector_writes_vector_records);
+    RUN_TEST(test_compressed_vector_matches_single_saves);
     return UNITY_END();
 }
@@ -0,0 +1,260 @@
+#include "unity.h"
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "DataSaver_mock.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "data_handling/LandedThrottle.h"
+#include "data_handling/SensorDataHandler.h"
+#include "data_handling/Telemetry.h"
+#include "state_estimation/DescentDetector.h"
+#include "state_estimation/StateMachine.h"
+#include "state_estimation/States.h"
+#include "state_estimation/VerticalVelocityEstimator.h"
+
+namespace {
+
+constexpr float kGravity_mps2 = 9.81F;
+
+// Dual-deploy flight: boost, coast, 2 s of free fall after apogee, drogue to
+// 25 m/s, main to 6 m/s below 250 m, then the rocket sits on the ground.
+class DualDeployFlight {
+public:
+    static constexpr uint32_t kTick_ms = 10;
+    static constexpr uint32_t kLaunch_ms = 5000;
+    static constexpr uint32_t kBurn_ms = 3000;
+    static constexpr float kMotorAccel_mps2 = 70.0F;
+    static constexpr uint32_t kFreeFall_ms = 2000;
+    static constexpr float kDrogueRate_mps = 25.0F;
+    static constexpr float kMainRate_mps = 6.0F;
+    static constexpr float kMainAltitude_m = 250.0F;
+
+    void tick() {
+        time_ms_ += kTick_ms;
+        const float dt = static_cast<float>(kTick_ms) / 1000.0F;
+        float accel = 0.0F;
+        if (landed_ || time_ms_ < kLaunch_ms) {
+            accel = 0.0F;
+        } else if (time_ms_ < kLaunch_ms + kBurn_ms) {
+            accel = kMotorAccel_mps2 - kGravity_mps2;
+        } else if (apogee_ms_ == 0 || time_ms_ < apogee_ms_ + kFreeFall_ms) {
+            accel = -kGravity_mps2;
+        } else {
+            // Canopies relax the velocity towards their terminal descent rate
+            const float target = altitude_ > kMainAltitude_m ? -kDrogueRate_mps : -kMainRate_mps;
+            if (target == -kDrogueRate_mps && drogue_ms_ == 0) drogue_ms_ = time_ms_;
+            if (target == -kMainRate_mps && main_ms_ == 0) main_ms_ = time_ms_;
+            accel = (target - velocity_) / 0.3F;
+        }
+        inertialAccel_ = accel;
+        if (landed_ || time_ms_ < kLaunch_ms) return;
+
+        velocity_ += accel * dt;
+        altitude_ += velocity_ * dt;
+        if (apogee_ms_ == 0 && velocity_ < 0.0F) apogee_ms_ = time_ms_;
+        if (altitude_ <= 0.0F && apogee_ms_ != 0) {
+            altitude_ = 0.0F;
+            velocity_ = 0.0F;
+            landed_ = true;
+            landed_ms_ = time_ms_;
+        }
+    }
+
+    uint32_t time_ms() const { return time_ms_; }
+    float altitude() const { return altitude_; }
+    float measuredAccel() const { return inertialAccel_ + kGravity_mps2; }
+    uint32_t drogue_ms() const { return drogue_ms_; }
+    uint32_t main_ms() const { return main_ms_; }
+    uint32_t landed_ms() const { return landed_ms_; }
+    bool landed() const { return landed_; }
+
+private:
+    uint32_t time_ms_ = 0;
+    float altitude_ = 0.0F;
+    float velocity_ = 0.0F;
+    float inertialAccel_ = 0.0F;
+    bool landed_ = false;
+    uint32_t apogee_ms_ = 0;
+    uint32_t drogue_ms_ = 0;
+    uint32_t main_ms_ = 0;
+    uint32_t landed_ms_ = 0;
+};
+
+struct Sample {
+    AccelerationTriplet accel;
+    DataPoint alt;
+};
+
+Sample noisySample(const DualDeployFlight& flight, std::default_random_engine& rng) {
+    std::normal_distribution<float> accelNoise(0.0F, 0.2F);
+    std::normal_distribution<float> altNoise(0.0F, 0.3F);
+    const uint32_t ts = flight.time_ms();
+    return {{DataPoint(ts, 0.0F), DataPoint(ts, 0.0F), DataPoint(ts, flight.measuredAccel() + accelNoise(rng))},
+            DataPoint(ts, flight.altitude() + altNoise(rng))};
+}
+
+class LandingSaver : public DataSaverMock {
+public:
+    void landingDetected(uint32_t landingTimestamp_ms) override {
+        landingCalls++;
+        landingTimestamp_ms_ = landingTimestamp_ms;
+    }
+    uint32_t landingCalls = 0;
+    uint32_t landingTimestamp_ms_ = 0;
+};
+
+uint32_t landedCallbackCount = 0;
+void onLanded() {
+    landedCallbackCount++;
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_detects_drogue_main_and_landing(void) {
+    std::default_random_engine rng(7);
+    DualDeployFlight flight;
+    VerticalVelocityEstimator vve;
+    DescentDetector detector;
+
+    // Run the estimator and detector from the pad, as in a state machine that starts them at apogee or earlier
+    while (!flight.landed() || flight.time_ms() < flight.landed_ms() + 20000) {
+        flight.tick();
+        const Sample s = noisySample(flight, rng);
+        vve.update(s.accel, s.alt);
+        detector.update(&vve);
+    }
+
+    printf("drogue %u/%u ms, main %u/%u ms, landed %u/%u ms (detected/true)\n", detector.getDrogueDeployedTime(),
+           flight.drogue_ms(), detector.getMainDeployedTime(), flight.main_ms(), detector.getLandedTime(),
+           flight.landed_ms());
+
+    TEST_ASSERT_TRUE(detector.isDrogueDeployed());
+    TEST_ASSERT_TRUE(detector.isMainDeployed());
+    TEST_ASSERT_TRUE(detector.isLanded());
+
+    // Each event needs a full, stable window (1 s) to settle; landing additionally holds for 5 s
+    TEST_ASSERT_UINT32_WITHIN(3000, flight.drogue_ms() + 1500, detector.getDrogueDeployedTime());
+    TEST_ASSERT_UINT32_WITHIN(1500, flight.main_ms() + 1000, detector.getMainDeployedTime());
+    TEST_ASSERT_TRUE(detector.getLandedTime() >= flight.landed_ms() + 5000);
+    TEST_ASSERT_TRUE(detector.getLandedTime() <= flight.landed_ms() + 9000);
+    TEST_ASSERT_TRUE(detector.getDrogueDeployedTime() < detector.getMainDeployedTime());
+
+    detector.reset();
+    TEST_ASSERT_FALSE(detector.isLanded());
+    TEST_ASSERT_FALSE(detector.isDrogueDeployed());
+}
+
+void test_free_fall_is_not_a_deployment(void) {
+    VerticalVelocityEstimator vve;
+    DescentDetector detector;
+    vve.init({1000.0F, 0});
+
+    // Ballistic fall from rest: velocity changes 9.8 m/s every second, never a stable window
+    float altitude = 1000.0F;
+    float velocity = 0.0F;
+    for (uint32_t ts = 10; ts <= 8000; ts += 10) {
+        velocity -= kGravity_mps2 * 0.01F;
+        altitude += velocity * 0.01F;
+        const AccelerationTriplet accel = {DataPoint(ts, 0.0F), DataPoint(ts, 0.0F), DataPoint(ts, 0.0F)};
+        vve.update(accel, DataPoint(ts, altitude));
+        detector.update(&vve);
+    }
+    TEST_ASSERT_FALSE(detector.isDrogueDeployed());
+    TEST_ASSERT_FALSE(detector.isLanded());
+    TEST_ASSERT_TRUE(detector.getDescentRate_mps() > 50.0F);
+}
+
+void test_state_machine_reaches_landed(void) {
+    std::default_random_engine rng(11);
+    DualDeployFlight flight;
+    LandingSaver saver;
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    FastLaunchDetector fld(30, 500);
+    DescentDetector dd;
+    StateMachine sm(&saver, &lp, &ad, &vve, &fld, &dd);
+    landedCallbackCount = 0;
+    TEST_ASSERT_TRUE(sm.registerOnStateEntry(STATE_LANDED, onLanded));
+
+    std::array<bool, kFlightStateCount> visited{};
+    while (!flight.landed() || flight.time_ms() < flight.landed_ms() + 20000) {
+        flight.tick();
+        const Sample s = noisySample(flight, rng);
+        TEST_ASSERT_EQUAL(0, sm.update(s.accel, s.alt));
+        visited[sm.getState()] = true;
+    }
+
+    TEST_ASSERT_EQUAL(STATE_LANDED, sm.getState());
+    TEST_ASSERT_TRUE(visited[STATE_ASCENT]);
+    TEST_ASSERT_TRUE(visited[STATE_DESCENT]);
+    TEST_ASSERT_TRUE(visited[STATE_DROGUE_DEPLOYED]);
+    TEST_ASSERT_TRUE(visited[STATE_MAIN_DEPLOYED]);
+    TEST_ASSERT_EQUAL_UINT32(1, landedCallbackCount);
+    TEST_ASSERT_EQUAL_UINT32(1, saver.landingCalls);
+    TEST_ASSERT_EQUAL_UINT32(dd.getLandedTime(), saver.landingTimestamp_ms_);
+
+    // Every state change is logged exactly once
+    std::vector<uint8_t> logged;
+    for (const auto& call : saver.saveDataPointCalls) {
+        if (call.second == STATE_CHANGE) logged.push_back(static_cast<uint8_t>(call.first.data));
+    }
+    const uint8_t expected[] = {STATE_ASCENT, STATE_DESCENT, STATE_DROGUE_DEPLOYED, STATE_MAIN_DEPLOYED,
+                                STATE_LANDED};
+    // A fast launch detection may log SOFT_ASCENT first
+    const size_t offset = (!logged.empty() && logged[0] == STATE_SOFT_ASCENT) ? 1U : 0U;
+    TEST_ASSERT_EQUAL(sizeof(expected), logged.size() - offset);
+    for (size_t i = 0; i < sizeof(expected); ++i) {
+        TEST_ASSERT_EQUAL(expected[i], logged[i + offset]);
+    }
+}
+
+void test_landed_throttle_slows_handlers_and_telemetry(void) {
+    DataSaverMock saver;
+    SensorDataHandler accel(ACCELEROMETER_X, &saver);
+    SensorDataHandler baro(ALTITUDE, &saver);
+    accel.restrictSaveSpeed(10);
+    SendableSensorData accelStream(&accel, 20);
+    SendableSensorData baroStream(&baro, 10);
+
+    const std::array<SensorDataHandler*, 2> handlers = {{&accel, &baro}};
+    const std::array<SendableSensorData*, 2> streams = {{&accelStream, &baroStream}};
+    LandedThrottle throttle(handlers, streams, 1000, 5000, 500);
+
+    TEST_ASSERT_TRUE(throttle.shouldPollSensors(0));
+    TEST_ASSERT_TRUE(throttle.shouldPollSensors(1));
+    TEST_ASSERT_FALSE(throttle.isApplied());
+
+    throttle.apply();
+    throttle.apply();
+    TEST_ASSERT_TRUE(throttle.isApplied());
+    TEST_ASSERT_EQUAL_UINT16(5000, accelStream.period_ms);
+    TEST_ASSERT_EQUAL_UINT16(5000, baroStream.period_ms);
+
+    // Save interval is now 1 s: 10 s of 100 Hz samples saves 10 points
+    saver.clear();
+    for (uint32_t ts = 1000; ts < 11000; ts += 10) {
+        accel.addData(DataPoint(ts, 1.0F));
+    }
+    TEST_ASSERT_EQUAL(10, saver.saveDataPointCalls.size());
+
+    TEST_ASSERT_TRUE(throttle.shouldPollSensors(2000));
+    TEST_ASSERT_FALSE(throttle.shouldPollSensors(2400));
+    TEST_ASSERT_TRUE(throttle.shouldPollSensors(2500));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_detects_drogue_main_and_landing);
+    RUN_TEST(test_free_fall_is_not_a_deployment);
+    RUN_TEST(test_state_machine_reaches_landed);
+    RUN_TEST(test_landed_throttle_slows_handlers_and_telemetry);
+    return UNITY_END();
+}
@@ -0,0 +1,254 @@
+#include "unity.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaverSPI.h"
+#include "data_handling/DataVector.h"
+#include "data_handling/FlashDecoder.h"
+#include "data_handling/FloatCompression.h"
+
+namespace {
+
+constexpr uint32_t kTimestampInterval_ms = 100;
+constexpr uint32_t kPointCount = 2000;
+constexpr uint32_t kImageSize_bytes = 64U * 1024U;
+
+class RecordCollector : public IRecordSink {
+public:
+    void onRecord(const DecodedRecord& record) override { records.push_back(record); }
+
+    std::vector<DecodedRecord> records;
+};
+
+// Captures what dumpData() writes and acknowledges every page
+class DumpCapture : public Stream {
+public:
+    using Stream::write;
+
+    size_t write(uint8_t byte) override {
+        bytes.push_back(byte);
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        bytes.insert(bytes.end(), buffer, buffer + size);
+        return size;
+    }
+
+    int read() override { return 'n'; }
+
+    std::vector<uint8_t> bytes;
+};
+
+Adafruit_SPIFlash* flash;
+DataSaverSPI* dss;
+FloatCompressor compressor;
+
+uint32_t pointTimestamp(uint32_t i) { return 1000U + i * 10U; }
+float pointValue(uint32_t i) { return static_cast<float>(i) * 0.25F - 100.0F; }
+uint8_t pointName(uint32_t i) { return (i % 2U == 0U) ? ALTITUDE : ACCELEROMETER_Z; }
+
+void logPoints() {
+    for (uint32_t i = 0; i < kPointCount; i++) {
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(pointTimestamp(i), pointValue(i)), pointName(i)));
+    }
+}
+
+// Every flushed point comes back in order, stamped with the last TIMESTAMP record before it.
+// The partial page still in RAM (at most one page of records) is not on flash.
+void assertDecodedPoints(const std::vector<DecodedRecord>& records) {
+    const auto count = static_cast<uint32_t>(records.size());
+    TEST_ASSERT_TRUE(count <= kPointCount);
+    TEST_ASSERT_TRUE(count + kFlashPageSize_bytes / sizeof(Record_t) >= kPointCount);
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT8(pointName(i), records[i].name);
+        TEST_ASSERT_EQUAL_FLOAT(pointValue(i), records[i].value);
+        TEST_ASSERT_TRUE(records[i].timestamp_ms <= pointTimestamp(i));
+        TEST_ASSERT_TRUE(pointTimestamp(i) - records[i].timestamp_ms <= kTimestampInterval_ms);
+    }
+}
+
+void assertImageDecodes() {
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    std::vector<uint8_t> image(kImageSize_bytes);
+    TEST_ASSERT_TRUE(flash->readBuffer(kDataStartAddress, image.data(), image.size()));
+    decoder.decodeImage(image.data(), image.size());
+    TEST_ASSERT_EQUAL_UINT32(0U, decoder.getMalformedPageCount());
+    TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(collector.records.size()), decoder.getRecordCount());
+    assertDecodedPoints(collector.records);
+}
+
+void assertDumpDecodes() {
+    DumpCapture capture;
+    dss->dumpData(capture, false);
+
+    // Feed in uneven chunks to exercise the streaming parser
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    for (size_t offset = 0; offset < capture.bytes.size(); offset += 97U) {
+        const size_t remaining = capture.bytes.size() - offset;
+        decoder.feedDump(capture.bytes.data() + offset, remaining < 97U ? remaining : 97U);
+    }
+    TEST_ASSERT_TRUE(decoder.isDumpComplete());
+    assertDecodedPoints(collector.records);
+}
+
+} // namespace
+
+void setUp(void) {
+    flash = new Adafruit_SPIFlash();
+    dss = new DataSaverSPI(static_cast<uint16_t>(kTimestampInterval_ms), flash);
+    dss->eraseAllData();
+}
+
+void tearDown(void) {
+    delete dss;
+    delete flash;
+}
+
+void test_decodes_raw_image(void) {
+    logPoints();
+    assertImageDecodes();
+}
+
+void test_decodes_headered_image(void) {
+    dss->setPageHeadersEnabled(true);
+    logPoints();
+    assertImageDecodes();
+}
+
+void test_decodes_compressed_image(void) {
+    dss->setCompressor(&compressor);
+    logPoints();
+    assertImageDecodes();
+}
+
+void test_decodes_raw_dump(void) {
+    logPoints();
+    assertDumpDecodes();
+}
+
+void test_decodes_headered_dump(void) {
+    dss->setPageHeadersEnabled(true);
+    logPoints();
+    assertDumpDecodes();
+}
+
+void test_decodes_compressed_dump(void) {
+    dss->setCompressor(&compressor);
+    logPoints();
+    assertDumpDecodes();
+}
+
+void test_dump_resyncs_after_lost_bytes(void) {
+    logPoints();
+    DumpCapture capture;
+    dss->dumpData(capture, false);
+
+    // Drop a byte from the middle of the third page: that page is garbled, the rest decode
+    const size_t pageStream_bytes = 3U + 255U;
+    capture.bytes.erase(capture.bytes.begin() + static_cast<long>(6U + 2U * pageStream_bytes + 100U));
+
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    decoder.feedDump(capture.bytes.data(), capture.bytes.size());
+    TEST_ASSERT_TRUE(decoder.isDumpComplete());
+    TEST_ASSERT_TRUE(decoder.getPageCount() >= kPointCount / 51U);
+    TEST_ASSERT_TRUE(collector.records.back().value > pointValue(kPointCount - 52U));
+}
+
+void test_dump_flags_are_reported(void) {
+    logPoints();
+    DumpCapture capture;
+    dss->dumpData(capture, false);
+
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    TEST_ASSERT_FALSE(decoder.isDumpComplete());
+    decoder.feedDump(capture.bytes.data(), capture.bytes.size());
+    TEST_ASSERT_EQUAL_STRING("DP", decoder.getDumpFlags());
+}
+
+void test_headered_dump_reports_finished(void) {
+    dss->setPageHeadersEnabled(true);
+    logPoints();
+    DumpCapture capture;
+    dss->dumpData(capture, false);
+
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    decoder.feedDump(capture.bytes.data(), capture.bytes.size());
+    TEST_ASSERT_EQUAL_STRING("F", decoder.getDumpFlags());
+}
+
+void test_erased_and_corrupt_pages_are_counted(void) {
+    dss->setPageHeadersEnabled(true);
+    logPoints();
+    *flash->memoryAt(kDataStartAddress + 20U) ^= 0x01U;  // Breaks the CRC of the first page
+
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    TEST_ASSERT_EQUAL(-1, decoder.decodePage(flash->memoryAt(kDataStartAddress)));
+    TEST_ASSERT_EQUAL(1, decoder.decodePage(flash->memoryAt(kDataStartAddress + kImageSize_bytes)));
+    TEST_ASSERT_EQUAL(0, decoder.decodePage(flash->memoryAt(kDataStartAddress + kFlashPageSize_bytes)));
+    TEST_ASSERT_EQUAL_UINT32(1U, decoder.getMalformedPageCount());
+    TEST_ASSERT_EQUAL_UINT32(1U, decoder.getErasedPageCount());
+    TEST_ASSERT_TRUE(decoder.getRecordCount() > 0U);
+}
+
+// Triplets and single points interleaved, through dumpData()
+void assertVectorDumpDecodes() {
+    constexpr uint32_t kVectorCount = 1000;
+    for (uint32_t i = 0; i < kVectorCount; i++) {
+        const float x = pointValue(i);
+        TEST_ASSERT_EQUAL(0, dss->saveDataVector(DataVector(pointTimestamp(i), x, x + 1.0F, x + 2.0F), ACCELEROMETER_X));
+        TEST_ASSERT_EQUAL(0, dss->saveDataPoint(DataPoint(pointTimestamp(i), -x), ALTITUDE));
+    }
+    DumpCapture capture;
+    dss->dumpData(capture, false);
+
+    RecordCollector collector;
+    FlashDecoder decoder(collector);
+    decoder.feedDump(capture.bytes.data(), capture.bytes.size());
+    TEST_ASSERT_TRUE(decoder.isDumpComplete());
+    const std::vector<DecodedRecord>& records = collector.records;
+    TEST_ASSERT_TRUE(records.size() > (kVectorCount - 20U) * 4U);
+    for (uint32_t r = 0; r < records.size(); r++) {
+        const uint32_t i = r / 4U;
+        const uint8_t component = static_cast<uint8_t>(r % 4U);
+        const float x = pointValue(i);
+        TEST_ASSERT_EQUAL_UINT8(component == 3U ? ALTITUDE : ACCELEROMETER_X + component, records[r].name);
+        TEST_ASSERT_EQUAL_FLOAT(component == 3U ? -x : x + static_cast<float>(component), records[r].value);
+        TEST_ASSERT_TRUE(pointTimestamp(i) - records[r].timestamp_ms <= kTimestampInterval_ms);
+    }
+}
+
+void test_decodes_raw_vector_dump(void) {
+    assertVectorDumpDecodes();
+}
+
+void test_decodes_headered_vector_dump(void) {
+    dss->setPageHeadersEnabled(true);
+    assertVectorDumpDecodes();
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_decodes_raw_image);
+    RUN_TEST(test_decodes_headered_image);
+    RUN_TEST(test_decodes_compressed_image);
+    RUN_TEST(test_decodes_raw_dump);
+    RUN_TEST(test_decodes_headered_dump);
+    RUN_TEST(test_decodes_compressed_dump);
+    RUN_TEST(test_decodes_raw_vector_dump);
+    RUN_TEST(test_decodes_headered_vector_dump);
+    RUN_TEST(test_dump_resyncs_after_lost_bytes);
+    RUN_TEST(test_dump_flags_are_reported);
+    RUN_TEST(test_headered_dump_reports_finished);
+    RUN_TEST(test_erased_and_corrupt_pages_are_counted);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+#include "unity.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataSaverSPI.h"
+#include "data_handling/FlashDumpProtocol.h"
+
+namespace {
+
+constexpr uint32_t kPageCount = static_cast<uint32_t>((16U * 1024U * 1024U - kDataStartAddress) / kDumpPageSize_bytes);
+
+/**
+ * Serial link between dumpDataWindowed() and a DumpReceiver in the same
+ * thread. Bytes written by the device go straight into the receiver; control
+ * messages queue up until the device reads them. Either direction can lose or
+ * corrupt bytes at a fixed rate using a deterministic generator.
+ */
+class LoopbackLink : public Stream, public IDumpSink {
+public:
+    explicit LoopbackLink(uint32_t startPage = 0) : receiver(*this, startPage) {}
+
+    using Stream::write;
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            uint8_t byte = buffer[i];
+            deviceBytes++;
+            if (lossy(deviceLossPerMillion)) {
+                continue;  // Dropped
+            }
+            if (lossy(deviceLossPerMillion)) {
+                byte ^= 0x20U;  // Corrupted
+            }
+            receiver.process(&byte, 1);
+        }
+        return size;
+    }
+
+    int read() override {
+        if (toDevice.empty()) {
+            return -1;
+        }
+        const uint8_t byte = toDevice.front();
+        toDevice.pop_front();
+        return byte;
+    }
+
+    void onPage(uint32_t page, const uint8_t* data) override {
+        std::vector<uint8_t>& stored = pages[page];
+        stored.assign(kDumpPageSize_bytes, kEmptyPageValue);
+        if (data != nullptr) {
+            stored.assign(data, data + kDumpPageSize_bytes);
+        }
+    }
+
+    void sendControl(const uint8_t* message, size_t length) override {
+        for (size_t i = 0; i < length; i++) {
+            if (!lossy(hostLossPerMillion)) {
+                toDevice.push_back(message[i]);
+            }
+        }
+    }
+
+    DumpReceiver receiver;
+    std::map<uint32_t, std::vector<uint8_t>> pages;
+    std::deque<uint8_t> toDevice;
+    size_t deviceBytes = 0;
+    uint32_t deviceLossPerMillion = 0;
+    uint32_t hostLossPerMillion = 0;
+
+private:
+    bool lossy(uint32_t perMillion) {
+        rng_ = rng_ * 1664525U + 1013904223U;
+        return (rng_ >> 8) % 1000000U < perMillion;
+    }
+
+    uint32_t rng_ = 12345U;
+};
+
+Adafruit_SPIFlash* flash;
+DataSaverSPI* dss;
+
+// Log enough to fill a few sectors so written and erased pages are both dumped
+void logFlight() {
+    for (uint32_t i = 0; i < 3000U; i++) {
+        dss->saveDataPoint(DataPoint(500U + i, static_cast<float>(i) * 0.25F), static_cast<uint8_t>(i % 7U));
+    }
+}
+
+void assertMatchesFlash(const LoopbackLink& link, uint32_t startPage) {
+    TEST_ASSERT_EQUAL_UINT32(kPageCount - startPage, static_cast<uint32_t>(link.pages.size()));
+    for (const auto& entry : link.pages) {
+        TEST_ASSERT_TRUE(entry.first >= startPage);
+        const uint32_t address = kDataStartAddress + entry.first * static_cast<uint32_t>(kDumpPageSize_bytes);
+        TEST_ASSERT_EQUAL_MEMORY(flash->memoryAt(address), entry.second.data(), kDumpPageSize_bytes);
+    }
+}
+
+} // namespace
+
+void setUp(void) {
+    flash = new Adafruit_SPIFlash();
+    dss = new DataSaverSPI(100, flash);
+    dss->eraseAllData();
+}
+
+void tearDown(void) {
+    delete dss;
+    delete flash;
+}
+
+void test_control_parser_resyncs_after_garbage(void) {
+    std::array<uint8_t, kDumpControlSize_bytes> message = {};
+    encodeDumpControl(kDumpNak, 0x01020304U, message.data());
+
+    DumpControlParser parser;
+    TEST_ASSERT_FALSE(parser.push(0x55U));
+    TEST_ASSERT_FALSE(parser.push(kDumpAck));
+    bool complete = false;
+    for (size_t i = 0; i < message.size(); i++) {
+        complete = parser.push(message[i]);
+    }
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL_UINT8(kDumpNak, parser.getType());
+    TEST_ASSERT_EQUAL_UINT32(0x01020304U, parser.getPage());
+}
+
+void test_windowed_dump_over_clean_link(void) {
+    logFlight();
+    dss->saveTimestamp(10000U);  // Force the last partial page out
+    const uint32_t writtenPages = dss->getBufferFlushes();
+
+    LoopbackLink link;
+    TEST_ASSERT_EQUAL(0, dss->dumpDataWindowed(link));
+    TEST_ASSERT_TRUE(link.receiver.isDone());
+    TEST_ASSERT_EQUAL_UINT32(kPageCount, link.receiver.getNextPage());
+    TEST_ASSERT_EQUAL_UINT32(0U, link.receiver.getCrcErrors());
+    TEST_ASSERT_EQUAL_UINT32(0U, link.receiver.getDuplicates());
+    assertMatchesFlash(link, 0);
+
+    // Nothing is resent on a clean link: one frame per page plus the end frame
+    const size_t expectedBytes = writtenPages * kDumpPageFrameSize_bytes +
+                                 (kPageCount - writtenPages) * kDumpShortFrameSize_bytes +
+                                 kDumpShortFrameSize_bytes;
+    TEST_ASSERT_EQUAL_size_t(expectedBytes, link.deviceBytes);
+}
+
+void test_windowed_dump_recovers_from_lossy_link(void) {
+    logFlight();
+
+    LoopbackLink link;
+    link.deviceLossPerMillion = 50;   // ~1 in 20000 bytes dropped and as many corrupted
+    link.hostLossPerMillion = 2000;   // ~1 in 70 control messages damaged
+    TEST_ASSERT_EQUAL(0, dss->dumpDataWindowed(link));
+    TEST_ASSERT_TRUE(link.receiver.isDone());
+    TEST_ASSERT_TRUE(link.receiver.getCrcErrors() > 0U);
+    assertMatchesFlash(link, 0);
+}
+
+void test_windowed_dump_resumes_from_page(void) {
+    logFlight();
+
+    const uint32_t resumePage = 20;
+    LoopbackLink link(resumePage);
+    TEST_ASSERT_EQUAL(0, dss->dumpDataWindowed(link, resumePage));
+    TEST_ASSERT_TRUE(link.receiver.isDone());
+    TEST_ASSERT_EQUAL_UINT32(kPageCount - resumePage, link.receiver.getPagesReceived());
+    assertMatchesFlash(link, resumePage);
+}
+
+void test_dump_single_flight(void) {
+    logFlight();
+    dss->launchDetected(4000U);
+    logFlight();
+    dss->saveTimestamp(20000U);  // Force the last partial page out
+
+    uint32_t firstPage = 0;
+    uint32_t endPage = 0;
+    TEST_ASSERT_TRUE(dss->getFlightPages(1U, firstPage, endPage));
+    TEST_ASSERT_TRUE(endPage > firstPage);
+
+    LoopbackLink link(firstPage);
+    TEST_ASSERT_EQUAL(0, dss->dumpFlight(link, 1U));
+    TEST_ASSERT_TRUE(link.receiver.isDone());
+    TEST_ASSERT_EQUAL_UINT32(endPage - firstPage, static_cast<uint32_t>(link.pages.size()));
+    TEST_ASSERT_EQUAL_UINT32(firstPage, link.pages.begin()->first);
+    TEST_ASSERT_EQUAL_UINT32(endPage - 1U, link.pages.rbegin()->first);
+    TEST_ASSERT_EQUAL(1, dss->dumpFlight(link, 2U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_control_parser_resyncs_after_garbage);
+    RUN_TEST(test_windowed_dump_over_clean_link);
+    RUN_TEST(test_windowed_dump_recovers_from_lossy_link);
+    RUN_TEST(test_windowed_dump_resumes_from_page);
+    RUN_TEST(test_dump_single_flight);
+    return UNITY_END();
+}
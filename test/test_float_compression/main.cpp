@@ -0,0 +1,256 @@
+#include "unity.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "data_handling/DataNames.h"
+#include "data_handling/FloatCompression.h"
+
+namespace {
+
+constexpr std::size_t kPageSize_bytes = 256;
+constexpr std::size_t kRecordSize_bytes = 5;
+constexpr std::size_t kMaxDecoded_bytes = 8192;
+
+struct Record {
+    uint8_t name;
+    uint32_t bits;
+};
+
+uint32_t floatBits(float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Sensor values are integer counts times a scale factor, like real IMU/baro drivers produce
+float quantize(float value, float lsb) {
+    return std::round(value / lsb) * lsb;
+}
+
+// 10 s of a logging loop at the MARTHA 1.3 rates from docs/FlashDataSaving.md
+std::vector<Record> flightLog(uint32_t seed) {
+    std::default_random_engine rng(seed);
+    std::normal_distribution<float> accelNoise(0.0F, 0.01F);
+    std::normal_distribution<float> gyroNoise(0.0F, 0.001F);
+    std::normal_distribution<float> altNoise(0.0F, 0.1F);
+    std::vector<Record> log;
+    uint32_t lastTimestamp_ms = 0;
+    for (uint32_t t_ms = 0; t_ms < 10000; t_ms += 10) {
+        const float t_s = static_cast<float>(t_ms) / 1000.0F;
+        if (t_ms - lastTimestamp_ms > 5 || t_ms == 0) {
+            log.push_back({TIMESTAMP, t_ms});
+            lastTimestamp_ms = t_ms;
+        }
+        const float boost = t_s > 2.0F && t_s < 5.0F ? 60.0F : 0.0F;
+        log.push_back({ACCELEROMETER_X, floatBits(quantize(0.1F + accelNoise(rng), 0.0048F))});
+        log.push_back({ACCELEROMETER_Y, floatBits(quantize(-0.2F + accelNoise(rng), 0.0048F))});
+        log.push_back({ACCELEROMETER_Z, floatBits(quantize(9.81F + boost + accelNoise(rng), 0.0048F))});
+        log.push_back({GYROSCOPE_X, floatBits(quantize(gyroNoise(rng), 0.0003F))});
+        log.push_back({GYROSCOPE_Y, floatBits(quantize(gyroNoise(rng), 0.0003F))});
+        log.push_back({GYROSCOPE_Z, floatBits(quantize(0.5F * t_s + gyroNoise(rng), 0.0003F))});
+        log.push_back({ALTITUDE, floatBits(quantize(30.0F * t_s * t_s + altNoise(rng), 0.01F))});
+        if (t_ms % 100 == 0) {
+            log.push_back({CURRENT_STATE, floatBits(t_s > 2.0F ? 2.0F : 0.0F)});
+        }
+        if (t_ms % 1000 == 0) {
+            log.push_back({TEMPERATURE, floatBits(quantize(21.0F + 0.1F * t_s, 0.01F))});
+            log.push_back({MAGNETOMETER_X, floatBits(quantize(20.0F, 0.15F))});
+            log.push_back({MAGNETOMETER_Y, floatBits(quantize(-5.0F, 0.15F))});
+            log.push_back({MAGNETOMETER_Z, floatBits(quantize(40.0F, 0.15F))});
+            log.push_back({FLIGHT_ID, floatBits(7.0F)});
+        }
+    }
+    return log;
+}
+
+// Encode a record stream into pages the way DataSaverSPI does
+std::vector<std::vector<uint8_t>> compress(const std::vector<Record>& log) {
+    std::vector<std::vector<uint8_t>> pages;
+    std::vector<uint8_t> page(kPageSize_bytes, 0xAA);
+    FloatCompressor compressor;
+    uint32_t lastTimestamp_ms = 0;
+    for (const Record& r : log) {
+        if (!compressor.isPageOpen()) {
+            compressor.beginPage(page.data(), page.size(), lastTimestamp_ms);
+        }
+        if (!compressor.append(r.name, r.bits)) {
+            compressor.finishPage();
+            pages.push_back(page);
+            std::fill(page.begin(), page.end(), 0xAA);  // Stale bytes must not leak into the next page
+            compressor.beginPage(page.data(), page.size(), lastTimestamp_ms);
+            TEST_ASSERT_TRUE(compressor.append(r.name, r.bits));
+        }
+        if (r.name == TIMESTAMP) {
+            lastTimestamp_ms = r.bits;
+        }
+    }
+    compressor.finishPage();
+    pages.push_back(page);
+    return pages;
+}
+
+std::vector<Record> decode(const std::vector<uint8_t>& page) {
+    std::vector<uint8_t> out(kMaxDecoded_bytes);
+    std::size_t length = 0;
+    TEST_ASSERT_EQUAL(0, FloatCompressor::decodePage(page.data(), page.size(), out.data(), out.size(), length));
+    TEST_ASSERT_EQUAL(0, length % kRecordSize_bytes);
+    std::vector<Record> records;
+    for (std::size_t i = 0; i < length; i += kRecordSize_bytes) {
+        Record r = {out[i], 0U};
+        std::memcpy(&r.bits, &out[i + 1], sizeof(r.bits));
+        records.push_back(r);
+    }
+    return records;
+}
+
+// Decode every page and drop the base timestamp each page starts with
+std::vector<Record> decodeAll(const std::vector<std::vector<uint8_t>>& pages) {
+    std::vector<Record> records;
+    for (const auto& page : pages) {
+        const std::vector<Record> decoded = decode(page);
+        TEST_ASSERT_TRUE(!decoded.empty());
+        TEST_ASSERT_EQUAL_UINT8(TIMESTAMP, decoded[0].name);
+        records.insert(records.end(), decoded.begin() + 1, decoded.end());
+    }
+    return records;
+}
+
+void assertSameRecords(const std::vector<Record>& expected, const std::vector<Record>& actual) {
+    TEST_ASSERT_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT8(expected[i].name, actual[i].name);
+        TEST_ASSERT_EQUAL_HEX32(expected[i].bits, actual[i].bits);
+    }
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_flight_log_round_trips_and_compresses(void) {
+    const std::vector<Record> log = flightLog(1);
+    const auto pages = compress(log);
+    assertSameRecords(log, decodeAll(pages));
+
+    const std::size_t raw_bytes = log.size() * kRecordSize_bytes;
+    const std::size_t rawPages = (raw_bytes + 254U) / 255U;  // 51 records per raw page
+    const float ratio = static_cast<float>(rawPages) / static_cast<float>(pages.size());
+    printf("%u records: %u raw pages, %u compressed pages (%.2fx)\n", static_cast<unsigned>(log.size()),
+           static_cast<unsigned>(rawPages), static_cast<unsigned>(pages.size()), static_cast<double>(ratio));
+    TEST_ASSERT_TRUE(ratio > 1.25F);
+}
+
+void test_special_values_round_trip(void) {
+    const float specials[] = {0.0F, -0.0F, std::numeric_limits<float>::infinity(),
+                              -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(),
+                              std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(),
+                              -std::numeric_limits<float>::lowest(), 1.0F, 1.0F};
+    std::vector<Record> log = {{TIMESTAMP, 0xFFFFFF00U}, {TIMESTAMP, 0x00000010U}};  // Timestamp wrap-around
+    for (float value : specials) {
+        log.push_back({ALTITUDE, floatBits(value)});
+        log.push_back({255, floatBits(-value)});
+    }
+    assertSameRecords(log, decodeAll(compress(log)));
+}
+
+void test_random_bits_stay_within_worst_case(void) {
+    std::default_random_engine rng(3);
+    std::uniform_int_distribution<uint32_t> bits;
+    std::uniform_int_distribution<int> names(0, 255);
+    std::vector<Record> log;
+    for (int i = 0; i < 5000; ++i) {
+        log.push_back({static_cast<uint8_t>(names(rng)), bits(rng)});
+    }
+    const auto pages = compress(log);
+    assertSameRecords(log, decodeAll(pages));
+
+    // Incompressible input degrades to at most kMaxCompressedRecordBits per record
+    const std::size_t bitsPerPage = (kPageSize_bytes - kCompressedPageHeaderSize_bytes) * 8U;
+    const std::size_t minRecordsPerPage = bitsPerPage / kMaxCompressedRecordBits;
+    TEST_ASSERT_TRUE(pages.size() <= log.size() / minRecordsPerPage + 1U);
+}
+
+void test_pages_decode_independently(void) {
+    const std::vector<Record> log = flightLog(2);
+    const auto pages = compress(log);
+    TEST_ASSERT_TRUE(pages.size() > 3U);
+
+    // A page's base timestamp is the last timestamp written before it
+    const std::vector<Record> third = decode(pages[2]);
+    const std::vector<Record> second = decode(pages[1]);
+    uint32_t expectedBase = second[0].bits;
+    for (const Record& r : second) {
+        if (r.name == TIMESTAMP) {
+            expectedBase = r.bits;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(expectedBase, third[0].bits);
+    TEST_ASSERT_EQUAL_UINT8(kCompressedPageMarker, pages[2][0]);
+}
+
+void test_append_refuses_when_full_and_page_is_unchanged(void) {
+    std::vector<uint8_t> page(kCompressedPageHeaderSize_bytes + 8U);
+    FloatCompressor compressor;
+    TEST_ASSERT_FALSE(compressor.append(ALTITUDE, 0U));  // No page open
+
+    compressor.beginPage(page.data(), page.size(), 1000U);
+    TEST_ASSERT_TRUE(compressor.append(ALTITUDE, floatBits(123.456F)));  // 9 + 3 + 10 + <=32 bits
+    const std::size_t used = compressor.getBytesUsed();
+    const std::vector<uint8_t> before = page;
+    TEST_ASSERT_FALSE(compressor.append(ACCELEROMETER_X, floatBits(-3.21F)));
+    TEST_ASSERT_EQUAL(used, compressor.getBytesUsed());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(before.data(), page.data(), page.size());
+    TEST_ASSERT_EQUAL_UINT16(1, compressor.getRecordCount());
+
+    // An unchanged value still fits in the remaining bits
+    TEST_ASSERT_TRUE(compressor.append(ALTITUDE, floatBits(123.456F)));
+    compressor.finishPage();
+    const std::vector<Record> records = decode(page);
+    TEST_ASSERT_EQUAL(3, records.size());
+    TEST_ASSERT_EQUAL_UINT32(1000U, records[0].bits);
+    TEST_ASSERT_EQUAL_HEX32(floatBits(123.456F), records[2].bits);
+}
+
+void test_malformed_pages_are_rejected(void) {
+    std::vector<uint8_t> page(kPageSize_bytes, 0xFF);
+    std::vector<uint8_t> out(kMaxDecoded_bytes);
+    std::size_t length = 0;
+
+    // Raw Byte5 and erased pages are not compressed pages
+    TEST_ASSERT_EQUAL(-1, FloatCompressor::decodePage(page.data(), page.size(), out.data(), out.size(), length));
+    page[0] = ACCELEROMETER_X;
+    TEST_ASSERT_EQUAL(-1, FloatCompressor::decodePage(page.data(), page.size(), out.data(), out.size(), length));
+
+    // A record count larger than the bit stream runs out of bits
+    FloatCompressor compressor;
+    compressor.beginPage(page.data(), page.size(), 0U);
+    TEST_ASSERT_TRUE(compressor.append(ALTITUDE, floatBits(1.0F)));
+    compressor.finishPage();
+    page[1] = 0xFF;
+    page[2] = 0x03;
+    TEST_ASSERT_EQUAL(-1, FloatCompressor::decodePage(page.data(), page.size(), out.data(), out.size(), length));
+
+    // Output buffer too small for the records
+    page[1] = 1;
+    page[2] = 0;
+    TEST_ASSERT_EQUAL(-1, FloatCompressor::decodePage(page.data(), page.size(), out.data(), 9U, length));
+    TEST_ASSERT_EQUAL(0, FloatCompressor::decodePage(page.data(), page.size(), out.data(), 10U, length));
+    TEST_ASSERT_EQUAL(10, length);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_flight_log_round_trips_and_compresses);
+    RUN_TEST(test_special_values_round_trip);
+    RUN_TEST(test_random_bits_stay_within_worst_case);
+    RUN_TEST(test_pages_decode_independently);
+    RUN_TEST(test_append_refuses_when_full_and_page_is_unchanged);
+    RUN_TEST(test_malformed_pages_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+#include "unity.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "data_handling/DataPoint.h"
+#include "state_estimation/GyroPreIntegrator.h"
+#include "state_estimation/OrientationEstimator.h"
+#include "state_estimation/StateEstimationTypes.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kRadToDeg = 57.29577951308232;
+
+struct QuatD {
+    double w, x, y, z;
+};
+
+QuatD multiply(const QuatD& a, const QuatD& b) {
+    return {a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+// Classic coning motion: the body z axis sweeps a cone of half-angle kConeAngle at kConeRate
+constexpr double kConeAngle_rad = 0.1;
+constexpr double kConeRate_radps = 2.0 * kPi * 10.0;
+
+void coningRate(double t, double& wx, double& wy, double& wz) {
+    const double s = std::sin(kConeAngle_rad);
+    const double c = std::cos(kConeAngle_rad);
+    wx = -kConeRate_radps * s * std::sin(kConeRate_radps * t);
+    wy = kConeRate_radps * s * std::cos(kConeRate_radps * t);
+    wz = kConeRate_radps * (1.0 - c);
+}
+
+// Fine-step reference attitude for the coning motion
+QuatD coningReference(double duration_s) {
+    QuatD q = {1.0, 0.0, 0.0, 0.0};
+    const double h = 1e-6;
+    const auto steps = static_cast<uint32_t>(duration_s / h);
+    for (uint32_t i = 0; i < steps; ++i) {
+        double wx = 0.0, wy = 0.0, wz = 0.0;
+        coningRate((static_cast<double>(i) + 0.5) * h, wx, wy, wz);
+        const double angle = std::sqrt(wx * wx + wy * wy + wz * wz) * h;
+        const double s = (angle > 0.0) ? std::sin(0.5 * angle) / angle * h : 0.0;
+        q = multiply(q, {std::cos(0.5 * angle), wx * s, wy * s, wz * s});
+    }
+    return q;
+}
+
+GyroTriplet gyroAt(uint32_t ts, float x, float y, float z) {
+    return {DataPoint(ts, x), DataPoint(ts, y), DataPoint(ts, z)};
+}
+
+double errorDeg(const Quaternion& q, const QuatD& ref) {
+    const double dot = std::fabs(static_cast<double>(q.w) * ref.w + static_cast<double>(q.x) * ref.x +
+                                 static_cast<double>(q.y) * ref.y + static_cast<double>(q.z) * ref.z);
+    return 2.0 * std::acos(dot > 1.0 ? 1.0 : dot) * kRadToDeg;
+}
+
+const AccelerationTriplet kNoAccel = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+const MagTriplet kNoMag = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_constant_rate_accumulates_delta_angle(void) {
+    GyroPreIntegrator integrator;
+    for (uint32_t t = 0; t <= 100; ++t) {
+        integrator.addSample(gyroAt(t, 0.0f, 0.0f, 10.0f));
+    }
+    TEST_ASSERT_EQUAL_UINT16(100, integrator.getSampleCount());
+
+    const RotationDelta delta = integrator.consume();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, delta.z);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, delta.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, delta.y);
+    TEST_ASSERT_EQUAL_UINT32(0, delta.startTime_ms);
+    TEST_ASSERT_EQUAL_UINT32(100, delta.endTime_ms);
+    TEST_ASSERT_EQUAL_UINT16(100, delta.sampleCount);
+}
+
+void test_consume_starts_new_interval(void) {
+    GyroPreIntegrator integrator;
+    integrator.addSample(gyroAt(0, 1.0f, 0.0f, 0.0f));
+    integrator.addSample(gyroAt(10, 1.0f, 0.0f, 0.0f));
+    (void)integrator.consume();
+
+    const RotationDelta empty = integrator.consume();
+    TEST_ASSERT_EQUAL_UINT16(0, empty.sampleCount);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9f, 0.0f, empty.x);
+
+    integrator.addSample(gyroAt(20, 1.0f, 0.0f, 0.0f));
+    const RotationDelta next = integrator.consume();
+    TEST_ASSERT_EQUAL_UINT32(10, next.startTime_ms);
+    TEST_ASSERT_EQUAL_UINT32(20, next.endTime_ms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.01f, next.x);
+
+    // Stale or repeated timestamps are ignored
+    integrator.addSample(gyroAt(20, 5.0f, 0.0f, 0.0f));
+    integrator.addSample(gyroAt(15, 5.0f, 0.0f, 0.0f));
+    TEST_ASSERT_EQUAL_UINT16(0, integrator.getSampleCount());
+}
+
+void test_pre_integrated_coning_beats_decimated_gyro(void) {
+    // 1 kHz IMU, orientation updated at 50 Hz, 2 s of coning
+    const uint32_t duration_ms = 2000;
+    const uint32_t orientationPeriod_ms = 20;
+
+    GyroPreIntegrator integrator;
+    OrientationEstimator preIntegrated;
+    OrientationEstimator decimated;
+    preIntegrated.launchDetected();
+    decimated.launchDetected();
+
+    for (uint32_t t = 0; t <= duration_ms; ++t) {
+        double wx = 0.0, wy = 0.0, wz = 0.0;
+        coningRate(static_cast<double>(t) / 1000.0, wx, wy, wz);
+        const GyroTriplet gyro = gyroAt(t, static_cast<float>(wx), static_cast<float>(wy), static_cast<float>(wz));
+        integrator.addSample(gyro);
+        if (t == 0) {
+            decimated.update(kNoAccel, gyroAt(0, 0.0f, 0.0f, 0.0f), kNoMag, 0);
+        } else if (t % orientationPeriod_ms == 0) {
+            preIntegrated.update(kNoAccel, integrator.consume(), kNoMag);
+            decimated.update(kNoAccel, gyro, kNoMag, t);
+        }
+    }
+
+    const QuatD reference = coningReference(static_cast<double>(duration_ms) / 1000.0);
+    const double preIntegratedError = errorDeg(preIntegrated.getQuaternion(), reference);
+    const double decimatedError = errorDeg(decimated.getQuaternion(), reference);
+    printf("coning error after 2 s: pre-integrated %.6f deg, decimated gyro %.4f deg\n", preIntegratedError,
+           decimatedError);
+
+    TEST_ASSERT_TRUE(preIntegratedError < 0.1);
+    TEST_ASSERT_TRUE(preIntegratedError < decimatedError);
+}
+
+void test_pad_update_uses_mean_rate(void) {
+    GyroPreIntegrator integrator;
+    OrientationEstimator fromDelta;
+    OrientationEstimator fromRate;
+
+    for (uint32_t t = 0; t <= 20; ++t) {
+        integrator.addSample(gyroAt(t, 0.5f, 0.0f, 0.0f));
+    }
+    const AccelerationTriplet gravity = {DataPoint(20, 0.5f), DataPoint(20, 1.0f), DataPoint(20, 9.7f)};
+    fromRate.update(gravity, gyroAt(0, 0.0f, 0.0f, 0.0f), kNoMag, 0);
+    fromRate.update(gravity, gyroAt(20, 0.5f, 0.0f, 0.0f), kNoMag, 20);
+    fromDelta.update(gravity, integrator.consume(), kNoMag);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, fromRate.getQuaternion().x, fromDelta.getQuaternion().x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, fromRate.getQuaternion().w, fromDelta.getQuaternion().w);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_constant_rate_accumulates_delta_angle);
+    RUN_TEST(test_consume_starts_new_interval);
+    RUN_TEST(test_pre_integrated_coning_beats_decimated_gyro);
+    RUN_TEST(test_pad_update_uses_mean_rate);
+    return UNITY_END();
+}
@@ -0,0 +1,287 @@
+#include "unity.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ArduinoHAL.h"
+#include "DataSaver_mock.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "data_handling/DataVector.h"
+#include "data_handling/MultiDataSaver.h"
+#include "data_handling/SensorDataHandler.h"
+
+namespace {
+
+// Records every call in a shared log so tests can check the order sinks are called in
+class OrderedSaver : public DataSaverMock {
+public:
+    OrderedSaver(std::vector<int>& log, int id) : log_(log), id_(id) {}
+
+    int saveDataPoint(const DataPoint& dp, uint8_t name) override {
+        log_.push_back(id_);
+        if (delay_us > 0U) {
+            std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+        }
+        DataSaverMock::saveDataPoint(dp, name);
+        return result;
+    }
+
+    int saveDataPoints(const NamedDataPoint* points, size_t count) override {
+        batchSizes.push_back(count);
+        return IDataSaver::saveDataPoints(points, count);
+    }
+
+    int saveDataVector(const DataVector& vector, uint8_t name) override {
+        vectors.emplace_back(vector, name);
+        return result;
+    }
+
+    bool begin() override {
+        begun = true;
+        return beginResult;
+    }
+
+    void launchDetected(uint32_t launchTimestamp_ms) override { launch_ms = launchTimestamp_ms; }
+
+    int result = 0;
+    uint32_t delay_us = 0;
+    bool begun = false;
+    bool beginResult = true;
+    uint32_t launch_ms = 0;
+    std::vector<size_t> batchSizes;
+    std::vector<std::pair<DataVector, uint8_t>> vectors;
+
+private:
+    std::vector<int>& log_;
+    int id_;
+};
+
+} // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_sinks_are_called_in_priority_order(void) {
+    std::vector<int> log;
+    OrderedSaver debug(log, 0);
+    OrderedSaver sd(log, 1);
+    OrderedSaver flash(log, 2);
+    MultiDataSaver multi;
+    TEST_ASSERT_EQUAL(0, multi.addSink(&debug));
+    TEST_ASSERT_EQUAL(1, multi.addSink(&sd, 5));
+    TEST_ASSERT_EQUAL(2, multi.addSink(&flash, 10));
+
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoint(DataPoint(100U, 1.0F), ALTITUDE));
+    TEST_ASSERT_EQUAL(3U, log.size());
+    TEST_ASSERT_EQUAL(2, log[0]);
+    TEST_ASSERT_EQUAL(1, log[1]);
+    TEST_ASSERT_EQUAL(0, log[2]);
+    flash.assertSaveDataPointCalledWith(DataPoint(100U, 1.0F), ALTITUDE);
+
+    TEST_ASSERT_TRUE(multi.begin());
+    TEST_ASSERT_TRUE(debug.begun && sd.begun && flash.begun);
+    sd.beginResult = false;
+    TEST_ASSERT_FALSE(multi.begin());
+    multi.launchDetected(1234U);
+    TEST_ASSERT_EQUAL_UINT32(1234U, debug.launch_ms);
+    TEST_ASSERT_EQUAL_UINT32(1234U, flash.launch_ms);
+
+    OrderedSaver extra(log, 3);
+    TEST_ASSERT_EQUAL(3, multi.addSink(&extra));
+    TEST_ASSERT_EQUAL(-1, multi.addSink(&extra));
+    TEST_ASSERT_EQUAL(-1, multi.addSink(nullptr));
+}
+
+void test_flash_keeps_everything_while_sd_is_decimated(void) {
+    std::vector<int> log;
+    OrderedSaver flash(log, 0);
+    OrderedSaver sd(log, 1);
+    MultiDataSaver multi;
+    const int flashSink = multi.addSink(&flash, 10);
+    const int sdSink = multi.addSink(&sd);
+    multi.setRateLimit(sdSink, 100U);
+    multi.setChannelEnabled(sdSink, ACCELEROMETER_X, false);
+
+    // Two channels at 100 Hz for one second, through one handler each
+    SensorDataHandler altitude(ALTITUDE, &multi);
+    SensorDataHandler accel(ACCELEROMETER_X, &multi);
+    for (uint32_t t = 0; t < 1000U; t += 10U) {
+        altitude.addData(DataPoint(t, 1.0F));
+        accel.addData(DataPoint(t, 2.0F));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(200U, multi.getStats(flashSink).saved);
+    TEST_ASSERT_EQUAL_UINT32(200U, flash.saveDataPointCalls.size());
+    // SD gets altitude at 10 Hz, starting with the first point, and no accelerometer
+    TEST_ASSERT_EQUAL_UINT32(10U, sd.saveDataPointCalls.size());
+    TEST_ASSERT_EQUAL_UINT32(0U, sd.saveDataPointCalls[0].first.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32(100U, sd.saveDataPointCalls[1].first.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32(100U, multi.getStats(sdSink).filtered);
+    TEST_ASSERT_EQUAL_UINT32(90U, multi.getStats(sdSink).rateLimited);
+
+    // Only the filtered channel again
+    multi.setAllChannelsEnabled(sdSink, false);
+    multi.setChannelEnabled(sdSink, ACCELEROMETER_X, true);
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoint(DataPoint(2000U, 3.0F), ACCELEROMETER_X));
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoint(DataPoint(2000U, 3.0F), ALTITUDE));
+    TEST_ASSERT_EQUAL_UINT32(11U, sd.saveDataPointCalls.size());
+    TEST_ASSERT_EQUAL_UINT8(ACCELEROMETER_X, sd.saveDataPointCalls.back().second);
+}
+
+void test_failing_sink_does_not_stop_the_others(void) {
+    std::vector<int> log;
+    OrderedSaver broken(log, 0);
+    OrderedSaver healthy(log, 1);
+    broken.result = -1;
+    MultiDataSaver multi;
+    const int brokenSink = multi.addSink(&broken, 10);
+    const int healthySink = multi.addSink(&healthy);
+
+    for (uint32_t i = 0; i < 5U; i++) {
+        TEST_ASSERT_EQUAL(-1, multi.saveDataPoint(DataPoint(i, 0.0F), ALTITUDE));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5U, multi.getStats(brokenSink).failed);
+    TEST_ASSERT_EQUAL_UINT32(5U, multi.getStats(healthySink).saved);
+    TEST_ASSERT_EQUAL_UINT32(5U, healthy.saveDataPointCalls.size());
+}
+
+void test_stalled_sink_is_backed_off(void) {
+    std::vector<int> log;
+    OrderedSaver flash(log, 0);
+    OrderedSaver sd(log, 1);
+    MultiDataSaver multi;
+    const int flashSink = multi.addSink(&flash, 10);
+    const int sdSink = multi.addSink(&sd);
+    multi.setStallLimit(sdSink, 1000U, 50U);
+
+    // One 5 ms stall, then the card is fast again
+    sd.delay_us = 5000U;
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoint(DataPoint(0U, 0.0F), ALTITUDE));
+    sd.delay_us = 0U;
+    TEST_ASSERT_EQUAL_UINT32(1U, multi.getStats(sdSink).stalls);
+    TEST_ASSERT_TRUE(multi.getStats(sdSink).worstSave_us >= 5000U);
+
+    for (uint32_t i = 1; i < 20U; i++) {
+        TEST_ASSERT_EQUAL(0, multi.saveDataPoint(DataPoint(i, 0.0F), ALTITUDE));
+    }
+    TEST_ASSERT_EQUAL_UINT32(19U, multi.getStats(sdSink).stallSkipped);
+    TEST_ASSERT_EQUAL_UINT32(20U, multi.getStats(flashSink).saved);
+
+    // After the back-off the sink gets points again
+    delay(60U);
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoint(DataPoint(100U, 0.0F), ALTITUDE));
+    TEST_ASSERT_EQUAL_UINT32(2U, multi.getStats(sdSink).saved);
+}
+
+void test_batches_reach_each_sink_in_one_call(void) {
+    std::vector<int> log;
+    OrderedSaver flash(log, 0);
+    OrderedSaver sd(log, 1);
+    MultiDataSaver multi;
+    const int flashSink = multi.addSink(&flash, 10);
+    const int sdSink = multi.addSink(&sd);
+    multi.setRateLimit(sdSink, 100U);
+    multi.setChannelEnabled(sdSink, ACCELEROMETER_X, false);
+
+    // 100 Hz altitude and accelerometer for 100 ms, in one batch
+    NamedDataPoint batch[20];
+    for (uint32_t i = 0; i < 20U; i++) {
+        batch[i] = NamedDataPoint{static_cast<uint8_t>((i % 2U == 0U) ? ALTITUDE : ACCELEROMETER_X), DataPoint((i / 2U) * 10U, 1.0F)};
+    }
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoints(batch, 20U));
+
+    TEST_ASSERT_EQUAL(1U, flash.batchSizes.size());
+    TEST_ASSERT_EQUAL(20U, flash.batchSizes[0]);
+    TEST_ASSERT_EQUAL_UINT32(20U, multi.getStats(flashSink).saved);
+    // SD takes only the first altitude point; the rate limit counts points staged in the same batch
+    TEST_ASSERT_EQUAL(1U, sd.batchSizes.size());
+    TEST_ASSERT_EQUAL(1U, sd.batchSizes[0]);
+    sd.assertSaveDataPointCalledWith(DataPoint(0U, 1.0F), ALTITUDE);
+    TEST_ASSERT_EQUAL_UINT32(10U, multi.getStats(sdSink).filtered);
+    TEST_ASSERT_EQUAL_UINT32(9U, multi.getStats(sdSink).rateLimited);
+
+    // Larger batches are split into kMaxBatch points per call
+    NamedDataPoint large[MultiDataSaver::kMaxBatch + 5U];
+    for (NamedDataPoint& point : large) {
+        point = NamedDataPoint{PRESSURE, DataPoint(1000U, 2.0F)};
+    }
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoints(large, MultiDataSaver::kMaxBatch + 5U));
+    TEST_ASSERT_EQUAL(3U, flash.batchSizes.size());
+    TEST_ASSERT_EQUAL(5U, flash.batchSizes[2]);
+}
+
+void test_failed_batch_does_not_start_the_rate_limit(void) {
+    std::vector<int> log;
+    OrderedSaver sd(log, 0);
+    MultiDataSaver multi;
+    const int sdSink = multi.addSink(&sd);
+    multi.setRateLimit(sdSink, 100U);
+
+    NamedDataPoint batch[2] = {NamedDataPoint{ALTITUDE, DataPoint(0U, 1.0F)},
+                               NamedDataPoint{ALTITUDE, DataPoint(50U, 2.0F)}};
+    sd.result = -1;
+    TEST_ASSERT_EQUAL(-1, multi.saveDataPoints(batch, 2U));
+    TEST_ASSERT_EQUAL_UINT32(1U, multi.getStats(sdSink).failed);
+    TEST_ASSERT_EQUAL_UINT32(1U, multi.getStats(sdSink).rateLimited);
+
+    // Nothing was stored, so the next point is not rate limited, as with saveDataPoint()
+    sd.result = 0;
+    NamedDataPoint retry = {ALTITUDE, DataPoint(60U, 3.0F)};
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoints(&retry, 1U));
+    TEST_ASSERT_EQUAL_UINT32(1U, multi.getStats(sdSink).saved);
+    TEST_ASSERT_EQUAL_UINT32(1U, multi.getStats(sdSink).rateLimited);
+    sd.assertSaveDataPointCalledWith(DataPoint(60U, 3.0F), ALTITUDE);
+
+    // A successful batch does start it
+    NamedDataPoint soon = {ALTITUDE, DataPoint(100U, 4.0F)};
+    TEST_ASSERT_EQUAL(0, multi.saveDataPoints(&soon, 1U));
+    TEST_ASSERT_EQUAL_UINT32(2U, multi.getStats(sdSink).rateLimited);
+}
+
+void test_vectors_reach_each_sink_whole(void) {
+    std::vector<int> log;
+    OrderedSaver flash(log, 0);
+    OrderedSaver sd(log, 1);
+    MultiDataSaver multi;
+    const int flashSink = multi.addSink(&flash, 10);
+    const int sdSink = multi.addSink(&sd);
+    multi.setRateLimit(sdSink, 100U);
+
+    // A 100 Hz accelerometer through one handler
+    SensorDataHandler accel(ACCELEROMETER_X, &multi);
+    for (uint32_t t = 0; t < 1000U; t += 10U) {
+        accel.addData(DataVector(t, 1.0F, 2.0F, 3.0F));
+    }
+
+    TEST_ASSERT_EQUAL(100U, flash.vectors.size());
+    TEST_ASSERT_EQUAL(0U, flash.saveDataPointCalls.size());
+    TEST_ASSERT_EQUAL_UINT8(ACCELEROMETER_X, flash.vectors[0].second);
+    TEST_ASSERT_EQUAL_UINT8(3U, flash.vectors[0].first.size);
+    TEST_ASSERT_EQUAL_UINT32(100U, multi.getStats(flashSink).saved);
+    // The SD rate limit applies per label, to whole vectors
+    TEST_ASSERT_EQUAL(10U, sd.vectors.size());
+    TEST_ASSERT_EQUAL_UINT32(100U, sd.vectors[1].first.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32(90U, multi.getStats(sdSink).rateLimited);
+
+    multi.setChannelEnabled(sdSink, ACCELEROMETER_X, false);
+    TEST_ASSERT_EQUAL(0, multi.saveDataVector(DataVector(5000U, 0.0F, 0.0F, 0.0F), ACCELEROMETER_X));
+    TEST_ASSERT_EQUAL(10U, sd.vectors.size());
+    TEST_ASSERT_EQUAL(101U, flash.vectors.size());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sinks_are_called_in_priority_order);
+    RUN_TEST(test_flash_keeps_everything_while_sd_is_decimated);
+    RUN_TEST(test_failing_sink_does_not_stop_the_others);
+    RUN_TEST(test_stalled_sink_is_backed_off);
+    RUN_TEST(test_batches_reach_each_sink_in_one_call);
+    RUN_TEST(test_failed_batch_does_not_start_the_rate_limit);
+    RUN_TEST(test_vectors_reach_each_sink_whole);
+    return UNITY_END();
+}
@@ -73,8 +73,67 @@ void test_orientation_estimator_with_real_data(void) {
     }
 }
 
+void test_euler_angles_follow_quaternion_after_update(void) {
+    OrientationEstimator estimator;
+    estimator.launchDetected();
+
+    const AccelerationTriplet accel = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+    const MagTriplet mag = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+    const GyroTriplet rollRate = {DataPoint(0, 1.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, estimator.getRoll());
+
+    // 1 rad/s about x for 0.5 s in 10 ms steps
+    for (uint32_t t = 10; t <= 500; t += 10) {
+        estimator.update(accel, rollRate, mag, t);
+    }
+
+    const Quaternion q = estimator.getQuaternion();
+    const float expectedRoll = 2.0f * std::atan2(q.x, q.w) * 57.29578f;
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 28.65f, estimator.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, expectedRoll, estimator.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, estimator.getPitch());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, estimator.getYaw());
+
+    // Cached value is refreshed once the quaternion changes again
+    const float firstRoll = estimator.getRoll();
+    estimator.update(accel, rollRate, mag, 510);
+    TEST_ASSERT_TRUE(estimator.getRoll() > firstRoll);
+}
+
+void test_exponential_integrator_is_exact_for_constant_spin(void) {
+    OrientationEstimator exact;
+    OrientationEstimator firstOrder(0.05f, 0.005f, GyroIntegrator::FirstOrder);
+    exact.launchDetected();
+    firstOrder.launchDetected();
+
+    const AccelerationTriplet accel = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+    const MagTriplet mag = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+    const float rate_radps = 20.0f; // ~3 rev/s roll
+    const GyroTriplet spin = {DataPoint(0, rate_radps), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+
+    // 1 s of flight at a decimated 50 Hz
+    for (uint32_t t = 20; t <= 1000; t += 20) {
+        exact.update(accel, spin, mag, t);
+        firstOrder.update(accel, spin, mag, t);
+    }
+
+    // Expected: q = [cos(10), sin(10), 0, 0]
+    const float halfAngle = 0.5f * rate_radps * 1.0f;
+    const Quaternion q = exact.getQuaternion();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, std::cos(halfAngle), q.w);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, std::sin(halfAngle), q.x);
+
+    const Quaternion qf = firstOrder.getQuaternion();
+    const float exactError = std::fabs(q.w * std::cos(halfAngle) + q.x * std::sin(halfAngle));
+    const float firstOrderError = std::fabs(qf.w * std::cos(halfAngle) + qf.x * std::sin(halfAngle));
+    TEST_ASSERT_TRUE(exactError > firstOrderError);
+}
+
 int main() {
     UNITY_BEGIN();
+    RUN_TEST(test_exponential_integrator_is_exact_for_constant_spin);
+    RUN_TEST(test_euler_angles_follow_quaternion_after_update);
     RUN_TEST(test_orientation_estimator_with_real_data);
     return UNITY_END();
 }
@@ -0,0 +1,254 @@
+#include "unity.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data_handling/DataPoint.h"
+#include "state_estimation/OrientationEstimator.h"
+#include "state_estimation/StateEstimationTypes.h"
+
+// Orientation drift versus CPU cost for the in-flight (pure gyro) integrators.
+//
+// Each gyro trace is integrated once with a fine-step double precision reference
+// (rates linearly interpolated between samples). OrientationEstimator is then run
+// in flight mode on every k-th sample with each GyroIntegrator, and the attitude
+// error against the reference is reported together with the CPU time spent in
+// update() per second of flight. Results are written to
+// orientation_integration_benchmark.csv.
+
+namespace {
+
+struct GyroSample {
+    uint32_t ts;
+    double x;
+    double y;
+    double z;
+};
+
+struct Trace {
+    std::string name;
+    std::vector<GyroSample> samples;
+};
+
+struct QuaternionD {
+    double w;
+    double x;
+    double y;
+    double z;
+};
+
+const char* const kFlightFiles[] = {
+    "data/MARTHA_3-8_1.3_B2_SingleID_transformed.csv",
+    "data/MARTHA_IREC_2025_B2_transformed.csv",
+    "data/AA Data Collection - Second Launch Trimmed.csv",
+};
+
+const std::array<uint32_t, 4> kDecimations = {{1, 2, 4, 8}};
+constexpr double kReferenceStep_ms = 0.1;
+constexpr double kRadToDeg = 57.29577951308232;
+constexpr double kPi = 3.14159265358979323846;
+
+struct Method {
+    const char* name;
+    GyroIntegrator integrator;
+};
+const std::array<Method, 2> kMethods = {{
+    {"exponential", GyroIntegrator::Exponential},
+    {"first_order", GyroIntegrator::FirstOrder},
+}};
+
+struct Result {
+    double finalDrift_deg;
+    double maxDrift_deg;
+    double cpu_us_per_flight_s;
+    double rate_hz;
+};
+
+bool loadTrace(const char* filename, Trace& trace) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    trace.name = filename;
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string token;
+        std::vector<std::string> tokens;
+        while (std::getline(ss, token, ',')) tokens.push_back(token);
+        if (tokens.size() < 7) continue;
+        try {
+            const auto ts = static_cast<uint32_t>(std::stoul(tokens[0]));
+            if (!trace.samples.empty() && ts <= trace.samples.back().ts) continue;
+            trace.samples.push_back({ts, std::stod(tokens[4]), std::stod(tokens[5]), std::stod(tokens[6])});
+        } catch (...) {
+            continue;
+        }
+    }
+    return trace.samples.size() > 1;
+}
+
+// 1 kHz IMU: 20 rad/s roll with a 2 Hz coning wobble on the other two axes
+Trace syntheticSpin() {
+    Trace trace;
+    trace.name = "synthetic 20 rad/s roll + coning";
+    for (uint32_t ts = 0; ts <= 10000; ++ts) {
+        const double t = static_cast<double>(ts) / 1000.0;
+        const double phase = 2.0 * kPi * 2.0 * t;
+        trace.samples.push_back({ts, 20.0, 2.0 * std::sin(phase), 2.0 * std::cos(phase)});
+    }
+    return trace;
+}
+
+QuaternionD multiply(const QuaternionD& a, const QuaternionD& b) {
+    return {a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+QuaternionD rotate(const QuaternionD& q, double rx, double ry, double rz) {
+    const double angle = std::sqrt(rx * rx + ry * ry + rz * rz);
+    if (angle <= 0.0) return q;
+    const double s = std::sin(0.5 * angle) / angle;
+    return multiply(q, {std::cos(0.5 * angle), rx * s, ry * s, rz * s});
+}
+
+// Reference attitude at every sample timestamp
+std::vector<QuaternionD> integrateReference(const Trace& trace) {
+    std::vector<QuaternionD> out;
+    out.reserve(trace.samples.size());
+    QuaternionD q = {1.0, 0.0, 0.0, 0.0};
+    out.push_back(q);
+    for (size_t i = 1; i < trace.samples.size(); ++i) {
+        const GyroSample& a = trace.samples[i - 1];
+        const GyroSample& b = trace.samples[i];
+        const double span_ms = static_cast<double>(b.ts - a.ts);
+        const auto steps = static_cast<size_t>(std::ceil(span_ms / kReferenceStep_ms));
+        const double h_s = span_ms / static_cast<double>(steps) / 1000.0;
+        for (size_t k = 0; k < steps; ++k) {
+            const double f = (static_cast<double>(k) + 0.5) / static_cast<double>(steps);
+            q = rotate(q, (a.x + f * (b.x - a.x)) * h_s, (a.y + f * (b.y - a.y)) * h_s,
+                       (a.z + f * (b.z - a.z)) * h_s);
+        }
+        out.push_back(q);
+    }
+    return out;
+}
+
+double angleBetween_deg(const Quaternion& q, const QuaternionD& ref) {
+    const double dot = std::fabs(static_cast<double>(q.w) * ref.w + static_cast<double>(q.x) * ref.x +
+                                 static_cast<double>(q.y) * ref.y + static_cast<double>(q.z) * ref.z);
+    return 2.0 * std::acos(std::min(1.0, dot)) * kRadToDeg;
+}
+
+Result runTrace(const Trace& trace, const std::vector<QuaternionD>& reference, GyroIntegrator integrator,
+                uint32_t decimation) {
+    OrientationEstimator estimator(0.05f, 0.005f, integrator);
+    estimator.launchDetected();
+
+    const AccelerationTriplet accel = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+    const MagTriplet mag = {DataPoint(0, 0.0f), DataPoint(0, 0.0f), DataPoint(0, 0.0f)};
+
+    // Seed the estimator's clock with the first sample so the first dt is sane
+    const GyroSample& first = trace.samples.front();
+    const GyroTriplet still = {DataPoint(first.ts, 0.0f), DataPoint(first.ts, 0.0f), DataPoint(first.ts, 0.0f)};
+    estimator.update(accel, still, mag, first.ts);
+
+    Result result = {0.0, 0.0, 0.0, 0.0};
+    double cpu_ns = 0.0;
+    size_t updates = 0;
+    size_t lastIndex = 0;
+    for (size_t i = decimation; i < trace.samples.size(); i += decimation) {
+        const GyroSample& s = trace.samples[i];
+        const GyroTriplet gyro = {DataPoint(s.ts, static_cast<float>(s.x)), DataPoint(s.ts, static_cast<float>(s.y)),
+                                  DataPoint(s.ts, static_cast<float>(s.z))};
+
+        const auto start = std::chrono::steady_clock::now();
+        estimator.update(accel, gyro, mag, s.ts);
+        const auto stop = std::chrono::steady_clock::now();
+        cpu_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        ++updates;
+        lastIndex = i;
+
+        const double drift = angleBetween_deg(estimator.getQuaternion(), reference[i]);
+        result.maxDrift_deg = std::max(result.maxDrift_deg, drift);
+        result.finalDrift_deg = drift;
+    }
+
+    const double duration_s = static_cast<double>(trace.samples[lastIndex].ts - first.ts) / 1000.0;
+    if (duration_s > 0.0) {
+        result.cpu_us_per_flight_s = cpu_ns / 1000.0 / duration_s;
+        result.rate_hz = static_cast<double>(updates) / duration_s;
+    }
+    return result;
+}
+
+}  // namespace
+
+/* ---------- Unity fixtures ---------- */
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_gyro_integration_drift_vs_cpu(void) {
+    std::vector<Trace> traces;
+    traces.push_back(syntheticSpin());
+    for (const char* filename : kFlightFiles) {
+        Trace trace;
+        if (loadTrace(filename, trace)) {
+            traces.push_back(trace);
+        } else {
+            printf("Skipping missing CSV: %s\n", filename);
+        }
+    }
+
+    std::ofstream csv("orientation_integration_benchmark.csv");
+    TEST_ASSERT_TRUE_MESSAGE(csv.is_open(), "Failed to open CSV file for writing");
+    csv << "trace,integrator,decimation,rate_hz,final_drift_deg,max_drift_deg,cpu_us_per_flight_s\n";
+
+    printf("\n===== GYRO INTEGRATION DRIFT VS CPU =====\n");
+    printf("%-52s %-12s %4s %8s %12s %12s %14s\n", "trace", "integrator", "dec", "rate Hz", "final [deg]",
+           "max [deg]", "us/flight-s");
+
+    // [method][decimation] for the synthetic trace
+    std::array<std::array<Result, kDecimations.size()>, kMethods.size()> spin{};
+    for (size_t t = 0; t < traces.size(); ++t) {
+        const std::vector<QuaternionD> reference = integrateReference(traces[t]);
+        for (size_t m = 0; m < kMethods.size(); ++m) {
+            for (size_t d = 0; d < kDecimations.size(); ++d) {
+                const Result r = runTrace(traces[t], reference, kMethods[m].integrator, kDecimations[d]);
+                if (t == 0) spin[m][d] = r;
+                printf("%-52s %-12s %4u %8.1f %12.4f %12.4f %14.1f\n", traces[t].name.c_str(), kMethods[m].name,
+                       kDecimations[d], r.rate_hz, r.finalDrift_deg, r.maxDrift_deg, r.cpu_us_per_flight_s);
+                csv << '"' << traces[t].name << "\"," << kMethods[m].name << ',' << kDecimations[d] << ','
+                    << r.rate_hz << ',' << r.finalDrift_deg << ',' << r.maxDrift_deg << ','
+                    << r.cpu_us_per_flight_s << '\n';
+            }
+        }
+    }
+    csv.close();
+
+    // At high spin the exponential integrator at half rate must beat first order at full rate.
+    // The remaining error at higher decimation comes from the skipped samples, not the integrator.
+    TEST_ASSERT_TRUE(spin[0][1].maxDrift_deg < spin[1][0].maxDrift_deg);
+    for (size_t d = 0; d < kDecimations.size(); ++d) {
+        TEST_ASSERT_TRUE(spin[0][d].maxDrift_deg <= spin[1][d].maxDrift_deg);
+    }
+}
+
+/* ---------- main runner ----------------------- */
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_gyro_integration_drift_vs_cpu);
+    return UNITY_END();
+}
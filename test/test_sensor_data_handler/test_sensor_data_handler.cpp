@@ -2,6 +2,7 @@
 #include "data_handling/SensorDataHandler.h"
 #include "data_handling/DataPoint.h"
 #include "data_handling/DataSaver.h"
+#include "data_handling/DataNames.h"
 #include "ArduinoHAL.h"  // Optional: Needed if SensorDataHandler or DataSaver use Arduino specific API
 
 #include <vector>
@@ -170,6 +171,110 @@ void test_long_delay_resets_save_timer(void) {
     TEST_ASSERT_EQUAL_UINT32(2, mockSaver.savedRecords.size());
 }
 
+/**
+ * Test that a vector shares the rate limit and is saved one channel per component.
+ */
+void test_addData_vector_saves_each_component(void) {
+    MockDataSaver mockSaver;
+    uint8_t sensorName = 5;
+    SensorDataHandler sdh(sensorName, &mockSaver);
+    sdh.restrictSaveSpeed(50);
+
+    sdh.addData(DataVector(1000, 1.0f, 2.0f, 3.0f));
+    TEST_ASSERT_EQUAL_UINT32(3, mockSaver.savedRecords.size());
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT8(sensorName + i, mockSaver.savedRecords[i].sensorName);
+        TEST_ASSERT_EQUAL_UINT32(1000, mockSaver.savedRecords[i].data.timestamp_ms);
+        TEST_ASSERT_EQUAL_FLOAT(1.0f + i, mockSaver.savedRecords[i].data.data);
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, sdh.getLastDataVectorSaved().size);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, sdh.getLastDataPointSaved().data);
+
+    // Too soon: nothing is saved and the last saved vector is kept
+    sdh.addData(DataVector(1020, 4.0f, 5.0f, 6.0f));
+    TEST_ASSERT_EQUAL_UINT32(3, mockSaver.savedRecords.size());
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, sdh.getLastDataVectorSaved().data[2]);
+
+    sdh.addData(DataVector(1051, 4.0f, 5.0f, 6.0f));
+    TEST_ASSERT_EQUAL_UINT32(6, mockSaver.savedRecords.size());
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, sdh.getLastDataVectorSaved().data[2]);
+}
+
+/**
+ * Test that the average mode saves the mean of every sample in the interval.
+ */
+void test_average_decimation_saves_interval_mean(void) {
+    MockDataSaver mockSaver;
+    uint8_t sensorName = 6;
+    SensorDataHandler sdh(sensorName, &mockSaver);
+    sdh.restrictSaveSpeed(100);
+    sdh.setDecimation(DecimationMode::kAverage);
+
+    // A 1 kHz ramp on a large offset, with a 500 Hz wobble that dropping samples would alias
+    for (uint32_t t = 0; t <= 300; t++) {
+        const float wobble = (t % 2 == 0) ? 0.5f : -0.5f;
+        sdh.addData(makeData(t, 101325.0f + static_cast<float>(t) * 0.01f + wobble));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, mockSaver.savedRecords.size());
+    // Samples 0..100 (51 high, 50 low), then 101..200 and 201..300 (50 of each)
+    TEST_ASSERT_EQUAL_UINT32(100, mockSaver.savedRecords[0].data.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 101325.5f + 0.5f / 101.0f, mockSaver.savedRecords[0].data.data);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 101326.505f, mockSaver.savedRecords[1].data.data);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 101327.505f, mockSaver.savedRecords[2].data.data);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 101327.505f, sdh.getLastDataPointSaved().data);
+
+    // Vectors are averaged per component
+    SensorDataHandler accel(ACCELEROMETER_X, &mockSaver);
+    accel.restrictSaveSpeed(10);
+    accel.setDecimation(DecimationMode::kAverage);
+    for (uint32_t t = 1; t <= 10; t++) {
+        accel.addData(DataVector(t, static_cast<float>(t), -static_cast<float>(t), 9.8f));
+    }
+    const DataVector& saved = accel.getLastDataVectorSaved();
+    TEST_ASSERT_EQUAL_UINT32(10, saved.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.5f, saved.data[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -5.5f, saved.data[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 9.8f, saved.data[2]);
+}
+
+/**
+ * Test that the min/max mode saves both extremes of the interval in time order.
+ */
+void test_min_max_decimation_saves_envelope(void) {
+    MockDataSaver mockSaver;
+    uint8_t sensorName = 7;
+    SensorDataHandler sdh(sensorName, &mockSaver);
+    sdh.restrictSaveSpeed(100);
+    sdh.setDecimation(DecimationMode::kMinMax);
+
+    // A one-sample spike the drop mode would miss, then a falling ramp
+    for (uint32_t t = 0; t <= 100; t++) {
+        sdh.addData(makeData(t, t == 37 ? 50.0f : 1.0f));
+    }
+    // Telemetry sees the sample that ended the interval, not the extreme saved last
+    TEST_ASSERT_EQUAL_UINT32(100, sdh.getLastDataPointSaved().timestamp_ms);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, sdh.getLastDataPointSaved().data);
+    for (uint32_t t = 101; t <= 200; t++) {
+        sdh.addData(makeData(t, 300.0f - static_cast<float>(t)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, mockSaver.savedRecords.size());
+    TEST_ASSERT_EQUAL_UINT32(0, mockSaver.savedRecords[0].data.timestamp_ms);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, mockSaver.savedRecords[0].data.data);
+    TEST_ASSERT_EQUAL_UINT32(37, mockSaver.savedRecords[1].data.timestamp_ms);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, mockSaver.savedRecords[1].data.data);
+    TEST_ASSERT_EQUAL_UINT32(101, mockSaver.savedRecords[2].data.timestamp_ms);
+    TEST_ASSERT_EQUAL_FLOAT(199.0f, mockSaver.savedRecords[2].data.data);
+    TEST_ASSERT_EQUAL_UINT32(200, mockSaver.savedRecords[3].data.timestamp_ms);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, mockSaver.savedRecords[3].data.data);
+
+    // A flat interval saves one point, and the interval timing follows the samples
+    for (uint32_t t = 201; t <= 300; t++) {
+        sdh.addData(makeData(t, 2.0f));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, mockSaver.savedRecords.size());
+    TEST_ASSERT_EQUAL_UINT32(201, mockSaver.savedRecords[4].data.timestamp_ms);
+}
+
 // ---------------------------------------------------------------------
 // Main
 // ---------------------------------------------------------------------
@@ -180,5 +285,8 @@ int main(void) {
     RUN_TEST(test_addData_with_save_interval);
     RUN_TEST(test_multiple_data_same_timestamp);
     RUN_TEST(test_long_delay_resets_save_timer);
+    RUN_TEST(test_addData_vector_saves_each_component);
+    RUN_TEST(test_average_decimation_saves_interval_mean);
+    RUN_TEST(test_min_max_decimation_saves_envelope);
     return UNITY_END();
 }
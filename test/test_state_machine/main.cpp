@@ -259,6 +259,34 @@ void test_fast_launch_with_confirm(){
     delete flash;
 }
 
+void test_descent_is_idle_without_descent_detector(){
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    FastLaunchDetector fld(30, 500);
+    StateMachine sm(dataSaverPtr, &lp, &ad, &vve, &fld);
+
+    SimpleSimulator sim(3000, 70, 2000, 5);
+    uint32_t descentStart_ms = 0;
+    while (!sim.getHasLanded()) {
+        sim.tick();
+        DataPoint aclX(sim.getCurrentTime(), 0);
+        DataPoint aclY(sim.getCurrentTime(), 0);
+        DataPoint aclZ(sim.getCurrentTime(), sim.getIntertialVerticalAcl() + 9.8f);
+        DataPoint alt(sim.getCurrentTime(), sim.getAltitude());
+        AccelerationTriplet accel = {aclX, aclY, aclZ};
+        sm.update(accel, alt);
+        if (descentStart_ms == 0 && sm.getState() == STATE_DESCENT) {
+            descentStart_ms = sim.getCurrentTime();
+        }
+    }
+
+    // As before descent detection existed: the machine stays in DESCENT and the VVE stops at apogee
+    TEST_ASSERT_EQUAL(STATE_DESCENT, sm.getState());
+    TEST_ASSERT_TRUE(descentStart_ms > 0);
+    TEST_ASSERT_EQUAL_UINT32(descentStart_ms, vve.getTimestamp());
+}
+
 //
 // Main: Run all tests
 //
@@ -270,5 +298,6 @@ int main(void) {
     RUN_TEST(test_state_machine_with_real_data);
     RUN_TEST(test_fast_launch_with_revert);
     RUN_TEST(test_fast_launch_with_confirm);
+    RUN_TEST(test_descent_is_idle_without_descent_detector);
     return UNITY_END();
 }
@@ -0,0 +1,359 @@
+#include "unity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AirResistanceSimulation.h"
+#include "DataSaver_mock.h"
+#include "data_handling/DataPoint.h"
+#include "state_estimation/StateMachine.h"
+#include "state_estimation/States.h"
+
+// Monte Carlo fuzzer for StateMachine transition timing.
+//
+// Generates randomized flights with AirResistanceSimulator (motor, burn time,
+// drag, pad wait) and passes them through a sensor model with IMU/baro noise,
+// accelerometer spikes, sample dropouts and bursts, sample-period jitter and
+// a slower sample-and-hold barometer. A share of the runs are pad-only: the
+// rocket sits on the rail for a minute with handling bumps, and any
+// transition out of ARMED is a false trigger.
+//
+// Flights run on every core. Each flight is seeded from its index, so results
+// are identical for any thread count. Latency percentiles and false-transition
+// rates (with a 95% Wilson upper bound) are printed, and every flight is written
+// to state_machine_monte_carlo.csv.
+//
+// Flight count: MONTE_CARLO_FLIGHTS (default 200, enough for a CI smoke run;
+// use 2000 or more for a study), pad-only share of that count:
+// MONTE_CARLO_PAD_FRACTION (default 0.2), base seed: MONTE_CARLO_SEED.
+// Build with -DMONTE_CARLO_DEFAULT_FLIGHTS=2000 to make the large run the default.
+
+#ifndef MONTE_CARLO_DEFAULT_FLIGHTS
+#define MONTE_CARLO_DEFAULT_FLIGHTS 200
+#endif
+
+namespace {
+
+constexpr float kGravity_mps2 = 9.81F;
+constexpr uint32_t kSimTick_ms = 1;
+constexpr uint32_t kPostApogee_ms = 5000;
+constexpr uint32_t kPadOnlyDuration_ms = 60000;
+
+struct FlightConfig {
+    bool padOnly;
+    uint32_t launch_ms;
+    float motorAccel_mps2;
+    uint32_t burn_ms;
+    float dragCoeff;
+    uint32_t samplePeriod_ms;
+    uint32_t sampleJitter_ms;
+    uint32_t baroPeriod_ms;
+    float accelNoise_mps2;
+    float baroNoise_m;
+    float dropoutProbability;
+    float burstProbability;
+    float spikeProbability;
+};
+
+struct FlightResult {
+    FlightConfig config;
+    uint32_t trueLaunch_ms = 0;
+    uint32_t trueApogee_ms = 0;
+    uint32_t softAscent_ms = 0;   // first SOFT_ASCENT entry, 0 if never
+    uint32_t ascent_ms = 0;       // first ASCENT entry, 0 if never
+    uint32_t descent_ms = 0;      // first DESCENT entry, 0 if never
+    uint32_t softAscentReverts = 0;
+    uint32_t samples = 0;
+};
+
+uint64_t envOr(const char* name, uint64_t fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    return std::strtoull(value, nullptr, 10);
+}
+
+double envOr(const char* name, double fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    return std::strtod(value, nullptr);
+}
+
+FlightConfig randomConfig(bool padOnly, std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+    auto between = [&](float lo, float hi) { return lo + (hi - lo) * unit(rng); };
+    auto betweenU = [&](uint32_t lo, uint32_t hi) {
+        return std::uniform_int_distribution<uint32_t>(lo, hi)(rng);
+    };
+
+    FlightConfig c;
+    c.padOnly = padOnly;
+    c.launch_ms = betweenU(5000, 20000);
+    c.motorAccel_mps2 = between(35.0F, 90.0F);
+    c.burn_ms = betweenU(1000, 4000);
+    c.dragCoeff = between(0.0003F, 0.0015F);
+    c.samplePeriod_ms = betweenU(8, 20);
+    c.sampleJitter_ms = betweenU(0, 4);
+    c.baroPeriod_ms = betweenU(c.samplePeriod_ms, 50);
+    c.accelNoise_mps2 = between(0.1F, 1.5F);
+    c.baroNoise_m = between(0.2F, 3.0F);
+    c.dropoutProbability = between(0.0F, 0.05F);
+    c.burstProbability = between(0.0F, 0.002F);
+    c.spikeProbability = between(0.0F, 0.005F);
+    return c;
+}
+
+// Rail bumps while waiting on the pad: about one every 20 s, 20-250 ms long
+struct PadBumps {
+    uint32_t start_ms = 0;
+    uint32_t end_ms = 0;
+    float accel_mps2 = 0.0F;
+
+    float at(uint32_t t_ms, std::mt19937& rng) {
+        if (t_ms >= end_ms) {
+            std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+            if (unit(rng) < 0.00005F) {
+                start_ms = t_ms;
+                end_ms = t_ms + std::uniform_int_distribution<uint32_t>(20, 250)(rng);
+                accel_mps2 = 5.0F + 35.0F * unit(rng);
+            }
+        }
+        return (t_ms >= start_ms && t_ms < end_ms) ? accel_mps2 : 0.0F;
+    }
+};
+
+FlightResult runFlight(uint32_t index, uint64_t baseSeed, bool padOnly) {
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(baseSeed * 1000003ULL + index));
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+
+    FlightResult result;
+    result.config = randomConfig(padOnly, rng);
+    const FlightConfig& c = result.config;
+    std::normal_distribution<float> accelNoise(0.0F, c.accelNoise_mps2);
+    std::normal_distribution<float> baroNoise(0.0F, c.baroNoise_m);
+    std::uniform_int_distribution<int32_t> jitter(-static_cast<int32_t>(c.sampleJitter_ms),
+                                                  static_cast<int32_t>(c.sampleJitter_ms));
+
+    // A pad-only flight never lights the motor
+    const uint32_t launch_ms = padOnly ? kPadOnlyDuration_ms * 10U : c.launch_ms;
+    AirResistanceSimulator sim(launch_ms, c.motorAccel_mps2, c.burn_ms, kSimTick_ms, c.dragCoeff);
+    result.trueLaunch_ms = padOnly ? 0U : launch_ms;
+
+    DataSaverMock saver;
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    FastLaunchDetector fld(30, 500);
+    StateMachine sm(&saver, &lp, &ad, &vve, &fld);
+
+    PadBumps bumps;
+    uint32_t nextSample_ms = c.samplePeriod_ms;
+    uint32_t nextBaro_ms = 0;
+    uint32_t burstEnd_ms = 0;
+    float heldAltitude_m = 0.0F;
+    uint8_t lastState = sm.getState();
+
+    while (true) {
+        sim.tick();
+        const uint32_t t = sim.getCurrentTime();
+        const float bump = sim.getAltitude() <= 0.0F ? bumps.at(t, rng) : 0.0F;
+
+        if (padOnly && t >= kPadOnlyDuration_ms) break;
+        if (!padOnly && sim.getApogeeTimestamp() != 0 && t >= sim.getApogeeTimestamp() + kPostApogee_ms) break;
+        if (sim.getHasLanded()) break;
+
+        if (t < nextSample_ms) continue;
+        const int32_t step = static_cast<int32_t>(c.samplePeriod_ms) + jitter(rng);
+        nextSample_ms = t + static_cast<uint32_t>(std::max<int32_t>(1, step));
+
+        // Dropped samples: single misses and bus-hang bursts
+        if (t < burstEnd_ms) continue;
+        if (unit(rng) < c.burstProbability) {
+            burstEnd_ms = t + std::uniform_int_distribution<uint32_t>(50, 300)(rng);
+            continue;
+        }
+        if (unit(rng) < c.dropoutProbability) continue;
+
+        float accelZ = sim.getInertialVerticalAcl() + kGravity_mps2 + bump + accelNoise(rng);
+        if (unit(rng) < c.spikeProbability) {
+            accelZ += (unit(rng) < 0.5F ? -1.0F : 1.0F) * (20.0F + 60.0F * unit(rng));
+        }
+        if (t >= nextBaro_ms) {
+            heldAltitude_m = sim.getAltitude() + baroNoise(rng);
+            nextBaro_ms = t + c.baroPeriod_ms;
+        }
+
+        const AccelerationTriplet accel = {DataPoint(t, accelNoise(rng)), DataPoint(t, accelNoise(rng)),
+                                           DataPoint(t, accelZ)};
+        sm.update(accel, DataPoint(t, heldAltitude_m));
+        ++result.samples;
+
+        const uint8_t state = sm.getState();
+        if (state != lastState) {
+            if (state == STATE_SOFT_ASCENT && result.softAscent_ms == 0) result.softAscent_ms = t;
+            if (state == STATE_ASCENT && result.ascent_ms == 0) result.ascent_ms = t;
+            if (state == STATE_DESCENT && result.descent_ms == 0) result.descent_ms = t;
+            if (lastState == STATE_SOFT_ASCENT && state == STATE_ARMED) ++result.softAscentReverts;
+            lastState = state;
+        }
+        // Keep memory bounded over thousands of flights
+        saver.clear();
+    }
+
+    result.trueApogee_ms = padOnly ? 0U : sim.getApogeeTimestamp();
+    return result;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return std::nan("");
+    std::sort(values.begin(), values.end());
+    const double rank = p / 100.0 * static_cast<double>(values.size() - 1);
+    const auto lo = static_cast<size_t>(std::floor(rank));
+    const auto hi = static_cast<size_t>(std::ceil(rank));
+    return values[lo] + (values[hi] - values[lo]) * (rank - static_cast<double>(lo));
+}
+
+// 95% Wilson score upper bound for k events in n trials
+double wilsonUpper(size_t k, size_t n) {
+    if (n == 0) return 1.0;
+    const double z = 1.96;
+    const double nn = static_cast<double>(n);
+    const double p = static_cast<double>(k) / nn;
+    const double denom = 1.0 + z * z / nn;
+    const double centre = p + z * z / (2.0 * nn);
+    const double margin = z * std::sqrt(p * (1.0 - p) / nn + z * z / (4.0 * nn * nn));
+    return (centre + margin) / denom;
+}
+
+void printLatency(const char* name, const std::vector<double>& values_ms) {
+    printf("%-26s n=%-6zu p50 %8.1f  p90 %8.1f  p99 %8.1f  max %8.1f ms\n", name, values_ms.size(),
+           percentile(values_ms, 50.0), percentile(values_ms, 90.0), percentile(values_ms, 99.0),
+           values_ms.empty() ? std::nan("") : *std::max_element(values_ms.begin(), values_ms.end()));
+}
+
+void printRate(const char* name, size_t k, size_t n) {
+    printf("%-26s %6zu / %-6zu = %7.4f%%  (95%% upper bound %7.4f%%)\n", name, k, n,
+           n > 0 ? 100.0 * static_cast<double>(k) / static_cast<double>(n) : 0.0, 100.0 * wilsonUpper(k, n));
+}
+
+}  // namespace
+
+/* ---------- Unity fixtures ---------- */
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_state_machine_monte_carlo(void) {
+    const auto flightCount = static_cast<uint32_t>(envOr("MONTE_CARLO_FLIGHTS", static_cast<uint64_t>(MONTE_CARLO_DEFAULT_FLIGHTS)));
+    const double padFraction = envOr("MONTE_CARLO_PAD_FRACTION", 0.2);
+    const uint64_t baseSeed = envOr("MONTE_CARLO_SEED", static_cast<uint64_t>(1));
+    const auto padCount = static_cast<uint32_t>(static_cast<double>(flightCount) * padFraction);
+    TEST_ASSERT_TRUE(flightCount > 0);
+
+    std::vector<FlightResult> results(flightCount);
+    std::atomic<uint32_t> next(0);
+    const unsigned workers = std::max(1U, std::thread::hardware_concurrency());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < workers; ++w) {
+        threads.emplace_back([&]() {
+            for (uint32_t i = next.fetch_add(1); i < flightCount; i = next.fetch_add(1)) {
+                // The last padCount indices are pad-only runs
+                results[i] = runFlight(i, baseSeed, i >= flightCount - padCount);
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> softLatency, launchLatency, apogeeLatency;
+    size_t flights = 0, pads = 0;
+    size_t missedLaunch = 0, missedApogee = 0, earlyApogee = 0, earlyLaunch = 0;
+    size_t padFalseSoftAscent = 0, padFalseLaunch = 0;
+    uint64_t samples = 0;
+
+    std::ofstream csv("state_machine_monte_carlo.csv");
+    TEST_ASSERT_TRUE_MESSAGE(csv.is_open(), "Failed to open CSV file for writing");
+    csv << "flight,pad_only,motor_accel_mps2,burn_ms,drag_coeff,sample_period_ms,jitter_ms,baro_period_ms,"
+           "accel_noise_mps2,baro_noise_m,dropout_p,burst_p,spike_p,true_launch_ms,true_apogee_ms,"
+           "soft_ascent_ms,ascent_ms,descent_ms,soft_ascent_reverts\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const FlightResult& r = results[i];
+        const FlightConfig& c = r.config;
+        samples += r.samples;
+        csv << i << ',' << c.padOnly << ',' << c.motorAccel_mps2 << ',' << c.burn_ms << ',' << c.dragCoeff << ','
+            << c.samplePeriod_ms << ',' << c.sampleJitter_ms << ',' << c.baroPeriod_ms << ',' << c.accelNoise_mps2
+            << ',' << c.baroNoise_m << ',' << c.dropoutProbability << ',' << c.burstProbability << ','
+            << c.spikeProbability << ',' << r.trueLaunch_ms << ',' << r.trueApogee_ms << ',' << r.softAscent_ms
+            << ',' << r.ascent_ms << ',' << r.descent_ms << ',' << r.softAscentReverts << '\n';
+
+        if (c.padOnly) {
+            ++pads;
+            if (r.softAscent_ms != 0) ++padFalseSoftAscent;
+            if (r.ascent_ms != 0) ++padFalseLaunch;
+            continue;
+        }
+        ++flights;
+        if (r.ascent_ms == 0) {
+            ++missedLaunch;
+        } else if (r.ascent_ms < r.trueLaunch_ms) {
+            ++earlyLaunch;
+        } else {
+            launchLatency.push_back(static_cast<double>(r.ascent_ms - r.trueLaunch_ms));
+        }
+        if (r.softAscent_ms >= r.trueLaunch_ms && r.softAscent_ms != 0) {
+            softLatency.push_back(static_cast<double>(r.softAscent_ms - r.trueLaunch_ms));
+        }
+        if (r.descent_ms == 0) {
+            ++missedApogee;
+        } else if (r.descent_ms < r.trueApogee_ms) {
+            ++earlyApogee;
+        } else {
+            apogeeLatency.push_back(static_cast<double>(r.descent_ms - r.trueApogee_ms));
+        }
+    }
+    csv.close();
+
+    printf("\n===== STATE MACHINE MONTE CARLO =====\n");
+    printf("%zu flights + %zu pad-only runs, %llu samples, %u threads, %.1f s\n", flights, pads,
+           static_cast<unsigned long long>(samples), workers, elapsed_s);
+    printf("\n-- transition latency (from true event) --\n");
+    printLatency("ARMED->SOFT_ASCENT", softLatency);
+    printLatency("->ASCENT", launchLatency);
+    printLatency("ASCENT->DESCENT", apogeeLatency);
+    printf("\n-- false / missed transitions --\n");
+    printRate("launch missed", missedLaunch, flights);
+    printRate("ASCENT before launch", earlyLaunch, flights);
+    printRate("apogee missed", missedApogee, flights);
+    printRate("DESCENT before apogee", earlyApogee, flights);
+    printRate("pad: false SOFT_ASCENT", padFalseSoftAscent, pads);
+    printRate("pad: false ASCENT", padFalseLaunch, pads);
+
+    // Sanity bounds only; the report is the product. False-trigger rates depend on the
+    // noise model and thresholds under study, so they are reported rather than asserted.
+    TEST_ASSERT_TRUE(samples > 0);
+    TEST_ASSERT_TRUE(flights == 0 || static_cast<double>(missedLaunch) / static_cast<double>(flights) < 0.01);
+    TEST_ASSERT_TRUE(flights == 0 || static_cast<double>(missedApogee) / static_cast<double>(flights) < 0.01);
+}
+
+/* ---------- main runner ----------------------- */
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_state_machine_monte_carlo);
+    return UNITY_END();
+}
@@ -0,0 +1,221 @@
+#include "unity.h"
+
+#include <cstdint>
+
+#include "ArduinoHAL.h"
+#include "DataSaver_mock.h"
+#include "SimpleSimulation.h"
+#include "data_handling/DataNames.h"
+#include "data_handling/DataPoint.h"
+#include "state_estimation/BurnoutStateMachine.h"
+#include "state_estimation/StateMachine.h"
+#include "state_estimation/States.h"
+#include "state_estimation/TableStateMachine.h"
+
+namespace {
+
+using namespace TransitionAction;
+
+// Custom profile: launch -> coast -> descent without the fast launch detector
+constexpr StateTransition kCoastTransitions[] = {
+    {STATE_ARMED, TransitionGuard::LaunchDetected, STATE_ASCENT,
+     kLogStateChange | kSaverLaunchAtLaunchTime | kInitApogeeDetector | kUpdateVerticalVelocity},
+    {STATE_ASCENT, TransitionGuard::Coasting, STATE_COAST_ASCENT, kLogStateChange},
+    {STATE_COAST_ASCENT, TransitionGuard::ApogeeDetected, STATE_DESCENT, kLogStateChange},
+};
+
+constexpr uint8_t kFlightUpdates = StateUpdate::kVerticalVelocity | StateUpdate::kApogeeDetector;
+
+constexpr StateUpdates kCoastStates[] = {
+    {STATE_ARMED, StateUpdate::kLaunchDetector},
+    {STATE_ASCENT, kFlightUpdates},
+    {STATE_COAST_ASCENT, kFlightUpdates},
+    {STATE_DESCENT, StateUpdate::kNone},
+};
+
+constexpr FlightProfile kCoastProfile = {STATE_ARMED, kCoastTransitions, 3, kCoastStates, 4};
+
+// ARMED rows split by an ASCENT row
+constexpr StateTransition kSplitTransitions[] = {
+    {STATE_ARMED, TransitionGuard::LaunchDetected, STATE_ASCENT, kNone},
+    {STATE_ASCENT, TransitionGuard::ApogeeDetected, STATE_DESCENT, kNone},
+    {STATE_ARMED, TransitionGuard::FastLaunchDetected, STATE_SOFT_ASCENT, kNone},
+};
+
+constexpr StateUpdates kSplitStates[] = {
+    {STATE_ARMED, StateUpdate::kNone},
+    {STATE_ASCENT, StateUpdate::kNone},
+};
+
+constexpr FlightProfile kSplitProfile = {STATE_ARMED, kSplitTransitions, 3, kSplitStates, 2};
+
+AccelerationTriplet simAccel(const SimpleSimulator& sim) {
+    // The launch detector expects measured acceleration, i.e. +9.8 m/s^2 at rest
+    return {DataPoint(sim.getCurrentTime(), 0), DataPoint(sim.getCurrentTime(), 0),
+            DataPoint(sim.getCurrentTime(), sim.getIntertialVerticalAcl() + 9.8f)};
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_custom_profile_runs_full_flight(void) {
+    DataSaverMock dataSaver;
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    TableStateMachine sm(kCoastProfile, &dataSaver, &lp, &ad, &vve);
+    TEST_ASSERT_TRUE(sm.isProfileValid());
+    TEST_ASSERT_EQUAL(STATE_ARMED, sm.getState());
+
+    SimpleSimulator sim(10000, 70, 3000, 10);
+    uint32_t coastTime_ms = 0;
+    while (!sim.getHasLanded()) {
+        sim.tick();
+        TEST_ASSERT_EQUAL(0, sm.update(simAccel(sim), DataPoint(sim.getCurrentTime(), sim.getAltitude())));
+        if (coastTime_ms == 0 && sm.getState() == STATE_COAST_ASCENT) {
+            coastTime_ms = sim.getCurrentTime();
+        }
+    }
+
+    TEST_ASSERT_EQUAL(STATE_DESCENT, sm.getState());
+    TEST_ASSERT_TRUE(lp.isLaunched());
+    TEST_ASSERT_TRUE(ad.isApogeeDetected());
+    // Coast starts once the 3 s burn is over
+    TEST_ASSERT_UINT32_WITHIN(500, 10000 + 3000, coastTime_ms);
+
+    // ASCENT, COAST_ASCENT and DESCENT were each logged once, in order
+    uint8_t logged[3] = {0, 0, 0};
+    size_t count = 0;
+    for (const auto& call : dataSaver.saveDataPointCalls) {
+        if (call.second == STATE_CHANGE && count < 3) {
+            logged[count++] = static_cast<uint8_t>(call.first.data);
+        }
+    }
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(STATE_ASCENT, logged[0]);
+    TEST_ASSERT_EQUAL(STATE_COAST_ASCENT, logged[1]);
+    TEST_ASSERT_EQUAL(STATE_DESCENT, logged[2]);
+}
+
+void test_worst_case_update_time_is_recorded_per_state(void) {
+    DataSaverMock dataSaver;
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    FastLaunchDetector fld(30, 500);
+    StateMachine sm(&dataSaver, &lp, &ad, &vve, &fld);
+
+    SimpleSimulator sim(10000, 70, 3000, 10);
+    while (sim.getApogeeTimestamp() == 0 || sim.getCurrentTime() < sim.getApogeeTimestamp() + 5000) {
+        sim.tick();
+        sm.update(simAccel(sim), DataPoint(sim.getCurrentTime(), sim.getAltitude()));
+    }
+    TEST_ASSERT_EQUAL(STATE_DESCENT, sm.getState());
+
+    // micros() may tick 0 us for cheap updates, so only the states doing filter work are checked
+    const uint32_t armed_us = sm.getWorstCaseUpdateTime_us(STATE_ARMED);
+    const uint32_t ascent_us = sm.getWorstCaseUpdateTime_us(STATE_ASCENT);
+    printf("worst-case update: ARMED %u us, ASCENT %u us, DESCENT %u us\n", armed_us, ascent_us,
+           sm.getWorstCaseUpdateTime_us(STATE_DESCENT));
+    TEST_ASSERT_TRUE(armed_us + ascent_us > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, sm.getWorstCaseUpdateTime_us(STATE_LANDED));
+
+    sm.resetUpdateTimes();
+    TEST_ASSERT_EQUAL_UINT32(0, sm.getWorstCaseUpdateTime_us(STATE_ASCENT));
+}
+
+void test_state_outside_profile_is_an_error(void) {
+    constexpr StateUpdates noStates[] = {{STATE_DESCENT, StateUpdate::kNone}};
+    const FlightProfile profile = {STATE_UNARMED, nullptr, 0, noStates, 1};
+    TableStateMachine sm(profile, nullptr, nullptr, nullptr, nullptr);
+    TEST_ASSERT_TRUE(sm.isProfileValid());
+
+    const AccelerationTriplet accel = {DataPoint(0, 0), DataPoint(0, 0), DataPoint(0, 0)};
+    TEST_ASSERT_EQUAL(1, sm.update(accel, DataPoint(0, 0)));
+}
+
+void test_split_rows_invalidate_profile(void) {
+    TableStateMachine sm(kSplitProfile, nullptr, nullptr, nullptr, nullptr);
+    TEST_ASSERT_FALSE(sm.isProfileValid());
+
+    const AccelerationTriplet accel = {DataPoint(0, 0), DataPoint(0, 0), DataPoint(0, 0)};
+    TEST_ASSERT_EQUAL(2, sm.update(accel, DataPoint(0, 0)));
+    TEST_ASSERT_EQUAL(STATE_ARMED, sm.getState());
+}
+
+void test_missing_detectors_make_guards_false(void) {
+    // Without a launch detector the ARMED row can never fire
+    TableStateMachine sm(kCoastProfile, nullptr, nullptr, nullptr, nullptr);
+    const AccelerationTriplet accel = {DataPoint(0, 0), DataPoint(0, 0), DataPoint(0, 100.0f)};
+    for (uint32_t i = 0; i < 100; ++i) {
+        TEST_ASSERT_EQUAL(0, sm.update(accel, DataPoint(i, 0)));
+    }
+    TEST_ASSERT_EQUAL(STATE_ARMED, sm.getState());
+}
+
+void test_burnout_logs_coast_with_y_timestamp(void) {
+    DataSaverMock dataSaver;
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    BurnoutStateMachine sm(&dataSaver, &lp, &ad, &vve);
+
+    SimpleSimulator sim(10000, 70, 3000, 10);
+    while (sm.getState() != STATE_DESCENT && !sim.getHasLanded()) {
+        sim.tick();
+        AccelerationTriplet accel = simAccel(sim);
+        accel.y.timestamp_ms += 1;  // Tell the axes apart
+        TEST_ASSERT_EQUAL(0, sm.update(accel, DataPoint(sim.getCurrentTime(), sim.getAltitude())));
+    }
+    TEST_ASSERT_EQUAL(STATE_DESCENT, sm.getState());
+
+    size_t logged = 0;
+    for (const auto& call : dataSaver.saveDataPointCalls) {
+        if (call.second != STATE_CHANGE) {
+            continue;
+        }
+        logged++;
+        const bool isCoast = static_cast<uint8_t>(call.first.data) == STATE_COAST_ASCENT;
+        TEST_ASSERT_EQUAL_UINT32(isCoast ? 1U : 0U, call.first.timestamp_ms % 10U);
+    }
+    TEST_ASSERT_EQUAL(3, logged);
+}
+
+void test_fast_launch_detector_skips_the_launch_sample(void) {
+    // Find the sample on which the launch detector fires for a steady 35 m/s^2
+    LaunchDetector probe(30, 1000, 40);
+    uint32_t launchSample = 0;
+    for (uint32_t i = 0; !probe.isLaunched(); ++i) {
+        const DataPoint t(i * 10U, 0);
+        probe.update({DataPoint(i * 10U, 0), t, DataPoint(i * 10U, 35.0f)});
+        launchSample = i;
+    }
+
+    // Same samples, but the launching one is also above the FLD threshold
+    DataSaverMock dataSaver;
+    LaunchDetector lp(30, 1000, 40);
+    ApogeeDetector ad;
+    VerticalVelocityEstimator vve;
+    FastLaunchDetector fld(40, 500);
+    StateMachine sm(&dataSaver, &lp, &ad, &vve, &fld);
+    for (uint32_t i = 0; i <= launchSample; ++i) {
+        const float z = (i == launchSample) ? 50.0f : 35.0f;
+        sm.update({DataPoint(i * 10U, 0), DataPoint(i * 10U, 0), DataPoint(i * 10U, z)}, DataPoint(i * 10U, 0));
+    }
+    TEST_ASSERT_EQUAL(STATE_ASCENT, sm.getState());
+    TEST_ASSERT_FALSE(fld.hasLaunched());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_custom_profile_runs_full_flight);
+    RUN_TEST(test_worst_case_update_time_is_recorded_per_state);
+    RUN_TEST(test_state_outside_profile_is_an_error);
+    RUN_TEST(test_split_rows_invalidate_profile);
+    RUN_TEST(test_missing_detectors_make_guards_false);
+    RUN_TEST(test_burnout_logs_coast_with_y_timestamp);
+    RUN_TEST(test_fast_launch_detector_skips_the_launch_sample);
+    return UNITY_END();
+}
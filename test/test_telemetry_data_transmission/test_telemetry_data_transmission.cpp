@@ -221,11 +221,42 @@ void test_second_packet_counter_is_one(void) {
     TEST_ASSERT_EQUAL(1, mockRfdSerial.writeCalls.at(secondPacketStart + TelemetryFmt::kPacketCounterIndex + 3));
 }
 
+void test_vector_stream_matches_multi_group(void) {
+    MockDataSaver mockXAcl, mockYAcl, mockZAcl, vectorSaver;
+    SensorDataHandler xAclData(1, &mockXAcl);
+    SensorDataHandler yAclData(2, &mockYAcl);
+    SensorDataHandler zAclData(3, &mockZAcl);
+    xAclData.addData(DataPoint(1, 6.767676f));
+    yAclData.addData(DataPoint(1, 6.969696f));
+    zAclData.addData(DataPoint(1, 1.234567f));
+    std::array<SensorDataHandler*, 3> accelerationTriplet{&xAclData, &yAclData, &zAclData};
+    SendableSensorData groupSsd(accelerationTriplet, 102, 2);
+    std::array<SendableSensorData*, 1> groupSsds{&groupSsd};
+    Stream groupSerial;
+    Telemetry groupTelemetry(groupSsds, groupSerial);
+
+    // One handler fed the whole triplet; the default saveDataVector() saves one point per axis
+    SensorDataHandler accelData(1, &vectorSaver);
+    accelData.addData(DataVector(1, 6.767676f, 6.969696f, 1.234567f));
+    TEST_ASSERT_EQUAL(3U, vectorSaver.savedRecords.size());
+    TEST_ASSERT_EQUAL_UINT8(3U, vectorSaver.savedRecords[2].sensorName);
+    SendableSensorData vectorSsd(&accelData, 102, 3, 2);
+    std::array<SendableSensorData*, 1> vectorSsds{&vectorSsd};
+    Stream vectorSerial;
+    Telemetry vectorTelemetry(vectorSsds, vectorSerial);
+
+    TEST_ASSERT_TRUE(groupTelemetry.tick((uint32_t)500));
+    TEST_ASSERT_TRUE(vectorTelemetry.tick((uint32_t)500));
+    TEST_ASSERT_EQUAL(29U, vectorSerial.writeCalls.size());
+    TEST_ASSERT_TRUE(vectorSerial.writeCalls == groupSerial.writeCalls);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_initialization);
     RUN_TEST(test_a_full_second_of_ticks);
     RUN_TEST(test_first_packet_counter_is_zero);
     RUN_TEST(test_second_packet_counter_is_one);
+    RUN_TEST(test_vector_stream_matches_multi_group);
     return UNITY_END();
 }
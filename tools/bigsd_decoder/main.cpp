@@ -0,0 +1,143 @@
+// Converts a DataSaverBigSD binary log (/stream-<n>.bin) to the CSV text the
+// logger would have written in CSV mode, byte for byte.
+//
+// Build (Linux/macOS), from the repository root:
+//   g++ -std=c++11 -O2 -Iinclude -o bigsd_decoder tools/bigsd_decoder/main.cpp
+//       src/data_handling/BinaryLogFormat.cpp src/data_handling/CsvFormat.cpp src/data_handling/Crc.cpp
+//
+// Usage:
+//   ./bigsd_decoder stream-0.bin stream-0.csv [--from <timestamp_ms>] [--names]
+// Pass the first segment. Later segments (stream-0-1.bin, stream-0-2.bin, ...)
+// are found next to it and decoded as one stream; they have no header of their own.
+// --from starts at the block holding that timestamp instead of the beginning.
+// --names prints the channel and flight state tables from the log header.
+
+#include "data_handling/BinaryLogFormat.h"
+#include "data_handling/CsvFormat.h"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kFlush_bytes = 1U << 20;
+
+class CsvFileSink : public IRecordSink {
+public:
+    explicit CsvFileSink(FILE* out) : out_(out) { buffer_.reserve(kFlush_bytes + kMaxCsvLineLength_bytes); }
+
+    void onRecord(const DecodedRecord& record) override {
+        char line[kMaxCsvLineLength_bytes];
+        buffer_.append(line, formatCsvLine(record.timestamp_ms, record.name, record.value, line));
+        if (buffer_.size() >= kFlush_bytes) {
+            flush();
+        }
+    }
+
+    void flush() {
+        std::fwrite(buffer_.data(), 1, buffer_.size(), out_);
+        buffer_.clear();
+    }
+
+private:
+    FILE* out_;
+    std::string buffer_;
+};
+
+bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::array<uint8_t, 65536> chunk;
+    std::size_t count = 0;
+    while ((count = std::fread(chunk.data(), 1, chunk.size(), file)) > 0U) {
+        data.insert(data.end(), chunk.begin(), chunk.begin() + static_cast<long>(count));
+    }
+    std::fclose(file);
+    return true;
+}
+
+// stream-0.bin -> stream-0-<segment>.bin, as DataSaverBigSD names them
+std::string segmentPath(const std::string& first, unsigned segment) {
+    const std::size_t dot = first.rfind('.');
+    const std::size_t slash = first.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return first + "-" + std::to_string(segment);
+    }
+    return first.substr(0, dot) + "-" + std::to_string(segment) + first.substr(dot);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <log.bin> <out.csv> [--from <timestamp_ms>] [--names]\n", argv[0]);
+        return 2;
+    }
+    bool seek = false;
+    uint32_t from_ms = 0;
+    bool names = false;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            seek = true;
+            from_ms = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--names") == 0) {
+            names = true;
+        }
+    }
+
+    std::vector<uint8_t> log;
+    if (!readFile(argv[1], log)) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    // Every segment but the last is full, so the blocks line up when appended
+    unsigned segments = 1;
+    while (readFile(segmentPath(argv[1], segments).c_str(), log)) {
+        segments++;
+    }
+    FILE* out = std::fopen(argv[2], "wb");
+    if (out == nullptr) {
+        std::perror(argv[2]);
+        return 1;
+    }
+
+    CsvFileSink sink(out);
+    BinaryLogDecoder decoder(sink);
+    if (decoder.parseHeader(log.data(), log.size()) != 0) {
+        std::fprintf(stderr, "%s is not a binary log (pass the first segment, stream-<n>.bin)\n", argv[1]);
+        return 1;
+    }
+    if (names) {
+        for (unsigned value = 0; value < 256U; value++) {
+            const char* channel = decoder.getChannelName(static_cast<uint8_t>(value));
+            if (channel != nullptr) {
+                std::fprintf(stderr, "channel %u %s\n", value, channel);
+            }
+            const char* state = decoder.getStateName(static_cast<uint8_t>(value));
+            if (state != nullptr) {
+                std::fprintf(stderr, "state %u %s\n", value, state);
+            }
+        }
+    }
+
+    if (seek) {
+        for (std::size_t offset = decoder.findBlock(log.data(), log.size(), from_ms);
+             offset + kBinaryBlockSize_bytes <= log.size(); offset += kBinaryBlockSize_bytes) {
+            decoder.decodeBlock(log.data() + offset);
+        }
+    } else {
+        decoder.decodeLog(log.data(), log.size());
+    }
+    sink.flush();
+    std::fclose(out);
+
+    std::fprintf(stderr, "%u records from %u blocks in %u segments, %u bad blocks\n", decoder.getRecordCount(),
+                 decoder.getBlockCount(), segments, decoder.getBadBlockCount());
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Host-side receiver for DataSaverSPI::dumpDataWindowed().
+//
+// Reads dump frames from a serial port and writes each page into an image of
+// the flash data region: page N lands at byte offset N * 256, erased pages are
+// written as 0xFF. The output file is not truncated, so an interrupted dump
+// can be resumed into the same file with the start page it prints.
+//
+// Build (Linux/macOS), from the repository root:
+//   g++ -std=c++11 -O2 -Iinclude -o dump_receiver tools/dump_receiver/main.cpp
+//       src/data_handling/FlashDumpProtocol.cpp src/data_handling/Crc.cpp
+//
+// Usage:
+//   ./dump_receiver /dev/ttyACM0 flash.bin [startPage]
+// For DataSaverSPI::dumpFlight(), pass the flight's first page from printFlights().
+
+#include "data_handling/FlashDumpProtocol.h"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// Give up when the device has been silent this long (longer than its own abort timeout)
+constexpr int kIdleTimeout_s = 15;
+
+class FileSink : public IDumpSink {
+public:
+    FileSink(int port, int file) : port_(port), file_(file) {}
+
+    void onPage(uint32_t page, const uint8_t* data) override {
+        std::array<uint8_t, kDumpPageSize_bytes> erased;
+        erased.fill(0xFF);
+        const uint8_t* bytes = data != nullptr ? data : erased.data();
+        const off_t offset = static_cast<off_t>(page) * static_cast<off_t>(kDumpPageSize_bytes);
+        if (pwrite(file_, bytes, kDumpPageSize_bytes, offset) != static_cast<ssize_t>(kDumpPageSize_bytes)) {
+            std::perror("write");
+            std::exit(1);
+        }
+    }
+
+    void sendControl(const uint8_t* message, std::size_t length) override {
+        if (write(port_, message, length) != static_cast<ssize_t>(length)) {
+            std::perror("serial write");
+        }
+    }
+
+private:
+    int port_;
+    int file_;
+};
+
+bool configurePort(int port) {
+    termios tty = {};
+    if (tcgetattr(port, &tty) != 0) {
+        return false;
+    }
+    cfmakeraw(&tty);
+    cfsetspeed(&tty, B115200);  // Ignored by USB CDC ports, which run at USB speed
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    return tcsetattr(port, TCSANOW, &tty) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <serial port> <output image> [start page]\n", argv[0]);
+        return 2;
+    }
+    const uint32_t startPage = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 0U;
+
+    const int port = open(argv[1], O_RDWR | O_NOCTTY);
+    if (port < 0 || !configurePort(port)) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    const int file = open(argv[2], O_WRONLY | O_CREAT, 0644);
+    if (file < 0) {
+        std::perror(argv[2]);
+        return 1;
+    }
+
+    FileSink sink(port, file);
+    DumpReceiver receiver(sink, startPage);
+    std::array<uint8_t, 4096> buffer;
+    uint32_t lastReported = startPage;
+
+    while (!receiver.isDone()) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(port, &readable);
+        timeval timeout = {kIdleTimeout_s, 0};
+        if (select(port + 1, &readable, nullptr, nullptr, &timeout) <= 0) {
+            break;
+        }
+        const ssize_t count = read(port, buffer.data(), buffer.size());
+        if (count <= 0) {
+            break;
+        }
+        receiver.process(buffer.data(), static_cast<std::size_t>(count));
+
+        if (receiver.getNextPage() - lastReported >= 1024U) {
+            lastReported = receiver.getNextPage();
+            std::fprintf(stderr, "\rpage %u", lastReported);
+        }
+    }
+
+    std::fprintf(stderr, "\n%u pages, %u CRC errors, %u duplicates\n", receiver.getPagesReceived(),
+                 receiver.getCrcErrors(), receiver.getDuplicates());
+    close(file);
+    close(port);
+    if (!receiver.isDone()) {
+        std::fprintf(stderr, "Dump incomplete; resume with start page %u\n", receiver.getNextPage());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+// Decodes DataSaverSPI flash data into CSV or a columnar binary file.
+//
+// Input is memory-mapped and either a dumpData() capture (detected by the
+// 'abcdef' preamble), an image of the data region as written by
+// tools/dump_receiver, or a full chip image (--chip, skips the metadata
+// sectors).
+//
+// Build (Linux/macOS), from the repository root:
+//   g++ -std=c++17 -O2 -Iinclude -o flash_decoder tools/flash_decoder/main.cpp
+//       src/data_handling/FlashDecoder.cpp src/data_handling/FloatCompression.cpp src/data_handling/Crc.cpp
+//
+// Usage:
+//   ./flash_decoder [--chip] [--columnar] <input> <output>
+//
+// CSV rows are "timestamp_ms,name,value". The columnar file is the magic
+// "CURECOL1", a uint64 record count n, then n uint32 timestamps, n uint8
+// names and n float32 values, all little endian; in numpy:
+//   n = int(np.fromfile(f, np.uint64, 1, offset=8)[0])
+//   ts = np.fromfile(f, np.uint32, n, offset=16)
+
+#include "data_handling/FlashDecoder.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kPreambleSearch_bytes = 4096;
+constexpr std::size_t kCsvFlush_bytes = 1U << 20;
+
+class CsvSink : public IRecordSink {
+public:
+    explicit CsvSink(FILE* out) : out_(out) { buffer_.reserve(kCsvFlush_bytes + 64U); }
+    ~CsvSink() override { flush(); }
+
+    void onRecord(const DecodedRecord& record) override {
+        // 10 + 3 + ~15 characters for the three fields, plus separators
+        char line[64];
+        char* p = std::to_chars(line, line + 16, record.timestamp_ms).ptr;
+        *p++ = ',';
+        p = std::to_chars(p, p + 8, static_cast<unsigned>(record.name)).ptr;
+        *p++ = ',';
+        p = std::to_chars(p, p + 32, record.value).ptr;  // Shortest text that reads back to the same float
+        *p++ = '\n';
+        buffer_.append(line, p);
+        if (buffer_.size() >= kCsvFlush_bytes) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (buffer_.empty()) {
+            return;
+        }
+        std::fwrite(buffer_.data(), 1, buffer_.size(), out_);
+        buffer_.clear();
+    }
+
+private:
+    FILE* out_;
+    std::string buffer_;
+};
+
+class ColumnarSink : public IRecordSink {
+public:
+    void onRecord(const DecodedRecord& record) override {
+        timestamps_.push_back(record.timestamp_ms);
+        names_.push_back(record.name);
+        values_.push_back(record.value);
+    }
+
+    void write(FILE* out) const {
+        const uint64_t count = timestamps_.size();
+        std::fwrite("CURECOL1", 1, 8, out);
+        std::fwrite(&count, sizeof(count), 1, out);
+        std::fwrite(timestamps_.data(), sizeof(uint32_t), timestamps_.size(), out);
+        std::fwrite(names_.data(), sizeof(uint8_t), names_.size(), out);
+        std::fwrite(values_.data(), sizeof(float), values_.size(), out);
+    }
+
+private:
+    std::vector<uint32_t> timestamps_;
+    std::vector<uint8_t> names_;
+    std::vector<float> values_;
+};
+
+bool isDumpCapture(const uint8_t* data, std::size_t size) {
+    const std::size_t limit = size < kPreambleSearch_bytes ? size : kPreambleSearch_bytes;
+    for (std::size_t i = 0; i + 6U <= limit; i++) {
+        if (std::memcmp(data + i, "abcdef", 6) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decode @p data into @p out and report what was found. The sinks are flushed
+// by the time this returns, before the caller closes @p out.
+void decode(const uint8_t* data, std::size_t size, bool chip, bool columnar, FILE* out) {
+    CsvSink csv(out);
+    ColumnarSink columns;
+    IRecordSink& sink = columnar ? static_cast<IRecordSink&>(columns) : static_cast<IRecordSink&>(csv);
+    FlashDecoder decoder(sink);
+
+    const bool dump = isDumpCapture(data, size);
+    if (dump) {
+        decoder.feedDump(data, size);
+    } else if (chip) {
+        if (size > kDataStartAddress) {
+            decoder.decodeImage(data + kDataStartAddress, size - kDataStartAddress);
+        }
+    } else {
+        decoder.decodeImage(data, size);
+    }
+
+    if (columnar) {
+        columns.write(out);
+    }
+
+    std::fprintf(stderr, "%u records from %u pages (%u erased, %u malformed)\n", decoder.getRecordCount(),
+                 decoder.getPageCount(), decoder.getErasedPageCount(), decoder.getMalformedPageCount());
+    if (dump) {
+        std::fprintf(stderr, "dump %s, flags '%s'\n", decoder.isDumpComplete() ? "complete" : "truncated",
+                     decoder.getDumpFlags());
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool chip = false;
+    bool columnar = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--chip") == 0) {
+            chip = true;
+        } else if (std::strcmp(argv[i], "--columnar") == 0) {
+            columnar = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 2U) {
+        std::fprintf(stderr, "usage: %s [--chip] [--columnar] <input> <output>\n", argv[0]);
+        return 2;
+    }
+
+    const int fd = open(paths[0], O_RDONLY);
+    struct stat info = {};
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::perror(paths[0]);
+        return 1;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    const auto* data = static_cast<const uint8_t*>(mapped);
+
+    FILE* out = std::fopen(paths[1], "wb");
+    if (out == nullptr) {
+        std::perror(paths[1]);
+        return 1;
+    }
+
+    decode(data, size, chip, columnar, out);
+    std::fclose(out);
+    munmap(mapped, size);
+    close(fd);
+    return 0;
+}